@@ -8,9 +8,11 @@
 
 #ifdef _MSC_VER
     #define INLINE      __forceinline
+    #define FORCEINLINE static __forceinline
     #define NOINLINE    __declspec ( noinline )
 #else
     #define INLINE      static inline
+    #define FORCEINLINE static inline __attribute__ ( ( always_inline ) )
     #define NOINLINE
 #endif
 
@@ -49,6 +49,10 @@ state_t;
 // Global subsystem state.
 static state_t* state;
 
+// Send all console log output to standard error? Y/N
+// (independent of the subsystem state; see logger_redirect_console)
+static bool log_redirect_console = false;
+
 /**
  * @brief Appends a message to the log file.
  * @param mesg The message to append.
@@ -107,6 +111,14 @@ logger_shutdown
     state = 0;
 }
 
+void
+logger_redirect_console
+(   const bool redirect
+)
+{
+    log_redirect_console = redirect;
+}
+
 void
 LOG
 (   const LOG_LEVEL lvl
@@ -140,8 +152,8 @@ LOG
                   , ( colored ) ? "" : ANSI_CC_RESET
                   , buf + string_length ( log_level_prefixes[ lvl ] )
                   );
-    ( err ) ? platform_console_write_error ( buf )
-            : platform_console_write ( buf );
+    ( err || log_redirect_console ) ? platform_console_write_error ( buf )
+                                    : platform_console_write ( buf );
 }
 
 void
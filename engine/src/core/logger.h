@@ -75,6 +75,17 @@ logger_shutdown
 (   void* state
 );
 
+/**
+ * @brief Sends all console log output to the standard error stream, so that
+ * standard output carries only the program's own output (e.g. a protocol or
+ * a report). May be called before the logger subsystem is initialized.
+ * @param redirect Redirect? Y/N
+ */
+void
+logger_redirect_console
+(   const bool redirect
+);
+
 /**
  * @brief Logs a message according to the logging elevation protocol for the
  * specified log elevation.
@@ -136,3 +136,35 @@ string_trim
     
     return s;
 }
+
+bool
+string_to_u64
+(   const char* s
+,   u64*        value
+)
+{
+    if ( !( *s ) )
+    {
+        return false;
+    }
+    *value = 0;
+    for ( ; *s; ++s )
+    {
+        if ( !digit ( *s ) )
+        {
+            return false;
+        }
+        *value = 10 * ( *value ) + to_digit ( *s );
+    }
+    return true;
+}
+
+bool
+string_to_f64
+(   const char* s
+,   f64*        value
+)
+{
+    i32 length;
+    return sscanf ( s , "%lf%n" , value , &length ) == 1 && !s[ length ];
+}
\ No newline at end of file
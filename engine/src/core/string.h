@@ -112,4 +112,28 @@ string_trim
 (   char* s
 );
 
+/**
+ * @brief Parses an unsigned decimal integer.
+ * @param s The string to parse.
+ * @param value Output buffer.
+ * @return true if s is a valid unsigned integer, false otherwise.
+ */
+bool
+string_to_u64
+(   const char* s
+,   u64*        value
+);
+
+/**
+ * @brief Parses a floating point number.
+ * @param s The string to parse.
+ * @param value Output buffer.
+ * @return true if s is a valid floating point number, false otherwise.
+ */
+bool
+string_to_f64
+(   const char* s
+,   f64*        value
+);
+
 #endif  // STRING_H
@@ -0,0 +1,43 @@
+/**
+ * @file exp.h
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Defines exponential and logarithmic operations.
+ */
+#ifndef MATH_EXP_H
+#define MATH_EXP_H
+
+#include "common.h"
+
+// Global constants.
+#define LN2             0.69314718055994530942f
+#define LN10            2.30258509299404568402f
+
+/**
+ * @brief Defines aliases for the exponential and logarithm functions (this
+ * avoids function signatures which clash with the platform-specific math
+ * header).
+ */
+#define exp(X) ( _exp ( X ) )
+#define log(X) ( _log ( X ) )
+
+/**
+ * @brief Natural exponential function.
+ * @param x A floating point number.
+ * @return e^x
+ */
+f32
+_exp
+(   f32 x
+);
+
+/**
+ * @brief Natural logarithm function.
+ * @param x A floating point number.
+ * @return ln(x)
+ */
+f32
+_log
+(   f32 x
+);
+
+#endif  // MATH_EXP_H
\ No newline at end of file
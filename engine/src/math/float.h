@@ -28,4 +28,20 @@ _abs
 (   f32 x
 );
 
+/**
+ * @brief Defines an alias for the rounding function (this avoids function
+ * signatures which clash with the platform-specific math header).
+ */
+#define round(X) ( _round ( X ) )
+
+/**
+ * @brief Rounds to the nearest integer (halfway cases away from zero).
+ * @param x A floating point number.
+ * @return round(x)
+ */
+f32
+_round
+(   f32 x
+);
+
 #endif  // MATH_FLOAT_H
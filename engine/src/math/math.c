@@ -13,6 +13,9 @@
 // Undefine preprocessor bindings which have name conflicts with <math.h> and <stdlib.h>
 #undef abs
 #undef sqrt
+#undef exp
+#undef log
+#undef round
 #undef sin
 #undef cos
 #undef tan
@@ -35,6 +38,14 @@ _abs
     return fabsf ( x );
 }
 
+f32
+_round
+(   f32 x
+)
+{
+    return roundf ( x );
+}
+
 f32
 _sqrt
 (   f32 x
@@ -43,6 +54,22 @@ _sqrt
     return sqrtf ( x );
 }
 
+f32
+_exp
+(   f32 x
+)
+{
+    return expf ( x );
+}
+
+f32
+_log
+(   f32 x
+)
+{
+    return logf ( x );
+}
+
 
 f32
 _sin
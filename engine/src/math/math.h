@@ -10,6 +10,7 @@
 
 #include "math/conversion.h"
 #include "math/div.h"
+#include "math/exp.h"
 #include "math/float.h"
 #include "math/matrix.h"
 #include "math/quaternion.h"
@@ -44,10 +45,10 @@
  * @return The clamped value.
  */
 #define clamp(VALUE,MIN,MAX)                                    \
-    ({ __typeof__ (VALUE) value = (VALUE);                      \
-       __typeof__ (MIN) min = (MIN);                            \
-       __typeof__ (MAX) max = (MAX);                            \
-       ( value <= min ) ? min : ( value >= max ) ? max : value; \
+    ({ __typeof__ (VALUE) _V = (VALUE);                         \
+       __typeof__ (MIN) _LO = (MIN);                            \
+       __typeof__ (MAX) _HI = (MAX);                            \
+       ( _V <= _LO ) ? _LO : ( _V >= _HI ) ? _HI : _V;          \
     })
 
 #endif  // MATH_H
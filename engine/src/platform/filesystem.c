@@ -24,6 +24,14 @@ file_exists
     return !stat ( p , &buf );
 }
 
+bool
+file_remove
+(   const char* p
+)
+{
+    return !remove ( p );
+}
+
 bool
 file_open
 (   const char*     p
@@ -74,6 +82,34 @@ file_open
     return true;
 }
 
+bool
+file_open_stdio
+(   FILE_MODE       mode
+,   file_handle_t*  f
+)
+{
+    ( *f ).valid = false;
+    ( *f ).handle = 0;
+
+    // Interpret argument.
+    if ( mode == FILE_MODE_READ )
+    {
+        ( *f ).handle = stdin;
+    }
+    else if ( mode == FILE_MODE_WRITE )
+    {
+        ( *f ).handle = stdout;
+    }
+    else
+    {
+        LOGERROR ( "file_open_stdio: Invalid file mode provided." );
+        return false;
+    }
+
+    ( *f ).valid = true;
+    return true;
+}
+
 void
 file_close
 (   file_handle_t* f
@@ -90,6 +126,25 @@ file_close
     ( *f ).handle = 0;
 }
 
+bool
+file_size
+(   file_handle_t*  f
+,   u64*            size
+)
+{
+    if ( !( *f ).handle )
+    {
+        return false;
+    }
+
+    FILE* file = ( *f ).handle;
+    const i64 position = ftell ( file );
+    fseek ( file , 0 , SEEK_END );
+    *size = ftell ( file );
+    fseek ( file , position , SEEK_SET );
+    return true;
+}
+
 bool
 file_read_line
 (   file_handle_t*  f
@@ -34,6 +34,16 @@ file_exists
 (   const char* p
 );
 
+/**
+ * @brief Deletes a file.
+ * @param p The filepath.
+ * @return true if file deleted successfully; false otherwise.
+ */
+bool
+file_remove
+(   const char* p
+);
+
 /**
  * @brief Attempts to open a file.
  * @param p The filepath.
@@ -50,6 +60,20 @@ file_open
 ,   file_handle_t*  f
 );
 
+/**
+ * @brief Opens a handle to a standard stream of the process: standard input
+ * for FILE_MODE_READ, or standard output for FILE_MODE_WRITE. The handle must
+ * not be closed.
+ * @param mode Mode flag.
+ * @param handle Output buffer for file handle.
+ * @return true if stream opened successfully; false otherwise.
+ */
+bool
+file_open_stdio
+(   FILE_MODE       mode
+,   file_handle_t*  f
+);
+
 /**
  * @brief Closes a file.
  * @param f Handle to the file to close.
@@ -59,6 +83,18 @@ file_close
 (   file_handle_t* f
 );
 
+/**
+ * @brief Queries the size of a file.
+ * @param f Handle to the file.
+ * @param size Output buffer to hold the file size in bytes.
+ * @return true if file size read successfully; false otherwise.
+ */
+bool
+file_size
+(   file_handle_t*  f
+,   u64*            size
+);
+
 /**
  * @brief Reads a file into an output buffer until EOF or line break
  * encountered.
@@ -24,6 +24,13 @@
 
 #include <sys/time.h>
 
+#include <pthread.h>
+#include <ucontext.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include <termios.h>
 #include <unistd.h>
 
@@ -460,6 +467,13 @@ platform_console_write_error
     _platform_console_write ( mesg , stderr );
 }
 
+void
+platform_console_flush
+( void )
+{
+    fflush ( stdout );
+}
+
 KEY
 platform_console_read_key
 ( void )
@@ -685,6 +699,210 @@ platform_sleep
 #endif
 }
 
+u32
+platform_processor_count
+( void )
+{
+    const long count = sysconf ( _SC_NPROCESSORS_ONLN );
+    return ( count > 0 ) ? count : 1;
+}
+
+/**
+ * @brief Adapts a platform thread entry point to the pthread signature.
+ * @param thread Handle to the thread being started.
+ * @return 0.
+ */
+void*
+platform_thread_start
+(   void* thread
+)
+{
+    platform_thread_t* thread_ = thread;
+    ( *thread_ ).result = ( *thread_ ).start ( ( *thread_ ).args );
+    return 0;
+}
+
+bool
+platform_thread_create
+(   PFN_thread_start    start
+,   void*               args
+,   platform_thread_t*  thread
+)
+{
+    ( *thread ).start = start;
+    ( *thread ).args = args;
+    ( *thread ).result = 0;
+
+    pthread_t handle;
+    if ( pthread_create ( &handle , 0 , platform_thread_start , thread ) )
+    {
+        LOGERROR ( "platform_thread_create: Call to pthread_create failed." );
+        return false;
+    }
+    ( *thread ).handle = handle;
+    return true;
+}
+
+u32
+platform_thread_join
+(   platform_thread_t*  thread
+)
+{
+    pthread_join ( ( pthread_t )( *thread ).handle , 0 );
+    return ( *thread ).result;
+}
+
+// Type definition for the platform state of a coroutine.
+typedef struct
+{
+    ucontext_t  context;
+    ucontext_t  caller;
+    void*       stack;
+}
+platform_coroutine_context_t;
+
+/**
+ * @brief Adapts a platform coroutine entry point to the makecontext
+ * signature, which only passes int arguments: the coroutine handle is split
+ * into two halves.
+ * @param lo Low 32 bits of the coroutine handle address.
+ * @param hi High 32 bits of the coroutine handle address.
+ */
+void
+platform_coroutine_start
+(   u32 lo
+,   u32 hi
+)
+{
+    platform_coroutine_t* coroutine = ( platform_coroutine_t* )( ( ( u64 ) hi << 32 ) | lo );
+    ( *coroutine ).start ( ( *coroutine ).args );
+    ( *coroutine ).done = true;
+    // Returning resumes the caller (uc_link).
+}
+
+bool
+platform_coroutine_create
+(   PFN_coroutine_start     start
+,   void*                   args
+,   const u64               stack_size
+,   platform_coroutine_t*   coroutine
+)
+{
+    ( *coroutine ).start = start;
+    ( *coroutine ).args = args;
+    ( *coroutine ).done = false;
+
+    platform_coroutine_context_t* context = platform_memory_allocate ( sizeof ( platform_coroutine_context_t ) , false );
+    void* stack = platform_memory_allocate ( stack_size , false );
+    if ( !context || !stack || getcontext ( &( *context ).context ) )
+    {
+        LOGERROR ( "platform_coroutine_create: Failed to initialize coroutine context." );
+        platform_memory_free ( stack , false );
+        platform_memory_free ( context , false );
+        return false;
+    }
+    ( *context ).stack = stack;
+    ( *context ).context.uc_stack.ss_sp = stack;
+    ( *context ).context.uc_stack.ss_size = stack_size;
+    ( *context ).context.uc_link = &( *context ).caller;
+    makecontext ( &( *context ).context
+                , ( void (*)( void ) ) platform_coroutine_start
+                , 2
+                , ( u32 ) ( u64 ) coroutine
+                , ( u32 ) ( ( u64 ) coroutine >> 32 )
+                );
+    ( *coroutine ).handle = ( u64 ) context;
+    return true;
+}
+
+bool
+platform_coroutine_resume
+(   platform_coroutine_t*   coroutine
+)
+{
+    if ( ( *coroutine ).done )
+    {
+        return false;
+    }
+    platform_coroutine_context_t* context = ( platform_coroutine_context_t* )( *coroutine ).handle;
+    swapcontext ( &( *context ).caller , &( *context ).context );
+    return !( *coroutine ).done;
+}
+
+void
+platform_coroutine_yield
+(   platform_coroutine_t*   coroutine
+)
+{
+    platform_coroutine_context_t* context = ( platform_coroutine_context_t* )( *coroutine ).handle;
+    swapcontext ( &( *context ).context , &( *context ).caller );
+}
+
+void
+platform_coroutine_destroy
+(   platform_coroutine_t*   coroutine
+)
+{
+    platform_coroutine_context_t* context = ( platform_coroutine_context_t* )( *coroutine ).handle;
+    if ( !context )
+    {
+        return;
+    }
+    platform_memory_free ( ( *context ).stack , false );
+    platform_memory_free ( context , false );
+    ( *coroutine ).handle = 0;
+}
+
+bool
+platform_file_map
+(   const char*                 path
+,   platform_file_mapping_t*    mapping
+)
+{
+    const int file = open ( path , O_RDONLY );
+    if ( file < 0 )
+    {
+        LOGERROR ( "platform_file_map: Failed to open file '%s'." , path );
+        return false;
+    }
+
+    struct stat info;
+    if ( fstat ( file , &info ) || !info.st_size )
+    {
+        LOGERROR ( "platform_file_map: Failed to read size of file '%s'." , path );
+        close ( file );
+        return false;
+    }
+
+    void* memory = mmap ( 0 , info.st_size , PROT_READ , MAP_SHARED , file , 0 );
+    close ( file );
+    if ( memory == MAP_FAILED )
+    {
+        LOGERROR ( "platform_file_map: Call to mmap failed." );
+        return false;
+    }
+
+    ( *mapping ).memory = memory;
+    ( *mapping ).size = info.st_size;
+    ( *mapping ).handle = 0;
+    return true;
+}
+
+void
+platform_file_unmap
+(   platform_file_mapping_t*    mapping
+)
+{
+    if ( !( *mapping ).memory )
+    {
+        return;
+    }
+    munmap ( ( void* )( *mapping ).memory , ( *mapping ).size );
+    ( *mapping ).memory = 0;
+    ( *mapping ).size = 0;
+    ( *mapping ).handle = 0;
+}
+
 void
 _platform_console_write
 (   const char* mesg
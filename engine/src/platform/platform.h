@@ -10,6 +10,41 @@
 
 #include "core/input.h"
 
+// Type definition for a thread entry point.
+typedef u32 ( *PFN_thread_start )( void* args );
+
+// Type definition for a thread handle.
+typedef struct
+{
+    u64                 handle;
+    PFN_thread_start    start;
+    void*               args;
+    u32                 result;
+}
+platform_thread_t;
+
+// Type definition for a coroutine entry point.
+typedef void ( *PFN_coroutine_start )( void* args );
+
+// Type definition for a coroutine handle.
+typedef struct
+{
+    u64                 handle;
+    PFN_coroutine_start start;
+    void*               args;
+    bool                done;
+}
+platform_coroutine_t;
+
+// Type definition for a read-only memory-mapped file.
+typedef struct
+{
+    const void* memory;
+    u64         size;
+    u64         handle;
+}
+platform_file_mapping_t;
+
 /**
  * @brief Initializes the platform subsystem. Call once to read the memory
  * requirement. Call again passing in a state pointer.
@@ -153,6 +188,14 @@ platform_console_write_error
 (   const char* mesg
 );
 
+/**
+ * @brief Platform-independent function to flush console output, e.g. after
+ * writing a partial line.
+ */
+void
+platform_console_flush
+( void );
+
 /**
  * @brief Platform-independent function to read a single keystroke of user
  * input in the console.
@@ -184,4 +227,113 @@ platform_sleep
 (   u64 ms
 );
 
+/**
+ * @brief Platform-independent function to query the number of logical
+ * processors available to the application.
+ * @return The number of logical processors (at least 1).
+ */
+u32
+platform_processor_count
+( void );
+
+/**
+ * @brief Platform-independent function to start a new thread. The thread
+ * handle must remain valid until the thread is joined.
+ * @param start The thread entry point.
+ * @param args Argument to pass to start.
+ * @param thread Output buffer for the thread handle.
+ * @return true if thread started successfully, false otherwise.
+ */
+bool
+platform_thread_create
+(   PFN_thread_start    start
+,   void*               args
+,   platform_thread_t*  thread
+);
+
+/**
+ * @brief Platform-independent function to wait for a thread to exit.
+ * @param thread Handle to the thread to join.
+ * @return The value returned by the thread entry point.
+ */
+u32
+platform_thread_join
+(   platform_thread_t*  thread
+);
+
+/**
+ * @brief Platform-independent function to create a coroutine: a function
+ * which runs on its own stack, on the thread which resumes it, and which may
+ * suspend itself (see platform_coroutine_yield) to be resumed later where it
+ * left off. The coroutine does not run until it is first resumed. The
+ * coroutine handle must remain valid until the coroutine is destroyed.
+ * @param start The coroutine entry point.
+ * @param args Argument to pass to start.
+ * @param stack_size The size of the coroutine stack (bytes).
+ * @param coroutine Output buffer for the coroutine handle.
+ * @return true if coroutine created successfully, false otherwise.
+ */
+bool
+platform_coroutine_create
+(   PFN_coroutine_start     start
+,   void*                   args
+,   const u64               stack_size
+,   platform_coroutine_t*   coroutine
+);
+
+/**
+ * @brief Platform-independent function to run a coroutine until it yields
+ * or returns.
+ * @param coroutine Handle to the coroutine to resume.
+ * @return true if the coroutine yielded, false if it has returned.
+ */
+bool
+platform_coroutine_resume
+(   platform_coroutine_t*   coroutine
+);
+
+/**
+ * @brief Platform-independent function to suspend the running coroutine,
+ * returning control to the caller of platform_coroutine_resume. Must only be
+ * called from within the coroutine.
+ * @param coroutine Handle to the running coroutine.
+ */
+void
+platform_coroutine_yield
+(   platform_coroutine_t*   coroutine
+);
+
+/**
+ * @brief Platform-independent function to destroy a coroutine and free its
+ * stack. A coroutine which has yielded may be destroyed without being
+ * resumed to completion (its entry point does not return).
+ * @param coroutine Handle to the coroutine to destroy.
+ */
+void
+platform_coroutine_destroy
+(   platform_coroutine_t*   coroutine
+);
+
+/**
+ * @brief Platform-independent function to map an entire file into memory as
+ * read-only. Pages are loaded on demand by the operating system.
+ * @param path The filepath.
+ * @param mapping Output buffer for the file mapping.
+ * @return true if file mapped successfully, false otherwise.
+ */
+bool
+platform_file_map
+(   const char*                 path
+,   platform_file_mapping_t*    mapping
+);
+
+/**
+ * @brief Platform-independent function to unmap a memory-mapped file.
+ * @param mapping Handle to the file mapping.
+ */
+void
+platform_file_unmap
+(   platform_file_mapping_t*    mapping
+);
+
 #endif  // PLATFORM_H
@@ -327,6 +327,13 @@ platform_console_write_error
     _platform_console_write ( mesg , stderr );
 }
 
+void
+platform_console_flush
+( void )
+{
+    fflush ( stdout );
+}
+
 KEY
 platform_console_read_key
 ( void )
@@ -380,6 +387,227 @@ platform_sleep
     Sleep ( ms );
 }
 
+u32
+platform_processor_count
+( void )
+{
+    SYSTEM_INFO info;
+    GetSystemInfo ( &info );
+    return ( info.dwNumberOfProcessors > 0 ) ? info.dwNumberOfProcessors : 1;
+}
+
+/**
+ * @brief Adapts a platform thread entry point to the Windows signature.
+ * @param thread Handle to the thread being started.
+ * @return 0.
+ */
+DWORD WINAPI
+platform_thread_start
+(   LPVOID thread
+)
+{
+    platform_thread_t* thread_ = thread;
+    ( *thread_ ).result = ( *thread_ ).start ( ( *thread_ ).args );
+    return 0;
+}
+
+bool
+platform_thread_create
+(   PFN_thread_start    start
+,   void*               args
+,   platform_thread_t*  thread
+)
+{
+    ( *thread ).start = start;
+    ( *thread ).args = args;
+    ( *thread ).result = 0;
+
+    HANDLE handle = CreateThread ( 0 , 0 , platform_thread_start , thread , 0 , 0 );
+    if ( !handle )
+    {
+        LOGERROR ( "platform_thread_create: Call to CreateThread failed." );
+        return false;
+    }
+    ( *thread ).handle = ( u64 ) handle;
+    return true;
+}
+
+u32
+platform_thread_join
+(   platform_thread_t*  thread
+)
+{
+    WaitForSingleObject ( ( HANDLE )( *thread ).handle , INFINITE );
+    CloseHandle ( ( HANDLE )( *thread ).handle );
+    return ( *thread ).result;
+}
+
+// Type definition for the platform state of a coroutine.
+typedef struct
+{
+    LPVOID  fiber;
+    LPVOID  caller;
+}
+platform_coroutine_context_t;
+
+/**
+ * @brief Adapts a platform coroutine entry point to the fiber signature. A
+ * fiber must not return, so it switches back to its caller for good instead.
+ * @param coroutine Handle to the coroutine being started.
+ */
+VOID CALLBACK
+platform_coroutine_start
+(   LPVOID coroutine
+)
+{
+    platform_coroutine_t* coroutine_ = coroutine;
+    ( *coroutine_ ).start ( ( *coroutine_ ).args );
+    ( *coroutine_ ).done = true;
+    SwitchToFiber ( ( *( ( platform_coroutine_context_t* )( *coroutine_ ).handle ) ).caller );
+}
+
+bool
+platform_coroutine_create
+(   PFN_coroutine_start     start
+,   void*                   args
+,   const u64               stack_size
+,   platform_coroutine_t*   coroutine
+)
+{
+    ( *coroutine ).start = start;
+    ( *coroutine ).args = args;
+    ( *coroutine ).done = false;
+
+    platform_coroutine_context_t* context = platform_memory_allocate ( sizeof ( platform_coroutine_context_t ) , false );
+    if ( !context )
+    {
+        LOGERROR ( "platform_coroutine_create: Failed to initialize coroutine context." );
+        return false;
+    }
+    ( *context ).caller = 0;
+    ( *context ).fiber = CreateFiber ( stack_size , platform_coroutine_start , coroutine );
+    if ( !( *context ).fiber )
+    {
+        LOGERROR ( "platform_coroutine_create: Call to CreateFiber failed." );
+        platform_memory_free ( context , false );
+        return false;
+    }
+    ( *coroutine ).handle = ( u64 ) context;
+    return true;
+}
+
+bool
+platform_coroutine_resume
+(   platform_coroutine_t*   coroutine
+)
+{
+    if ( ( *coroutine ).done )
+    {
+        return false;
+    }
+
+    // Only a fiber may switch to another fiber.
+    if ( !IsThreadAFiber () && !ConvertThreadToFiber ( 0 ) )
+    {
+        LOGERROR ( "platform_coroutine_resume: Call to ConvertThreadToFiber failed." );
+        return false;
+    }
+
+    platform_coroutine_context_t* context = ( platform_coroutine_context_t* )( *coroutine ).handle;
+    ( *context ).caller = GetCurrentFiber ();
+    SwitchToFiber ( ( *context ).fiber );
+    return !( *coroutine ).done;
+}
+
+void
+platform_coroutine_yield
+(   platform_coroutine_t*   coroutine
+)
+{
+    SwitchToFiber ( ( *( ( platform_coroutine_context_t* )( *coroutine ).handle ) ).caller );
+}
+
+void
+platform_coroutine_destroy
+(   platform_coroutine_t*   coroutine
+)
+{
+    platform_coroutine_context_t* context = ( platform_coroutine_context_t* )( *coroutine ).handle;
+    if ( !context )
+    {
+        return;
+    }
+    DeleteFiber ( ( *context ).fiber );
+    platform_memory_free ( context , false );
+    ( *coroutine ).handle = 0;
+}
+
+bool
+platform_file_map
+(   const char*                 path
+,   platform_file_mapping_t*    mapping
+)
+{
+    HANDLE file = CreateFileA ( path
+                              , GENERIC_READ
+                              , FILE_SHARE_READ
+                              , 0
+                              , OPEN_EXISTING
+                              , FILE_ATTRIBUTE_NORMAL
+                              , 0
+                              );
+    if ( file == INVALID_HANDLE_VALUE )
+    {
+        LOGERROR ( "platform_file_map: Failed to open file '%s'." , path );
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if ( !GetFileSizeEx ( file , &size ) || !size.QuadPart )
+    {
+        LOGERROR ( "platform_file_map: Failed to read size of file '%s'." , path );
+        CloseHandle ( file );
+        return false;
+    }
+
+    HANDLE handle = CreateFileMappingA ( file , 0 , PAGE_READONLY , 0 , 0 , 0 );
+    CloseHandle ( file );
+    if ( !handle )
+    {
+        LOGERROR ( "platform_file_map: Call to CreateFileMappingA failed." );
+        return false;
+    }
+
+    const void* memory = MapViewOfFile ( handle , FILE_MAP_READ , 0 , 0 , 0 );
+    if ( !memory )
+    {
+        LOGERROR ( "platform_file_map: Call to MapViewOfFile failed." );
+        CloseHandle ( handle );
+        return false;
+    }
+
+    ( *mapping ).memory = memory;
+    ( *mapping ).size = size.QuadPart;
+    ( *mapping ).handle = ( u64 ) handle;
+    return true;
+}
+
+void
+platform_file_unmap
+(   platform_file_mapping_t*    mapping
+)
+{
+    if ( !( *mapping ).memory )
+    {
+        return;
+    }
+    UnmapViewOfFile ( ( *mapping ).memory );
+    CloseHandle ( ( HANDLE )( *mapping ).handle );
+    ( *mapping ).memory = 0;
+    ( *mapping ).size = 0;
+    ( *mapping ).handle = 0;
+}
+
 void
 _platform_console_write
 (   const char* mesg
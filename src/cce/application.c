@@ -19,6 +19,7 @@
 #include "platform/filesystem.h"
 
 #include "chess/chess.h"
+#include "chess/test/bench.h"
 
 // Type definition for game variant.
 typedef enum
@@ -106,6 +107,9 @@ static const char* cce_command_strings[] = { [ CCE_COMMAND_QUIT ]
 #define CCE_RENDER_TEXTBUFFER_LENGTH 65535
 #define CCE_INPUT_TEXTBUFFER_LENGTH  8
 
+// Defines the maximum number of moves recorded for the game record.
+#define CCE_GAME_MAX_PLY 2048U
+
 // Type definition for internal application state.
 typedef struct
 {
@@ -120,14 +124,27 @@ typedef struct
     // Chess.
     move_search_t       move_search_args;
     attacks_t           attacks;
+    nnue_t*             nnue;
+    bitbases_t          bitbases;
+    book_t              book;
     board_t             board;
     moves_t             moves;
     move_t              move;
     u32                 ply;
     u32                 fifty;
+    move_t              history[ CCE_GAME_MAX_PLY ];
+
+    // Engine search, run as a coroutine resumed once per update (see
+    // cce_execute_move_engine).
+    platform_coroutine_t search;
+    bool                 searching;
+    f64                  search_yield;      // Absolute time by which the search yields.
+    u64                  search_nodes;      // Nodes last rendered.
 
-    // Benchmarking.
+    // Benchmarking. move_elapsed is the time spent computing the last engine
+    // move, excluding the time its search spent suspended between updates.
     clock_t             clock;
+    f64                 move_elapsed;
     f64                 elapsed;
 
     // Command.
@@ -159,6 +176,7 @@ bool cce_prompt_command             ( void );
 bool cce_execute_command            ( void );
 bool cce_execute_move_player        ( void );
 bool cce_execute_move_engine        ( void );
+bool cce_execute_move_engine_finish ( void );
 bool cce_debug                      ( void );
 
 /**
@@ -183,6 +201,53 @@ void cce_render_buffer              ( void );
 // Defines engine search depth.
 #define CCE_ENGINE_SEARCH_DEPTH 8
 
+// Defines the time the engine search may run for per update (s), and the
+// number of nodes between two checks of it.
+#define CCE_ENGINE_SEARCH_BUDGET            0.01
+#define CCE_ENGINE_SEARCH_OBSERVER_INTERVAL 4096
+
+// Defines the stack size of the engine search coroutine.
+#define CCE_ENGINE_SEARCH_STACK_SIZE        MEBIBYTES ( 4 )
+
+/**
+ * @brief Engine search coroutine entry point.
+ * @param args Unused.
+ */
+void
+cce_engine_search
+(   void* args
+);
+
+/**
+ * @brief Engine search observer. Suspends the search coroutine once the
+ * search has used up its budget for the current update.
+ * @param result The search result so far.
+ * @param args Unused.
+ */
+void
+cce_engine_search_observer
+(   const move_search_result_t* result
+,   void*                       args
+);
+
+// Defines the filepath of the (optional) engine evaluation network.
+#define CCE_NNUE_FILEPATH "cce.nnue"
+
+// Defines the filepath of the (optional) Polyglot opening book.
+#define CCE_BOOK_FILEPATH "book.bin"
+
+// Defines the directory of the (optional) endgame bitbases.
+#define CCE_BITBASE_DIRECTORY "."
+
+// Defines number of evaluations to time in the debug benchmark.
+#define CCE_BENCH_EVALUATE_ITERATIONS 1000000
+
+// Defines number of positions to time in the debug move generation benchmark.
+#define CCE_BENCH_MOVEGEN_ITERATIONS 1000000
+
+// Defines the search depth of the debug search benchmark.
+#define CCE_BENCH_SEARCH_DEPTH 6
+
 /**
  * @brief User input handler.
  * @param char_count Number of characters to prompt for.
@@ -213,6 +278,10 @@ void cce_log_splash_title ( void );
 void cce_log_board        ( void );
 void cce_log_move         ( void );
 
+// Game record interface.
+#define CCE_PGN_FILEPATH "console.game.pgn"
+bool cce_write_pgn        ( void );
+
 // Console color code indices for text rendering.
 #define CCE_COLOR_DEFAULT   ANSI_CC ( ANSI_CC_NONE )
 #define CCE_COLOR_HINT      ANSI_CC ( ANSI_CC_FG_GRAY )
@@ -221,6 +290,9 @@ void cce_log_move         ( void );
 #define CCE_COLOR_PLUS      ANSI_CC ( ANSI_CC_FG_DARK_GREEN )
 #define CCE_COLOR_INFO      ANSI_CC ( ANSI_CC_FG_DARK_MAGENTA )
 
+// Console control sequence to return to the start of the line and clear it.
+#define CCE_CLEAR_LINE      "\r\033[K"
+
 /**
  * @brief Renders the application state to the console and log file.
  */
@@ -285,6 +357,7 @@ cce_startup
     
     ( *state ).update = 0;
     ( *state ).ioerr = 0;
+    ( *state ).searching = false;
 
     memory_clear ( ( *state ).in
                  , sizeof ( ( *state ).in )
@@ -314,6 +387,37 @@ cce_startup
     // Pregenerate attack tables.
     attacks_init ( &( *state ).attacks );
 
+    // Load evaluation network, if present.
+    ( *state ).nnue = 0;
+    if ( file_exists ( CCE_NNUE_FILEPATH ) )
+    {
+        ( *state ).nnue = memory_allocate ( sizeof ( nnue_t )
+                                          , MEMORY_TAG_APPLICATION
+                                          );
+        if ( !nnue_load ( CCE_NNUE_FILEPATH , ( *state ).nnue ) )
+        {
+            LOGWARN ( "cce_startup: Failed to load evaluation network '"CCE_NNUE_FILEPATH"'. Using default evaluation." );
+            memory_free ( ( *state ).nnue , sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+            ( *state ).nnue = 0;
+        }
+    }
+    ( *state ).move_search_args.nnue = ( *state ).nnue;
+
+    // Map opening book, if present.
+    memory_clear ( &( *state ).book , sizeof ( book_t ) );
+    if ( file_exists ( CCE_BOOK_FILEPATH ) && !book_open ( CCE_BOOK_FILEPATH , &( *state ).book ) )
+    {
+        LOGWARN ( "cce_startup: Failed to open opening book '"CCE_BOOK_FILEPATH"'." );
+    }
+
+    // Map endgame bitbases, if present.
+    const u32 bitbase_count = bitbases_load ( CCE_BITBASE_DIRECTORY , &( *state ).bitbases );
+    if ( bitbase_count )
+    {
+        LOGINFO ( "cce_startup: Loaded %u endgame bitbase(s) from '"CCE_BITBASE_DIRECTORY"'." , bitbase_count );
+    }
+    ( *state ).move_search_args.bitbases = ( bitbase_count ) ? &( *state ).bitbases : 0;
+
     ( *state ).render = CCE_RENDER_NONE;
     ( *state ).state = CCE_GAME_STATE_GAME_INIT;
     return true;
@@ -330,6 +434,17 @@ cce_shutdown
     }
 
     // Free memory used by the application.
+    state_t* state = ( *cce ).internal;
+    if ( ( *state ).searching )
+    {
+        platform_coroutine_destroy ( &( *state ).search );
+    }
+    if ( ( *state ).nnue )
+    {
+        memory_free ( ( *state ).nnue , sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+    }
+    bitbases_unload ( &( *state ).bitbases );
+    book_close ( &( *state ).book );
     memory_free ( cce
                 , sizeof ( cce_t ) + sizeof ( state_t )
                 , MEMORY_TAG_APPLICATION
@@ -454,6 +569,10 @@ cce_game_end
     if ( ( *state ).ply )
     {
         LOGINFO ( "A copy of the game was written to the log file: "CCE_LOG_FILEPATH"." );
+        if ( cce_write_pgn () )
+        {
+            LOGINFO ( "The game record was written in PGN format to: "CCE_PGN_FILEPATH"." );
+        }
     }
 
     // Signal engine to shutdown the application.
@@ -642,6 +761,12 @@ cce_execute_move_player
 {
     state_t* state = ( *cce ).internal;
     
+    // Record the move.
+    if ( ( *state ).ply < CCE_GAME_MAX_PLY )
+    {
+        ( *state ).history[ ( *state ).ply ] = ( *state ).move;
+    }
+
     // Perform the move.
     board_move ( &( *state ).board
                , ( *state ).move
@@ -739,25 +864,88 @@ cce_execute_move_engine
 ( void )
 {
     state_t* state = ( *cce ).internal;
-    
-    // Render simulated input.
-    RENDER_CLEAR ();
-    RENDER_PUSH ( CCE_COLOR_HINT "Computing best move. . .  " );
-    RENDER ();
 
-    // Start clock.
+    if ( !( *state ).searching )
+    {
+        // Render simulated input.
+        RENDER_CLEAR ();
+        RENDER_PUSH ( CCE_COLOR_HINT "Computing best move. . .  " );
+        RENDER ();
+        platform_console_flush ();
+
+        // Play from the opening book while in book; otherwise, start the
+        // search.
+        clock_start ( &( *state ).clock );
+        ( *state ).move = book_move ( &( *state ).book
+                                    , &( *state ).board
+                                    , &( *state ).attacks
+                                    );
+        clock_update ( &( *state ).clock );
+        ( *state ).move_elapsed = ( *state ).clock.elapsed;
+        if ( ( *state ).move )
+        {
+            return cce_execute_move_engine_finish ();
+        }
+        if ( !platform_coroutine_create ( cce_engine_search
+                                        , 0
+                                        , CCE_ENGINE_SEARCH_STACK_SIZE
+                                        , &( *state ).search
+                                        ))
+        {
+            LOGERROR ( "cce_execute_move_engine: Failed to start engine search." );
+            return false;
+        }
+        ( *state ).searching = true;
+        ( *state ).search_nodes = 0;
+    }
+
+    // Run the search until it completes or uses up its budget for this
+    // update, so that the application loop stays responsive.
+    ( *state ).render = CCE_RENDER_NONE;
+    ( *state ).search_yield = platform_get_absolute_time () + CCE_ENGINE_SEARCH_BUDGET;
     clock_start ( &( *state ).clock );
-    
-    // Compute best move.
-    ( *state ).move = board_best_move ( &( *state ).board
-                                      , &( *state ).attacks
-                                      , CCE_ENGINE_SEARCH_DEPTH
-                                      , &( *state ).move_search_args
-                                      );
-
-    // Stop clock.
+    const bool suspended = platform_coroutine_resume ( &( *state ).search );
     clock_update ( &( *state ).clock );
-    ( *state ).elapsed += ( *state ).clock.elapsed;
+    ( *state ).move_elapsed += ( *state ).clock.elapsed;
+    if ( suspended )
+    {
+        // Render search progress.
+        const move_search_result_t* result = &( *state ).move_search_args.result;
+        if ( ( *result ).nodes != ( *state ).search_nodes )
+        {
+            ( *state ).search_nodes = ( *result ).nodes;
+            RENDER_CLEAR ();
+            RENDER_PUSH ( CCE_CLEAR_LINE CCE_COLOR_HINT "Computing best move. . .  depth %u, %llu nodes"
+                        , ( *result ).depth
+                        , ( *result ).nodes
+                        );
+            RENDER ();
+            platform_console_flush ();
+        }
+        return true;
+    }
+    platform_coroutine_destroy ( &( *state ).search );
+    ( *state ).searching = false;
+    ( *state ).move = ( *state ).move_search_args.result.best;
+
+    // Clear search progress.
+    if ( ( *state ).search_nodes )
+    {
+        RENDER_CLEAR ();
+        RENDER_PUSH ( CCE_CLEAR_LINE CCE_COLOR_HINT "Computing best move. . .  " );
+        RENDER ();
+    }
+
+    return cce_execute_move_engine_finish ();
+}
+
+bool
+cce_execute_move_engine_finish
+( void )
+{
+    state_t* state = ( *cce ).internal;
+
+    ( *state ).elapsed += ( *state ).move_elapsed;
 
     // Render simulated input.
     RENDER_CLEAR ();
@@ -772,6 +960,12 @@ cce_execute_move_engine
     }
     RENDER ();
 
+    // Record the move.
+    if ( ( *state ).ply < CCE_GAME_MAX_PLY )
+    {
+        ( *state ).history[ ( *state ).ply ] = ( *state ).move;
+    }
+
     // Perform the move.
     board_move ( &( *state ).board
                , ( *state ).move
@@ -871,6 +1065,36 @@ cce_execute_move_engine
     return true;
 }
 
+void
+cce_engine_search
+(   void* args
+)
+{
+    state_t* state = ( *cce ).internal;
+    ( *state ).move_search_args.observer = cce_engine_search_observer;
+    ( *state ).move_search_args.observer_args = 0;
+    ( *state ).move_search_args.observer_interval = CCE_ENGINE_SEARCH_OBSERVER_INTERVAL;
+    board_best_move ( &( *state ).board
+                    , &( *state ).attacks
+                    , CCE_ENGINE_SEARCH_DEPTH
+                    , &( *state ).move_search_args
+                    );
+    ( *state ).move_search_args.observer = 0;
+}
+
+void
+cce_engine_search_observer
+(   const move_search_result_t* result
+,   void*                       args
+)
+{
+    state_t* state = ( *cce ).internal;
+    if ( platform_get_absolute_time () >= ( *state ).search_yield )
+    {
+        platform_coroutine_yield ( &( *state ).search );
+    }
+}
+
 bool
 cce_handle_user_input
 (   const u8 char_count
@@ -1250,7 +1474,7 @@ cce_render_execute_move_engine
 
     // Render the time taken to choose the move.
     RENDER_PUSH ( CCE_COLOR_HINT "\n\t\t\t\tTook %f seconds."
-                , ( *state ).clock.elapsed
+                , ( *state ).move_elapsed
                 );
 
     // Render the move.
@@ -1534,6 +1758,58 @@ cce_log_splash_title
              );
 }
 
+bool
+cce_write_pgn
+( void )
+{
+    state_t* state = ( *cce ).internal;
+
+    file_handle_t file;
+    if ( !file_open ( CCE_PGN_FILEPATH , FILE_MODE_WRITE , false , &file ) )
+    {
+        LOGWARN ( "cce_write_pgn: Unable to open '"CCE_PGN_FILEPATH"' for writing." );
+        return false;
+    }
+
+    // The side to move is the one which was checkmated.
+    const PGN_RESULT result = ( ( *state ).end == CCE_GAME_END_CHECKMATE ) ? ( ( ( *state ).board.side == WHITE ) ? PGN_RESULT_BLACK
+                                                                                                                    : PGN_RESULT_WHITE
+                                                                             )
+                            : ( ( *state ).end == CCE_GAME_END_STALEMATE
+                             || ( *state ).end == CCE_GAME_END_DRAW      ) ? PGN_RESULT_DRAW
+                                                                           : PGN_RESULT_UNKNOWN
+                                                                           ;
+    const char* player = ( ( *state ).game == CCE_GAME_ENGINE_VERSUS_ENGINE ) ? "cce" : "Player";
+    const char* opponent = ( ( *state ).game == CCE_GAME_PLAYER_VERSUS_PLAYER ) ? "Player" : "cce";
+
+    // Replay the game from the starting position.
+    pgn_writer_t writer;
+    pgn_write_begin ( &writer , &file );
+    bool success = pgn_write_tag ( &writer , "Event" , "cce game" )
+                && pgn_write_tag ( &writer , "Site" , "?" )
+                && pgn_write_tag ( &writer , "Date" , "????.??.??" )
+                && pgn_write_tag ( &writer , "Round" , "-" )
+                && pgn_write_tag ( &writer , "White" , player )
+                && pgn_write_tag ( &writer , "Black" , opponent )
+                && pgn_write_tag ( &writer , "Result" , pgn_string_result ( result ) )
+                ;
+    board_t board;
+    fen_parse ( FEN_START , &board );
+    for ( u32 i = 0; success && i < min ( ( *state ).ply , CCE_GAME_MAX_PLY ); ++i )
+    {
+        success = pgn_write_move ( &writer , &board , &( *state ).attacks , ( *state ).history[ i ] );
+        board_move ( &board , ( *state ).history[ i ] , &( *state ).attacks );
+    }
+    success = success && pgn_write_end ( &writer , result );
+    file_close ( &file );
+
+    if ( !success )
+    {
+        LOGWARN ( "cce_write_pgn: Failed to write the game record to '"CCE_PGN_FILEPATH"'." );
+    }
+    return success;
+}
+
 void
 cce_log_board
 ( void )
@@ -1626,6 +1902,47 @@ cce_debug
                     , &( *state ).move_search_args
                     );
 
+    // Evaluation benchmark. Timing does not depend on the weights, so a
+    // randomly initialized network is used if none was loaded.
+    nnue_t* nnue = ( *state ).nnue;
+    if ( !nnue )
+    {
+        nnue = memory_allocate ( sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+        for ( u64 i = 0; i < sizeof ( ( *nnue ).ft_weights ) / sizeof ( ( *nnue ).ft_weights[ 0 ] ); ++i )
+        {
+            ( *nnue ).ft_weights[ i ] = random2 ( -16 , 16 );
+        }
+        for ( u64 i = 0; i < sizeof ( ( *nnue ).l1_weights ); ++i )
+        {
+            ( *nnue ).l1_weights[ i ] = random2 ( -64 , 64 );
+        }
+        for ( u64 i = 0; i < sizeof ( ( *nnue ).l2_weights ); ++i )
+        {
+            ( *nnue ).l2_weights[ i ] = random2 ( -64 , 64 );
+        }
+        for ( u64 i = 0; i < sizeof ( ( *nnue ).out_weights ); ++i )
+        {
+            ( *nnue ).out_weights[ i ] = random2 ( -64 , 64 );
+        }
+    }
+    bench_evaluate ( &( *state ).attacks
+                   , nnue
+                   , CCE_BENCH_EVALUATE_ITERATIONS
+                   );
+    if ( nnue != ( *state ).nnue )
+    {
+        memory_free ( nnue , sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+    }
+
+    // Move generation and search benchmarks.
+    bench_movegen ( &( *state ).attacks
+                  , CCE_BENCH_MOVEGEN_ITERATIONS
+                  );
+    bench_search ( &( *state ).attacks
+                 , CCE_BENCH_SEARCH_DEPTH
+                 , &( *state ).move_search_args
+                 );
+
     LOGDEBUG ( "cce_debug: Done. Exiting." );
 
     ( *state ).end = CCE_GAME_END_TAG_COUNT;
@@ -37,13 +37,6 @@ attack_mask_with_occupancy
     return mask;
 }
 
-/**
- * @brief For pregenerating attack tables. Generates every attack option for a
- * single pawn.
- * @param square The pawn's position.
- * @return A bitboard with the pawn's attack options set.
- */
-INLINE
 bitboard_t
 attack_mask_pawn
 (   const SIDE      side
@@ -82,13 +75,6 @@ attack_mask_pawn
     return mask;
 }
 
-/**
- * @brief For pregenerating attack tables. Generates every attack option for a
- * single knight.
- * @param square The knight's position.
- * @return A bitboard with the knight's attack options set.
- */
-INLINE
 bitboard_t
 attack_mask_knight
 (   const SQUARE square
@@ -136,13 +122,6 @@ attack_mask_knight
     return mask;
 }
 
-/**
- * @brief For pregenerating attack tables. Generates every attack option for a
- * single bishop.
- * @param square The bishop's position.
- * @return A bitboard with the bishop's attack options set.
- */
-INLINE
 bitboard_t
 attack_mask_bishop
 (   const SQUARE square
@@ -177,14 +156,6 @@ attack_mask_bishop
     return mask;
 }
 
-/**
- * @brief Variation of attack_mask_bishop which accepts a block mask parameter.
- * @param square The bishop's position.
- * @param block A mask to optionally block the bishop in the specified
- * direction(s).
- * @return A bitboard with the bishop's attack options set.
- */
-INLINE
 bitboard_t
 attack_mask_bishop_with_block
 (   const SQUARE        square
@@ -236,13 +207,6 @@ attack_mask_bishop_with_block
     return mask;
 }
 
-/**
- * @brief For pregenerating attack tables. Generates every attack option for a
- * single rook.
- * @param square The rook's position.
- * @return A bitboard with the rook's attack options set.
- */
-INLINE
 bitboard_t
 attack_mask_rook
 (   const SQUARE square
@@ -277,15 +241,6 @@ attack_mask_rook
     return mask;
 }
 
-/**
- * @brief Variation of attack_mask_rook which accepts a block mask
- * parameter.
- * @param square The rook's position.
- * @param block A mask to optionally block the rook in the specified
- * direction(s).
- * @return A bitboard with the rook's attack options set.
- */
-INLINE
 bitboard_t
 attack_mask_rook_with_block
 (   const SQUARE        square
@@ -337,13 +292,6 @@ attack_mask_rook_with_block
     return mask;
 }
 
-/**
- * @brief For pregenerating attack tables. Generates the attack options for a
- * single king.
- * @param square The king's position.
- * @return A bitboard with the king's attack options set.
- */
-INLINE
 bitboard_t
 attack_mask_king
 (   const SQUARE square
@@ -419,10 +367,12 @@ attacks_init
                                                                     , attack
                                                                     , attack_relevant_count
                                                                     );
-            const u16 k = ( occupancy * bitboard_magic_bishops [ i ] ) >> ( 64 - bishop_attack_relevant_counts[ i ] );
-            ( *attacks ).bishop[ i ][ k ] = attack_mask_bishop_with_block ( i
-                                                                          , occupancy
-                                                                          );
+            const u64 k = bishop_attack_offsets[ i ]
+                        + ( ( ( occupancy | ~attack ) * bitboard_magic_bishops[ i ] ) >> bishop_attack_shifts[ i ] )
+                        ;
+            ( *attacks ).sliders[ k ] = attack_mask_bishop_with_block ( i
+                                                                      , occupancy
+                                                                      );
         }
 
         // Rook.
@@ -436,10 +386,12 @@ attacks_init
                                                                     , attack
                                                                     , attack_relevant_count
                                                                     );
-            const u16 k = ( occupancy * bitboard_magic_rooks[ i ] ) >> ( 64 - rook_attack_relevant_counts [ i ] );
-            ( *attacks ).rook[ i ][ k ] = attack_mask_rook_with_block ( i
-                                                                      , occupancy
-                                                                      );
+            const u64 k = rook_attack_offsets[ i ]
+                        + ( ( ( occupancy | ~attack ) * bitboard_magic_rooks[ i ] ) >> rook_attack_shifts[ i ] )
+                        ;
+            ( *attacks ).sliders[ k ] = attack_mask_rook_with_block ( i
+                                                                  , occupancy
+                                                                  );
         }
     }
 }
@@ -17,4 +17,88 @@ attacks_init
 (   attacks_t* attacks
 );
 
+/**
+ * @brief For pregenerating attack tables. Generates every attack option for a
+ * single pawn.
+ * @param side The pawn's side.
+ * @param square The pawn's position.
+ * @return A bitboard with the pawn's attack options set.
+ */
+bitboard_t
+attack_mask_pawn
+(   const SIDE      side
+,   const SQUARE    square
+);
+
+/**
+ * @brief For pregenerating attack tables. Generates every attack option for a
+ * single knight.
+ * @param square The knight's position.
+ * @return A bitboard with the knight's attack options set.
+ */
+bitboard_t
+attack_mask_knight
+(   const SQUARE square
+);
+
+/**
+ * @brief For pregenerating attack tables. Generates every attack option for a
+ * single bishop.
+ * @param square The bishop's position.
+ * @return A bitboard with the bishop's attack options set.
+ */
+bitboard_t
+attack_mask_bishop
+(   const SQUARE square
+);
+
+/**
+ * @brief Variation of attack_mask_bishop which accepts a block mask parameter.
+ * @param square The bishop's position.
+ * @param block A mask to optionally block the bishop in the specified
+ * direction(s).
+ * @return A bitboard with the bishop's attack options set.
+ */
+bitboard_t
+attack_mask_bishop_with_block
+(   const SQUARE        square
+,   const bitboard_t    block
+);
+
+/**
+ * @brief For pregenerating attack tables. Generates every attack option for a
+ * single rook.
+ * @param square The rook's position.
+ * @return A bitboard with the rook's attack options set.
+ */
+bitboard_t
+attack_mask_rook
+(   const SQUARE square
+);
+
+/**
+ * @brief Variation of attack_mask_rook which accepts a block mask
+ * parameter.
+ * @param square The rook's position.
+ * @param block A mask to optionally block the rook in the specified
+ * direction(s).
+ * @return A bitboard with the rook's attack options set.
+ */
+bitboard_t
+attack_mask_rook_with_block
+(   const SQUARE        square
+,   const bitboard_t    block
+);
+
+/**
+ * @brief For pregenerating attack tables. Generates the attack options for a
+ * single king.
+ * @param square The king's position.
+ * @return A bitboard with the king's attack options set.
+ */
+bitboard_t
+attack_mask_king
+(   const SQUARE square
+);
+
 #endif  // CHESS_ATTACK_H
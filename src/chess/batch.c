@@ -0,0 +1,266 @@
+/**
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @file batch.c
+ * @brief Implementation of the batch header.
+ * (see batch.h for additional details)
+ */
+// SIMD intrinsics pull in the C standard library headers, so they must be
+// included before the engine headers redefine some of its names.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "chess/batch.h"
+
+#include "chess/score.h"
+
+#include "core/memory.h"
+
+// Defines the alignment of each bitboard plane.
+#define BOARD_BATCH_ALIGNMENT 32
+
+/**
+ * @brief Computes the value of a piece on a square (material and position),
+ * from white's point of view (see score_board).
+ * @param piece The piece.
+ * @param square The square.
+ * @return The value.
+ */
+INLINE
+i32
+board_batch_value
+(   const PIECE     piece
+,   const SQUARE    square
+)
+{
+    i32 value = material_scores[ piece ];
+    switch ( piece )
+    {
+        case P: value += pawn_positional_scores[ square ]   ;break;
+        case N: value += knight_positional_scores[ square ] ;break;
+        case B: value += bishop_positional_scores[ square ] ;break;
+        case R: value += rook_positional_scores[ square ]   ;break;
+        case K: value += king_positional_scores[ square ]   ;break;
+
+        case p: value -= pawn_positional_scores[ mirror_position[ square ] ]   ;break;
+        case n: value -= knight_positional_scores[ mirror_position[ square ] ] ;break;
+        case b: value -= bishop_positional_scores[ mirror_position[ square ] ] ;break;
+        case r: value -= rook_positional_scores[ mirror_position[ square ] ]   ;break;
+        case k: value -= king_positional_scores[ mirror_position[ square ] ]   ;break;
+
+        default: break;
+    }
+    return value;
+}
+
+/**
+ * @brief Computes the number of set bits within a bitboard, without looping
+ * over them (see bitboard_count).
+ * @param bitboard A bitboard.
+ * @return The number of set bits within bitboard.
+ */
+INLINE
+u64
+board_batch_count
+(   bitboard_t bitboard
+)
+{
+    bitboard -= ( bitboard >> 1 ) & 0x5555555555555555ULL;
+    bitboard = ( bitboard & 0x3333333333333333ULL ) + ( ( bitboard >> 2 ) & 0x3333333333333333ULL );
+    bitboard = ( bitboard + ( bitboard >> 4 ) ) & 0x0F0F0F0F0F0F0F0FULL;
+    return ( bitboard * 0x0101010101010101ULL ) >> 56;
+}
+
+#if defined(__AVX2__)
+/**
+ * @brief Computes the number of set bits within each of four bitboards.
+ * @param bitboards Four bitboards.
+ * @return The number of set bits within each bitboard.
+ */
+INLINE
+__m256i
+board_batch_count_avx2
+(   const __m256i bitboards
+)
+{
+    // Look up the count of each nibble, then sum the bytes of each lane.
+    const __m256i lookup = _mm256_setr_epi8 ( 0 , 1 , 1 , 2 , 1 , 2 , 2 , 3 , 1 , 2 , 2 , 3 , 2 , 3 , 3 , 4
+                                            , 0 , 1 , 1 , 2 , 1 , 2 , 2 , 3 , 1 , 2 , 2 , 3 , 2 , 3 , 3 , 4
+                                            );
+    const __m256i low = _mm256_set1_epi8 ( 0x0F );
+    const __m256i counts = _mm256_add_epi8 ( _mm256_shuffle_epi8 ( lookup , _mm256_and_si256 ( bitboards , low ) )
+                                           , _mm256_shuffle_epi8 ( lookup , _mm256_and_si256 ( _mm256_srli_epi16 ( bitboards , 4 ) , low ) )
+                                           );
+    return _mm256_sad_epu8 ( counts , _mm256_setzero_si256 () );
+}
+#endif
+
+bool
+board_batch_create
+(   const u32       capacity
+,   board_batch_t*  batch
+)
+{
+    memory_clear ( batch , sizeof ( board_batch_t ) );
+    for ( PIECE piece = P; piece <= k; ++piece )
+    {
+        ( *batch ).pieces[ piece ] = memory_allocate_aligned ( capacity * sizeof ( bitboard_t )
+                                                             , BOARD_BATCH_ALIGNMENT
+                                                             , MEMORY_TAG_APPLICATION
+                                                             );
+        if ( !( *batch ).pieces[ piece ] )
+        {
+            return false;
+        }
+    }
+    ( *batch ).sides = memory_allocate ( capacity , MEMORY_TAG_APPLICATION );
+    if ( !( *batch ).sides )
+    {
+        return false;
+    }
+    ( *batch ).capacity = capacity;
+
+    // Bit-slice the piece-square tables.
+    for ( PIECE piece = P; piece <= k; ++piece )
+    {
+        i32 lo = board_batch_value ( piece , 0 );
+        i32 hi = lo;
+        for ( SQUARE square = 1; square < 64; ++square )
+        {
+            const i32 value = board_batch_value ( piece , square );
+            lo = ( value < lo ) ? value : lo;
+            hi = ( value > hi ) ? value : hi;
+        }
+        u8 bit_count = 0;
+        while ( bit_count < BOARD_BATCH_MAX_BITS && ( ( u64 )( hi - lo ) >> bit_count ) )
+        {
+            bit_count += 1;
+        }
+        ( *batch ).bases[ piece ] = lo;
+        ( *batch ).bit_counts[ piece ] = bit_count;
+        for ( SQUARE square = 0; square < 64; ++square )
+        {
+            const u32 remainder = board_batch_value ( piece , square ) - lo;
+            for ( u8 i = 0; i < bit_count; ++i )
+            {
+                if ( ( remainder >> i ) & 1 )
+                {
+                    BITSET ( ( *batch ).masks[ piece ][ i ] , square );
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void
+board_batch_destroy
+(   board_batch_t* batch
+)
+{
+    for ( PIECE piece = P; piece <= k; ++piece )
+    {
+        if ( ( *batch ).pieces[ piece ] )
+        {
+            memory_free_aligned ( ( *batch ).pieces[ piece ]
+                                , ( *batch ).capacity * sizeof ( bitboard_t )
+                                , BOARD_BATCH_ALIGNMENT
+                                , MEMORY_TAG_APPLICATION
+                                );
+        }
+    }
+    if ( ( *batch ).sides )
+    {
+        memory_free ( ( *batch ).sides , ( *batch ).capacity , MEMORY_TAG_APPLICATION );
+    }
+    memory_clear ( batch , sizeof ( board_batch_t ) );
+}
+
+bool
+board_batch_push
+(   board_batch_t*  batch
+,   const board_t*  board
+)
+{
+    if ( ( *batch ).count >= ( *batch ).capacity )
+    {
+        return false;
+    }
+    const u32 i = ( *batch ).count;
+    for ( PIECE piece = P; piece <= k; ++piece )
+    {
+        ( *batch ).pieces[ piece ][ i ] = ( *board ).pieces[ piece ];
+    }
+    ( *batch ).sides[ i ] = ( *board ).side;
+    ( *batch ).count += 1;
+    return true;
+}
+
+void
+board_batch_clear
+(   board_batch_t* batch
+)
+{
+    ( *batch ).count = 0;
+}
+
+void
+score_boards
+(   const board_batch_t*    batch
+,   i32*                    scores
+)
+{
+    u32 i = 0;
+
+#if defined(__AVX2__)
+    for ( ; i + BOARD_BATCH_WIDTH <= ( *batch ).count; i += BOARD_BATCH_WIDTH )
+    {
+        __m256i score = _mm256_setzero_si256 ();
+        for ( PIECE piece = P; piece <= k; ++piece )
+        {
+            const __m256i bitboards = _mm256_loadu_si256 ( ( const __m256i* )( ( *batch ).pieces[ piece ] + i ) );
+            score = _mm256_add_epi64 ( score
+                                     , _mm256_mul_epi32 ( board_batch_count_avx2 ( bitboards )
+                                                        , _mm256_set1_epi64x ( ( *batch ).bases[ piece ] )
+                                                        ));
+            for ( u8 j = 0; j < ( *batch ).bit_counts[ piece ]; ++j )
+            {
+                const __m256i masked = _mm256_and_si256 ( bitboards
+                                                        , _mm256_set1_epi64x ( ( *batch ).masks[ piece ][ j ] )
+                                                        );
+                score = _mm256_add_epi64 ( score
+                                         , _mm256_sll_epi64 ( board_batch_count_avx2 ( masked )
+                                                            , _mm_cvtsi32_si128 ( j )
+                                                            ));
+            }
+        }
+
+        i64 lanes[ BOARD_BATCH_WIDTH ];
+        _mm256_storeu_si256 ( ( __m256i* ) lanes , score );
+        for ( u32 j = 0; j < BOARD_BATCH_WIDTH; ++j )
+        {
+            scores[ i + j ] = ( ( *batch ).sides[ i + j ] == WHITE ) ? lanes[ j ] : -lanes[ j ];
+        }
+    }
+#endif
+
+    // Scalar kernel (and the boards left over by the vector kernel).
+    for ( ; i < ( *batch ).count; ++i )
+    {
+        i64 score = 0;
+        for ( PIECE piece = P; piece <= k; ++piece )
+        {
+            const bitboard_t bitboard = ( *batch ).pieces[ piece ][ i ];
+            if ( !bitboard )
+            {
+                continue;
+            }
+            score += ( i64 )( *batch ).bases[ piece ] * board_batch_count ( bitboard );
+            for ( u8 j = 0; j < ( *batch ).bit_counts[ piece ]; ++j )
+            {
+                score += board_batch_count ( bitboard & ( *batch ).masks[ piece ][ j ] ) << j;
+            }
+        }
+        scores[ i ] = ( ( *batch ).sides[ i ] == WHITE ) ? score : -score;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+/**
+ * @file batch.h
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Bulk evaluation of independent board states.
+ *
+ * A batch holds board states in structure-of-arrays layout: one plane of
+ * bitboards per piece, indexed by board, plus the side to move of each board.
+ * score_boards computes the same material and piece-square table score as
+ * score_board for every board of the batch at once.
+ *
+ * The piece-square tables are bit-sliced when the batch is created: the value
+ * of a piece on a square (material plus position) is split into a base value
+ * and the bits of the remainder, each bit stored as a mask of the squares
+ * where it is set. The score of a piece bitboard is then the base times its
+ * population count, plus each bit weight times the population count of the
+ * bitboard under that bit's mask. These are the same few operations for every
+ * board, so several boards are scored per instruction with AVX2.
+ */
+#ifndef CHESS_BATCH_H
+#define CHESS_BATCH_H
+
+#include "chess/common.h"
+
+// Defines the maximum number of bits per bit-sliced piece-square value.
+#define BOARD_BATCH_MAX_BITS 32
+
+// Defines the number of boards scored per kernel step.
+#define BOARD_BATCH_WIDTH 4
+
+// Type definition for a batch of board states.
+typedef struct
+{
+    u32         count;
+    u32         capacity;
+
+    // Board states.
+    bitboard_t* pieces[ 12 ];
+    u8*         sides;
+
+    // Bit-sliced piece-square tables.
+    i32         bases[ 12 ];
+    u8          bit_counts[ 12 ];
+    bitboard_t  masks[ 12 ][ BOARD_BATCH_MAX_BITS ];
+}
+board_batch_t;
+
+/**
+ * @brief Allocates an empty batch.
+ * @param capacity The maximum number of board states.
+ * @param batch Output buffer.
+ * @return true if batch allocated successfully, false otherwise.
+ */
+bool
+board_batch_create
+(   const u32       capacity
+,   board_batch_t*  batch
+);
+
+/**
+ * @brief Frees a batch.
+ * @param batch The batch.
+ */
+void
+board_batch_destroy
+(   board_batch_t* batch
+);
+
+/**
+ * @brief Appends a board state to a batch.
+ * @param batch The batch.
+ * @param board A chess board state.
+ * @return false if the batch is full, true otherwise.
+ */
+bool
+board_batch_push
+(   board_batch_t*  batch
+,   const board_t*  board
+);
+
+/**
+ * @brief Removes every board state from a batch.
+ * @param batch The batch.
+ */
+void
+board_batch_clear
+(   board_batch_t* batch
+);
+
+/**
+ * @brief Batch evaluation function. Computes score_board for every board
+ * state of a batch.
+ * @param batch The batch.
+ * @param scores Output buffer for one score per board state, relative to the
+ * side to move.
+ */
+void
+score_boards
+(   const board_batch_t*    batch
+,   i32*                    scores
+);
+
+#endif  // CHESS_BATCH_H
\ No newline at end of file
@@ -7,103 +7,70 @@
 #include "chess/best.h"
 
 #include "chess/board.h"
+#include "chess/score.h"
 
-// Defines a material score for each piece.
-static const i32 material_scores[] = { [ P ] = 100
-                                     , [ N ] = 300
-                                     , [ B ] = 350
-                                     , [ R ] = 500
-                                     , [ Q ] = 1000
-                                     , [ K ] = 10000
-                                     , [ p ] = -100
-                                     , [ n ] = -300
-                                     , [ b ] = -350
-                                     , [ r ] = -500
-                                     , [ q ] = -1000
-                                     , [ k ] = -10000
-                                     };
-
-// Defines a positional score table for each piece.
-static const i32 pawn_positional_scores[] = { 90 ,  90 ,  90 ,  90 ,  90 ,  90 ,  90 ,  90
-                                            , 30 ,  30 ,  30 ,  40 ,  40 ,  30 ,  30 ,  30
-                                            , 20 ,  20 ,  20 ,  30 ,  30 ,  30 ,  20 ,  20
-                                            , 10 ,  10 ,  10 ,  20 ,  20 ,  10 ,  10 ,  10
-                                            ,  5 ,   5 ,  10 ,  20 ,  20 ,   5 ,   5 ,   5
-                                            ,  0 ,   0 ,   0 ,   5 ,   5 ,   0 ,   0 ,   0
-                                            ,  0 ,   0 ,   0 , -10 , -10 ,   0 ,   0 ,   0
-                                            ,  0 ,   0 ,   0 ,   0 ,   0 ,   0 ,   0 ,   0
-                                            };
-static const i32 knight_positional_scores[] = { -5 ,   0 ,   0 ,   0 ,   0 ,   0 ,   0 ,  -5
-                                              , -5 ,   0 ,   0 ,  10 ,  10 ,   0 ,   0 ,  -5
-                                              , -5 ,   5 ,  20 ,  20 ,  20 ,  20 ,   5 ,  -5
-                                              , -5 ,  10 ,  20 ,  30 ,  30 ,  20 ,  10 ,  -5
-                                              , -5 ,  10 ,  20 ,  30 ,  30 ,  20 ,  10 ,  -5
-                                              , -5 ,   5 ,  20 ,  10 ,  10 ,  20 ,   5 ,  -5
-                                              , -5 ,   0 ,   0 ,   0 ,   0 ,   0 ,   0 ,  -5
-                                              , -5 , -10 ,   0 ,   0 ,   0 ,   0 , -10 ,  -5
-                                              };
-static const i32 bishop_positional_scores[] = {  0 ,   0 ,   0 ,   0 ,   0 ,   0 ,   0 ,   0
-                                              ,  0 ,   0 ,   0 ,   0 ,   0 ,   0 ,   0 ,   0
-                                              ,  0 ,   0 ,   0 ,  10 ,  10 ,   0 ,   0 ,   0
-                                              ,  0 ,   0 ,  10 ,  20 ,  20 ,  10 ,   0 ,   0
-                                              ,  0 ,   0 ,  10 ,  20 ,  20 ,  10 ,   0 ,   0
-                                              ,  0 ,  10 ,   0 ,   0 ,   0 ,   0 ,  10 ,   0
-                                              ,  0 ,  30 ,   0 ,   0 ,   0 ,   0 ,  30 ,   0
-                                              ,  0 ,   0 , -10 ,   0 ,   0 , -10 ,   0 ,   0
-                                              };
-static const i32 rook_positional_scores[] = { 50 ,  50 ,  50 ,  50 ,  50 ,  50 ,  50 ,  50
-                                            , 50 ,  50 ,  50 ,  50 ,  50 ,  50 ,  50 ,  50
-                                            ,  0 ,   0 ,  10 ,  20 ,  20 ,  10 ,   0 ,   0
-                                            ,  0 ,   0 ,  10 ,  20 ,  20 ,  10 ,   0 ,   0
-                                            ,  0 ,   0 ,  10 ,  20 ,  20 ,  10 ,   0 ,   0
-                                            ,  0 ,   0 ,  10 ,  20 ,  20 ,  10 ,   0 ,   0
-                                            ,  0 ,   0 ,  10 ,  20 ,  20 ,  10 ,   0 ,   0
-                                            ,  0 ,   0 ,   0 ,  20 ,  20 ,   0 ,   0 ,   0
-                                            };
-static const i32 king_positional_scores[] = {  0 ,   0 ,   0 ,   0 ,   0 ,   0 ,   0 ,   0
-                                            ,  0 ,   0 ,   5 ,   5 ,   5 ,   5 ,   0 ,   0
-                                            ,  0 ,   5 ,   5 ,  10 ,  10 ,   5 ,   5 ,   0
-                                            ,  0 ,   5 ,  10 ,  20 ,  20 ,  10 ,   5 ,   0
-                                            ,  0 ,   5 ,  10 ,  20 ,  20 ,  10 ,   5 ,   0
-                                            ,  0 ,   0 ,   5 ,  10 ,  10 ,   5 ,   0 ,   0
-                                            ,  0 ,   5 ,   5 ,  -5 ,  -5 ,   0 ,   5 ,   0
-                                            ,  0 ,   0 ,   5 ,   0 , -15 ,   0 ,  10 ,   0
-                                            };
-
-// Defines the mirror score table indices for calculating the opposite side's
-// score.
-static const SQUARE mirror_position[ 128 ] = { A1 , B1 , C1 , D1 , E1 , F1 , G1 , H1
-	                                         , A2 , B2 , C2 , D2 , E2 , F2 , G2 , H2
-	   	                                     , A3 , B3 , C3 , D3 , E3 , F3 , G3 , H3
-	                                         , A4 , B4 , C4 , D4 , E4 , F4 , G4 , H4
-	                                         , A5 , B5 , C5 , D5 , E5 , F5 , G5 , H5
-	                                         , A6 , B6 , C6 , D6 , E6 , F6 , G6 , H6
-	                                         , A7 , B7 , C7 , D7 , E7 , F7 , G7 , H7
-	                                         , A8 , B8 , C8 , D8 , E8 , F8 , G8 , H8
-	                                         };
-
-// Defines most-valuable victim versus least-valuable attacker table.
-static const i32 mvv_lva[ 12 ][ 12 ] = { { 105 , 205 , 305 , 405 , 505 , 605 ,   105 , 205 , 305 , 405 , 505 , 605 }
-	                                   , { 104 , 204 , 304 , 404 , 504 , 604 ,   104 , 204 , 304 , 404 , 504 , 604 }
-	                                   , { 103 , 203 , 303 , 403 , 503 , 603 ,   103 , 203 , 303 , 403 , 503 , 603 }
-	                                   , { 102 , 202 , 302 , 402 , 502 , 602 ,   102 , 202 , 302 , 402 , 502 , 602 }
-	                                   , { 101 , 201 , 301 , 401 , 501 , 601 ,   101 , 201 , 301 , 401 , 501 , 601 }
-	                                   , { 100 , 200 , 300 , 400 , 500 , 600 ,   100 , 200 , 300 , 400 , 500 , 600 }
-
-	                                   , { 105 , 205 , 305 , 405 , 505 , 605 ,   105 , 205 , 305 , 405 , 505 , 605 }
-	                                   , { 104 , 204 , 304 , 404 , 504 , 604 ,   104 , 204 , 304 , 404 , 504 , 604 }
-	                                   , { 103 , 203 , 303 , 403 , 503 , 603 ,   103 , 203 , 303 , 403 , 503 , 603 }
-	                                   , { 102 , 202 , 302 , 402 , 502 , 602 ,   102 , 202 , 302 , 402 , 502 , 602 }
-	                                   , { 101 , 201 , 301 , 401 , 501 , 601 ,   101 , 201 , 301 , 401 , 501 , 601 }
-	                                   , { 100 , 200 , 300 , 400 , 500 , 600 ,   100 , 200 , 300 , 400 , 500 , 600 }
-	                                   };
-
-// Late move reduction parameters. 
-static const u32 lmr_full_depth_moves = 4;
-static const u32 lmr_reduction_limit = 3;
+// Bitbase score bound. A known win scores at least this much (less the ply),
+// which is below any forced mate found by the search but above any static
+// evaluation, so that the search prefers converting into a won ending but
+// still finds the mate once it is within the horizon.
+static const i32 bitbase_win_score = 20000;
 
 /**
- * @brief Negamax search.
+ * @brief Updates the progress of a search result (nodes, selective depth and
+ * elapsed time), and reports it to the observer, if any.
+ * @param args Static function arguments.
+ * @param iteration Reported after a completed iteration? Y/N
+ */
+void
+move_search_report
+(   move_search_t*  args
+,   const bool      iteration
+);
+
+/**
+ * @brief Tests if a search has been interrupted (see move_search_t). Called
+ * before a node is counted, so that a node limited search counts exactly
+ * node_limit nodes. Reads the clock once every MOVE_SEARCH_CLOCK_INTERVAL
+ * nodes if the search is time limited.
+ * @param args Static function arguments.
+ * @return true if the current iteration should be abandoned, false otherwise.
+ */
+INLINE
+bool
+move_search_stopped
+(   move_search_t*  args
+)
+{
+    // The first iteration always completes.
+    if ( ( *args ).depth < 2 )
+    {
+        return false;
+    }
+    if ( ( *args ).observer_interval && ( *args ).leaf_count >= ( *args ).observer_next )
+    {
+        ( *args ).observer_next += ( *args ).observer_interval;
+        move_search_report ( args , false );
+    }
+    if ( ( *args ).node_limit && ( *args ).leaf_count >= ( *args ).node_limit )
+    {
+        ( *args ).stop = true;
+    }
+    if (    ( *args ).time_limit
+         && !( ( *args ).leaf_count & ( MOVE_SEARCH_CLOCK_INTERVAL - 1 ) )
+       )
+    {
+        clock_update ( &( *args ).clock );
+        if ( ( *args ).clock.elapsed >= ( *args ).time_limit )
+        {
+            ( *args ).stop = true;
+        }
+    }
+    return ( *args ).stop;
+}
+
+/**
+ * @brief Negamax search of a principal variation node (open window). Must be
+ * used for any call whose window may be wider than a null window.
  * @param alpha Alpha negamax cutoff.
  * @param beta Beta negamax cutoff.
  * @param depth Current recursion depth.
@@ -111,7 +78,25 @@ static const u32 lmr_reduction_limit = 3;
  * @return Current negamax score.
  */
 i32
-negamax
+negamax_pv
+(   i32             alpha
+,   i32             beta
+,   u32             depth
+,   move_search_t*  args
+);
+
+/**
+ * @brief Negamax search of a non-principal variation node (null window,
+ * beta = alpha + 1). Such a node can only fail high or fail low, so it never
+ * re-searches, follows the principal variation, or updates the PV table.
+ * @param alpha Alpha negamax cutoff.
+ * @param beta Beta negamax cutoff (alpha + 1).
+ * @param depth Current recursion depth.
+ * @param args Static function arguments.
+ * @return Current negamax score.
+ */
+i32
+negamax_nonpv
 (   i32             alpha
 ,   i32             beta
 ,   u32             depth
@@ -133,13 +118,14 @@ quiescence
 );
 
 /**
- * @brief Board state evaluation function.
- * @param board A chess board state.
- * @return A score corresponding to the board state.
+ * @brief Evaluates the current board state of a search, using the network if
+ * one is loaded and score_board otherwise.
+ * @param args Static function arguments.
+ * @return A score corresponding to the current board state.
  */
 i32
-score_board
-(   const board_t* board
+evaluate
+(   move_search_t*  args
 );
 
 /**
@@ -157,30 +143,31 @@ score_move
 /**
  * @brief Sorts a move list by move score.
  * @param moves A pregenerated list of valid moves.
+ * @param count Number of moves.
  * @param args Static function arguments.
  * @return moves.
  */
-moves_t*
+move_t*
 moves_sort_by_score
-(   moves_t*        moves
+(   move_t*         moves
+,   const u32       count
 ,   move_search_t*  args
 );
 
 /**
  * @brief Enables scoring of the principal variation moves.
  * @param moves A pregenerated list of valid moves.
+ * @param count Number of moves.
  * @param args Static function arguments.
  * @return moves.
  */
-moves_t*
+move_t*
 moves_enable_pv_scoring
-(   moves_t*        moves
+(   move_t*         moves
+,   const u32       count
 ,   move_search_t*  args
 );
 
-// #include "chess/string.h"   // Temporary.
-// char s[1024];               // Temporary.
-
 move_t
 board_best_move
 (   const board_t*      board
@@ -201,35 +188,179 @@ board_best_move
     ( *args ).ply = 0;
     ( *args ).leaf_count = 0;
     ( *args ).move_count = 0;
+    ( *args ).seldepth = 0;
+    ( *args ).depth = 0;
+    ( *args ).score = 0;
+    ( *args ).move_stack_top = ( *args ).move_stack;
+    ( *args ).bitbase_enabled = ( *args ).bitbases
+                             && bitbase_probe ( ( *args ).bitbases , board ) == BITBASE_UNKNOWN
+                             ;
+    ( *args ).observer_next = ( *args ).observer_interval;
+    memory_clear ( &( *args ).result , sizeof ( move_search_result_t ) );
+    if ( ( *args ).params )
+    {
+        memory_copy ( ( *args ).param , ( *( *args ).params ).values , sizeof ( ( *args ).param ) );
+    }
+    else
+    {
+        search_params_t params;
+        search_params_default ( &params );
+        memory_copy ( ( *args ).param , params.values , sizeof ( ( *args ).param ) );
+    }
+    clock_start ( &( *args ).clock );
+    if ( ( *args ).nnue )
+    {
+        nnue_accumulator_refresh ( &( *args ).accumulators[ 0 ] , board , WHITE , ( *args ).nnue );
+        nnue_accumulator_refresh ( &( *args ).accumulators[ 0 ] , board , BLACK , ( *args ).nnue );
+    }
 
-    // Perform search with iterative deepening.
+    // Perform search with iterative deepening. After the first iteration,
+    // each iteration searches a window around the previous score first (if
+    // enabled), and only re-searches with a full window if the score falls
+    // outside of it.
+    const i32 window = ( *args ).param[ SEARCH_PARAM_ASPIRATION_WINDOW ];
+    move_search_result_t* result = &( *args ).result;
     for ( u32 i = 1; i <= depth; ++i )
     {
+        ( *args ).depth = i;
         ( *args ).pv_follow = true;
-        negamax ( -50000 , 50000 , i , args );
-        // LOGDEBUG ( "BEST MOVE (%u): %s, CURRENT NODE COUNT: %u"
-        //          , i
-        //          , string_move ( s , ( *args ).pv[ 0 ][ 0 ] )
-        //          , ( *args ).leaf_count
-        //          );
+        i32 score;
+        if ( window && i > 1 )
+        {
+            const i32 alpha = ( *args ).score - window;
+            const i32 beta = ( *args ).score + window;
+            score = negamax_pv ( alpha , beta , i , args );
+            if ( ( score <= alpha || score >= beta ) && !( *args ).stop )
+            {
+                ( *args ).pv_follow = true;
+                score = negamax_pv ( -50000 , 50000 , i , args );
+            }
+        }
+        else
+        {
+            score = negamax_pv ( -50000 , 50000 , i , args );
+        }
+
+        // Discard the iteration if it was interrupted.
+        if ( i > 1 && ( *args ).stop )
+        {
+            break;
+        }
+        ( *args ).score = score;
+
+        // Record the result of the iteration. The principal variation is
+        // replayed from the root to recover the full moves.
+        board_t pv_board;
+        memory_copy ( &pv_board , board , sizeof ( board_t ) );
+        ( *result ).pv_length = 0;
+        for ( u32 j = 0; j < ( *args ).pv_len[ 0 ]; ++j )
+        {
+            const move_t move = move_expand ( ( *args ).pv[ 0 ][ j ] , &pv_board );
+            if ( !move )
+            {
+                break;
+            }
+            ( *result ).pv[ ( *result ).pv_length++ ] = move;
+            board_move ( &pv_board , move , attacks );
+        }
+        ( *result ).best = move_expand ( ( *args ).pv[ 0 ][ 0 ] , board );
+        ( *result ).score = score;
+        ( *result ).forced_mate = score > MOVE_SEARCH_MATE_SCORE - MOVE_SEARCH_MAX_PLY
+                               || score < -MOVE_SEARCH_MATE_SCORE + MOVE_SEARCH_MAX_PLY
+                               ;
+        ( *result ).mate = ( !( *result ).forced_mate ) ? 0
+                         : ( score > 0 )                ?  ( MOVE_SEARCH_MATE_SCORE - score + 1 ) / 2
+                         :                                -( MOVE_SEARCH_MATE_SCORE + score ) / 2
+                         ;
+        ( *result ).depth = i;
+        move_search_report ( args , true );
+        if ( ( *args ).stop )
+        {
+            break;
+        }
     }
+    ( *result ).nodes = ( *args ).leaf_count;
+    ( *result ).seldepth = ( *args ).seldepth;
+    clock_update ( &( *args ).clock );
+    ( *result ).elapsed = ( *args ).clock.elapsed;
 
     // Best move.
-    return ( *args ).pv[ 0 ][ 0 ];
+    return ( *result ).best;
 }
 
+void
+move_search_report
+(   move_search_t*  args
+,   const bool      iteration
+)
+{
+    move_search_result_t* result = &( *args ).result;
+    ( *result ).nodes = ( *args ).leaf_count;
+    ( *result ).seldepth = ( *args ).seldepth;
+    clock_update ( &( *args ).clock );
+    ( *result ).elapsed = ( *args ).clock.elapsed;
+    ( *result ).iteration = iteration;
+    if ( ( *args ).observer )
+    {
+        ( *args ).observer ( result , ( *args ).observer_args );
+    }
+}
+
+/**
+ * @brief Negamax search. Each call site passes pv as a constant, so the
+ * compiler emits separate PV and non-PV node implementations (negamax_pv,
+ * negamax_nonpv) with no node type branches.
+ * @param alpha Alpha negamax cutoff.
+ * @param beta Beta negamax cutoff.
+ * @param depth Current recursion depth.
+ * @param args Static function arguments.
+ * @param pv Principal variation node? Y/N (a compile-time constant).
+ * @return Current negamax score.
+ */
+FORCEINLINE
 i32
 negamax
 (   i32             alpha
 ,   i32             beta
 ,   u32             depth
 ,   move_search_t*  args
+,   const bool      pv
 )
 {
     // Initialize PV table.
     bool pv_found = false;
     ( *args ).pv_len[ ( *args ).ply ] = ( *args ).ply;
 
+    // Probe the endgame bitbases (except at the root, which must return a
+    // move, and except in check, where the search must find the checkmate).
+    // A draw is exact; a win or a loss only bounds the score, so that the
+    // search below still finds the mate.
+    if ( ( *args ).bitbase_enabled && ( *args ).ply )
+    {
+        const BITBASE_RESULT result = bitbase_probe ( ( *args ).bitbases , &( *args ).board );
+        if (    ( result == BITBASE_DRAW || result == BITBASE_WIN || result == BITBASE_LOSS )
+             && !board_check ( &( *args ).board , ( *args ).attacks , ( *args ).board.side )
+           )
+        {
+            if ( result == BITBASE_DRAW )
+            {
+                return 0;
+            }
+            if ( result == BITBASE_WIN )
+            {
+                alpha = max ( alpha , bitbase_win_score - ( i32 )( *args ).ply );
+            }
+            else
+            {
+                beta = min ( beta , -bitbase_win_score + ( i32 )( *args ).ply );
+            }
+            if ( alpha >= beta )
+            {
+                return ( result == BITBASE_WIN ) ? beta : alpha;
+            }
+        }
+    }
+
     // Base case.
     if ( !depth )
     {
@@ -240,9 +371,13 @@ negamax
     // move tables.
     if ( ( *args ).ply >= MOVE_SEARCH_MAX_PLY )
     {
-        return score_board ( &( *args ).board );
+        return evaluate ( args );
     }
 
+    if ( move_search_stopped ( args ) )
+    {
+        return 0;
+    }
     ( *args ).leaf_count += 1;
 
     // Check? Y/N
@@ -252,35 +387,38 @@ negamax
                                    );
     if ( check )
     {
-        depth += 1;
+        depth += ( *args ).param[ SEARCH_PARAM_CHECK_EXTENSION ];
     }
 
-    // Generate move options.
-    moves_t moves;
-    moves_compute ( &moves
-                  , &( *args ).board
-                  , ( *args ).attacks
-                  );
-    if ( ( *args ).pv_follow )
+    // Generate move options onto the move stack.
+    move_t* moves = ( *args ).move_stack_top;
+    const u32 count = moves_generate ( moves
+                                     , &( *args ).board
+                                     , ( *args ).attacks
+                                     );
+    ( *args ).move_stack_top = moves + count;
+    if ( pv && ( *args ).pv_follow )
     {
-        moves_enable_pv_scoring ( &moves , args );
+        moves_enable_pv_scoring ( moves , count , args );
     }
-    moves_sort_by_score ( &moves
+    moves_sort_by_score ( moves
+                        , count
                         , args
                         );
     
     // Iterate over move options.
     u32 moves_searched = 0;
-    for ( u32 i = 0; i < moves.count; ++i )
+    for ( u32 i = 0; i < count; ++i )
     {
         // Preserve board state.
-        board_t board_prev;
-        memory_copy ( &board_prev , &( *args ).board , sizeof ( board_t ) );
+        board_t* board_prev = &( *args ).board_stack[ ( *args ).ply ];
+        memory_copy ( board_prev , &( *args ).board , sizeof ( board_t ) );
         ( *args ).ply += 1;
+        ( *args ).seldepth = max ( ( *args ).seldepth , ( *args ).ply );
         
         // Perform next move.
         board_move ( &( *args ).board
-                   , moves.moves[ i ]
+                   , moves[ i ]
                    , ( *args ).attacks
                    );
 
@@ -291,62 +429,71 @@ negamax
                          ))
         {
             // Restore board state.
-            memory_copy ( &( *args ).board , &board_prev , sizeof ( board_t ) );
+            memory_copy ( &( *args ).board , board_prev , sizeof ( board_t ) );
             ( *args ).ply -= 1;
             continue;
         }
         ( *args ).move_count += 1;
+        if ( ( *args ).nnue )
+        {
+            nnue_accumulator_update ( &( *args ).accumulators[ ( *args ).ply ]
+                                    , &( *args ).accumulators[ ( *args ).ply - 1 ]
+                                    , board_prev
+                                    , &( *args ).board
+                                    , ( *args ).nnue
+                                    );
+        }
 
         // Score the move.
         i32 score;
-        if ( pv_found )
+        if ( pv && pv_found )
         {
             // Principal variation search.
-            score = -negamax ( -alpha - 1 , -alpha , depth - 1 , args );
+            score = -negamax_nonpv ( -alpha - 1 , -alpha , depth - 1 , args );
             if ( ( score > alpha ) && ( score < beta ) ) // Rescore needed? Y/N
             {
                 // Regular search.
-                score = -negamax ( -beta , -alpha , depth - 1 , args );
+                score = -negamax_pv ( -beta , -alpha , depth - 1 , args );
             }
         }
-        else
+        else if ( !moves_searched )
         {
-            if ( !moves_searched )
-            {   
-                // Regular search.
-                score = -negamax ( -beta , -alpha , depth - 1 , args );
+            // Regular search.
+            score = ( pv ) ? -negamax_pv ( -beta , -alpha , depth - 1 , args )
+                           : -negamax_nonpv ( -beta , -alpha , depth - 1 , args )
+                           ;
+        }
+        else 
+        {
+            // Apply late move reduction.
+            if (    moves_searched >= ( u32 )( *args ).param[ SEARCH_PARAM_LMR_FULL_DEPTH_MOVES ]
+                 && depth >= ( u32 )( *args ).param[ SEARCH_PARAM_LMR_REDUCTION_LIMIT ]
+                 && !check
+                 && !move_decode_capture ( moves[ i ] )
+                 && !move_decode_promotion ( moves[ i ] )
+               )
+            {
+                const u32 reduction = min ( ( u32 )( *args ).param[ SEARCH_PARAM_LMR_REDUCTION ] , depth - 1 );
+                score = -negamax_nonpv ( -alpha - 1 , -alpha , depth - 1 - reduction , args );
             }
-            else 
+            else
             {
-                // Apply late move reduction.
-                if (    moves_searched >= lmr_full_depth_moves
-                     && depth >= lmr_reduction_limit
-                     && !check
-                     && !move_decode_capture ( moves.moves[ i ] )
-                     && !move_decode_promotion ( moves.moves[ i ] )
-                   )
-                {
-                    score = -negamax ( -alpha - 1 , -alpha , depth - 2 , args );
-                }
-                else
-                {
-                    score = alpha + 1;
-                }
+                score = alpha + 1;
+            }
 
-                // LMR found a better move? Y/N
-                if ( score > alpha )
+            // LMR found a better move? Y/N
+            if ( score > alpha )
+            {
+                score = -negamax_nonpv ( -alpha - 1 , -alpha , depth - 1 , args );
+                if ( pv && ( score > alpha ) && ( score < beta ) ) // Rescore needed? Y/N
                 {
-                    score = -negamax ( -alpha - 1 , -alpha , depth - 1 , args );
-                    if ( ( score > alpha ) && ( score < beta ) ) // Rescore needed? Y/N
-                    {
-                        score = -negamax ( -beta , -alpha , depth - 1 , args );
-                    }
+                    score = -negamax_pv ( -beta , -alpha , depth - 1 , args );
                 }
             }
         }
 
         // Restore board state.
-        memory_copy ( &( *args ).board , &board_prev , sizeof ( board_t ) );
+        memory_copy ( &( *args ).board , board_prev , sizeof ( board_t ) );
         ( *args ).ply -= 1;
 
         moves_searched += 1;
@@ -355,29 +502,30 @@ negamax
         if ( score >= beta )
         {
             // If move is quiet, update killer move table.
-            if ( !move_decode_capture ( moves.moves[ i ] ) )
+            if ( !move_decode_capture ( moves[ i ] ) )
             {
                 ( *args ).killer_moves[ 1 ][ ( *args ).ply ] = ( *args ).killer_moves[ 0 ][ ( *args ).ply ];
-                ( *args ).killer_moves[ 0 ][ ( *args ).ply ] = moves.moves[ i ];
+                ( *args ).killer_moves[ 0 ][ ( *args ).ply ] = move_compact ( moves[ i ] );
             }
             
+            ( *args ).move_stack_top = moves;
             return beta;
         }
 
-        // Alpha cutoff - new best move.
-        if ( score > alpha )
+        // Alpha cutoff - new best move (only possible with an open window).
+        if ( pv && score > alpha )
         {
             // If move is quiet, update history move table.
-            if ( !move_decode_capture ( moves.moves[ i ] ) )
+            if ( !move_decode_capture ( moves[ i ] ) )
             {
-                ( *args ).history_moves[ move_decode_piece ( moves.moves[ i ] ) ][ move_decode_dst ( moves.moves[ i ] ) ] += depth;
+                ( *args ).history_moves[ move_decode_piece ( moves[ i ] ) ][ move_decode_dst ( moves[ i ] ) ] += depth;
             }
 
             alpha = score;
 
             // Update PV table.
             pv_found = true;
-            ( *args ).pv[ ( *args ).ply ][ ( *args ).ply ] = moves.moves[ i ];
+            ( *args ).pv[ ( *args ).ply ][ ( *args ).ply ] = move_compact ( moves[ i ] );
             for ( u32 j = ( *args ).ply + 1; j < ( *args ).pv_len[ ( *args ).ply + 1 ]; ++j )
             {
                 ( *args ).pv[ ( *args ).ply ][ j ] = ( *args ).pv[ ( *args ).ply + 1 ][ j ];
@@ -386,12 +534,15 @@ negamax
         }
     }// END for.
 
+    // Release the move stack slice.
+    ( *args ).move_stack_top = moves;
+
     // No legal moves.
-    if ( !( ( *args ).move_count ) )
+    if ( !moves_searched )
     {
         if ( check ) // Checkmate.
         {       
-            return -49000 + ( *args ).ply;
+            return -MOVE_SEARCH_MATE_SCORE + ( *args ).ply;
         }
         return 0;    // Stalemate.
     }
@@ -399,6 +550,28 @@ negamax
     return alpha;
 }
 
+i32
+negamax_pv
+(   i32             alpha
+,   i32             beta
+,   u32             depth
+,   move_search_t*  args
+)
+{
+    return negamax ( alpha , beta , depth , args , true );
+}
+
+i32
+negamax_nonpv
+(   i32             alpha
+,   i32             beta
+,   u32             depth
+,   move_search_t*  args
+)
+{
+    return negamax ( alpha , beta , depth , args , false );
+}
+
 i32
 quiescence
 (   i32             alpha
@@ -408,9 +581,20 @@ quiescence
 {
     i32 score;
 
+    if ( move_search_stopped ( args ) )
+    {
+        return 0;
+    }
     ( *args ).leaf_count += 1;
     
-    score = score_board ( &( *args ).board );
+    score = evaluate ( args );
+
+    // If search has gone too deep, stop recursing to prevent overflowing the
+    // move tables.
+    if ( ( *args ).ply >= MOVE_SEARCH_MAX_PLY )
+    {
+        return score;
+    }
 
     // Beta cutoff - no move found.
     if ( score >= beta )
@@ -424,31 +608,37 @@ quiescence
         alpha = score;
     }
 
-    // Generate move options.
-    moves_t moves;
-    moves_sort_by_score ( moves_compute ( &moves
-                                        , &( *args ).board
-                                        , ( *args ).attacks
-                                        )
+    // Generate move options onto the move stack, keeping only the captures.
+    move_t* moves = ( *args ).move_stack_top;
+    const u32 generated = moves_generate ( moves
+                                         , &( *args ).board
+                                         , ( *args ).attacks
+                                         );
+    u32 count = 0;
+    for ( u32 i = 0; i < generated; ++i )
+    {
+        if ( move_decode_capture ( moves[ i ] ) )
+        {
+            moves[ count++ ] = moves[ i ];
+        }
+    }
+    ( *args ).move_stack_top = moves + count;
+    moves_sort_by_score ( moves
+                        , count
                         , args
                         );
     
-    for ( u32 i = 0; i < moves.count; ++i )
+    for ( u32 i = 0; i < count; ++i )
     {
-        // Filter quiet moves.
-        if ( !move_decode_capture ( moves.moves[ i ] ) )
-        {
-            continue;
-        }
-
         // Preserve board state.
-        board_t board_prev;
-        memory_copy ( &board_prev , &( *args ).board , sizeof ( board_t ) );
+        board_t* board_prev = &( *args ).board_stack[ ( *args ).ply ];
+        memory_copy ( board_prev , &( *args ).board , sizeof ( board_t ) );
         ( *args ).ply += 1;
+        ( *args ).seldepth = max ( ( *args ).seldepth , ( *args ).ply );
         
         // Perform next capture.
         board_move ( &( *args ).board
-                   , moves.moves[ i ]
+                   , moves[ i ]
                    , ( *args ).attacks
                    );
 
@@ -459,22 +649,32 @@ quiescence
                          ))
         {
             // Restore board state.
-            memory_copy ( &( *args ).board , &board_prev , sizeof ( board_t ) );
+            memory_copy ( &( *args ).board , board_prev , sizeof ( board_t ) );
             ( *args ).ply -= 1;
             continue;
         }
         ( *args ).move_count += 1;
+        if ( ( *args ).nnue )
+        {
+            nnue_accumulator_update ( &( *args ).accumulators[ ( *args ).ply ]
+                                    , &( *args ).accumulators[ ( *args ).ply - 1 ]
+                                    , board_prev
+                                    , &( *args ).board
+                                    , ( *args ).nnue
+                                    );
+        }
 
         // Score the capture.
         score = -quiescence ( -beta , -alpha , args );
 
         // Restore board state.
-        memory_copy ( &( *args ).board , &board_prev , sizeof ( board_t ) );
+        memory_copy ( &( *args ).board , board_prev , sizeof ( board_t ) );
         ( *args ).ply -= 1;
 
         // Beta cutoff - no move found.
         if ( score >= beta )
         {
+            ( *args ).move_stack_top = moves;
             return beta;
         }
 
@@ -485,9 +685,27 @@ quiescence
         }
     }// END for.
 
+    // Release the move stack slice.
+    ( *args ).move_stack_top = moves;
+
     return alpha;
 }
 
+i32
+evaluate
+(   move_search_t*  args
+)
+{
+    if ( ( *args ).nnue )
+    {
+        return nnue_evaluate ( &( *args ).accumulators[ ( *args ).ply ]
+                             , ( *args ).board.side
+                             , ( *args ).nnue
+                             );
+    }
+    return score_board ( &( *args ).board );
+}
+
 i32
 score_board
 (   const board_t* board
@@ -537,26 +755,28 @@ score_move
 ,   move_search_t*  args
 )
 {
+    const move16_t compact = move_compact ( move );
+
     // PV scoring enabled? Y/N
     if ( ( *args ).pv_score )
     {
-        if ( ( *args ).pv[ 0 ][ ( *args ).ply ] == move )
+        if ( ( *args ).pv[ 0 ][ ( *args ).ply ] == compact )
         {
             ( *args ).pv_score = false;
-            return 20000;
+            return ( *args ).param[ SEARCH_PARAM_PV_BONUS ];
         }
     }
 
     // Quiet.
     if ( !move_decode_capture ( move ) )
     {
-        if ( ( *args ).killer_moves[ 0 ][ ( *args ).ply ] == move )
+        if ( ( *args ).killer_moves[ 0 ][ ( *args ).ply ] == compact )
         {
-            return 9000;
+            return ( *args ).param[ SEARCH_PARAM_KILLER_BONUS_1 ];
         }
-        if ( ( *args ).killer_moves[ 1 ][ ( *args ).ply ] == move )
+        if ( ( *args ).killer_moves[ 1 ][ ( *args ).ply ] == compact )
         {
-            return 8000;
+            return ( *args ).param[ SEARCH_PARAM_KILLER_BONUS_2 ];
         }
         return ( *args ).history_moves[ move_decode_piece ( move ) ][ move_decode_dst ( move ) ];
     }
@@ -575,12 +795,13 @@ score_move
             break;
         }
     }
-    return 10000 + mvv_lva[ move_decode_piece ( move ) ][ target ];
+    return ( *args ).param[ SEARCH_PARAM_CAPTURE_BONUS ] + mvv_lva[ move_decode_piece ( move ) ][ target ];
 }
 
-moves_t*
+move_t*
 moves_sort_by_score
-(   moves_t*        moves
+(   move_t*         moves
+,   const u32       count
 ,   move_search_t*  args
 )
 {
@@ -589,31 +810,32 @@ moves_sort_by_score
     move_t key;
 
     i = 0;
-    while ( i < ( *moves ).count )
+    while ( i < count )
     {
-        key = ( *moves ).moves[ i ];
+        key = moves[ i ];
         j = i;
-        while ( j && score_move ( ( *moves ).moves[ j - 1 ], args ) < score_move ( key , args ) )
+        while ( j && score_move ( moves[ j - 1 ], args ) < score_move ( key , args ) )
         {
-            ( *moves ).moves[ j ] = ( *moves ).moves[ j - 1 ];
+            moves[ j ] = moves[ j - 1 ];
             j -= 1;
         }
-        ( *moves ).moves[ j ] = key;
+        moves[ j ] = key;
         i += 1;
     }
     return moves;
 }
 
-moves_t*
+move_t*
 moves_enable_pv_scoring
-(   moves_t*        moves
+(   move_t*         moves
+,   const u32       count
 ,   move_search_t*  args
 )
 {
     ( *args ).pv_follow = false;
-    for ( u32 i = 0; i < ( *moves ).count; ++i )
+    for ( u32 i = 0; i < count; ++i )
     {
-        if ( ( *args ).pv[ 0 ][ ( *args ).ply ] != ( *moves ).moves[ i ] )
+        if ( ( *args ).pv[ 0 ][ ( *args ).ply ] != move_compact ( moves[ i ] ) )
         {
             continue;
         }
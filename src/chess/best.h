@@ -7,10 +7,50 @@
 #define CHESS_BEST_H
 
 #include "chess/common.h"
+#include "chess/bitbase.h"
+#include "chess/nnue.h"
+#include "chess/param.h"
+
+#include "core/clock.h"
 
 // Defines max ply depth for a move search.
 #define MOVE_SEARCH_MAX_PLY 64
 
+// Defines the capacity of the move stack (every ply along the current line
+// may hold a full move list).
+#define MOVE_SEARCH_MOVE_STACK_LENGTH ( ( MOVE_SEARCH_MAX_PLY + 1 ) * MOVES_BUFFER_LENGTH )
+
+// Defines the number of nodes searched between two reads of the clock, when
+// a search is time limited (a power of two).
+#define MOVE_SEARCH_CLOCK_INTERVAL 2048
+
+// Defines the score of a checkmate at the root. A forced mate found n plies
+// from the root scores MOVE_SEARCH_MATE_SCORE - n.
+#define MOVE_SEARCH_MATE_SCORE 49000
+
+// Type definition for the result of a search: the outcome of its last
+// completed iteration, and its progress so far.
+typedef struct
+{
+    move_t              best;                           // Best move.
+    i32                 score;                          // Relative to the side to move at the root.
+    i32                 mate;                           // Moves to mate (negative if mated); 0 if mated at the root.
+    bool                forced_mate;                    // Forced mate (for either side) found? Y/N
+    move_t              pv[ MOVE_SEARCH_MAX_PLY ];      // Principal variation.
+    u32                 pv_length;
+    u32                 depth;
+    u32                 seldepth;                       // Highest ply reached so far.
+    u64                 nodes;                          // Searched so far.
+    f64                 elapsed;                        // Seconds since the search began.
+    bool                iteration;                      // Reported after a completed iteration? Y/N
+}
+move_search_result_t;
+
+// Type definition for a search observer callback.
+typedef void ( *PFN_move_search_observer )( const move_search_result_t* result
+                                          , void*                       args
+                                          );
+
 // Type definition for a container to hold internal move search function
 // parameters.
 typedef struct
@@ -18,32 +58,95 @@ typedef struct
     // Pregenerated attack tables.
     const attacks_t*    attacks;
     
-    // Current ply, leaf count, move count.
+    // Current ply, leaf count, move count, highest ply reached.
     u32                 ply;
-    u32                 leaf_count;
+    u64                 leaf_count;
     u32                 move_count;
+    u32                 seldepth;
 
-    // Current board state.
+    // Current iteration depth, and the score of the last completed iteration
+    // (relative to the side to move at the root).
+    u32                 depth;
+    i32                 score;
+
+    // Current board state, and the board state preceding the move made at
+    // each ply (restored when the move is unmade).
     board_t             board;
+    board_t             board_stack[ MOVE_SEARCH_MAX_PLY ];
+
+    // Move stack. The moves generated at each ply are stored contiguously:
+    // a ply's slice begins where its parent's slice ends and is only as long
+    // as the number of moves generated, so the move lists along the current
+    // line stay dense in memory.
+    move_t              move_stack[ MOVE_SEARCH_MOVE_STACK_LENGTH ];
+    move_t*             move_stack_top;
 
-    // Move tables: killer, history.
-    move_t              killer_moves[ 2 ][ MOVE_SEARCH_MAX_PLY ];
+    // Move tables: killer, history. Killer moves are stored compact.
+    move16_t            killer_moves[ 2 ][ MOVE_SEARCH_MAX_PLY ];
     move_t              history_moves[ 12 ][ 64 ];
 
-    // Move tables: triangular principal variation.
-    move_t              pv[ MOVE_SEARCH_MAX_PLY ][ MOVE_SEARCH_MAX_PLY ];
+    // Move tables: triangular principal variation, stored compact (see
+    // move_expand).
+    move16_t            pv[ MOVE_SEARCH_MAX_PLY ][ MOVE_SEARCH_MAX_PLY ];
     u32                 pv_len[ MOVE_SEARCH_MAX_PLY ];
     bool                pv_follow;
     bool                pv_score;
+
+    // Neural network evaluation (optional). If set before the search begins,
+    // the network replaces score_board, and one accumulator is maintained
+    // per ply.
+    const nnue_t*       nnue;
+    nnue_accumulator_t  accumulators[ MOVE_SEARCH_MAX_PLY + 1 ];
+
+    // Search parameters (optional). If set before the search begins, they
+    // replace the defaults (see param.h). The values in effect are copied to
+    // param when the search begins.
+    const search_params_t*  params;
+    i32                     param[ SEARCH_PARAM_COUNT ];
+
+    // Endgame bitbases (optional). If set, and the root position is not
+    // covered by them, the positions the search converts into are bounded
+    // by lookup: a draw ends the line, and a win or a loss bounds its score
+    // (see negamax). bitbase_enabled is set when the search begins.
+    const bitbases_t*   bitbases;
+    bool                bitbase_enabled;
+
+    // Search interruption (optional). The search stops once stop is set,
+    // which may be done from another thread while it runs, once time_limit
+    // seconds have elapsed, or once node_limit nodes have been searched (each
+    // limit if nonzero). The caller clears stop before the search begins. An
+    // interrupted iteration is discarded, and the first iteration always
+    // completes, so there is always a move. The node limit is exact: once
+    // the first iteration completes, no node past the node_limit-th is
+    // searched, so a search limited by nodes alone is deterministic (see
+    // bench_nodes).
+    volatile bool       stop;
+    f64                 time_limit;
+    u64                 node_limit;
+    clock_t             clock;
+
+    // Observer (optional). If set, it is called on the search thread with
+    // the result so far and observer_args after each completed iteration,
+    // and, if observer_interval is nonzero, every observer_interval nodes
+    // once the first iteration completes (the best move, score and
+    // principal variation are then those of the last completed iteration).
+    PFN_move_search_observer    observer;
+    void*                       observer_args;
+    u64                         observer_interval;
+    u64                         observer_next;
+
+    // Result of the search, valid once board_best_move returns.
+    move_search_result_t        result;
 }
 move_search_t;
 
 /**
- * @brief Computes the best possible move given a board state. Requires
+ * @brief Computes the best possible move given a board state, by iterative
+ * deepening up to a maximum depth or until interrupted. Requires
  * pregenerated attack tables.
  * @param board A chess board state.
  * @param attacks The pregenerated attacks tables.
- * @param depth Number of moves ahead to peek.
+ * @param depth Maximum number of moves ahead to peek.
  * @param args Buffer to hold internal search function arguments.
  * @return The optimal move.
  */
@@ -55,4 +158,15 @@ board_best_move
 ,   move_search_t*      args
 );
 
+/**
+ * @brief Board state evaluation function (material and piece-square tables).
+ * @param board A chess board state.
+ * @return A score corresponding to the board state, relative to the side to
+ * move.
+ */
+i32
+score_board
+(   const board_t* board
+);
+
 #endif  // CHESS_BEST_H
\ No newline at end of file
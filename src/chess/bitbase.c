@@ -0,0 +1,322 @@
+/**
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @file bitbase.c
+ * @brief Implementation of the bitbase header.
+ * (see bitbase.h for additional details)
+ */
+#include "chess/bitbase.h"
+
+#include "chess/bitboard.h"
+#include "chess/board.h"
+
+#include "core/logger.h"
+#include "core/memory.h"
+#include "core/string.h"
+
+#include "platform/filesystem.h"
+
+// Bitbase file header length (magic, version, endgame, reserved).
+#define BITBASE_FILE_HEADER_LENGTH ( 4 * sizeof ( u32 ) )
+
+// Supported endgames.
+static const bitbase_endgame_t bitbase_endgames[ BITBASE_ENDGAME_COUNT ] =
+{   { "KQK"  , { Q }     , 1 }
+,   { "KRK"  , { R }     , 1 }
+,   { "KPK"  , { P }     , 1 }
+,   { "KQKR" , { Q , r } , 2 }
+,   { "KRKB" , { R , b } , 2 }
+,   { "KRKN" , { R , n } , 2 }
+,   { "KBNK" , { B , N } , 2 }
+};
+
+/**
+ * @brief Computes a material signature: the number of each non-king piece,
+ * 2 bits per piece.
+ * @param counts Number of pieces, indexed by piece.
+ * @return A material signature.
+ */
+INLINE
+u32
+bitbase_material
+(   const u8* counts
+)
+{
+    u32 material = 0;
+    for ( PIECE piece = P; piece <= k; ++piece )
+    {
+        if ( piece != K && piece != k )
+        {
+            material |= ( u32 ) counts[ piece ] << ( piece << 1 );
+        }
+    }
+    return material;
+}
+
+/**
+ * @brief Tests if an endgame contains pawns.
+ * @param endgame The endgame index.
+ * @return true if endgame contains pawns, false otherwise.
+ */
+INLINE
+bool
+bitbase_pawns
+(   const u32 endgame
+)
+{
+    for ( u32 i = 0; i < bitbase_endgames[ endgame ].piece_count; ++i )
+    {
+        if (    bitbase_endgames[ endgame ].pieces[ i ] == P
+             || bitbase_endgames[ endgame ].pieces[ i ] == p
+           )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Computes the number of squares the white king is folded onto.
+ * @param endgame The endgame index.
+ * @return 32 (files a-d) for pawn endgames, 16 (a1-d4) otherwise.
+ */
+INLINE
+u64
+bitbase_king_squares
+(   const u32 endgame
+)
+{
+    return ( bitbase_pawns ( endgame ) ) ? 32 : 16;
+}
+
+const bitbase_endgame_t*
+bitbase_endgame
+(   const u32 endgame
+)
+{
+    return &bitbase_endgames[ endgame ];
+}
+
+u64
+bitbase_size
+(   const u32 endgame
+)
+{
+    u64 size = 2 * bitbase_king_squares ( endgame ) * 64;
+    for ( u32 i = 0; i < bitbase_endgames[ endgame ].piece_count; ++i )
+    {
+        size *= 64;
+    }
+    return size;
+}
+
+i32
+bitbase_find
+(   const board_t*  board
+,   bool*           flip
+)
+{
+    u8 counts[ 12 ];
+    u8 counts_flipped[ 12 ];
+    for ( PIECE piece = P; piece <= k; ++piece )
+    {
+        counts[ piece ] = bitboard_count ( ( *board ).pieces[ piece ] );
+        counts_flipped[ ( piece + 6 ) % 12 ] = counts[ piece ];
+    }
+    const u32 material = bitbase_material ( counts );
+    const u32 material_flipped = bitbase_material ( counts_flipped );
+
+    for ( u32 i = 0; i < BITBASE_ENDGAME_COUNT; ++i )
+    {
+        memory_clear ( counts , sizeof ( counts ) );
+        for ( u32 j = 0; j < bitbase_endgames[ i ].piece_count; ++j )
+        {
+            counts[ bitbase_endgames[ i ].pieces[ j ] ] += 1;
+        }
+        const u32 endgame = bitbase_material ( counts );
+        if ( endgame == material )
+        {
+            *flip = false;
+            return i;
+        }
+        if ( endgame == material_flipped )
+        {
+            *flip = true;
+            return i;
+        }
+    }
+    return -1;
+}
+
+u64
+bitbase_index
+(   const u32       endgame
+,   const board_t*  board
+,   const bool      flip
+)
+{
+    // Gather squares (white king, black king, pieces), reversing colors if
+    // requested.
+    const u32 flip_square = ( flip ) ? 56 : 0;
+    const u32 flip_piece = ( flip ) ? 6 : 0;
+    SQUARE squares[ BITBASE_MAX_PIECES ];
+    squares[ 0 ] = bitboard_lsb ( ( *board ).pieces[ ( K + flip_piece ) % 12 ] ) ^ flip_square;
+    squares[ 1 ] = bitboard_lsb ( ( *board ).pieces[ ( k + flip_piece ) % 12 ] ) ^ flip_square;
+    const u32 count = bitbase_endgames[ endgame ].piece_count;
+    for ( u32 i = 0; i < count; ++i )
+    {
+        const PIECE piece = ( bitbase_endgames[ endgame ].pieces[ i ] + flip_piece ) % 12;
+        squares[ 2 + i ] = bitboard_lsb ( ( *board ).pieces[ piece ] ) ^ flip_square;
+    }
+    const SIDE side = ( flip ) ? !( *board ).side : ( *board ).side;
+
+    // Fold the white king onto files a-d, and for pawnless endgames onto
+    // ranks 1-4.
+    u32 fold = ( ( squares[ 0 ] & 7 ) >= 4 ) ? 7 : 0;
+    const bool pawns = bitbase_pawns ( endgame );
+    if ( !pawns && ( squares[ 0 ] >> 3 ) < 4 )
+    {
+        fold |= 56;
+    }
+    const SQUARE king = squares[ 0 ] ^ fold;
+    u64 index = side * bitbase_king_squares ( endgame )
+              + ( ( pawns ) ? ( king >> 3 ) : ( ( king >> 3 ) - 4 ) ) * 4
+              + ( king & 7 )
+              ;
+    for ( u32 i = 1; i < 2 + count; ++i )
+    {
+        index = index * 64 + ( squares[ i ] ^ fold );
+    }
+    return index;
+}
+
+bool
+bitbase_position
+(   const u32   endgame
+,   const u64   index
+,   board_t*    board
+)
+{
+    const u32 count = bitbase_endgames[ endgame ].piece_count;
+    const bool pawns = bitbase_pawns ( endgame );
+
+    // Decode squares.
+    SQUARE squares[ BITBASE_MAX_PIECES ];
+    u64 index_ = index;
+    for ( u32 i = 1 + count; i >= 1; --i )
+    {
+        squares[ i ] = index_ % 64;
+        index_ /= 64;
+    }
+    const u64 king = index_ % bitbase_king_squares ( endgame );
+    squares[ 0 ] = ( ( pawns ) ? ( king / 4 ) : ( king / 4 + 4 ) ) * 8 + king % 4;
+
+    memory_clear ( board , sizeof ( board_t ) );
+    ( *board ).side = index_ / bitbase_king_squares ( endgame );
+    ( *board ).enpassant = NO_SQ;
+    ( *board ).castle = 0;
+    ( *board ).capture = EMPTY_SQ;
+
+    // Place pieces.
+    for ( u32 i = 0; i < 2 + count; ++i )
+    {
+        if ( bit ( ( *board ).occupancies[ 2 ] , squares[ i ] ) )
+        {
+            return false;
+        }
+        const PIECE piece = ( i == 0 ) ? K
+                          : ( i == 1 ) ? k
+                          : bitbase_endgames[ endgame ].pieces[ i - 2 ]
+                          ;
+        if ( ( piece == P || piece == p ) && ( squares[ i ] < A7 || squares[ i ] > H2 ) )
+        {
+            return false;
+        }
+        BITSET ( ( *board ).pieces[ piece ] , squares[ i ] );
+        BITSET ( ( *board ).occupancies[ ( piece < p ) ? WHITE : BLACK ] , squares[ i ] );
+        BITSET ( ( *board ).occupancies[ 2 ] , squares[ i ] );
+    }
+    board_attacks_refresh ( board );
+    return true;
+}
+
+BITBASE_RESULT
+bitbase_probe
+(   const bitbases_t*   bitbases
+,   const board_t*      board
+)
+{
+    // Reject positions with too many pieces without counting them all.
+    bitboard_t occupancy = ( *board ).occupancies[ 2 ];
+    for ( u32 i = 0; i < BITBASE_MAX_PIECES && occupancy; ++i )
+    {
+        occupancy &= occupancy - 1;
+    }
+    if ( occupancy || ( *board ).castle )
+    {
+        return BITBASE_UNKNOWN;
+    }
+
+    bool flip;
+    const i32 endgame = bitbase_find ( board , &flip );
+    if ( endgame < 0 || !( *bitbases ).tables[ endgame ] )
+    {
+        return BITBASE_UNKNOWN;
+    }
+    return bitbase_read ( ( *bitbases ).tables[ endgame ]
+                        , bitbase_index ( endgame , board , flip )
+                        );
+}
+
+u32
+bitbases_load
+(   const char* directory
+,   bitbases_t* bitbases
+)
+{
+    memory_clear ( bitbases , sizeof ( bitbases_t ) );
+
+    u32 count = 0;
+    char filepath[ STACK_STRING_MAX_LENGTH ];
+    for ( u32 i = 0; i < BITBASE_ENDGAME_COUNT; ++i )
+    {
+        string_format ( filepath , "%s/%s" BITBASE_FILE_EXTENSION
+                      , directory , bitbase_endgames[ i ].name
+                      );
+        platform_file_mapping_t* mapping = &( *bitbases ).mappings[ i ];
+        if ( !file_exists ( filepath ) || !platform_file_map ( filepath , mapping ) )
+        {
+            continue;
+        }
+
+        const u32* header = ( *mapping ).memory;
+        if (    ( *mapping ).size != BITBASE_FILE_HEADER_LENGTH + ( bitbase_size ( i ) + 3 ) / 4
+             || header[ 0 ] != BITBASE_FILE_MAGIC
+             || header[ 1 ] != BITBASE_FILE_VERSION
+             || header[ 2 ] != i
+           )
+        {
+            LOGERROR ( "bitbases_load: '%s' is not a version %u %s bitbase."
+                     , filepath , BITBASE_FILE_VERSION , bitbase_endgames[ i ].name
+                     );
+            platform_file_unmap ( mapping );
+            continue;
+        }
+
+        ( *bitbases ).tables[ i ] = ( const u8* )( *mapping ).memory + BITBASE_FILE_HEADER_LENGTH;
+        count += 1;
+    }
+    return count;
+}
+
+void
+bitbases_unload
+(   bitbases_t* bitbases
+)
+{
+    for ( u32 i = 0; i < BITBASE_ENDGAME_COUNT; ++i )
+    {
+        platform_file_unmap ( &( *bitbases ).mappings[ i ] );
+        ( *bitbases ).tables[ i ] = 0;
+    }
+}
\ No newline at end of file
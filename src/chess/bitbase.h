@@ -0,0 +1,184 @@
+/**
+ * @file bitbase.h
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Endgame bitbases.
+ *
+ * A bitbase stores the win/draw/loss result of every position of a given
+ * material signature (e.g. KRK), from the perspective of the side to move,
+ * packed at 2 bits per position. The tables are generated offline by
+ * retrograde analysis (see tools/src/bitbase) and memory-mapped at runtime, so
+ * a probe costs one index computation and one byte load.
+ *
+ * Every table is stored with the stronger side as white; positions with the
+ * colors reversed are probed by flipping the board. The white king is further
+ * folded onto files a-d, and for pawnless tables onto ranks 1-4, which shrinks
+ * the tables by a factor of two (four for pawnless tables).
+ */
+#ifndef CHESS_BITBASE_H
+#define CHESS_BITBASE_H
+
+#include "chess/common.h"
+
+#include "platform/platform.h"
+
+// Defines the bitbase file header.
+#define BITBASE_FILE_MAGIC      0x42424343  // "CCBB"
+#define BITBASE_FILE_VERSION    1
+#define BITBASE_FILE_EXTENSION  ".bb"
+
+// Defines the maximum number of pieces (including kings) in a bitbase.
+#define BITBASE_MAX_PIECES      4
+
+// Defines the supported endgames. Each table may only depend on the tables
+// which precede it (captures and promotions lead into earlier tables).
+#define BITBASE_ENDGAME_COUNT   7
+
+// Type definition for a bitbase result, relative to the side to move.
+typedef enum
+{
+    BITBASE_DRAW
+,   BITBASE_WIN
+,   BITBASE_LOSS
+,   BITBASE_ILLEGAL     // The position is unreachable.
+
+,   BITBASE_UNKNOWN     // The position is not covered by any loaded bitbase.
+}
+BITBASE_RESULT;
+
+// Type definition for a bitbase endgame descriptor.
+typedef struct
+{
+    const char* name;
+
+    // The non-king pieces, with the stronger side as white.
+    PIECE       pieces[ BITBASE_MAX_PIECES - 2 ];
+    u32         piece_count;
+}
+bitbase_endgame_t;
+
+// Type definition for a container to hold the loaded bitbases.
+typedef struct
+{
+    // Packed results for each endgame (0 if not loaded).
+    const u8*               tables[ BITBASE_ENDGAME_COUNT ];
+    platform_file_mapping_t mappings[ BITBASE_ENDGAME_COUNT ];
+}
+bitbases_t;
+
+/**
+ * @brief Retrieves a bitbase endgame descriptor.
+ * @param endgame The endgame index.
+ * @return The endgame descriptor.
+ */
+const bitbase_endgame_t*
+bitbase_endgame
+(   const u32 endgame
+);
+
+/**
+ * @brief Computes the number of positions in a bitbase.
+ * @param endgame The endgame index.
+ * @return The number of positions (2 bits each when packed).
+ */
+u64
+bitbase_size
+(   const u32 endgame
+);
+
+/**
+ * @brief Finds the bitbase endgame matching the material on a board.
+ * @param board A chess board state.
+ * @param flip Output buffer. Set to true if the board must be probed with the
+ * colors reversed.
+ * @return The endgame index, or -1 if no endgame matches.
+ */
+i32
+bitbase_find
+(   const board_t*  board
+,   bool*           flip
+);
+
+/**
+ * @brief Computes the bitbase index of a board state. The material on the
+ * board must match the endgame.
+ * @param endgame The endgame index.
+ * @param board A chess board state.
+ * @param flip Probe with the colors reversed? Y/N
+ * @return The position index.
+ */
+u64
+bitbase_index
+(   const u32       endgame
+,   const board_t*  board
+,   const bool      flip
+);
+
+/**
+ * @brief Reconstructs the board state for a bitbase index. Does not test
+ * whether the side not to move is in check.
+ * @param endgame The endgame index.
+ * @param index The position index.
+ * @param board Output buffer.
+ * @return false if the index does not describe a valid placement of pieces,
+ * true otherwise.
+ */
+bool
+bitbase_position
+(   const u32   endgame
+,   const u64   index
+,   board_t*    board
+);
+
+/**
+ * @brief Reads a result from a packed bitbase.
+ * @param table The packed table.
+ * @param index The position index.
+ * @return The result.
+ */
+INLINE
+BITBASE_RESULT
+bitbase_read
+(   const u8*   table
+,   const u64   index
+)
+{
+    return ( table[ index >> 2 ] >> ( ( index & 3 ) << 1 ) ) & 3;
+}
+
+/**
+ * @brief Looks up the result of a board state in the loaded bitbases. Cheap
+ * enough to be called at every node of a search.
+ * @param bitbases The loaded bitbases.
+ * @param board A chess board state.
+ * @return The result relative to the side to move, or BITBASE_UNKNOWN if the
+ * position is not covered.
+ */
+BITBASE_RESULT
+bitbase_probe
+(   const bitbases_t*   bitbases
+,   const board_t*      board
+);
+
+/**
+ * @brief Memory-maps every bitbase file found in a directory. Missing files
+ * are skipped.
+ * @param directory The directory containing the bitbase files.
+ * @param bitbases Output buffer.
+ * @return The number of bitbases loaded.
+ */
+u32
+bitbases_load
+(   const char* directory
+,   bitbases_t* bitbases
+);
+
+/**
+ * @brief Unmaps all loaded bitbases.
+ * @param bitbases The loaded bitbases.
+ */
+void
+bitbases_unload
+(   bitbases_t* bitbases
+);
+
+#endif  // CHESS_BITBASE_H
\ No newline at end of file
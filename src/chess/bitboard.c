@@ -20,22 +20,5 @@ bitboard_attackable
         return 0;
     }
 
-    bitboard_t attackable = 0;
-
-    for ( u8 r = 0; r < 8; ++r )
-    {
-        for ( u8 f = 0; f < 8; ++f )
-        {
-            if ( board_square_attackable ( board
-                                         , attacks
-                                         , SQUAREINDX ( r , f )
-                                         , side
-                                         ))
-            {
-                BITSET ( attackable , SQUAREINDX ( r , f ) );
-            }
-        }
-    }
-
-    return attackable;
+    return ( *board ).attacked[ side ];
 }
@@ -14,6 +14,10 @@
 #define BITBOARD_MASK_FILE_H    ( ( bitboard_t ) 9187201950435737471ULL )
 #define BITBOARD_MASK_FILE_AB   ( ( bitboard_t ) 18229723555195321596ULL )
 #define BITBOARD_MASK_FILE_HG   ( ( bitboard_t ) 4557430888798830399ULL )
+#define BITBOARD_RANK_1         ( ( bitboard_t ) 18374686479671623680ULL )
+#define BITBOARD_RANK_3         ( ( bitboard_t ) 280375465082880ULL )
+#define BITBOARD_RANK_6         ( ( bitboard_t ) 16711680ULL )
+#define BITBOARD_RANK_8         ( ( bitboard_t ) 255ULL )
 
 /**
  * @brief Computes the number of set bits within a bitboard.
@@ -48,7 +52,7 @@ bitboard_lsb
 (   bitboard_t bitboard
 )
 {
-    return ( bitboard ) ? bitboard_count ( ( bitboard & -bitboard ) - 1 )
+    return ( bitboard ) ? __builtin_ctzll ( bitboard )
                         : NO_SQ
                         ;
 }
@@ -102,10 +106,10 @@ bitboard_bishop_attack
 ,   bitboard_t          occupancy
 )
 {
-    occupancy &= ( *attacks ).bishop_masks[ square ];
+    occupancy |= ~( *attacks ).bishop_masks[ square ];
     occupancy *= bitboard_magic_bishops[ square ];
-    occupancy >>= 64 - bishop_attack_relevant_counts[ square ];
-    return ( *attacks ).bishop[ square ][ occupancy ];
+    occupancy >>= bishop_attack_shifts[ square ];
+    return ( *attacks ).sliders[ bishop_attack_offsets[ square ] + occupancy ];
 }
 
 /**
@@ -123,10 +127,10 @@ bitboard_rook_attack
 ,   bitboard_t          occupancy
 )
 {
-    occupancy &= ( *attacks ).rook_masks[ square ];
+    occupancy |= ~( *attacks ).rook_masks[ square ];
     occupancy *= bitboard_magic_rooks[ square ];
-    occupancy >>= 64 - rook_attack_relevant_counts[ square ];
-    return ( *attacks ).rook[ square ][ occupancy ];
+    occupancy >>= rook_attack_shifts[ square ];
+    return ( *attacks ).sliders[ rook_attack_offsets[ square ] + occupancy ];
 }
 
 /**
@@ -167,11 +171,232 @@ bitboard_king_attack
 }
 
 /**
- * @brief Generates a bitboard whose bits are set if the corresponding square on
- * a chess board may be attacked by a given side. Requires pregenerated attack
+ * @brief Shifts every bit of a bitboard by the same number of squares.
+ * @param bitboard A bitboard.
+ * @param shift The number of squares (positive toward H1, negative toward A8).
+ * @return The shifted bitboard.
+ */
+INLINE
+bitboard_t
+bitboard_shift
+(   const bitboard_t    bitboard
+,   const i32           shift
+)
+{
+    return ( shift > 0 ) ? bitboard << shift
+                         : bitboard >> -shift
+                         ;
+}
+
+/**
+ * @brief Computes the attacks of every pawn of a set toward file A, without
+ * attack tables.
+ * @param pawns A bitboard of pawns.
+ * @param side The side of the pawns.
+ * @return A bitboard with every attacked square set.
+ */
+INLINE
+bitboard_t
+bitboard_pawn_attacks_west
+(   const bitboard_t    pawns
+,   const SIDE          side
+)
+{
+    return ( side == WHITE ) ? ( pawns >> 9 ) & BITBOARD_MASK_FILE_H
+                             : ( pawns << 7 ) & BITBOARD_MASK_FILE_H
+                             ;
+}
+
+/**
+ * @brief Computes the attacks of every pawn of a set toward file H, without
+ * attack tables.
+ * @param pawns A bitboard of pawns.
+ * @param side The side of the pawns.
+ * @return A bitboard with every attacked square set.
+ */
+INLINE
+bitboard_t
+bitboard_pawn_attacks_east
+(   const bitboard_t    pawns
+,   const SIDE          side
+)
+{
+    return ( side == WHITE ) ? ( pawns >> 7 ) & BITBOARD_MASK_FILE_A
+                             : ( pawns << 9 ) & BITBOARD_MASK_FILE_A
+                             ;
+}
+
+/**
+ * @brief Computes the attacks of every pawn of a set, without attack tables.
+ * @param pawns A bitboard of pawns.
+ * @param side The side of the pawns.
+ * @return A bitboard with every attacked square set.
+ */
+INLINE
+bitboard_t
+bitboard_pawn_attacks
+(   const bitboard_t    pawns
+,   const SIDE          side
+)
+{
+    return bitboard_pawn_attacks_west ( pawns , side )
+         | bitboard_pawn_attacks_east ( pawns , side )
+         ;
+}
+
+/**
+ * @brief Computes the single push targets of every pawn of a set, without
+ * attack tables.
+ * @param pawns A bitboard of pawns.
+ * @param empty A bitboard of the empty squares.
+ * @param side The side of the pawns.
+ * @return A bitboard with every push target set.
+ */
+INLINE
+bitboard_t
+bitboard_pawn_pushes
+(   const bitboard_t    pawns
+,   const bitboard_t    empty
+,   const SIDE          side
+)
+{
+    return bitboard_shift ( pawns , ( side == WHITE ) ? -8 : 8 ) & empty;
+}
+
+/**
+ * @brief Computes the attacks of every knight of a set, without attack
  * tables.
+ * @param knights A bitboard of knights.
+ * @return A bitboard with every attacked square set.
+ */
+INLINE
+bitboard_t
+bitboard_knight_attacks
+(   const bitboard_t knights
+)
+{
+    return ( ( ( knights >> 15 ) | ( knights << 17 ) ) & BITBOARD_MASK_FILE_A )
+         | ( ( ( knights >> 17 ) | ( knights << 15 ) ) & BITBOARD_MASK_FILE_H )
+         | ( ( ( knights >> 6 ) | ( knights << 10 ) ) & BITBOARD_MASK_FILE_AB )
+         | ( ( ( knights >> 10 ) | ( knights << 6 ) ) & BITBOARD_MASK_FILE_HG )
+         ;
+}
+
+/**
+ * @brief Computes the attacks of every king of a set, without attack tables.
+ * @param kings A bitboard of kings.
+ * @return A bitboard with every attacked square set.
+ */
+INLINE
+bitboard_t
+bitboard_king_attacks
+(   const bitboard_t kings
+)
+{
+    return ( kings >> 8 ) | ( kings << 8 )
+         | ( ( ( kings >> 7 ) | ( kings << 1 ) | ( kings << 9 ) ) & BITBOARD_MASK_FILE_A )
+         | ( ( ( kings >> 9 ) | ( kings >> 1 ) | ( kings << 7 ) ) & BITBOARD_MASK_FILE_H )
+         ;
+}
+
+/**
+ * @brief Computes the squares attacked along one direction by every slider of
+ * a set (Kogge-Stone occluded fill). The fill spreads through empty squares in
+ * three doubling steps, then one more shift adds the blocking squares.
+ * @param sliders A bitboard of sliders.
+ * @param empty A bitboard of the empty squares.
+ * @param shift The direction (see bitboard_shift).
+ * @param mask The squares a shift in this direction may reach without
+ * wrapping around the board.
+ * @return A bitboard with every attacked square set.
+ */
+INLINE
+bitboard_t
+bitboard_slider_fill
+(   bitboard_t          sliders
+,   bitboard_t          empty
+,   const i32           shift
+,   const bitboard_t    mask
+)
+{
+    empty &= mask;
+    sliders |= empty & bitboard_shift ( sliders , shift );
+    empty &= bitboard_shift ( empty , shift );
+    sliders |= empty & bitboard_shift ( sliders , 2 * shift );
+    empty &= bitboard_shift ( empty , 2 * shift );
+    sliders |= empty & bitboard_shift ( sliders , 4 * shift );
+    return bitboard_shift ( sliders , shift ) & mask;
+}
+
+/**
+ * @brief Computes the attacks of every bishop of a set, without attack tables
+ * (see bitboard_slider_fill).
+ * @param bishops A bitboard of bishops (or queens).
+ * @param occupancy An occupancy mask.
+ * @return A bitboard with every attacked square set.
+ */
+INLINE
+bitboard_t
+bitboard_bishop_attacks
+(   const bitboard_t    bishops
+,   const bitboard_t    occupancy
+)
+{
+    const bitboard_t empty = ~occupancy;
+    return bitboard_slider_fill ( bishops , empty , -7 , BITBOARD_MASK_FILE_A )
+         | bitboard_slider_fill ( bishops , empty , -9 , BITBOARD_MASK_FILE_H )
+         | bitboard_slider_fill ( bishops , empty , 9 , BITBOARD_MASK_FILE_A )
+         | bitboard_slider_fill ( bishops , empty , 7 , BITBOARD_MASK_FILE_H )
+         ;
+}
+
+/**
+ * @brief Computes the attacks of every rook of a set, without attack tables
+ * (see bitboard_slider_fill).
+ * @param rooks A bitboard of rooks (or queens).
+ * @param occupancy An occupancy mask.
+ * @return A bitboard with every attacked square set.
+ */
+INLINE
+bitboard_t
+bitboard_rook_attacks
+(   const bitboard_t    rooks
+,   const bitboard_t    occupancy
+)
+{
+    const bitboard_t empty = ~occupancy;
+    return bitboard_slider_fill ( rooks , empty , -8 , ~( bitboard_t ) 0 )
+         | bitboard_slider_fill ( rooks , empty , 8 , ~( bitboard_t ) 0 )
+         | bitboard_slider_fill ( rooks , empty , 1 , BITBOARD_MASK_FILE_A )
+         | bitboard_slider_fill ( rooks , empty , -1 , BITBOARD_MASK_FILE_H )
+         ;
+}
+
+/**
+ * @brief Computes the attacks of every queen of a set, without attack tables
+ * (see bitboard_slider_fill).
+ * @param queens A bitboard of queens.
+ * @param occupancy An occupancy mask.
+ * @return A bitboard with every attacked square set.
+ */
+INLINE
+bitboard_t
+bitboard_queen_attacks
+(   const bitboard_t    queens
+,   const bitboard_t    occupancy
+)
+{
+    return bitboard_bishop_attacks ( queens , occupancy )
+         | bitboard_rook_attacks ( queens , occupancy )
+         ;
+}
+
+/**
+ * @brief Generates a bitboard whose bits are set if the corresponding square on
+ * a chess board may be attacked by a given side. Reads the attack maps of the
+ * board state (see board_t).
  * @param board The chess board state.
- * @param attacks Pregenerated attack tables.
+ * @param attacks Pregenerated attack tables (unused).
  * @param side The current side.
  * @return A bitboard with all valid attacks set.
  */
@@ -9,6 +9,85 @@
 #include "chess/best.h"
 #include "chess/castle.h"
 
+// Defines the set of slider piece types (bit i set for piece i).
+#define BOARD_SLIDERS                                                   \
+    ( ( 1 << B ) | ( 1 << R ) | ( 1 << Q ) | ( 1 << b ) | ( 1 << r ) | ( 1 << q ) )
+
+/**
+ * @brief Computes the squares attacked by every piece of one type, set-wise
+ * (see bitboard_pawn_attacks et al.).
+ * @param board A chess board state.
+ * @param piece The piece type.
+ * @return A bitboard with every square attacked by piece set.
+ */
+INLINE
+bitboard_t
+board_piece_attacks
+(   const board_t*  board
+,   const PIECE     piece
+)
+{
+    const bitboard_t pieces = ( *board ).pieces[ piece ];
+    const bitboard_t occupancy = ( *board ).occupancies[ 2 ];
+    switch ( piece )
+    {
+        case P:         return bitboard_pawn_attacks ( pieces , WHITE )        ;
+        case p:         return bitboard_pawn_attacks ( pieces , BLACK )        ;
+        case N: case n: return bitboard_knight_attacks ( pieces )              ;
+        case B: case b: return bitboard_bishop_attacks ( pieces , occupancy )  ;
+        case R: case r: return bitboard_rook_attacks ( pieces , occupancy )    ;
+        case Q: case q: return bitboard_queen_attacks ( pieces , occupancy )   ;
+        default:        return bitboard_king_attacks ( pieces )                ;
+    }
+}
+
+/**
+ * @brief Computes the pieces giving check to the side to move, by attacking
+ * outward from its king.
+ * @param board A chess board state.
+ * @return A bitboard with every checking piece set.
+ */
+INLINE
+bitboard_t
+board_checkers
+(   const board_t* board
+)
+{
+    const SIDE side = ( *board ).side;
+    const PIECE other = ( side == WHITE ) ? p : P;
+    const bitboard_t king = ( *board ).pieces[ ( side == WHITE ) ? K : k ];
+    const bitboard_t occupancy = ( *board ).occupancies[ 2 ];
+    const bitboard_t queens = ( *board ).pieces[ other + Q ];
+    return ( bitboard_pawn_attacks ( king , side ) & ( *board ).pieces[ other ] )
+         | ( bitboard_knight_attacks ( king ) & ( *board ).pieces[ other + N ] )
+         | ( bitboard_bishop_attacks ( king , occupancy ) & ( ( *board ).pieces[ other + B ] | queens ) )
+         | ( bitboard_rook_attacks ( king , occupancy ) & ( ( *board ).pieces[ other + R ] | queens ) )
+         ;
+}
+
+/**
+ * @brief Recomputes the attacks by each side from the attacks by each piece
+ * type.
+ * @param board The board state to mutate.
+ */
+INLINE
+void
+board_attacks_merge
+(   board_t* board
+)
+{
+    ( *board ).attacked[ WHITE ] = 0;
+    ( *board ).attacked[ BLACK ] = 0;
+    for ( PIECE piece = P; piece <= K; ++piece )
+    {
+        ( *board ).attacked[ WHITE ] |= ( *board ).attacked_by[ piece ];
+    }
+    for ( PIECE piece = p; piece <= k; ++piece )
+    {
+        ( *board ).attacked[ BLACK ] |= ( *board ).attacked_by[ piece ];
+    }
+}
+
 bool
 board_checkmate
 (   const board_t*      board_
@@ -34,11 +113,22 @@ board_checkmate
     return true;
 }
 
+/**
+ * @brief Performs a move for one side. Each call site passes side as a
+ * constant, so the compiler emits a separate implementation per side with no
+ * side branches.
+ * @param board The board state to mutate.
+ * @param move The move to make.
+ * @param attacks The pregenerated attack tables.
+ * @param side The side to move (a compile-time constant).
+ */
+FORCEINLINE
 void
-board_move
+board_move_side
 (   board_t*            board
 ,   const move_t        move
 ,   const attacks_t*    attacks
+,   const SIDE          side
 )
 {
     const SQUARE src = move_decode_src ( move );
@@ -50,8 +140,16 @@ board_move
     const bool enpassant = move_decode_enpassant ( move );
     const bool castle = move_decode_castle ( move );
 
-    const bool white = ( *board ).side == WHITE;
-    
+    // Pieces of the side to move, and of the opponent.
+    const PIECE own = ( side == WHITE ) ? P : p;
+    const PIECE other = ( side == WHITE ) ? p : P;
+    const i32 forward = ( side == WHITE ) ? -8 : 8;
+
+    // Piece types whose squares change (bit i set for piece i), and the
+    // occupancy before the move.
+    u32 moved = 1 << piece;
+    const bitboard_t occupancy = ( *board ).occupancies[ 2 ];
+
     // Move the piece.
     BITCLR ( ( *board ).pieces[ piece ] , src );
     BITSET ( ( *board ).pieces[ piece ] , dst );
@@ -59,14 +157,13 @@ board_move
     // Parse capture.
     if ( capture )
     {
-        const PIECE from = ( white ) ? p : P;
-        const PIECE to = ( white ) ? k : K;
-        for ( PIECE i = from; i <= to; ++i )
+        for ( PIECE i = other; i <= other + K; ++i )
         {
             if ( bit ( ( *board ).pieces[ i ] , dst ) )
             {
                 ( *board ).capture = i;
                 BITCLR ( ( *board ).pieces[ i ] , dst );
+                moved |= 1 << i;
                 break;
             }
         }
@@ -76,25 +173,19 @@ board_move
     if ( promotion )
     {
         // Clear pawn.
-        BITCLR ( ( *board ).pieces[ ( white ) ? P : p ] , dst );
+        BITCLR ( ( *board ).pieces[ own ] , dst );
 
         // Set promotion.
         BITSET ( ( *board ).pieces[ promotion ] , dst );
+        moved |= 1 << promotion;
     }
 
     // Parse en passant capture.
     if ( enpassant )
     {
-        if ( white )
-        {
-            ( *board ).capture = p;
-            BITCLR ( ( *board ).pieces[ p ] , dst + 8 );
-        }
-        else
-        {
-            ( *board ).capture = P;
-            BITCLR ( ( *board ).pieces[ P ] , dst - 8 );
-        }
+        ( *board ).capture = other;
+        BITCLR ( ( *board ).pieces[ other ] , dst - forward );
+        moved |= 1 << other;
     }
 
     // Reset en passant square.
@@ -103,45 +194,24 @@ board_move
     // Parse double push.
     if ( double_push )
     {
-        ( *board ).enpassant = ( white ) ? dst + 8 : dst - 8;
+        ( *board ).enpassant = dst - forward;
     }
 
     // Parse castling.
     if ( castle )
     {
-        switch ( dst )
+        const PIECE rook = own + R;
+        const SQUARE king = ( side == WHITE ) ? E1 : E8;
+        moved |= 1 << rook;
+        if ( dst == king + 2 )
         {
-            case C1:
-            {
-                BITCLR ( ( *board ).pieces[ R ] , A1 );
-                BITSET ( ( *board ).pieces[ R ] , D1 );
-            }
-            break;
-
-            case G1:
-            {
-                BITCLR ( ( *board ).pieces[ R ] , H1 );
-                BITSET ( ( *board ).pieces[ R ] , F1 );
-            }
-            break;
-
-            case C8:
-            {
-                BITCLR ( ( *board ).pieces[ r ] , A8 );
-                BITSET ( ( *board ).pieces[ r ] , D8 );
-            }
-            break;
-
-            case G8:
-            {
-                BITCLR ( ( *board ).pieces[ r ] , H8 );
-                BITSET ( ( *board ).pieces[ r ] , F8 );
-            }
-            break;
-
-            default:
-            {}
-            break;
+            BITCLR ( ( *board ).pieces[ rook ] , king + 3 );
+            BITSET ( ( *board ).pieces[ rook ] , king + 1 );
+        }
+        else
+        {
+            BITCLR ( ( *board ).pieces[ rook ] , king - 4 );
+            BITSET ( ( *board ).pieces[ rook ] , king - 1 );
         }
     }
 
@@ -164,5 +234,117 @@ board_move
                                 ;
 
     // Toggle side.
-    ( *board ).side = !( *board ).side;
+    ( *board ).side = !side;
+
+    // Update attack maps. Leaper attacks only change when the leapers move;
+    // a slider's attacks also change when a square it attacks is vacated or
+    // filled.
+    const bitboard_t changed = occupancy ^ ( *board ).occupancies[ 2 ];
+    for ( PIECE i = P; i <= k; ++i )
+    {
+        if ( ( ( moved >> i ) & 1 )
+          || ( ( ( BOARD_SLIDERS >> i ) & 1 ) && ( ( *board ).attacked_by[ i ] & changed ) )
+           )
+        {
+            ( *board ).attacked_by[ i ] = board_piece_attacks ( board , i );
+        }
+    }
+    board_attacks_merge ( board );
+
+    // Update checkers (only if the opposing king is attacked).
+    ( *board ).checkers = ( ( *board ).attacked[ side ] & ( *board ).pieces[ other + K ] )
+                        ? board_checkers ( board )
+                        : 0
+                        ;
+}
+
+void
+board_attacks_refresh
+(   board_t* board
+)
+{
+    for ( PIECE piece = P; piece <= k; ++piece )
+    {
+        ( *board ).attacked_by[ piece ] = board_piece_attacks ( board , piece );
+    }
+    board_attacks_merge ( board );
+
+    const SIDE side = ( *board ).side;
+    ( *board ).checkers = ( ( *board ).attacked[ !side ] & ( *board ).pieces[ ( side == WHITE ) ? K : k ] )
+                        ? board_checkers ( board )
+                        : 0
+                        ;
+}
+
+void
+board_move
+(   board_t*            board
+,   const move_t        move
+,   const attacks_t*    attacks
+)
+{
+    if ( ( *board ).side == WHITE )
+    {
+        board_move_side ( board , move , attacks , WHITE );
+    }
+    else
+    {
+        board_move_side ( board , move , attacks , BLACK );
+    }
+}
+
+bool
+board_move_legal
+(   const board_t*      board
+,   const move_t        move
+,   const attacks_t*    attacks
+)
+{
+    const SIDE side = ( *board ).side;
+    const SQUARE src = move_decode_src ( move );
+    const SQUARE dst = move_decode_dst ( move );
+    const PIECE own = ( side == WHITE ) ? P : p;
+    const PIECE other = ( side == WHITE ) ? p : P;
+
+    // Compute the occupancy after the move, and the square of any captured
+    // piece.
+    bitboard_t occupancy = ( *board ).occupancies[ 2 ];
+    SQUARE captured = dst;
+    BITCLR ( occupancy , src );
+    BITSET ( occupancy , dst );
+    if ( move_decode_enpassant ( move ) )
+    {
+        captured = ( side == WHITE ) ? dst + 8 : dst - 8;
+        BITCLR ( occupancy , captured );
+    }
+    else if ( move_decode_castle ( move ) )
+    {
+        const SQUARE king = ( side == WHITE ) ? E1 : E8;
+        if ( dst == king + 2 )
+        {
+            BITCLR ( occupancy , king + 3 );
+            BITSET ( occupancy , king + 1 );
+        }
+        else
+        {
+            BITCLR ( occupancy , king - 4 );
+            BITSET ( occupancy , king - 1 );
+        }
+    }
+    const bitboard_t remaining = ~( U64_1 << captured );
+
+    // Locate the king after the move.
+    const SQUARE king = ( move_decode_piece ( move ) == own + K ) ? dst
+                      : bitboard_lsb ( ( *board ).pieces[ own + K ] )
+                      ;
+
+    // Test if any opposing piece which survives the move attacks the king
+    // (see board_square_attackable).
+    const bitboard_t queens = ( *board ).pieces[ other + Q ];
+    return !(    ( bitboard_pawn_attack ( attacks , king , side ) & ( *board ).pieces[ other ] & remaining )
+              || ( bitboard_knight_attack ( attacks , king ) & ( *board ).pieces[ other + N ] & remaining )
+              || ( bitboard_bishop_attack ( attacks , king , occupancy ) & ( ( *board ).pieces[ other + B ] | queens ) & remaining )
+              || ( bitboard_rook_attack ( attacks , king , occupancy ) & ( ( *board ).pieces[ other + R ] | queens ) & remaining )
+              || ( bitboard_king_attack ( attacks , king ) & ( *board ).pieces[ other + K ] )
+            );
 }
\ No newline at end of file
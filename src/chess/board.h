@@ -12,9 +12,9 @@
 
 /**
  * @brief Computes if a square on a chess board may be attacked by a given
- * side. Requires pregenerated attack tables.
+ * side. Reads the attack maps of the board state (see board_t).
  * @param board The chess board state.
- * @param attacks Pregenerated attack tables.
+ * @param attacks Pregenerated attack tables (unused).
  * @param square The square to check.
  * @param side The current side.
  * @return true if square attackable, false otherwise.
@@ -28,21 +28,14 @@ board_square_attackable
 ,   const SIDE          side
 )
 {
-    return square != NO_SQ
-        && (   ( bitboard_pawn_attack ( attacks , square , !side ) & ( ( side == WHITE ) ? ( *board ).pieces[ P ] : ( *board ).pieces[ p ] ) )
-            || ( bitboard_knight_attack ( attacks , square )  & ( ( side == WHITE ) ? ( *board ).pieces[ N ] : ( *board ).pieces[ n ] ) )
-            || ( bitboard_bishop_attack ( attacks , square , ( *board ).occupancies[ 2 ] ) & ( ( side == WHITE ) ? ( *board ).pieces[ B ] : ( *board ).pieces[ b ] ) )
-            || ( bitboard_rook_attack ( attacks , square , ( *board ).occupancies[ 2 ] ) & ( ( side == WHITE ) ? ( *board ).pieces[ R ] : ( *board ).pieces[ r ] ) )
-            || ( bitboard_queen_attack ( attacks , square , ( *board ).occupancies[ 2 ] ) & ( ( side == WHITE ) ? ( *board ).pieces[ Q ] : ( *board ).pieces[ q ] ) )
-            || ( bitboard_king_attack ( attacks , square ) & ( ( side == WHITE ) ? ( *board ).pieces[ K ] : ( *board ).pieces[ k ] ) )
-           );
+    return square != NO_SQ && bit ( ( *board ).attacked[ side ] , square );
 }
 
 /**
- * @brief Computes if a given side is in check. Requires pregenerated attack
- * tables.
+ * @brief Computes if a given side is in check. Reads the attack maps of the
+ * board state (see board_t).
  * @param board The chess board state.
- * @param attacks Pregenerated attack tables.
+ * @param attacks Pregenerated attack tables (unused).
  * @param side The side to test.
  * @return true if side's king is in check, false otherwise.
  */
@@ -54,13 +47,7 @@ board_check
 ,   const SIDE          side
 )
 {
-    return board_square_attackable ( board
-                                   , attacks
-                                   , bitboard_lsb ( ( side == WHITE ) ? ( *board ).pieces[ K ]
-                                                                      : ( *board ).pieces[ k ]
-                                                                      )
-                                   , !side
-                                   );
+    return ( *board ).attacked[ !side ] & ( *board ).pieces[ ( side == WHITE ) ? K : k ];
 }
 
 /**
@@ -97,9 +84,22 @@ board_stalemate
     return !board_check ( board , attacks, ( *board ).side ) && !( *moves ).count;
 }
 
+/**
+ * @brief Recomputes the attack maps of a board state from scratch (see
+ * board_t). Must be called after placing pieces by any means other than
+ * board_move. Does not require pregenerated attack tables.
+ * @param board The board state to mutate.
+ */
+void
+board_attacks_refresh
+(   board_t* board
+);
+
 /**
  * @brief Updates the provided board state by performing a move. Requires
- * pregenerated attack tables.
+ * pregenerated attack tables. The attack maps are updated incrementally: only
+ * the attacks of the pieces which moved, and of the sliders whose attacks
+ * reach a square that was vacated or filled, are recomputed.
  * @param board The board state to mutate.
  * @param move The move to make.
  * @param attacks The pregenerated attack tables.
@@ -111,4 +111,19 @@ board_move
 ,   const attacks_t*    attacks
 );
 
+/**
+ * @brief Computes if a pseudo-legal move leaves the moving side's king out of
+ * check, without performing the move. Requires pregenerated attack tables.
+ * @param board A chess board state.
+ * @param move A pseudo-legal move for the side to move.
+ * @param attacks The pregenerated attack tables.
+ * @return true if move legal, false otherwise.
+ */
+bool
+board_move_legal
+(   const board_t*      board
+,   const move_t        move
+,   const attacks_t*    attacks
+);
+
 #endif  // CHESS_BOARD_H
\ No newline at end of file
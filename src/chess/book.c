@@ -0,0 +1,228 @@
+/**
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @file book.c
+ * @brief Implementation of the book header.
+ * (see book.h for additional details)
+ */
+#include "chess/book.h"
+
+#include "chess/board.h"
+#include "chess/zobrist.h"
+
+#include "core/logger.h"
+#include "core/memory.h"
+
+#include "math/math.h"
+
+/**
+ * @brief Reads a big-endian unsigned integer.
+ * @param bytes The bytes to read.
+ * @param size Number of bytes to read.
+ * @return The integer.
+ */
+INLINE
+u64
+book_read
+(   const u8*   bytes
+,   const u32   size
+)
+{
+    u64 value = 0;
+    for ( u32 i = 0; i < size; ++i )
+    {
+        value = ( value << 8 ) | bytes[ i ];
+    }
+    return value;
+}
+
+/**
+ * @brief Converts a Polyglot move to a legal move on a board state.
+ * @param encoding The Polyglot move.
+ * @param board A chess board state.
+ * @param attacks The pregenerated attack tables.
+ * @return The matching legal move, or 0 if none matches.
+ */
+move_t
+book_move_parse
+(   const u16           encoding
+,   const board_t*      board
+,   const attacks_t*    attacks
+);
+
+bool
+book_open
+(   const char* filepath
+,   book_t*     book
+)
+{
+    memory_clear ( book , sizeof ( book_t ) );
+    if ( !platform_file_map ( filepath , &( *book ).mapping ) )
+    {
+        return false;
+    }
+    if ( ( *book ).mapping.size % BOOK_ENTRY_SIZE )
+    {
+        LOGERROR ( "book_open: '%s' is not a Polyglot book file." , filepath );
+        platform_file_unmap ( &( *book ).mapping );
+        return false;
+    }
+    ( *book ).entries = ( *book ).mapping.memory;
+    ( *book ).entry_count = ( *book ).mapping.size / BOOK_ENTRY_SIZE;
+    return true;
+}
+
+void
+book_close
+(   book_t* book
+)
+{
+    platform_file_unmap ( &( *book ).mapping );
+    ( *book ).entries = 0;
+    ( *book ).entry_count = 0;
+}
+
+move_t
+book_move
+(   const book_t*       book
+,   const board_t*      board
+,   const attacks_t*    attacks
+)
+{
+    if ( !( *book ).entries )
+    {
+        return 0;
+    }
+
+    // Binary search for the first entry with a matching key.
+    const u64 key = zobrist_key ( board );
+    u64 lo = 0;
+    u64 hi = ( *book ).entry_count;
+    while ( lo < hi )
+    {
+        const u64 mid = lo + ( hi - lo ) / 2;
+        if ( book_read ( ( *book ).entries + mid * BOOK_ENTRY_SIZE , 8 ) < key )
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    // Gather the legal candidate moves.
+    move_t moves[ BOOK_MAX_CANDIDATES ];
+    u32 weights[ BOOK_MAX_CANDIDATES ];
+    u32 count = 0;
+    u32 total = 0;
+    for ( u64 i = lo; i < ( *book ).entry_count && count < BOOK_MAX_CANDIDATES; ++i )
+    {
+        const u8* entry = ( *book ).entries + i * BOOK_ENTRY_SIZE;
+        if ( book_read ( entry , 8 ) != key )
+        {
+            break;
+        }
+        const u32 weight = book_read ( entry + 10 , 2 );
+        const move_t move = book_move_parse ( book_read ( entry + 8 , 2 ) , board , attacks );
+        if ( !weight || !move )
+        {
+            continue;
+        }
+        moves[ count ] = move;
+        weights[ count ] = weight;
+        total += weight;
+        count += 1;
+    }
+    if ( !count )
+    {
+        return 0;
+    }
+
+    // Weighted random selection.
+    i32 choice = random2 ( 0 , total - 1 );
+    for ( u32 i = 0; i < count; ++i )
+    {
+        choice -= weights[ i ];
+        if ( choice < 0 )
+        {
+            return moves[ i ];
+        }
+    }
+    return moves[ count - 1 ];
+}
+
+move_t
+book_move_parse
+(   const u16           encoding
+,   const board_t*      board
+,   const attacks_t*    attacks
+)
+{
+    // Polyglot squares are numbered from a1 (row 0 = rank 1).
+    SQUARE dst = ( 7 - ( ( encoding >> 3 ) & 7 ) ) * 8 + ( encoding & 7 );
+    const SQUARE src = ( 7 - ( ( encoding >> 9 ) & 7 ) ) * 8 + ( ( encoding >> 6 ) & 7 );
+    const u32 promotion = ( encoding >> 12 ) & 7;
+
+    // Castling is encoded as the king capturing its own rook.
+    if ( bit ( ( *board ).pieces[ K ] | ( *board ).pieces[ k ] , src ) )
+    {
+        if      ( src == E1 && dst == H1 ) dst = G1;
+        else if ( src == E1 && dst == A1 ) dst = C1;
+        else if ( src == E8 && dst == H8 ) dst = G8;
+        else if ( src == E8 && dst == A8 ) dst = C8;
+    }
+
+    moves_t moves;
+    moves_compute ( &moves , board , attacks );
+    for ( u32 i = 0; i < moves.count; ++i )
+    {
+        const move_t move = moves.moves[ i ];
+        if (    move_decode_src ( move ) != src
+             || move_decode_dst ( move ) != dst
+             || ( move_decode_promotion ( move ) ? ( move_decode_promotion ( move ) % 6 ) : 0 ) != promotion
+           )
+        {
+            continue;
+        }
+
+        // Filter the move if it puts the moving side into check.
+        board_t board_;
+        memory_copy ( &board_ , board , sizeof ( board_t ) );
+        board_move ( &board_ , move , attacks );
+        if ( board_check ( &board_ , attacks , ( *board ).side ) )
+        {
+            return 0;
+        }
+        return move;
+    }
+    return 0;
+}
+
+u16
+book_move_encode
+(   const move_t move
+)
+{
+    const SQUARE src = move_decode_src ( move );
+    SQUARE dst = move_decode_dst ( move );
+    if ( move_decode_castle ( move ) )
+    {
+        switch ( dst )
+        {
+            case G1: dst = H1; break;
+            case C1: dst = A1; break;
+            case G8: dst = H8; break;
+            case C8: dst = A8; break;
+            default:           break;
+        }
+    }
+    const PIECE promotion = move_decode_promotion ( move );
+
+    // Polyglot squares are numbered from a1 (row 0 = rank 1).
+    return ( dst & 7 )
+         | ( ( 7 - ( dst >> 3 ) ) << 3 )
+         | ( ( src & 7 ) << 6 )
+         | ( ( 7 - ( src >> 3 ) ) << 9 )
+         | ( ( ( promotion ) ? promotion % 6 : 0 ) << 12 )
+         ;
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+/**
+ * @file book.h
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Polyglot opening book.
+ *
+ * A Polyglot book is a file of 16-byte big-endian entries (u64 Zobrist key,
+ * u16 move, u16 weight, u32 learn), sorted by key. The file is memory-mapped
+ * and probed by binary search.
+ */
+#ifndef CHESS_BOOK_H
+#define CHESS_BOOK_H
+
+#include "chess/common.h"
+
+#include "platform/platform.h"
+
+// Defines the size of a single book entry.
+#define BOOK_ENTRY_SIZE 16
+
+// Defines the maximum number of candidate moves considered for a position.
+#define BOOK_MAX_CANDIDATES 64
+
+// Type definition for an opening book.
+typedef struct
+{
+    platform_file_mapping_t mapping;
+    const u8*               entries;
+    u64                     entry_count;
+}
+book_t;
+
+/**
+ * @brief Memory-maps a Polyglot book file.
+ * @param filepath The book filepath.
+ * @param book Output buffer.
+ * @return true if book opened successfully, false otherwise.
+ */
+bool
+book_open
+(   const char* filepath
+,   book_t*     book
+);
+
+/**
+ * @brief Unmaps a Polyglot book file.
+ * @param book The book.
+ */
+void
+book_close
+(   book_t* book
+);
+
+/**
+ * @brief Chooses a book move for a board state. Candidates are chosen at
+ * random in proportion to their weights. Requires pregenerated attack tables.
+ * @param book The book.
+ * @param board A chess board state.
+ * @param attacks The pregenerated attack tables.
+ * @return A legal book move, or 0 if the position is not in book.
+ */
+move_t
+book_move
+(   const book_t*       book
+,   const board_t*      board
+,   const attacks_t*    attacks
+);
+
+/**
+ * @brief Encodes a move in the Polyglot move format (castling is encoded as
+ * the king capturing its own rook).
+ * @param move A move.
+ * @return The Polyglot move.
+ */
+u16
+book_move_encode
+(   const move_t move
+);
+
+#endif  // CHESS_BOOK_H
\ No newline at end of file
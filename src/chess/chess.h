@@ -9,10 +9,21 @@
 #include "chess/common.h"
 
 #include "chess/attack.h"
+#include "chess/batch.h"
 #include "chess/best.h"
+#include "chess/bitbase.h"
 #include "chess/board.h"
+#include "chess/book.h"
 #include "chess/fen.h"
+#include "chess/game.h"
 #include "chess/move.h"
+#include "chess/nnue.h"
+#include "chess/packed.h"
+#include "chess/param.h"
+#include "chess/match.h"
+#include "chess/pgn.h"
+#include "chess/quad.h"
 #include "chess/string.h"
+#include "chess/zobrist.h"
 
 #endif  // CHESS_H
@@ -8,13 +8,14 @@
 
 #include "chess/common/bitboard.h"
 
+#include "chess/magic.h"
+
 // Type definition for a container to hold pregenerated attack tables.
 typedef struct
 {
     bitboard_t pawn[ 2 ][ 64 ];
     bitboard_t knight[ 64 ];
-    bitboard_t bishop[ 64 ][ 512 ];
-    bitboard_t rook[ 64 ][ 4096 ];
+    bitboard_t sliders[ MAGIC_TABLE_LENGTH ];
     bitboard_t king[ 64 ];
 
     bitboard_t bishop_masks[ 64 ];
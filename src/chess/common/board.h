@@ -23,6 +23,12 @@ typedef struct
     CASTLE      castle;
 
     PIECE       capture;
+
+    // Attack maps: the squares attacked by each piece type and by each side,
+    // and the pieces giving check to the side to move (see board_move).
+    bitboard_t  attacked_by[ 12 ];
+    bitboard_t  attacked[ 2 ];
+    bitboard_t  checkers;
 }
 board_t;
 
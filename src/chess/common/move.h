@@ -12,6 +12,11 @@
 // Type definition for a move.
 typedef u32 move_t;
 
+// Type definition for a compact move: source square, destination square and
+// promotion piece type only (see move_compact). The remaining fields of a
+// move are implied by the board state it is played on (see move_expand).
+typedef u16 move16_t;
+
 // Defines the maximum number of moves which may be added to a single container.
 #define MOVES_BUFFER_LENGTH 256
 
@@ -170,4 +175,66 @@ move_decode_castle
     return move & 0x800000;
 }
 
+/**
+ * @brief Converts a move to the compact 16-bit encoding: source square (bits
+ * 0-5), destination square (bits 6-11) and promotion piece type (bits 12-14;
+ * 0 for none, otherwise N, B, R or Q).
+ * @param move A move.
+ * @return The compact move.
+ */
+INLINE
+move16_t
+move_compact
+(   const move_t move
+)
+{
+    const PIECE promotion = move_decode_promotion ( move );
+    return move_decode_src ( move )
+         | ( move_decode_dst ( move ) << 6 )
+         | ( ( ( promotion ) ? promotion % 6 : 0 ) << 12 )
+         ;
+}
+
+/**
+ * @brief Retrieves source square from a compact move.
+ * @param move A compact move.
+ * @return The source square of move.
+ */
+INLINE
+SQUARE
+move16_decode_src
+(   const move16_t move
+)
+{
+    return move & 0x3F;
+}
+
+/**
+ * @brief Retrieves destination square from a compact move.
+ * @param move A compact move.
+ * @return The destination square of move.
+ */
+INLINE
+SQUARE
+move16_decode_dst
+(   const move16_t move
+)
+{
+    return ( move & 0xFC0 ) >> 6;
+}
+
+/**
+ * @brief Retrieves the promotion piece type from a compact move.
+ * @param move A compact move.
+ * @return The promotion piece type of move (N, B, R or Q), or 0 if none.
+ */
+INLINE
+PIECE
+move16_decode_promotion
+(   const move16_t move
+)
+{
+    return ( move & 0x7000 ) >> 12;
+}
+
 #endif  // CHESS_COMMON_MOVE_H
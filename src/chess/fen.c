@@ -6,6 +6,7 @@
  */
 #include "chess/fen.h"
 
+#include "chess/board.h"
 #include "chess/string.h"
 
 #include "core/logger.h"
@@ -26,6 +27,7 @@ fen_parse
     board.side = 0;
     board.enpassant = NO_SQ;
     board.castle = 0;
+    board.capture = EMPTY_SQ;
     memory_clear ( board.pieces , sizeof ( board.pieces ) );
     memory_clear ( board.occupancies , sizeof ( board.occupancies ) );
     
@@ -177,21 +179,21 @@ fen_parse
     }
     fen += 1;
 
-    // Parse enpassant token.
-    if ( fen[ 0 ] == '-' && fen[ 1 ] == FEN_WHITESPACE_TOKEN )
+    // Parse enpassant token (the move counters which follow it are optional).
+    if ( fen[ 0 ] == '-' && ( fen[ 1 ] == FEN_WHITESPACE_TOKEN || !fen[ 1 ] ) )
     {
         board.enpassant = NO_SQ;
-        fen += 2;
+        fen += 1;
     }
     else if (   fen[ 0 ] >= 'a' && fen[ 0 ] <= 'h'
              && fen[ 1 ] >= '1' && fen[ 1 ] <= '8'
-             && fen[ 2 ] == FEN_WHITESPACE_TOKEN
+             && ( fen[ 2 ] == FEN_WHITESPACE_TOKEN || !fen[ 2 ] )
             )
     {
         board.enpassant = SQUAREINDX ( 8 - to_digit ( fen[ 1 ] )
-                                     , fen[ 0 ] - 'A'
+                                     , fen[ 0 ] - 'a'
                                      );
-        fen += 3;
+        fen += 2;
     }
 
     // Validate.
@@ -216,6 +218,9 @@ fen_parse
                            | board.occupancies[ BLACK ]
                            ;
 
+    // Compute attack maps.
+    board_attacks_refresh ( &board );
+
     // Write the board to the output buffer.
     memory_copy ( board_ , &board , sizeof ( board_t ) );
 
@@ -306,11 +311,11 @@ fen_from_board
     }
     else
     {
-        dst[ 0 ] = ( ( *board ).castle & CASTLE_WK ) ? 'K' : '-';
-        dst[ 1 ] = ( ( *board ).castle & CASTLE_WQ ) ? 'Q' : '-';
-        dst[ 2 ] = ( ( *board ).castle & CASTLE_BK ) ? 'k' : '-';
-        dst[ 3 ] = ( ( *board ).castle & CASTLE_BQ ) ? 'q' : '-';
-        dst += 4;
+        // Only the available rights are listed (e.g. "Kq").
+        if ( ( *board ).castle & CASTLE_WK ) *dst++ = 'K';
+        if ( ( *board ).castle & CASTLE_WQ ) *dst++ = 'Q';
+        if ( ( *board ).castle & CASTLE_BK ) *dst++ = 'k';
+        if ( ( *board ).castle & CASTLE_BQ ) *dst++ = 'q';
     }
 
     dst[ 0 ] = FEN_WHITESPACE_TOKEN;
@@ -0,0 +1,161 @@
+/**
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @file game.c
+ * @brief Implementation of the game header.
+ * (see game.h for additional details)
+ */
+#include "chess/game.h"
+
+#include "chess/board.h"
+#include "chess/fen.h"
+#include "chess/move.h"
+#include "chess/zobrist.h"
+
+#include "core/memory.h"
+
+/**
+ * @brief Generates a pseudo-random number (splitmix64).
+ * @param state The generator state.
+ * @return A pseudo-random number.
+ */
+INLINE
+u64
+game_random
+(   u64* state
+)
+{
+    u64 x = ( *state += 0x9E3779B97F4A7C15ULL );
+    x = ( x ^ ( x >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+    x = ( x ^ ( x >> 27 ) ) * 0x94D049BB133111EBULL;
+    return x ^ ( x >> 31 );
+}
+
+void
+game_opening_random
+(   board_t*            board
+,   const attacks_t*    attacks
+,   const u64           seed
+,   const u64           index
+,   const u64           plies
+)
+{
+    u64 random = seed ^ ( index * 0xD1B54A32D192ED03ULL );
+    moves_t moves;
+    u32 ply = 0;
+    fen_parse ( FEN_START , board );
+    while ( ply < plies )
+    {
+        moves_compute ( &moves , board , attacks );
+        u32 count = 0;
+        for ( u32 i = 0; i < moves.count; ++i )
+        {
+            if ( board_move_legal ( board , moves.moves[ i ] , attacks ) )
+            {
+                moves.moves[ count++ ] = moves.moves[ i ];
+            }
+        }
+        if ( !count )
+        {
+            fen_parse ( FEN_START , board );
+            ply = 0;
+            continue;
+        }
+        board_move ( board , moves.moves[ game_random ( &random ) % count ] , attacks );
+        ply += 1;
+    }
+}
+
+void
+game_start
+(   game_t*         game
+,   const board_t*  board
+,   const u32       ply
+)
+{
+    memory_copy ( &( *game ).board , board , sizeof ( board_t ) );
+    ( *game ).ply = ply;
+    ( *game ).fifty = 0;
+    ( *game ).win_plies = 0;
+    ( *game ).loss_plies = 0;
+    ( *game ).draw_plies = 0;
+    ( *game ).keys[ 0 ] = zobrist_key ( board );
+}
+
+bool
+game_over
+(   const game_t*       game
+,   const attacks_t*    attacks
+,   u8*                 result
+)
+{
+    const board_t* board = &( *game ).board;
+    moves_t moves;
+    moves_compute ( &moves , board , attacks );
+    if ( board_checkmate ( board , attacks , &moves ) )
+    {
+        *result = ( ( *board ).side == WHITE ) ? 0 : 2;
+        return true;
+    }
+    if (    board_stalemate ( board , attacks , &moves )
+         || ( *game ).fifty >= GAME_FIFTY_MOVE_PLIES
+         || ( *game ).ply >= GAME_MAX_PLY
+       )
+    {
+        *result = 1;
+        return true;
+    }
+
+    // Threefold repetition: count the earlier occurrences of the position
+    // since the last irreversible move, with the same side to move.
+    u32 repetitions = 0;
+    for ( u32 i = 2; i <= ( *game ).fifty; i += 2 )
+    {
+        repetitions += ( *game ).keys[ ( *game ).fifty - i ] == ( *game ).keys[ ( *game ).fifty ];
+    }
+    if ( repetitions >= 2 )
+    {
+        *result = 1;
+        return true;
+    }
+    return false;
+}
+
+bool
+game_adjudicate
+(   game_t*     game
+,   const i32   score
+,   u8*         result
+)
+{
+    ( *game ).win_plies = ( score >= GAME_RESIGN_SCORE ) ? ( *game ).win_plies + 1 : 0;
+    ( *game ).loss_plies = ( score <= -GAME_RESIGN_SCORE ) ? ( *game ).loss_plies + 1 : 0;
+    ( *game ).draw_plies = (    ( *game ).ply >= GAME_DRAW_MIN_PLY
+                             && score <= GAME_DRAW_SCORE
+                             && score >= -GAME_DRAW_SCORE
+                           ) ? ( *game ).draw_plies + 1 : 0;
+    if ( ( *game ).win_plies >= GAME_RESIGN_PLIES || ( *game ).loss_plies >= GAME_RESIGN_PLIES )
+    {
+        *result = ( ( *game ).win_plies ) ? 2 : 0;
+        return true;
+    }
+    if ( ( *game ).draw_plies >= GAME_DRAW_PLIES )
+    {
+        *result = 1;
+        return true;
+    }
+    return false;
+}
+
+void
+game_move
+(   game_t*             game
+,   const move_t        move
+,   const attacks_t*    attacks
+)
+{
+    const PIECE piece = move_decode_piece ( move );
+    ( *game ).fifty = ( move_decode_capture ( move ) || piece == P || piece == p ) ? 0 : ( *game ).fifty + 1;
+    board_move ( &( *game ).board , move , attacks );
+    ( *game ).ply += 1;
+    ( *game ).keys[ ( *game ).fifty ] = zobrist_key ( &( *game ).board );
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+/**
+ * @file game.h
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Game driver for engine games (see match.h, and the self-play data
+ * generator).
+ *
+ * A game starts from an opening position, either given or made of uniformly
+ * random legal moves from the starting position (drawn from a generator
+ * seeded by a seed and the game index, so a game is reproducible whatever
+ * the number of threads playing). The caller searches each move, then passes
+ * the score to game_adjudicate and the move to game_move. A game ends by
+ * checkmate, stalemate, the fifty-move rule, threefold repetition (see
+ * game_over), or adjudication (see game_adjudicate):
+ *
+ *  - resignation, once the score has favoured the same side by at least
+ *    GAME_RESIGN_SCORE for GAME_RESIGN_PLIES consecutive plies;
+ *  - a draw, once the score has stayed within GAME_DRAW_SCORE of zero for
+ *    GAME_DRAW_PLIES consecutive plies (from GAME_DRAW_MIN_PLY), or once
+ *    the game reaches GAME_MAX_PLY plies.
+ *
+ * Results are given for white: 0 (loss), 1 (draw) or 2 (win).
+ */
+#ifndef CHESS_GAME_H
+#define CHESS_GAME_H
+
+#include "chess/common.h"
+
+// Defines adjudication parameters.
+#define GAME_MAX_PLY            400
+#define GAME_RESIGN_SCORE       1000
+#define GAME_RESIGN_PLIES       6
+#define GAME_DRAW_SCORE         10
+#define GAME_DRAW_PLIES         12
+#define GAME_DRAW_MIN_PLY       80
+#define GAME_FIFTY_MOVE_PLIES   100
+
+// Type definition for the state of a game in progress.
+typedef struct
+{
+    board_t     board;
+    u32         ply;
+    u32         fifty;
+
+    // Adjudication: consecutive plies won, lost (for white) and drawn.
+    u32         win_plies;
+    u32         loss_plies;
+    u32         draw_plies;
+
+    // Keys of the positions since the last irreversible move, indexed by
+    // the fifty-move counter.
+    u64         keys[ GAME_FIFTY_MOVE_PLIES + 1 ];
+}
+game_t;
+
+/**
+ * @brief Plays a random opening: a number of uniformly random legal moves
+ * from the starting position. Restarts if it runs into the end of the game.
+ * Requires pregenerated attack tables.
+ * @param board Output buffer.
+ * @param attacks The pregenerated attack tables.
+ * @param seed The generator seed.
+ * @param index The game index.
+ * @param plies The number of random moves.
+ */
+void
+game_opening_random
+(   board_t*            board
+,   const attacks_t*    attacks
+,   const u64           seed
+,   const u64           index
+,   const u64           plies
+);
+
+/**
+ * @brief Starts a game.
+ * @param game Output buffer.
+ * @param board The starting position.
+ * @param ply The number of plies played before the starting position.
+ */
+void
+game_start
+(   game_t*         game
+,   const board_t*  board
+,   const u32       ply
+);
+
+/**
+ * @brief Tests whether a game has ended, before the next move is searched:
+ * by checkmate, stalemate, the fifty-move rule, threefold repetition or the
+ * GAME_MAX_PLY limit. Requires pregenerated attack tables.
+ * @param game The game.
+ * @param attacks The pregenerated attack tables.
+ * @param result Output buffer for the result, if the game has ended.
+ * @return true if the game has ended, false otherwise.
+ */
+bool
+game_over
+(   const game_t*       game
+,   const attacks_t*    attacks
+,   u8*                 result
+);
+
+/**
+ * @brief Adjudicates a game from the search score of its current position.
+ * @param game The game.
+ * @param score The search score, from white's perspective.
+ * @param result Output buffer for the result, if the game is adjudicated.
+ * @return true if the game is adjudicated, false otherwise.
+ */
+bool
+game_adjudicate
+(   game_t*     game
+,   const i32   score
+,   u8*         result
+);
+
+/**
+ * @brief Plays a move. Requires pregenerated attack tables.
+ * @param game The game.
+ * @param move The move.
+ * @param attacks The pregenerated attack tables.
+ */
+void
+game_move
+(   game_t*             game
+,   const move_t        move
+,   const attacks_t*    attacks
+);
+
+#endif  // CHESS_GAME_H
\ No newline at end of file
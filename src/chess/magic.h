@@ -3,162 +3,191 @@
  * @author Matthew Weissel (null@mattweissel.info)
  * @brief Defines literals to assist with computing magic bitboards for
  * slider piece attacks.
+ *
+ * Generated by the magic number finder (see tools/src/magic/main.c). The
+ * attacks of both slider pieces on every square share a single table. The
+ * attack for an occupancy is found at offset + ( ( ( occupancy | ~mask ) *
+ * magic ) >> shift ), where mask is the relevant occupancy mask of the
+ * square ("black" magics).
  */
 #ifndef CHESS_MAGIC_H
 #define CHESS_MAGIC_H
 
 #include "chess/common/bitboard.h"
 
-// Defines relevant occupancy count for each board square for slider pieces.
-static const u8 bishop_attack_relevant_counts[ 64 ] = { 6 , 5 , 5 , 5 , 5 , 5 , 5 , 6
-                                                      , 5 , 5 , 5 , 5 , 5 , 5 , 5 , 5
-                                                      , 5 , 5 , 7 , 7 , 7 , 7 , 5 , 5
-                                                      , 5 , 5 , 7 , 9 , 9 , 7 , 5 , 5
-                                                      , 5 , 5 , 7 , 9 , 9 , 7 , 5 , 5
-                                                      , 5 , 5 , 7 , 7 , 7 , 7 , 5 , 5
-                                                      , 5 , 5 , 5 , 5 , 5 , 5 , 5 , 5
-                                                      , 6 , 5 , 5 , 5 , 5 , 5 , 5 , 6
-                                                      };
-static const u8 rook_attack_relevant_counts[ 64 ] = { 12 , 11 , 11 , 11 , 11 , 11 , 11 , 12
-                                                    , 11 , 10 , 10 , 10 , 10 , 10 , 10 , 11
-                                                    , 11 , 10 , 10 , 10 , 10 , 10 , 10 , 11
-                                                    , 11 , 10 , 10 , 10 , 10 , 10 , 10 , 11
-                                                    , 11 , 10 , 10 , 10 , 10 , 10 , 10 , 11
-                                                    , 11 , 10 , 10 , 10 , 10 , 10 , 10 , 11
-                                                    , 11 , 10 , 10 , 10 , 10 , 10 , 10 , 11
-                                                    , 12 , 11 , 11 , 11 , 11 , 11 , 11 , 12
-                                                    };
+// Defines the length of the shared slider attack table.
+#define MAGIC_TABLE_LENGTH 105638
+
+// Defines the index shift for each board square for slider pieces.
+static const u8 bishop_attack_shifts[ 64 ] = { 58 , 59 , 59 , 59 , 59 , 59 , 59 , 58
+                                             , 59 , 59 , 59 , 59 , 59 , 59 , 59 , 59
+                                             , 59 , 59 , 57 , 57 , 57 , 57 , 59 , 59
+                                             , 59 , 59 , 57 , 55 , 55 , 57 , 59 , 59
+                                             , 59 , 59 , 57 , 55 , 55 , 57 , 59 , 59
+                                             , 59 , 59 , 57 , 57 , 57 , 57 , 59 , 59
+                                             , 59 , 59 , 59 , 59 , 59 , 59 , 59 , 59
+                                             , 58 , 59 , 59 , 59 , 59 , 59 , 59 , 58
+                                             };
+static const u8 rook_attack_shifts[ 64 ] = { 52 , 53 , 53 , 53 , 53 , 53 , 53 , 52
+                                           , 53 , 54 , 54 , 54 , 54 , 54 , 54 , 53
+                                           , 53 , 54 , 54 , 54 , 54 , 54 , 54 , 53
+                                           , 53 , 54 , 54 , 54 , 54 , 54 , 54 , 53
+                                           , 53 , 54 , 54 , 54 , 54 , 54 , 54 , 53
+                                           , 53 , 54 , 54 , 54 , 54 , 54 , 54 , 53
+                                           , 53 , 54 , 54 , 54 , 54 , 54 , 54 , 53
+                                           , 52 , 53 , 53 , 53 , 53 , 53 , 53 , 52
+                                           };
+
+// Defines the table offset for each board square for slider pieces.
+static const i32 bishop_attack_offsets[ 64 ] = {   63852 ,   13456 ,   13331 ,   12311 ,  105550 ,   13397 ,   12692 ,   63818
+                                               ,   13079 ,   12756 ,   12820 ,   64920 ,   12375 ,   12445 ,   13520 ,   13586
+                                               ,   12502 ,   12572 ,  105033 ,   64793 ,  104275 ,  105280 ,   61520 ,   61584
+                                               ,   61711 ,  101584 ,  104401 ,  102100 ,  102612 ,  104654 ,  105578 ,  101361
+                                               ,   61777 ,  101614 ,  104780 ,  103124 ,  103635 ,  104147 ,  101644 ,   61394
+                                               ,   12884 ,   12948 ,  105156 ,  104906 ,  104529 ,  105396 ,   61839 ,   12630
+                                               ,   13648 ,   13714 ,   61457 ,  101874 ,   61648 ,   13139 ,   13274 ,   13776
+                                               ,   63777 ,   13840 ,  105610 ,  105524 ,   13203 ,   13012 ,   13912 ,   64307
+                                               };
+static const i32 rook_attack_offsets[ 64 ] = {    4095 ,   16351 ,   32734 ,   34781 ,   36828 ,   18399 ,   38875 ,       0
+                                             ,   40920 ,   65389 ,   66413 ,   67437 ,   94038 ,   68461 ,   97104 ,   20447
+                                             ,   22495 ,   69485 ,   70509 ,   71533 ,   72557 ,   73581 ,   74605 ,   24543
+                                             ,   26591 ,   82797 ,   75629 ,   83819 ,   84842 ,   76653 ,   77677 ,   28639
+                                             ,   51151 ,   78701 ,   85859 ,   79725 ,   86882 ,   87905 ,   80749 ,   30687
+                                             ,   42965 ,   88927 ,   89950 ,   81773 ,   90972 ,   91995 ,  101115 ,   45012
+                                             ,   57280 ,  100156 ,   99139 ,   98124 ,   95060 ,   93016 ,   96083 ,   63351
+                                             ,   12255 ,   61334 ,   59313 ,   53198 ,   47059 ,   49104 ,   55243 ,    8183
+                                             };
 
 // Defines magic bitboards for slider pieces.
-static const bitboard_t bitboard_magic_bishops[ 64 ] = { 0x89A1121896040240ULL
-                                                       , 0x2004844802002010ULL
-                                                       , 0x2068080051921000ULL
-                                                       , 0x62880A0220200808ULL
-                                                       , 0x4042004000000ULL
-                                                       , 0x100822020200011ULL
-                                                       , 0xC00444222012000AULL
-                                                       , 0x28808801216001ULL
-                                                       , 0x400492088408100ULL
-                                                       , 0x201C401040C0084ULL
-                                                       , 0x840800910A0010ULL
-                                                       , 0x82080240060ULL
-                                                       , 0x2000840504006000ULL
-                                                       , 0x30010C4108405004ULL
-                                                       , 0x1008005410080802ULL
-                                                       , 0x8144042209100900ULL
-                                                       , 0x208081020014400ULL
-                                                       , 0x4800201208CA00ULL
-                                                       , 0xF18140408012008ULL
-                                                       , 0x1004002802102001ULL
-                                                       , 0x841000820080811ULL
-                                                       , 0x40200200A42008ULL
-                                                       , 0x800054042000ULL
-                                                       , 0x88010400410C9000ULL
-                                                       , 0x520040470104290ULL
-                                                       , 0x1004040051500081ULL
-                                                       , 0x2002081833080021ULL
-                                                       , 0x400C00C010142ULL
-                                                       , 0x941408200C002000ULL
-                                                       , 0x658810000806011ULL
-                                                       , 0x188071040440A00ULL
-                                                       , 0x4800404002011C00ULL
-                                                       , 0x104442040404200ULL
-                                                       , 0x511080202091021ULL
-                                                       , 0x4022401120400ULL
-                                                       , 0x80C0040400080120ULL
-                                                       , 0x8040010040820802ULL
-                                                       , 0x480810700020090ULL
-                                                       , 0x102008E00040242ULL
-                                                       , 0x809005202050100ULL
-                                                       , 0x8002024220104080ULL
-                                                       , 0x431008804142000ULL
-                                                       , 0x19001802081400ULL
-                                                       , 0x200014208040080ULL
-                                                       , 0x3308082008200100ULL
-                                                       , 0x41010500040C020ULL
-                                                       , 0x4012020C04210308ULL
-                                                       , 0x208220A202004080ULL
-                                                       , 0x111040120082000ULL
-                                                       , 0x6803040141280A00ULL
-                                                       , 0x2101004202410000ULL
-                                                       , 0x8200000041108022ULL
-                                                       , 0x21082088000ULL
-                                                       , 0x2410204010040ULL
-                                                       , 0x40100400809000ULL
-                                                       , 0x822088220820214ULL
-                                                       , 0x40808090012004ULL
-                                                       , 0x910224040218C9ULL
-                                                       , 0x402814422015008ULL
-                                                       , 0x90014004842410ULL
-                                                       , 0x1000042304105ULL
-                                                       , 0x10008830412A00ULL
-                                                       , 0x2520081090008908ULL
-                                                       , 0x40102000A0A60140ULL
+static const bitboard_t bitboard_magic_bishops[ 64 ] = { 0x1806040102120409ULL
+                                                       , 0x402440400900318ULL
+                                                       , 0x1524008890014700ULL
+                                                       , 0x103030460010809ULL
+                                                       , 0x1860242049500ULL
+                                                       , 0x200124428100C021ULL
+                                                       , 0x111210118010061ULL
+                                                       , 0x1000521203040080ULL
+                                                       , 0x821A890814109012ULL
+                                                       , 0x40060AB2100840ULL
+                                                       , 0x210812A1200606ULL
+                                                       , 0x8820082060080000ULL
+                                                       , 0x400018582020000ULL
+                                                       , 0xA00400A2A4008008ULL
+                                                       , 0x8A00840403C0ULL
+                                                       , 0x1514004042084008ULL
+                                                       , 0x1000080EA8A006ULL
+                                                       , 0x9428000424119010ULL
+                                                       , 0x410020802481404ULL
+                                                       , 0x8004210206020181ULL
+                                                       , 0x4201010820400018ULL
+                                                       , 0x800600030100048ULL
+                                                       , 0xD0808154888009ULL
+                                                       , 0x200A00824A01000ULL
+                                                       , 0x2041000A1128040ULL
+                                                       , 0x820000601A041ULL
+                                                       , 0x800C020030208008ULL
+                                                       , 0x810200A098008020ULL
+                                                       , 0x1003001023004000ULL
+                                                       , 0x4021020000380040ULL
+                                                       , 0x203040000518080ULL
+                                                       , 0x1020100495040ULL
+                                                       , 0x1200112480900402ULL
+                                                       , 0x8040500348860804ULL
+                                                       , 0x648009D001180060ULL
+                                                       , 0x20080180480ULL
+                                                       , 0x4004001008920080ULL
+                                                       , 0x26460A0208041000ULL
+                                                       , 0x84C0C1020804ULL
+                                                       , 0x80040D588010080ULL
+                                                       , 0x10D21841000ULL
+                                                       , 0xA0042509140400ULL
+                                                       , 0x204001A828005000ULL
+                                                       , 0x690010080A10800ULL
+                                                       , 0x20100A032000100ULL
+                                                       , 0x40004800310060ULL
+                                                       , 0x811810A20544ULL
+                                                       , 0x80852944410080ULL
+                                                       , 0x20880888A000ULL
+                                                       , 0x1000021202034420ULL
+                                                       , 0x490A402D2080010ULL
+                                                       , 0x1092500582430201ULL
+                                                       , 0x10400115014000ULL
+                                                       , 0x14A01414200ULL
+                                                       , 0x418102028501020AULL
+                                                       , 0x40A22202202008ULL
+                                                       , 0x80882080E0250ULL
+                                                       , 0x800082484240ULL
+                                                       , 0x20000000401A4420ULL
+                                                       , 0x10240080406020C4ULL
+                                                       , 0x10040200854140ULL
+                                                       , 0x61C00800288240A0ULL
+                                                       , 0x400200C20224012AULL
+                                                       , 0x1222000101010C11ULL
                                                        };
-static const bitboard_t bitboard_magic_rooks[ 64 ] = { 0xA8002C000108020ULL
-                                                     , 0x6C00049B0002001ULL
-                                                     , 0x100200010090040ULL
-                                                     , 0x2480041000800801ULL
-                                                     , 0x280028004000800ULL
-                                                     , 0x900410008040022ULL
-                                                     , 0x280020001001080ULL
-                                                     , 0x2880002041000080ULL
-                                                     , 0xA000800080400034ULL
-                                                     , 0x4808020004000ULL
-                                                     , 0x2290802004801000ULL
-                                                     , 0x411000D00100020ULL
-                                                     , 0x402800800040080ULL
-                                                     , 0xB000401004208ULL
-                                                     , 0x2409000100040200ULL
-                                                     , 0x1002100004082ULL
-                                                     , 0x22878001E24000ULL
-                                                     , 0x1090810021004010ULL
-                                                     , 0x801030040200012ULL
-                                                     , 0x500808008001000ULL
-                                                     , 0xA08018014000880ULL
-                                                     , 0x8000808004000200ULL
-                                                     , 0x201008080010200ULL
-                                                     , 0x801020000441091ULL
-                                                     , 0x800080204005ULL
-                                                     , 0x1040200040100048ULL
-                                                     , 0x120200402082ULL
-                                                     , 0xD14880480100080ULL
-                                                     , 0x12040280080080ULL
-                                                     , 0x100040080020080ULL
-                                                     , 0x9020010080800200ULL
-                                                     , 0x813241200148449ULL
-                                                     , 0x491604001800080ULL
-                                                     , 0x100401000402001ULL
-                                                     , 0x4820010021001040ULL
-                                                     , 0x400402202000812ULL
-                                                     , 0x209009005000802ULL
-                                                     , 0x810800601800400ULL
-                                                     , 0x4301083214000150ULL
-                                                     , 0x204026458E001401ULL
-                                                     , 0x40204000808000ULL
-                                                     , 0x8001008040010020ULL
-                                                     , 0x8410820820420010ULL
-                                                     , 0x1003001000090020ULL
-                                                     , 0x804040008008080ULL
-                                                     , 0x12000810020004ULL
-                                                     , 0x1000100200040208ULL
-                                                     , 0x430000A044020001ULL
-                                                     , 0x280009023410300ULL
-                                                     , 0xE0100040002240ULL
-                                                     , 0x200100401700ULL
-                                                     , 0x2244100408008080ULL
-                                                     , 0x8000400801980ULL
-                                                     , 0x2000810040200ULL
-                                                     , 0x8010100228810400ULL
-                                                     , 0x2000009044210200ULL
-                                                     , 0x4080008040102101ULL
-                                                     , 0x40002080411D01ULL
-                                                     , 0x2005524060000901ULL
-                                                     , 0x502001008400422ULL
-                                                     , 0x489A000810200402ULL
-                                                     , 0x1004400080A13ULL
-                                                     , 0x4000011008020084ULL
-                                                     , 0x26002114058042ULL
+static const bitboard_t bitboard_magic_rooks[ 64 ] = { 0x1080022880C00006ULL
+                                                     , 0x40002000300042ULL
+                                                     , 0x1000D2001000240ULL
+                                                     , 0x2600051040220001ULL
+                                                     , 0x100040800110001ULL
+                                                     , 0x4100087C000A0100ULL
+                                                     , 0x24000901B8005004ULL
+                                                     , 0x20004018100204AULL
+                                                     , 0x8204004401810201ULL
+                                                     , 0xA001400020100245ULL
+                                                     , 0x8862002A01204080ULL
+                                                     , 0x800802801001ULL
+                                                     , 0x3002000C86000220ULL
+                                                     , 0x2001048042200ULL
+                                                     , 0x44002A69480050ULL
+                                                     , 0x1001001040820100ULL
+                                                     , 0x470025008000ULL
+                                                     , 0xC008444001201000ULL
+                                                     , 0x145010034200040ULL
+                                                     , 0x4816020028205040ULL
+                                                     , 0x10808014000800ULL
+                                                     , 0x800808002000400ULL
+                                                     , 0x100C40001688210ULL
+                                                     , 0x11820004002083ULL
+                                                     , 0x846080024000ULL
+                                                     , 0x40018100310010ULL
+                                                     , 0x90100280200080ULL
+                                                     , 0x100504200220006ULL
+                                                     , 0x12A0010100080010ULL
+                                                     , 0x2010400801200410ULL
+                                                     , 0x4180C80C00100102ULL
+                                                     , 0x35040200008421ULL
+                                                     , 0xC120001030100800ULL
+                                                     , 0xC810002004404000ULL
+                                                     , 0xC000908C1002000ULL
+                                                     , 0x80080801000ULL
+                                                     , 0x800010013001800ULL
+                                                     , 0x10007002400ULL
+                                                     , 0x225C800100800200ULL
+                                                     , 0x5840548102000A44ULL
+                                                     , 0x80A010E1000ULL
+                                                     , 0x14C0001008082000ULL
+                                                     , 0x110000800182000ULL
+                                                     , 0x101000850010022ULL
+                                                     , 0x90022002000E0018ULL
+                                                     , 0x8108010004010018ULL
+                                                     , 0xC1C8004120404002ULL
+                                                     , 0x4000002901620004ULL
+                                                     , 0x1C00A2004130ULL
+                                                     , 0x10008A084510200ULL
+                                                     , 0x20224431600ULL
+                                                     , 0x10A2000021109A00ULL
+                                                     , 0x200002000D202600ULL
+                                                     , 0x104010004000900ULL
+                                                     , 0x4220100049014400ULL
+                                                     , 0x14200098D080060ULL
+                                                     , 0x8800008414217046ULL
+                                                     , 0xA00004508100402AULL
+                                                     , 0x800041208C12ULL
+                                                     , 0x1902000118844012ULL
+                                                     , 0x2005000084380011ULL
+                                                     , 0x808200100088244AULL
+                                                     , 0x40004801300484ULL
+                                                     , 0x200000822841042ULL
                                                      };
 
-#endif  // CHESS_MAGIC_H
+#endif  // CHESS_MAGIC_H
\ No newline at end of file
@@ -0,0 +1,449 @@
+/**
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @file match.c
+ * @brief Implementation of the match header.
+ * (see match.h for additional details)
+ */
+#include "chess/match.h"
+
+#include "chess/board.h"
+#include "chess/fen.h"
+#include "chess/game.h"
+#include "chess/move.h"
+
+#include "core/logger.h"
+#include "core/memory.h"
+#include "core/string.h"
+
+#include "math/math.h"
+
+#include "platform/filesystem.h"
+
+// Type definition for the state of a match worker thread.
+typedef struct
+{
+    match_t*            match;
+    move_search_t*      search[ 2 ];
+    game_t              game;
+    bool                done;
+}
+match_worker_t;
+
+/**
+ * @brief Worker thread entry point. Plays game pairs until the requested
+ * number of pairs have been claimed.
+ * @param args A match_worker_t.
+ * @return 0.
+ */
+u32
+match_worker
+(   void* args
+);
+
+/**
+ * @brief Plays a single game.
+ * @param worker The worker.
+ * @param opening The starting position.
+ * @param white The engine playing white (0 for A, 1 for B).
+ * @return The result for white: 0 (loss), 1 (draw) or 2 (win).
+ */
+u8
+match_game
+(   match_worker_t* worker
+,   const board_t*  opening
+,   const u32       white
+);
+
+/**
+ * @brief Sets up the opening of a game pair.
+ * @param match The match.
+ * @param pair The pair index.
+ * @param board Output buffer.
+ */
+void
+match_opening
+(   const match_t*  match
+,   const u64       pair
+,   board_t*        board
+);
+
+/**
+ * @brief Converts an expected score to an Elo difference.
+ * @param score The expected score (between 0 and 1, exclusive).
+ * @return The Elo difference.
+ */
+INLINE
+f64
+match_elo
+(   const f64 score
+)
+{
+    return -400.0 * log ( 1.0 / score - 1.0 ) / LN10;
+}
+
+/**
+ * @brief Converts an Elo difference to an expected score.
+ * @param elo The Elo difference.
+ * @return The expected score.
+ */
+INLINE
+f64
+match_score
+(   const f64 elo
+)
+{
+    return 1.0 / ( 1.0 + exp ( -elo * LN10 / 400.0 ) );
+}
+
+u64
+match_memory_requirement
+(   const u32 thread_count
+)
+{
+    return thread_count * ( sizeof ( match_worker_t ) + 2 * sizeof ( move_search_t ) );
+}
+
+bool
+match_run
+(   match_t* match
+)
+{
+    ( *match ).next_pair = 0;
+    memory_clear ( ( *match ).pentanomial , sizeof ( ( *match ).pentanomial ) );
+    memory_clear ( ( *match ).results , sizeof ( ( *match ).results ) );
+    ( *match ).forfeits = 0;
+    ( *match ).nodes = 0;
+
+    const u32 thread_count = clamp ( ( *match ).thread_count , 1U , ( u32 ) MATCH_MAX_THREADS );
+    match_worker_t* workers = memory_allocate ( thread_count * sizeof ( match_worker_t ) , MEMORY_TAG_APPLICATION );
+    for ( u32 i = 0; i < thread_count; ++i )
+    {
+        workers[ i ].match = match;
+        for ( u32 j = 0; j < 2; ++j )
+        {
+            workers[ i ].search[ j ] = memory_allocate ( sizeof ( move_search_t ) , MEMORY_TAG_APPLICATION );
+            ( *workers[ i ].search[ j ] ).nnue = ( *match ).engines[ j ].nnue;
+            ( *workers[ i ].search[ j ] ).params = &( *match ).engines[ j ].params;
+        }
+    }
+
+    // Start the workers. The calling thread reports the progress, so every
+    // worker gets a thread of its own; the pairs are claimed one at a time,
+    // so a worker which fails to start only reduces the throughput.
+    platform_thread_t threads[ MATCH_MAX_THREADS ];
+    u32 started = 0;
+    for ( u32 i = 0; i < thread_count; ++i )
+    {
+        if ( !platform_thread_create ( match_worker , &workers[ i ] , &threads[ i ] ) )
+        {
+            threads[ i ].handle = 0;
+            workers[ i ].done = true;
+            continue;
+        }
+        started += 1;
+    }
+    if ( started && started < thread_count )
+    {
+        LOGWARN ( "match_run: Started %u of %u worker threads." , started , thread_count );
+    }
+
+    // Wait for the workers.
+    for (;;)
+    {
+        bool done = true;
+        for ( u32 i = 0; i < thread_count; ++i )
+        {
+            done &= __atomic_load_n ( &workers[ i ].done , __ATOMIC_ACQUIRE );
+        }
+        if ( done )
+        {
+            break;
+        }
+        if ( ( *match ).progress && !( *match ).progress ( ( *match ).progress_args ) )
+        {
+            // Stop handing out pairs.
+            __atomic_store_n ( &( *match ).next_pair , ( *match ).pairs , __ATOMIC_RELAXED );
+        }
+        platform_sleep ( MATCH_PROGRESS_INTERVAL );
+    }
+    for ( u32 i = 0; i < thread_count; ++i )
+    {
+        if ( threads[ i ].handle )
+        {
+            platform_thread_join ( &threads[ i ] );
+        }
+    }
+
+    for ( u32 i = 0; i < thread_count; ++i )
+    {
+        for ( u32 j = 0; j < 2; ++j )
+        {
+            memory_free ( workers[ i ].search[ j ] , sizeof ( move_search_t ) , MEMORY_TAG_APPLICATION );
+        }
+    }
+    memory_free ( workers , thread_count * sizeof ( match_worker_t ) , MEMORY_TAG_APPLICATION );
+    if ( !started )
+    {
+        LOGERROR ( "match_run: Failed to start any worker threads." );
+    }
+    return started;
+}
+
+void
+match_stats
+(   const match_t*  match
+,   const f64       elo0
+,   const f64       elo1
+,   match_stats_t*  stats
+)
+{
+    u64 counts[ 5 ];
+    u64 pairs = 0;
+    for ( u32 i = 0; i < 5; ++i )
+    {
+        counts[ i ] = __atomic_load_n ( &( *match ).pentanomial[ i ] , __ATOMIC_RELAXED );
+        pairs += counts[ i ];
+    }
+    memory_clear ( stats , sizeof ( match_stats_t ) );
+    ( *stats ).pairs = pairs;
+    ( *stats ).score = 0.5;
+    if ( !pairs )
+    {
+        return;
+    }
+
+    // Mean and variance of the score per game, over the game pairs.
+    f64 mean = 0;
+    for ( u32 i = 0; i < 5; ++i )
+    {
+        mean += counts[ i ] * ( i / 4.0 );
+    }
+    mean /= pairs;
+    f64 variance = 0;
+    for ( u32 i = 0; i < 5; ++i )
+    {
+        variance += counts[ i ] * ( i / 4.0 - mean ) * ( i / 4.0 - mean );
+    }
+    variance /= pairs;
+    ( *stats ).score = mean;
+
+    // Elo difference, with a 95% confidence interval. A score of 0 or 1 is
+    // clamped to keep the estimate finite.
+    const f64 epsilon = 1.0 / ( 4 * pairs + 1 );
+    const f64 score = clamp ( mean , epsilon , 1.0 - epsilon );
+    const f64 error = 1.959964 * sqrt ( variance / pairs );
+    ( *stats ).elo = match_elo ( score );
+    ( *stats ).elo_error = ( match_elo ( clamp ( score + error , epsilon , 1.0 - epsilon ) )
+                           - match_elo ( clamp ( score - error , epsilon , 1.0 - epsilon ) )
+                           ) / 2;
+
+    // Generalized SPRT log-likelihood ratio (normal approximation).
+    if ( variance > 0 )
+    {
+        const f64 s0 = match_score ( elo0 );
+        const f64 s1 = match_score ( elo1 );
+        ( *stats ).llr = pairs * ( s1 - s0 ) * ( 2 * mean - s0 - s1 ) / ( 2 * variance );
+    }
+}
+
+u64
+match_openings_memory_requirement
+(   const char* filepath
+)
+{
+    file_handle_t file;
+    u64 size;
+    if (    dataset_filepath ( filepath )
+         || !file_open ( filepath , FILE_MODE_READ , false , &file )
+       )
+    {
+        return 0;
+    }
+    if ( !file_size ( &file , &size ) )
+    {
+        size = 0;
+    }
+    file_close ( &file );
+    return ( size / MATCH_OPENING_MIN_LENGTH + 1 ) * sizeof ( board_packed_t );
+}
+
+bool
+match_openings_open
+(   const char*         filepath
+,   match_openings_t*   openings
+)
+{
+    memory_clear ( openings , sizeof ( match_openings_t ) );
+    if ( dataset_filepath ( filepath ) )
+    {
+        if ( !dataset_open ( filepath , &( *openings ).dataset ) )
+        {
+            LOGERROR ( "match_openings_open: Failed to open openings '%s'." , filepath );
+            return false;
+        }
+        ( *openings ).records = ( *openings ).dataset.records;
+        ( *openings ).count = ( *openings ).dataset.record_count;
+        return true;
+    }
+
+    file_handle_t file;
+    if ( !file_open ( filepath , FILE_MODE_READ , false , &file ) )
+    {
+        LOGERROR ( "match_openings_open: Failed to open openings '%s'." , filepath );
+        return false;
+    }
+    ( *openings ).capacity = match_openings_memory_requirement ( filepath );
+    ( *openings ).buffer = memory_allocate ( ( *openings ).capacity , MEMORY_TAG_APPLICATION );
+    ( *openings ).records = ( *openings ).buffer;
+    const u64 max_count = ( *openings ).capacity / sizeof ( board_packed_t );
+
+    u32 skipped = 0;
+    char* line;
+    while ( ( *openings ).count < max_count && file_read_line ( &file , &line ) )
+    {
+        const char* s = line;
+        while ( *s && whitespace ( *s ) )
+        {
+            s += 1;
+        }
+        if ( *s && *s != '#' )
+        {
+            if ( board_packed_parse ( s , &( *openings ).buffer[ ( *openings ).count ] ) )
+            {
+                ( *openings ).count += 1;
+            }
+            else
+            {
+                skipped += 1;
+            }
+        }
+        string_free ( line );
+    }
+    file_close ( &file );
+
+    if ( skipped )
+    {
+        LOGWARN ( "match_openings_open: Skipped %u invalid lines." , skipped );
+    }
+    return true;
+}
+
+void
+match_openings_close
+(   match_openings_t* openings
+)
+{
+    if ( ( *openings ).buffer )
+    {
+        memory_free ( ( *openings ).buffer , ( *openings ).capacity , MEMORY_TAG_APPLICATION );
+    }
+    else if ( ( *openings ).records )
+    {
+        dataset_close ( &( *openings ).dataset );
+    }
+    memory_clear ( openings , sizeof ( match_openings_t ) );
+}
+
+u32
+match_worker
+(   void* args
+)
+{
+    match_worker_t* worker = args;
+    match_t* match = ( *worker ).match;
+    board_t opening;
+    u64 pair;
+    while ( ( pair = __atomic_fetch_add ( &( *match ).next_pair , 1 , __ATOMIC_RELAXED ) ) < ( *match ).pairs )
+    {
+        match_opening ( match , pair , &opening );
+        u32 score = 0;
+        for ( u32 white = 0; white < 2; ++white )
+        {
+            const u8 result = match_game ( worker , &opening , white );
+            const u8 result_a = ( white ) ? 2 - result : result;
+            __atomic_fetch_add ( &( *match ).results[ result_a ] , 1 , __ATOMIC_RELAXED );
+            score += result_a;
+        }
+        __atomic_fetch_add ( &( *match ).pentanomial[ score ] , 1 , __ATOMIC_RELAXED );
+    }
+    __atomic_store_n ( &( *worker ).done , true , __ATOMIC_RELEASE );
+    return 0;
+}
+
+u8
+match_game
+(   match_worker_t* worker
+,   const board_t*  opening
+,   const u32       white
+)
+{
+    match_t* match = ( *worker ).match;
+    const attacks_t* attacks = ( *match ).attacks;
+    game_t* game = &( *worker ).game;
+    const board_t* board = &( *game ).board;
+    game_start ( game , opening , 0 );
+
+    f64 remaining[ 2 ] = { ( *match ).engines[ 0 ].base , ( *match ).engines[ 1 ].base };
+    u8 result;
+    while ( !game_over ( game , attacks , &result ) )
+    {
+        // Search.
+        const u32 index = ( ( *board ).side == WHITE ) ? white : 1 - white;
+        const match_engine_t* engine = &( *match ).engines[ index ];
+        move_search_t* search = ( *worker ).search[ index ];
+        ( *search ).stop = false;
+        ( *search ).node_limit = ( *engine ).nodes;
+        ( *search ).time_limit = ( *engine ).movetime;
+        if ( ( *engine ).base )
+        {
+            const f64 allotted = min ( remaining[ index ] / MATCH_MOVES_TO_GO + ( *engine ).increment
+                                     , remaining[ index ] / 2
+                                     );
+            ( *search ).time_limit = ( ( *search ).time_limit ) ? min ( ( *search ).time_limit , allotted )
+                                                                : allotted
+                                                                ;
+        }
+        clock_t clock;
+        clock_start ( &clock );
+        const move_t move = board_best_move ( board , attacks , ( *engine ).depth , search );
+        clock_update ( &clock );
+        __atomic_fetch_add ( &( *match ).nodes , ( *search ).result.nodes , __ATOMIC_RELAXED );
+        if ( ( *engine ).base )
+        {
+            remaining[ index ] -= clock.elapsed;
+            if ( remaining[ index ] <= 0 )
+            {
+                __atomic_fetch_add ( &( *match ).forfeits , 1 , __ATOMIC_RELAXED );
+                return ( ( *board ).side == WHITE ) ? 0 : 2;
+            }
+            remaining[ index ] += ( *engine ).increment;
+        }
+
+        const i32 score = ( ( *board ).side == WHITE ) ? ( *search ).result.score : -( *search ).result.score;
+        if ( game_adjudicate ( game , score , &result ) )
+        {
+            break;
+        }
+        game_move ( game , move , attacks );
+    }
+    return result;
+}
+
+void
+match_opening
+(   const match_t*  match
+,   const u64       pair
+,   board_t*        board
+)
+{
+    if ( ( *match ).opening_count )
+    {
+        if ( !board_unpack ( board , &( *match ).openings[ pair % ( *match ).opening_count ] ) )
+        {
+            fen_parse ( FEN_START , board );
+        }
+        return;
+    }
+
+    game_opening_random ( board , ( *match ).attacks , ( *match ).seed , pair , ( *match ).random_plies );
+}
\ No newline at end of file
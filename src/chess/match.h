@@ -0,0 +1,189 @@
+/**
+ * @file match.h
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Engine matches between two search configurations.
+ *
+ * A match plays game pairs between two engine configurations, A and B, in
+ * parallel across worker threads. Both games of a pair start from the same
+ * opening, with the engines swapping colours. The openings are taken in turn
+ * from a list of packed position records (see packed.h), or, without one, are
+ * made of random legal moves from the starting position, seeded by the pair
+ * index. Each engine has its own search parameters (see param.h), network,
+ * and node, move time, depth or clock limits.
+ *
+ * A game ends by loss on time, or as any engine game does (see game.h):
+ * by checkmate, stalemate, the fifty-move rule, threefold repetition, or
+ * adjudication.
+ *
+ * The Elo difference between the engines and its 95% confidence interval are
+ * estimated from the score of each game pair (the pentanomial distribution),
+ * which accounts for the correlation between the two games of an opening.
+ * The generalized sequential probability ratio test (GSPRT) log-likelihood
+ * ratio of H1: elo = elo1 against H0: elo = elo0 is computed alongside.
+ */
+#ifndef CHESS_MATCH_H
+#define CHESS_MATCH_H
+
+#include "chess/common.h"
+#include "chess/best.h"
+#include "chess/packed.h"
+
+// Defines the interval between two calls of the progress callback (ms).
+#define MATCH_PROGRESS_INTERVAL 10
+
+// Defines the share of its remaining time an engine spends on a move under a
+// clock (1 / MATCH_MOVES_TO_GO of it, plus the increment, but never more than
+// half of it).
+#define MATCH_MOVES_TO_GO       20
+
+// Defines the maximum number of worker threads.
+#define MATCH_MAX_THREADS       64
+
+// Defines the length of the shortest line holding a position (see
+// match_openings_open).
+#define MATCH_OPENING_MIN_LENGTH 16
+
+// Type definition for a match progress callback. Returns false to stop the
+// match (the games in progress are played out).
+typedef bool ( *PFN_match_progress )( void* args );
+
+// Type definition for an engine configuration.
+typedef struct
+{
+    const nnue_t*       nnue;           // Optional.
+    search_params_t     params;
+    u64                 nodes;          // Per move (0 for no limit).
+    f64                 movetime;       // Per move, in seconds (0 for no limit).
+    u32                 depth;          // Per move.
+    f64                 base;           // Clock, in seconds (0 for no clock).
+    f64                 increment;      // Clock increment, in seconds.
+}
+match_engine_t;
+
+// Type definition for a match.
+typedef struct
+{
+    // Configuration.
+    match_engine_t          engines[ 2 ];
+    const attacks_t*        attacks;
+    const board_packed_t*   openings;       // Optional.
+    u64                     opening_count;
+    u64                     random_plies;   // Without openings.
+    u64                     seed;           // Without openings.
+    u64                     pairs;
+    u32                     thread_count;
+
+    // Progress callback (optional). If set, it is called with progress_args
+    // every MATCH_PROGRESS_INTERVAL ms on the thread running the match.
+    PFN_match_progress      progress;
+    void*                   progress_args;
+
+    // Progress (updated atomically while the match runs). pentanomial[ i ]
+    // counts the game pairs in which engine A scored i half points;
+    // results[ i ] counts the games which engine A lost, drew or won.
+    u64                     next_pair;
+    u64                     pentanomial[ 5 ];
+    u64                     results[ 3 ];
+    u64                     forfeits;
+    u64                     nodes;
+}
+match_t;
+
+// Type definition for a set of openings, read from a FEN/EPD file or a
+// packed dataset.
+typedef struct
+{
+    const board_packed_t*   records;
+    u64                     count;
+
+    // Storage.
+    dataset_t               dataset;        // Packed dataset.
+    board_packed_t*         buffer;         // FEN/EPD file.
+    u64                     capacity;
+}
+match_openings_t;
+
+// Type definition for the statistics of a match.
+typedef struct
+{
+    u64                 pairs;
+    f64                 score;          // Engine A's mean score per game.
+    f64                 elo;
+    f64                 elo_error;      // Half-width of the 95% confidence interval.
+    f64                 llr;            // GSPRT log-likelihood ratio.
+}
+match_stats_t;
+
+/**
+ * @brief Computes the memory requirement of match_run (see memory_startup).
+ * @param thread_count The number of worker threads.
+ * @return The number of bytes match_run allocates.
+ */
+u64
+match_memory_requirement
+(   const u32 thread_count
+);
+
+/**
+ * @brief Plays a match. Clears the progress counters first. Blocks until
+ * every game pair has been played (or the progress callback stops the match).
+ * Requires pregenerated attack tables.
+ * @param match The match.
+ * @return false if no worker thread could be started, true otherwise.
+ */
+bool
+match_run
+(   match_t* match
+);
+
+/**
+ * @brief Computes the statistics of a match so far. May be called while the
+ * match runs.
+ * @param match The match.
+ * @param elo0 GSPRT H0 Elo difference.
+ * @param elo1 GSPRT H1 Elo difference.
+ * @param stats Output buffer.
+ */
+void
+match_stats
+(   const match_t*  match
+,   const f64       elo0
+,   const f64       elo1
+,   match_stats_t*  stats
+);
+
+/**
+ * @brief Computes the memory requirement of match_openings_open (see
+ * memory_startup).
+ * @param filepath The openings filepath.
+ * @return The number of bytes match_openings_open allocates.
+ */
+u64
+match_openings_memory_requirement
+(   const char* filepath
+);
+
+/**
+ * @brief Opens a set of openings: a packed dataset (memory-mapped), or a
+ * FEN/EPD file with one position per line (see board_packed_parse; invalid
+ * lines are skipped).
+ * @param filepath The openings filepath.
+ * @param openings Output buffer.
+ * @return true on success, false otherwise.
+ */
+bool
+match_openings_open
+(   const char*         filepath
+,   match_openings_t*   openings
+);
+
+/**
+ * @brief Closes a set of openings.
+ * @param openings The openings.
+ */
+void
+match_openings_close
+(   match_openings_t* openings
+);
+
+#endif  // CHESS_MATCH_H
\ No newline at end of file
@@ -98,554 +98,501 @@ move_parse
     return false;
 }
 
-INLINE
-void
-moves_push
-(   moves_t*        moves
-,   const move_t    move
-)
-{
-    ( *moves ).moves[ ( *moves ).count ] = move;
-    ( *moves ).count += 1;
-}
-
-moves_t*
-moves_compute
-(   moves_t*            moves
+bool
+move_parse_san
+(   const char*         s
 ,   const board_t*      board
+,   const moves_t*      moves
 ,   const attacks_t*    attacks
+,   move_t*             move
 )
 {
-    SQUARE src;
-    SQUARE dst;
+    const bool white = ( *board ).side == WHITE;
 
-    bitboard_t pieces;
-    bitboard_t attack;
+    // Strip check, mate and annotation suffixes.
+    u64 len = string_length_clamp ( s , MOVE_SAN_STRING_MAX_LENGTH + 1 );
+    while ( len && (    s[ len - 1 ] == '+' || s[ len - 1 ] == '#'
+                     || s[ len - 1 ] == '!' || s[ len - 1 ] == '?'
+                   ))
+    {
+        len -= 1;
+    }
+    if ( len < 2 || len > MOVE_SAN_STRING_MAX_LENGTH )
+    {
+        return false;
+    }
 
-    ( *moves ).count = 0;
+    PIECE piece = ( white ) ? P : p;
+    PIECE promotion = 0;
+    SQUARE dst = NO_SQ;
+    i32 src_file = -1;
+    i32 src_rank = -1;
 
-    for ( PIECE piece = P; piece <= k; ++piece )
+    // Castling.
+    if (   ( len == 3 || len == 5 )
+        && ( s[ 0 ] == 'O' || s[ 0 ] == '0' )
+        && s[ 1 ] == '-'
+       )
+    {
+        piece = ( white ) ? K : k;
+        dst = ( len == 3 ) ? ( ( white ) ? G1 : G8 )
+                           : ( ( white ) ? C1 : C8 )
+                           ;
+    }
+    else
     {
-        pieces = ( *board ).pieces[ piece ];
+        u64 i = 0;
+        u64 end = len;
+
+        // Moving piece.
+        switch ( s[ 0 ] )
+        {
+            case 'N': piece = ( white ) ? N : n; i += 1; break;
+            case 'B': piece = ( white ) ? B : b; i += 1; break;
+            case 'R': piece = ( white ) ? R : r; i += 1; break;
+            case 'Q': piece = ( white ) ? Q : q; i += 1; break;
+            case 'K': piece = ( white ) ? K : k; i += 1; break;
+            default:                                     break;
+        }
 
-        // White pawn and castling moves.
-        if ( ( *board ).side == WHITE )
+        // Promotion (with or without '=').
+        const char last = s[ end - 1 ];
+        if ( last == 'N' || last == 'B' || last == 'R' || last == 'Q' )
         {
-            // Pawn.
-            if ( piece == P )
+            switch ( last )
             {
-                while ( pieces )
-                {
-                    src = bitboard_lsb ( pieces );
-                    dst = src - 8;
-
-                    // Quiet moves.
-                    if ( !( dst < A8 ) && !bit ( ( *board ).occupancies[ 2 ]
-                                                  , dst
-                                                  ))
-                    {
-                        // Promotion.
-                        if ( src >= A7 && src <= H7 )
-                        {
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , Q , 0 , 0 , 0 , 0 )
-                                       );
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , R , 0 , 0 , 0 , 0 )
-                                       );
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , B , 0 , 0 , 0 , 0 )
-                                       );
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , N , 0 , 0 , 0 , 0 )
-                                       );
-                        }
-                        else
-                        {
-                            // Push.
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , 0 , 0 , 0 , 0 , 0 )
-                                       );
-
-                            // Double push.
-                            if ( ( src >= A2 && src <= H2 ) && !bit ( ( *board ).occupancies[ 2 ]
-                                                                    , dst - 8
-                                                                    ))
-                            {
-                                moves_push ( moves
-                                           , move_encode ( src , dst - 8 , piece , 0 , 0 , 1 , 0 , 0 )
-                                           );
-                            }
-                        }
-                    }
-
-                    // Capture moves.
-                    attack = bitboard_pawn_attack ( attacks
-                                                  , src
-                                                  , ( *board ).side
-                                                  )
-                           & ( *board ).occupancies[ BLACK ]
-                           ;
-                    while ( attack )
-                    {
-                        dst = bitboard_lsb ( attack );
-
-                        // Promotion + capture.
-                        if ( src >= A7 && src <= H7 )
-                        {
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , Q , 1 , 0 , 0 , 0 )
-                                       );
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , R , 1 , 0 , 0 , 0 )
-                                       );
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , B , 1 , 0 , 0 , 0 )
-                                       );
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , N , 1 , 0 , 0 , 0 )
-                                       );
-                        }
-                        // Push + capture.
-                        else
-                        {
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , 0 , 1 , 0 , 0 , 0 )
-                                       );
-                        }
-
-                        BITCLR ( attack , dst );
-                    }
-
-                    // En passant captures.
-                    if ( ( *board ).enpassant != NO_SQ )
-                    {
-                        bitboard_t enpassant = bitboard_pawn_attack ( attacks
-                                                                    , src
-                                                                    , ( *board ).side
-                                                                    )
-                                             & bitset ( 0 , ( *board ).enpassant )
-                                             ;
-                        if ( enpassant )
-                        {
-                            const SQUARE dst_enpassant = bitboard_lsb ( enpassant );
-                            moves_push ( moves
-                                       , move_encode ( src , dst_enpassant , piece , 0 , 1 , 0 , 1 , 0 )
-                                       );
-                            
-                        }
-                    }
-
-                    BITCLR ( pieces , src );
-                }
+                case 'N': promotion = ( white ) ? N : n; break;
+                case 'B': promotion = ( white ) ? B : b; break;
+                case 'R': promotion = ( white ) ? R : r; break;
+                case 'Q': promotion = ( white ) ? Q : q; break;
             }
-            
-            // Castling moves.
-            else if ( piece == K )
+            end -= 1;
+            if ( end && s[ end - 1 ] == '=' )
             {
-                if ( ( *board ).castle & CASTLE_WK )
-                {
-                    if (   !bit ( ( *board ).occupancies[ 2 ] , F1 )
-                        && !bit ( ( *board ).occupancies[ 2 ] , G1 )
-                       )
-                    {
-                        if (   !board_square_attackable ( board , attacks , E1 , BLACK )
-                            && !board_square_attackable ( board , attacks , F1 , BLACK )
-                           )
-                        {
-                            moves_push ( moves
-                                       , move_encode ( E1 , G1 , piece , 0 , 0 , 0 , 0 , 1 )
-                                       );
-                        }
-                    }
-                }
-                if ( ( *board ).castle & CASTLE_WQ )
-                {
-                    if (   !bit ( ( *board ).occupancies[ 2 ] , D1 )
-                        && !bit ( ( *board ).occupancies[ 2 ] , C1 )
-                        && !bit ( ( *board ).occupancies[ 2 ] , B1 )
-                       )
-                    {
-                        if (   !board_square_attackable ( board , attacks , E1 , BLACK )
-                            && !board_square_attackable ( board , attacks , D1 , BLACK )
-                           )
-                        {
-                            moves_push ( moves
-                                       , move_encode ( E1 , C1 , piece , 0 , 0 , 0 , 0 , 1 )
-                                       );
-                        }
-                    }
-                }
+                end -= 1;
             }
         }
-        
-        // Black pawn and castling moves.
-        else
+
+        // Destination square.
+        if (   end < i + 2
+            || s[ end - 2 ] < 'a' || s[ end - 2 ] > 'h'
+            || s[ end - 1 ] < '1' || s[ end - 1 ] > '8'
+           )
+        {
+            return false;
+        }
+        dst = SQUAREINDX ( 8 - to_digit ( s[ end - 1 ] )
+                         , s[ end - 2 ] - 'a'
+                         );
+        end -= 2;
+
+        // Disambiguation and capture marker.
+        for ( ; i < end; ++i )
         {
-            // Pawn.
-            if ( piece == p )
+            if ( s[ i ] >= 'a' && s[ i ] <= 'h' )
             {
-                while ( pieces )
-                {
-                    src = bitboard_lsb ( pieces );
-                    dst = src + 8;
-
-                    // Quiet moves.
-                    if ( !( dst > H1 ) && !bit ( ( *board ).occupancies[ 2 ]
-                                                  , dst
-                                                  ))
-                    {
-                        // Promotion.
-                        if ( src >= A2 && src <= H2 )
-                        {
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , q , 0 , 0 , 0 , 0 )
-                                       );
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , r , 0 , 0 , 0 , 0 )
-                                       );
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , b , 0 , 0 , 0 , 0 )
-                                       );
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , n , 0 , 0 , 0 , 0 )
-                                       );
-                        }
-                        else
-                        {
-                            // Push.
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , 0 , 0 , 0 , 0 , 0 )
-                                       );
-
-                            // Double push.
-                            if ( ( src >= A7 && src <= H7 ) && !bit ( ( *board ).occupancies[ 2 ]
-                                                                    , dst + 8
-                                                                    ))
-                            {
-                                moves_push ( moves
-                                           , move_encode ( src , dst + 8 , piece , 0 , 0 , 1 , 0 , 0 )
-                                           );
-                            }
-                        }
-                    }
-
-                    // Capture moves.
-                    attack = bitboard_pawn_attack ( attacks
-                                                  , src
-                                                  , ( *board ).side
-                                                  )
-                           & ( *board ).occupancies[ WHITE ]
-                           ;
-                    while ( attack )
-                    {
-                        dst = bitboard_lsb ( attack );
-
-                        // Promotion + capture.
-                        if ( src >= A2 && src <= H2 )
-                        {
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , q , 1 , 0 , 0 , 0 )
-                                       );
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , r , 1 , 0 , 0 , 0 )
-                                       );
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , b , 1 , 0 , 0 , 0 )
-                                       );
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , n , 1 , 0 , 0 , 0 )
-                                       );
-                        }
-                        // Push + capture.
-                        else
-                        {
-                            moves_push ( moves
-                                       , move_encode ( src , dst , piece , 0 , 1 , 0 , 0 , 0 )
-                                       );
-                        }
-
-                        BITCLR ( attack , dst );
-                    }
-
-                    // En passant captures.
-                    if ( ( *board ).enpassant != NO_SQ )
-                    {
-                        bitboard_t enpassant = bitboard_pawn_attack ( attacks
-                                                                    , src
-                                                                    , ( *board ).side
-                                                                    )
-                                             & bitset ( 0 , ( *board ).enpassant )
-                                             ;
-                        if ( enpassant )
-                        {
-                            const SQUARE dst_enpassant = bitboard_lsb ( enpassant );
-                            moves_push ( moves
-                                       , move_encode ( src , dst_enpassant , piece , 0 , 1 , 0 , 1 , 0 )
-                                       );
-                            
-                        }
-                    }
-
-                    BITCLR ( pieces , src );
-                }
+                src_file = s[ i ] - 'a';
             }
-
-            // Castling moves.
-            else if ( piece == k )
+            else if ( s[ i ] >= '1' && s[ i ] <= '8' )
+            {
+                src_rank = 8 - to_digit ( s[ i ] );
+            }
+            else if ( s[ i ] != 'x' )
             {
-                if ( ( *board ).castle & CASTLE_BK )
-                {
-                    if (   !bit ( ( *board ).occupancies[ 2 ] , F8 )
-                        && !bit ( ( *board ).occupancies[ 2 ] , G8 )
-                       )
-                    {
-                        if (   !board_square_attackable ( board , attacks , E8 , WHITE )
-                            && !board_square_attackable ( board , attacks , F8 , WHITE )
-                           )
-                        {
-                            moves_push ( moves
-                                       , move_encode ( E8 , G8 , piece , 0 , 0 , 0 , 0 , 1 )
-                                       );
-                        }
-                    }
-                }
-                if ( ( *board ).castle & CASTLE_BQ )
-                {
-                    if (   !bit ( ( *board ).occupancies[ 2 ] , D8 )
-                        && !bit ( ( *board ).occupancies[ 2 ] , C8 )
-                        && !bit ( ( *board ).occupancies[ 2 ] , B8 )
-                       )
-                    {
-                        if (   !board_square_attackable ( board , attacks , E8 , WHITE )
-                            && !board_square_attackable ( board , attacks , D8 , WHITE )
-                           )
-                        {
-                            moves_push ( moves
-                                       , move_encode ( E8 , C8 , piece , 0 , 0 , 0 , 0 , 1 )
-                                       );
-                        }
-                    }
-                }
+                return false;
             }
         }
+    }
 
-        // Knight.
-        if ( ( ( *board ).side == WHITE ) ? piece == N : piece == n )
+    // Find exactly one matching legal move.
+    u32 matches = 0;
+    for ( u32 i = 0; i < ( *moves ).count; ++i )
+    {
+        const move_t move_ = ( *moves ).moves[ i ];
+        const SQUARE src = move_decode_src ( move_ );
+        if (   move_decode_piece ( move_ ) != piece
+            || move_decode_dst ( move_ ) != dst
+            || move_decode_promotion ( move_ ) != promotion
+            || ( src_file >= 0 && ( i32 )( src & 7 ) != src_file )
+            || ( src_rank >= 0 && ( i32 )( src >> 3 ) != src_rank )
+           )
         {
-            while ( pieces )
-            {
-                src = bitboard_lsb ( pieces );
-               
-                attack = bitboard_knight_attack ( attacks , src )
-                       & ( ( ( *board ).side == WHITE ) ? ~( *board ).occupancies[ WHITE ]
-                                                        : ~( *board ).occupancies[ BLACK ]
-                                                        );
-                while ( attack )
-                {
-                    dst = bitboard_lsb ( attack );
- 
-                    // Quiet move.
-                    if ( !bit ( ( ( *board ).side == WHITE ) ? ( *board ).occupancies[ BLACK ]
-                                                             : ( *board ).occupancies[ WHITE ]
-                              , dst
-                              ))
-                    {
-                        moves_push ( moves
-                                   , move_encode ( src , dst , piece , 0 , 0 , 0 , 0 , 0 )
-                                   );
-                    }
-
-                    // Capture move.
-                    else
-                    { 
-                        moves_push ( moves
-                                   , move_encode ( src , dst , piece , 0 , 1 , 0 , 0 , 0 )
-                                   );
-                    }
-
-                    BITCLR ( attack , dst );
-                }
-
-                BITCLR ( pieces , src );
-            }
+            continue;
         }
-        
-        // Bishop.
-        else if ( ( ( *board ).side == WHITE ) ? piece == B : piece == b )
+        if ( !board_move_legal ( board , move_ , attacks ) )
         {
-            while ( pieces )
-            {
-                src = bitboard_lsb ( pieces );
-               
-                attack = bitboard_bishop_attack ( attacks
-                                                , src
-                                                , ( *board ).occupancies[ 2 ]
-                                                )
-                       & ( ( ( *board ).side == WHITE ) ? ~( *board ).occupancies[ WHITE ]
-                                                        : ~( *board ).occupancies[ BLACK ]
-                                                        );
-                while ( attack )
-                {
-                    dst = bitboard_lsb ( attack );
- 
-                    // Quiet move.
-                    if ( !bit ( ( ( *board ).side == WHITE ) ? ( *board ).occupancies[ BLACK ]
-                                                             : ( *board ).occupancies[ WHITE ]
-                              , dst
-                              ))
-                    {
-                        moves_push ( moves
-                                   , move_encode ( src , dst , piece , 0 , 0 , 0 , 0 , 0 )
-                                   );
-                    }
-
-                    // Capture move.
-                    else
-                    { 
-                        moves_push ( moves
-                                   , move_encode ( src , dst , piece , 0 , 1 , 0 , 0 , 0 )
-                                   );
-                    }
-
-                    BITCLR ( attack , dst );
-                }
-
-                BITCLR ( pieces , src );
-            }
+            continue;
         }
-        
-        // Rook.
-        else if ( ( ( *board ).side == WHITE ) ? piece == R : piece == r )
+        *move = move_;
+        matches += 1;
+    }
+    return matches == 1;
+}
+
+move_t
+move_expand
+(   const move16_t  move
+,   const board_t*  board
+)
+{
+    if ( !move )
+    {
+        return 0;
+    }
+    const SQUARE src = move16_decode_src ( move );
+    const SQUARE dst = move16_decode_dst ( move );
+    const SIDE side = ( *board ).side;
+    const PIECE offset = ( side == WHITE ) ? P : p;
+
+    // Moving piece.
+    PIECE piece = offset;
+    while ( piece <= offset + K && !bit ( ( *board ).pieces[ piece ] , src ) )
+    {
+        piece += 1;
+    }
+    if ( piece > offset + K )
+    {
+        return 0;
+    }
+
+    const i32 distance = ( i32 ) dst - ( i32 ) src;
+    const bool pawn = piece == offset + P;
+    const bool enpassant = pawn && dst == ( *board ).enpassant;
+    const PIECE promotion = move16_decode_promotion ( move );
+    return move_encode ( src
+                       , dst
+                       , piece
+                       , ( promotion ) ? offset + promotion : 0
+                       , enpassant || bit ( ( *board ).occupancies[ !side ] , dst )
+                       , pawn && ( distance == 16 || distance == -16 )
+                       , enpassant
+                       , piece == offset + K && ( distance == 2 || distance == -2 )
+                       );
+}
+
+/**
+ * @brief Appends a move to a move list.
+ * @param moves The end of the move list.
+ * @param move The move to append.
+ * @return The new end of the move list.
+ */
+INLINE
+move_t*
+moves_push
+(   move_t*         moves
+,   const move_t    move
+)
+{
+    *moves = move;
+    return moves + 1;
+}
+
+/**
+ * @brief Appends a pawn move for each target square of a set.
+ * @param moves The end of the move list.
+ * @param targets The target squares.
+ * @param shift The distance from source square to target square.
+ * @param piece The pawn.
+ * @param capture Capture flag.
+ * @param double_push Double push flag.
+ * @return The new end of the move list.
+ */
+INLINE
+move_t*
+moves_push_pawns
+(   move_t*     moves
+,   bitboard_t  targets
+,   const i32   shift
+,   const PIECE piece
+,   const bool  capture
+,   const bool  double_push
+)
+{
+    while ( targets )
+    {
+        const SQUARE dst = bitboard_lsb ( targets );
+        moves = moves_push ( moves
+                           , move_encode ( dst - shift , dst , piece , 0 , capture , double_push , 0 , 0 )
+                           );
+        BITCLR ( targets , dst );
+    }
+    return moves;
+}
+
+/**
+ * @brief Appends the four promotions for each target square of a set.
+ * @param moves The end of the move list.
+ * @param targets The target squares.
+ * @param shift The distance from source square to target square.
+ * @param piece The pawn.
+ * @param capture Capture flag.
+ * @return The new end of the move list.
+ */
+INLINE
+move_t*
+moves_push_promotions
+(   move_t*     moves
+,   bitboard_t  targets
+,   const i32   shift
+,   const PIECE piece
+,   const bool  capture
+)
+{
+    const PIECE promotions[ 4 ] = { piece + Q , piece + R , piece + B , piece + N };
+    while ( targets )
+    {
+        const SQUARE dst = bitboard_lsb ( targets );
+        for ( u32 i = 0; i < 4; ++i )
         {
-            while ( pieces )
-            {
-                src = bitboard_lsb ( pieces );
-               
-                attack = bitboard_rook_attack ( attacks
-                                              , src
-                                              , ( *board ).occupancies[ 2 ]
-                                              )
-                       & ( ( ( *board ).side == WHITE ) ? ~( *board ).occupancies[ WHITE ]
-                                                        : ~( *board ).occupancies[ BLACK ]
-                                                        );
-                while ( attack )
-                {
-                    dst = bitboard_lsb ( attack );
- 
-                    // Quiet move.
-                    if ( !bit ( ( ( *board ).side == WHITE ) ? ( *board ).occupancies[ BLACK ]
-                                                             : ( *board ).occupancies[ WHITE ]
-                              , dst
-                              ))
-                    {
-                        moves_push ( moves
-                                   , move_encode ( src , dst , piece , 0 , 0 , 0 , 0 , 0 )
-                                   );
-                    }
-
-                    // Capture move.
-                    else
-                    { 
-                        moves_push ( moves
-                                   , move_encode ( src , dst , piece , 0 , 1 , 0 , 0 , 0 )
-                                   );
-                    }
-
-                    BITCLR ( attack , dst );
-                }
-
-                BITCLR ( pieces , src );
-            }
+            moves = moves_push ( moves
+                               , move_encode ( dst - shift , dst , piece , promotions[ i ] , capture , 0 , 0 , 0 )
+                               );
         }
+        BITCLR ( targets , dst );
+    }
+    return moves;
+}
 
-        // Queen.
-        else if ( ( ( *board ).side == WHITE ) ? piece == Q : piece == q )
+/**
+ * @brief Generates the pawn moves for one side. The targets of every pawn are
+ * computed at once by shifting the whole pawn set (see bitboard_pawn_pushes
+ * and bitboard_pawn_attacks_west/east); the source square of each move is
+ * then its target square less the shift.
+ * @param moves The end of the move list.
+ * @param board A chess board state.
+ * @param attacks The pregenerated attack tables.
+ * @param side The side to move (a compile-time constant).
+ * @return The new end of the move list.
+ */
+FORCEINLINE
+move_t*
+moves_compute_pawns
+(   move_t*             moves
+,   const board_t*      board
+,   const attacks_t*    attacks
+,   const SIDE          side
+)
+{
+    const PIECE piece = ( side == WHITE ) ? P : p;
+    const i32 push = ( side == WHITE ) ? -8 : 8;
+    const i32 west = ( side == WHITE ) ? -9 : 7;
+    const i32 east = ( side == WHITE ) ? -7 : 9;
+    const bitboard_t promotion_rank = ( side == WHITE ) ? BITBOARD_RANK_8 : BITBOARD_RANK_1;
+    const bitboard_t double_push_rank = ( side == WHITE ) ? BITBOARD_RANK_3 : BITBOARD_RANK_6;
+
+    const bitboard_t pawns = ( *board ).pieces[ piece ];
+    const bitboard_t empty = ~( *board ).occupancies[ 2 ];
+    const bitboard_t enemies = ( *board ).occupancies[ !side ];
+
+    // Quiet moves.
+    const bitboard_t single = bitboard_pawn_pushes ( pawns , empty , side );
+    const bitboard_t double_ = bitboard_pawn_pushes ( single & double_push_rank , empty , side );
+    moves = moves_push_pawns ( moves , single & ~promotion_rank , push , piece , 0 , 0 );
+    moves = moves_push_pawns ( moves , double_ , 2 * push , piece , 0 , 1 );
+    moves = moves_push_promotions ( moves , single & promotion_rank , push , piece , 0 );
+
+    // Capture moves.
+    const bitboard_t west_captures = bitboard_pawn_attacks_west ( pawns , side ) & enemies;
+    const bitboard_t east_captures = bitboard_pawn_attacks_east ( pawns , side ) & enemies;
+    moves = moves_push_pawns ( moves , west_captures & ~promotion_rank , west , piece , 1 , 0 );
+    moves = moves_push_pawns ( moves , east_captures & ~promotion_rank , east , piece , 1 , 0 );
+    moves = moves_push_promotions ( moves , west_captures & promotion_rank , west , piece , 1 );
+    moves = moves_push_promotions ( moves , east_captures & promotion_rank , east , piece , 1 );
+
+    // En passant captures (the pawns which attack the en passant square are
+    // those an opposing pawn on it would attack).
+    if ( ( *board ).enpassant != NO_SQ )
+    {
+        bitboard_t sources = bitboard_pawn_attacks ( bitset ( 0 , ( *board ).enpassant ) , !side ) & pawns;
+        while ( sources )
         {
-            while ( pieces )
-            {
-                src = bitboard_lsb ( pieces );
-               
-                attack = bitboard_queen_attack ( attacks
-                                               , src
-                                               , ( *board ).occupancies[ 2 ]
-                                               )
-                       & ( ( ( *board ).side == WHITE ) ? ~( *board ).occupancies[ WHITE ]
-                                                        : ~( *board ).occupancies[ BLACK ]
-                                                        );
-                while ( attack )
-                {
-                    dst = bitboard_lsb ( attack );
- 
-                    // Quiet move.
-                    if ( !bit ( ( ( *board ).side == WHITE ) ? ( *board ).occupancies[ BLACK ]
-                                                             : ( *board ).occupancies[ WHITE ]
-                              , dst
-                              ))
-                    {
-                        moves_push ( moves
-                                   , move_encode ( src , dst , piece , 0 , 0 , 0 , 0 , 0 )
-                                   );
-                    }
-
-                    // Capture move.
-                    else
-                    { 
-                        moves_push ( moves
-                                   , move_encode ( src , dst , piece , 0 , 1 , 0 , 0 , 0 )
-                                   );
-                    }
-
-                    BITCLR ( attack , dst );
-                }
-
-                BITCLR ( pieces , src );
-            }
+            const SQUARE src = bitboard_lsb ( sources );
+            moves = moves_push ( moves
+                               , move_encode ( src , ( *board ).enpassant , piece , 0 , 1 , 0 , 1 , 0 )
+                               );
+            BITCLR ( sources , src );
         }
+    }
+    return moves;
+}
+
+/**
+ * @brief Generates the castling moves for one side.
+ * @param moves The end of the move list.
+ * @param board A chess board state.
+ * @param attacks The pregenerated attack tables.
+ * @param side The side to move (a compile-time constant).
+ * @return The new end of the move list.
+ */
+FORCEINLINE
+move_t*
+moves_compute_castle
+(   move_t*             moves
+,   const board_t*      board
+,   const attacks_t*    attacks
+,   const SIDE          side
+)
+{
+    const PIECE piece = ( side == WHITE ) ? K : k;
+    const SQUARE king = ( side == WHITE ) ? E1 : E8;
+    const bitboard_t occupancy = ( *board ).occupancies[ 2 ];
+
+    // King side.
+    if (    ( ( *board ).castle & ( ( side == WHITE ) ? CASTLE_WK : CASTLE_BK ) )
+         && !bit ( occupancy , king + 1 )
+         && !bit ( occupancy , king + 2 )
+         && !board_square_attackable ( board , attacks , king , !side )
+         && !board_square_attackable ( board , attacks , king + 1 , !side )
+       )
+    {
+        moves = moves_push ( moves
+                           , move_encode ( king , king + 2 , piece , 0 , 0 , 0 , 0 , 1 )
+                           );
+    }
+
+    // Queen side.
+    if (    ( ( *board ).castle & ( ( side == WHITE ) ? CASTLE_WQ : CASTLE_BQ ) )
+         && !bit ( occupancy , king - 1 )
+         && !bit ( occupancy , king - 2 )
+         && !bit ( occupancy , king - 3 )
+         && !board_square_attackable ( board , attacks , king , !side )
+         && !board_square_attackable ( board , attacks , king - 1 , !side )
+       )
+    {
+        moves = moves_push ( moves
+                           , move_encode ( king , king - 2 , piece , 0 , 0 , 0 , 0 , 1 )
+                           );
+    }
+    return moves;
+}
+
+/**
+ * @brief Generates the moves of one piece type (knight, bishop, rook, queen
+ * or king) for one side.
+ * @param moves The end of the move list.
+ * @param board A chess board state.
+ * @param attacks The pregenerated attack tables.
+ * @param piece The piece (a compile-time constant).
+ * @param side The side to move (a compile-time constant).
+ * @return The new end of the move list.
+ */
+FORCEINLINE
+move_t*
+moves_compute_piece
+(   move_t*             moves
+,   const board_t*      board
+,   const attacks_t*    attacks
+,   const PIECE         piece
+,   const SIDE          side
+)
+{
+    bitboard_t pieces = ( *board ).pieces[ piece ];
+    while ( pieces )
+    {
+        const SQUARE src = bitboard_lsb ( pieces );
 
-        // King.
-        else if ( ( ( *board ).side == WHITE ) ? piece == K : piece == k )
+        bitboard_t attack;
+        switch ( piece % 6 )
         {
-            while ( pieces )
-            {
-                src = bitboard_lsb ( pieces );
-               
-                attack = bitboard_king_attack ( attacks , src )
-                       & ( ( ( *board ).side == WHITE ) ? ~( *board ).occupancies[ WHITE ]
-                                                        : ~( *board ).occupancies[ BLACK ]
-                                                        );
-                while ( attack )
-                {
-                    dst = bitboard_lsb ( attack );
- 
-                    // Quiet move.
-                    if ( !bit ( ( ( *board ).side == WHITE ) ? ( *board ).occupancies[ BLACK ]
-                                                             : ( *board ).occupancies[ WHITE ]
-                              , dst
-                              ))
-                    {
-                        moves_push ( moves
-                                   , move_encode ( src , dst , piece , 0 , 0 , 0 , 0 , 0 )
-                                   );
-                    }
-
-                    // Capture move.
-                    else
-                    { 
-                        moves_push ( moves
-                                   , move_encode ( src , dst , piece , 0 , 1 , 0 , 0 , 0 )
-                                   );
-                    }
-
-                    BITCLR ( attack , dst );
-                }
-
-                BITCLR ( pieces , src );
-            }
+            case N:  attack = bitboard_knight_attack ( attacks , src )                                 ;break;
+            case B:  attack = bitboard_bishop_attack ( attacks , src , ( *board ).occupancies[ 2 ] ) ;break;
+            case R:  attack = bitboard_rook_attack ( attacks , src , ( *board ).occupancies[ 2 ] )   ;break;
+            case Q:  attack = bitboard_queen_attack ( attacks , src , ( *board ).occupancies[ 2 ] )  ;break;
+            default: attack = bitboard_king_attack ( attacks , src )                                   ;break;
         }
+        attack &= ~( *board ).occupancies[ side ];
+
+        while ( attack )
+        {
+            const SQUARE dst = bitboard_lsb ( attack );
+
+            // Quiet move or capture move.
+            moves = moves_push ( moves
+                               , move_encode ( src , dst , piece , 0
+                                             , bit ( ( *board ).occupancies[ !side ] , dst )
+                                             , 0 , 0 , 0
+                                             ));
+
+            BITCLR ( attack , dst );
+        }
+
+        BITCLR ( pieces , src );
+    }
+    return moves;
+}
 
-    }// END for.
+/**
+ * @brief Generates the move options for one side. Each call site passes side
+ * as a constant, so the compiler emits a separate generator per side with no
+ * side branches in its loops.
+ * @param moves Output buffer.
+ * @param board A chess board state.
+ * @param attacks The pregenerated attack tables.
+ * @param side The side to move (a compile-time constant).
+ * @return The number of moves generated.
+ */
+FORCEINLINE
+u32
+moves_generate_side
+(   move_t*             moves
+,   const board_t*      board
+,   const attacks_t*    attacks
+,   const SIDE          side
+)
+{
+    const PIECE offset = ( side == WHITE ) ? P : p;
+
+    move_t* end = moves;
+    end = moves_compute_pawns ( end , board , attacks , side );
+    end = moves_compute_piece ( end , board , attacks , offset + N , side );
+    end = moves_compute_piece ( end , board , attacks , offset + B , side );
+    end = moves_compute_piece ( end , board , attacks , offset + R , side );
+    end = moves_compute_piece ( end , board , attacks , offset + Q , side );
+    end = moves_compute_castle ( end , board , attacks , side );
+    end = moves_compute_piece ( end , board , attacks , offset + K , side );
+    return end - moves;
+}
 
+u32
+moves_generate_white
+(   move_t*             moves
+,   const board_t*      board
+,   const attacks_t*    attacks
+)
+{
+    return moves_generate_side ( moves , board , attacks , WHITE );
+}
+
+u32
+moves_generate_black
+(   move_t*             moves
+,   const board_t*      board
+,   const attacks_t*    attacks
+)
+{
+    return moves_generate_side ( moves , board , attacks , BLACK );
+}
+
+u32
+moves_generate
+(   move_t*             moves
+,   const board_t*      board
+,   const attacks_t*    attacks
+)
+{
+    return ( ( *board ).side == WHITE ) ? moves_generate_white ( moves , board , attacks )
+                                        : moves_generate_black ( moves , board , attacks )
+                                        ;
+}
+
+moves_t*
+moves_compute
+(   moves_t*            moves
+,   const board_t*      board
+,   const attacks_t*    attacks
+)
+{
+    ( *moves ).count = moves_generate ( ( *moves ).moves , board , attacks );
     return moves;
 }
 
@@ -688,7 +635,8 @@ moves_filter
         }
         if ( filter )
         {
-            moves_push ( filtered , move );
+            ( *filtered ).moves[ ( *filtered ).count ] = move;
+            ( *filtered ).count += 1;
         }
     }
     return filtered;
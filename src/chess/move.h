@@ -43,6 +43,43 @@ move_parse
 ,   move_t*             move
 );
 
+/**
+ * @brief Parses a move string in standard algebraic notation (e.g. "Nbd7",
+ * "exd5", "e8=Q+", "O-O") and writes it to an output buffer if it names
+ * exactly one legal move. Requires pregenerated attacks tables and a list of
+ * valid moves.
+ * @param s The move string to parse.
+ * @param board The board state the move is played from.
+ * @param moves A pregenerated list of all valid moves for board.
+ * @param attacks The pregenerated attacks tables.
+ * @param move Output buffer.
+ * @return false if move invalid or ambiguous, true otherwise.
+ */
+bool
+move_parse_san
+(   const char*         s
+,   const board_t*      board
+,   const moves_t*      moves
+,   const attacks_t*    attacks
+,   move_t*             move
+);
+
+/**
+ * @brief Converts a compact move back to a full move, recovering the moving
+ * piece and the capture, double push, en passant and castling flags from the
+ * board state the move is played on. Exact for any move generated on that
+ * board state (see move_compact).
+ * @param move A compact move.
+ * @param board The board state the move is played on.
+ * @return The full move, or 0 if move is 0 or no piece of the side to move
+ * stands on its source square.
+ */
+move_t
+move_expand
+(   const move16_t  move
+,   const board_t*  board
+);
+
 /**
  * @brief Generates the move options for a given board state using pregenerated
  * attack tables.
@@ -58,6 +95,51 @@ moves_compute
 ,   const attacks_t*    attacks
 );
 
+/**
+ * @brief Generates the move options for a given board state into a
+ * caller-supplied buffer, such as a slice of a search's move stack. Requires
+ * pregenerated attack tables.
+ * @param moves Output buffer (room for at least MOVES_BUFFER_LENGTH moves).
+ * @param board A chess board state.
+ * @param attacks The pregenerated attack tables.
+ * @return The number of moves generated.
+ */
+u32
+moves_generate
+(   move_t*             moves
+,   const board_t*      board
+,   const attacks_t*    attacks
+);
+
+/**
+ * @brief Side-specialized variants of moves_generate, for callers which
+ * already know the side to move.
+ * @param moves Output buffer (room for at least MOVES_BUFFER_LENGTH moves).
+ * @param board A chess board state (white to move).
+ * @param attacks The pregenerated attack tables.
+ * @return The number of moves generated.
+ */
+u32
+moves_generate_white
+(   move_t*             moves
+,   const board_t*      board
+,   const attacks_t*    attacks
+);
+
+/**
+ * @brief See moves_generate_white.
+ * @param moves Output buffer (room for at least MOVES_BUFFER_LENGTH moves).
+ * @param board A chess board state (black to move).
+ * @param attacks The pregenerated attack tables.
+ * @return The number of moves generated.
+ */
+u32
+moves_generate_black
+(   move_t*             moves
+,   const board_t*      board
+,   const attacks_t*    attacks
+);
+
 /**
  * @brief Applies a filter to a list of moves. Writes the filtered list
  * to an output buffer.
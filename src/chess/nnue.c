@@ -0,0 +1,434 @@
+/**
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @file nnue.c
+ * @brief Implementation of the nnue header.
+ * (see nnue.h for additional details)
+ */
+// SIMD intrinsics pull in the C standard library headers, so they must be
+// included before the engine headers redefine some of its names.
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+#include "chess/nnue.h"
+
+#include "chess/bitboard.h"
+
+#include "core/logger.h"
+#include "core/memory.h"
+
+#include "platform/filesystem.h"
+
+// Defines the maximum number of features which may change in a single move.
+#define NNUE_MAX_CHANGED_FEATURES 8
+
+/**
+ * @brief Computes the input feature index of a non-king piece.
+ * @param perspective The side whose accumulator half receives the feature.
+ * @param king The perspective side's king square.
+ * @param piece The piece.
+ * @param square The piece's square.
+ * @return The feature index.
+ */
+INLINE
+u32
+nnue_feature
+(   const SIDE      perspective
+,   const SQUARE    king
+,   const PIECE     piece
+,   const SQUARE    square
+)
+{
+    // Black sees the board flipped vertically.
+    const u32 flip = ( perspective == WHITE ) ? 0 : 56;
+    const u32 own = ( piece < p ) == ( perspective == WHITE );
+    return ( king ^ flip ) * NNUE_PIECE_FEATURES
+         + 1
+         + ( 2 * ( piece % 6 ) + !own ) * 64
+         + ( square ^ flip )
+         ;
+}
+
+/**
+ * @brief Adds a feature transformer weight row to an accumulator half.
+ * @param dst The accumulator half.
+ * @param row The weight row.
+ */
+INLINE
+void
+nnue_row_add
+(   i16*        dst
+,   const i16*  row
+)
+{
+#if defined(__AVX2__)
+    for ( u32 i = 0; i < NNUE_HALF_DIMENSIONS; i += 16 )
+    {
+        __m256i* d = ( __m256i* )( dst + i );
+        _mm256_storeu_si256 ( d , _mm256_add_epi16 ( _mm256_loadu_si256 ( d )
+                                                   , _mm256_loadu_si256 ( ( const __m256i* )( row + i ) )
+                                                   ));
+    }
+#elif defined(__SSE4_1__)
+    for ( u32 i = 0; i < NNUE_HALF_DIMENSIONS; i += 8 )
+    {
+        __m128i* d = ( __m128i* )( dst + i );
+        _mm_storeu_si128 ( d , _mm_add_epi16 ( _mm_loadu_si128 ( d )
+                                             , _mm_loadu_si128 ( ( const __m128i* )( row + i ) )
+                                             ));
+    }
+#else
+    for ( u32 i = 0; i < NNUE_HALF_DIMENSIONS; ++i )
+    {
+        dst[ i ] += row[ i ];
+    }
+#endif
+}
+
+/**
+ * @brief Subtracts a feature transformer weight row from an accumulator half.
+ * @param dst The accumulator half.
+ * @param row The weight row.
+ */
+INLINE
+void
+nnue_row_sub
+(   i16*        dst
+,   const i16*  row
+)
+{
+#if defined(__AVX2__)
+    for ( u32 i = 0; i < NNUE_HALF_DIMENSIONS; i += 16 )
+    {
+        __m256i* d = ( __m256i* )( dst + i );
+        _mm256_storeu_si256 ( d , _mm256_sub_epi16 ( _mm256_loadu_si256 ( d )
+                                                   , _mm256_loadu_si256 ( ( const __m256i* )( row + i ) )
+                                                   ));
+    }
+#elif defined(__SSE4_1__)
+    for ( u32 i = 0; i < NNUE_HALF_DIMENSIONS; i += 8 )
+    {
+        __m128i* d = ( __m128i* )( dst + i );
+        _mm_storeu_si128 ( d , _mm_sub_epi16 ( _mm_loadu_si128 ( d )
+                                             , _mm_loadu_si128 ( ( const __m128i* )( row + i ) )
+                                             ));
+    }
+#else
+    for ( u32 i = 0; i < NNUE_HALF_DIMENSIONS; ++i )
+    {
+        dst[ i ] -= row[ i ];
+    }
+#endif
+}
+
+/**
+ * @brief Clipped ReLU from int16 accumulator values to uint8 activations.
+ * @param dst Output buffer (length bytes).
+ * @param src Accumulator values.
+ * @param length Number of values (multiple of 32).
+ */
+INLINE
+void
+nnue_clip16
+(   u8*         dst
+,   const i16*  src
+,   const u32   length
+)
+{
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256 ();
+    for ( u32 i = 0; i < length; i += 32 )
+    {
+        const __m256i a = _mm256_loadu_si256 ( ( const __m256i* )( src + i ) );
+        const __m256i b = _mm256_loadu_si256 ( ( const __m256i* )( src + i + 16 ) );
+
+        // Saturating pack interleaves the 128-bit lanes; permute to restore
+        // the original order.
+        const __m256i packed = _mm256_max_epi8 ( _mm256_packs_epi16 ( a , b ) , zero );
+        _mm256_storeu_si256 ( ( __m256i* )( dst + i )
+                            , _mm256_permute4x64_epi64 ( packed , 0xD8 )
+                            );
+    }
+#elif defined(__SSE4_1__)
+    const __m128i zero = _mm_setzero_si128 ();
+    for ( u32 i = 0; i < length; i += 16 )
+    {
+        const __m128i a = _mm_loadu_si128 ( ( const __m128i* )( src + i ) );
+        const __m128i b = _mm_loadu_si128 ( ( const __m128i* )( src + i + 8 ) );
+        _mm_storeu_si128 ( ( __m128i* )( dst + i )
+                         , _mm_max_epi8 ( _mm_packs_epi16 ( a , b ) , zero )
+                         );
+    }
+#else
+    for ( u32 i = 0; i < length; ++i )
+    {
+        const i16 x = src[ i ];
+        dst[ i ] = ( x < 0 ) ? 0 : ( x > NNUE_ACTIVATION_MAX ) ? NNUE_ACTIVATION_MAX : x;
+    }
+#endif
+}
+
+/**
+ * @brief Dot product of uint8 activations and int8 weights.
+ * @param x Activations.
+ * @param w Weights.
+ * @param length Vector length (multiple of 32).
+ * @return The dot product.
+ */
+INLINE
+i32
+nnue_dot
+(   const u8*   x
+,   const i8*   w
+,   const u32   length
+)
+{
+#if defined(__AVX2__)
+    const __m256i ones = _mm256_set1_epi16 ( 1 );
+    __m256i sum = _mm256_setzero_si256 ();
+    for ( u32 i = 0; i < length; i += 32 )
+    {
+        // Activations never exceed 127, so the pairwise int16 sums produced
+        // by maddubs cannot saturate.
+        const __m256i product = _mm256_maddubs_epi16 ( _mm256_loadu_si256 ( ( const __m256i* )( x + i ) )
+                                                     , _mm256_loadu_si256 ( ( const __m256i* )( w + i ) )
+                                                     );
+        sum = _mm256_add_epi32 ( sum , _mm256_madd_epi16 ( product , ones ) );
+    }
+    __m128i sum128 = _mm_add_epi32 ( _mm256_castsi256_si128 ( sum )
+                                   , _mm256_extracti128_si256 ( sum , 1 )
+                                   );
+    sum128 = _mm_add_epi32 ( sum128 , _mm_shuffle_epi32 ( sum128 , 0x4E ) );
+    sum128 = _mm_add_epi32 ( sum128 , _mm_shuffle_epi32 ( sum128 , 0xB1 ) );
+    return _mm_cvtsi128_si32 ( sum128 );
+#elif defined(__SSE4_1__)
+    const __m128i ones = _mm_set1_epi16 ( 1 );
+    __m128i sum = _mm_setzero_si128 ();
+    for ( u32 i = 0; i < length; i += 16 )
+    {
+        const __m128i product = _mm_maddubs_epi16 ( _mm_loadu_si128 ( ( const __m128i* )( x + i ) )
+                                                  , _mm_loadu_si128 ( ( const __m128i* )( w + i ) )
+                                                  );
+        sum = _mm_add_epi32 ( sum , _mm_madd_epi16 ( product , ones ) );
+    }
+    sum = _mm_add_epi32 ( sum , _mm_shuffle_epi32 ( sum , 0x4E ) );
+    sum = _mm_add_epi32 ( sum , _mm_shuffle_epi32 ( sum , 0xB1 ) );
+    return _mm_cvtsi128_si32 ( sum );
+#else
+    i32 sum = 0;
+    for ( u32 i = 0; i < length; ++i )
+    {
+        sum += ( i32 ) x[ i ] * w[ i ];
+    }
+    return sum;
+#endif
+}
+
+/**
+ * @brief Quantized dense layer followed by a clipped ReLU.
+ * @param dst Output activations (out_length).
+ * @param x Input activations (in_length).
+ * @param weights Row-major weights (out_length x in_length).
+ * @param biases Biases (out_length).
+ * @param in_length Input length.
+ * @param out_length Output length.
+ */
+INLINE
+void
+nnue_affine_clip
+(   u8*         dst
+,   const u8*   x
+,   const i8*   weights
+,   const i32*  biases
+,   const u32   in_length
+,   const u32   out_length
+)
+{
+    for ( u32 i = 0; i < out_length; ++i )
+    {
+        const i32 y = ( biases[ i ] + nnue_dot ( x , weights + i * in_length , in_length ) ) >> NNUE_WEIGHT_SHIFT;
+        dst[ i ] = ( y < 0 ) ? 0 : ( y > NNUE_ACTIVATION_MAX ) ? NNUE_ACTIVATION_MAX : y;
+    }
+}
+
+bool
+nnue_load
+(   const char* filepath
+,   nnue_t*     nnue
+)
+{
+    file_handle_t file;
+    if ( !file_open ( filepath , FILE_MODE_READ , true , &file ) )
+    {
+        LOGERROR ( "nnue_load: Unable to open network file '%s'." , filepath );
+        return false;
+    }
+
+    u32 header[ 2 ];
+    u64 read;
+    if (   !file_read ( &file , sizeof ( header ) , header , &read )
+        || header[ 0 ] != NNUE_FILE_MAGIC
+        || header[ 1 ] != NNUE_FILE_VERSION
+       )
+    {
+        LOGERROR ( "nnue_load: '%s' is not a version %u network file."
+                 , filepath , NNUE_FILE_VERSION
+                 );
+        file_close ( &file );
+        return false;
+    }
+
+    const bool success = file_read ( &file , sizeof ( ( *nnue ).ft_biases ) , ( *nnue ).ft_biases , &read )
+                      && file_read ( &file , sizeof ( ( *nnue ).ft_weights ) , ( *nnue ).ft_weights , &read )
+                      && file_read ( &file , sizeof ( ( *nnue ).l1_biases ) , ( *nnue ).l1_biases , &read )
+                      && file_read ( &file , sizeof ( ( *nnue ).l1_weights ) , ( *nnue ).l1_weights , &read )
+                      && file_read ( &file , sizeof ( ( *nnue ).l2_biases ) , ( *nnue ).l2_biases , &read )
+                      && file_read ( &file , sizeof ( ( *nnue ).l2_weights ) , ( *nnue ).l2_weights , &read )
+                      && file_read ( &file , sizeof ( ( *nnue ).out_bias ) , &( *nnue ).out_bias , &read )
+                      && file_read ( &file , sizeof ( ( *nnue ).out_weights ) , ( *nnue ).out_weights , &read )
+                      ;
+    file_close ( &file );
+
+    if ( !success )
+    {
+        LOGERROR ( "nnue_load: Network file '%s' is truncated." , filepath );
+        return false;
+    }
+    return true;
+}
+
+void
+nnue_accumulator_refresh
+(   nnue_accumulator_t* accumulator
+,   const board_t*      board
+,   const SIDE          perspective
+,   const nnue_t*       nnue
+)
+{
+    i16* values = ( *accumulator ).values[ perspective ];
+    memory_copy ( values , ( *nnue ).ft_biases , sizeof ( ( *nnue ).ft_biases ) );
+
+    const SQUARE king = bitboard_lsb ( ( *board ).pieces[ ( perspective == WHITE ) ? K : k ] );
+    for ( PIECE piece = P; piece <= k; ++piece )
+    {
+        if ( piece == K || piece == k )
+        {
+            continue;
+        }
+        bitboard_t bitboard = ( *board ).pieces[ piece ];
+        while ( bitboard )
+        {
+            const SQUARE square = bitboard_lsb ( bitboard );
+            nnue_row_add ( values
+                         , ( *nnue ).ft_weights + nnue_feature ( perspective , king , piece , square ) * NNUE_HALF_DIMENSIONS
+                         );
+            BITCLR ( bitboard , square );
+        }
+    }
+}
+
+void
+nnue_accumulator_update
+(   nnue_accumulator_t*         accumulator
+,   const nnue_accumulator_t*   prev
+,   const board_t*              prev_board
+,   const board_t*              board
+,   const nnue_t*               nnue
+)
+{
+    // Collect the changed (piece, square) pairs once for both perspectives.
+    PIECE removed_pieces[ NNUE_MAX_CHANGED_FEATURES ];
+    SQUARE removed_squares[ NNUE_MAX_CHANGED_FEATURES ];
+    PIECE added_pieces[ NNUE_MAX_CHANGED_FEATURES ];
+    SQUARE added_squares[ NNUE_MAX_CHANGED_FEATURES ];
+    u32 removed_count = 0;
+    u32 added_count = 0;
+    bool overflow = false;
+    for ( PIECE piece = P; piece <= k; ++piece )
+    {
+        if ( piece == K || piece == k )
+        {
+            continue;
+        }
+        const bitboard_t changed = ( *prev_board ).pieces[ piece ] ^ ( *board ).pieces[ piece ];
+        bitboard_t removed = changed & ( *prev_board ).pieces[ piece ];
+        bitboard_t added = changed & ( *board ).pieces[ piece ];
+        while ( removed && removed_count < NNUE_MAX_CHANGED_FEATURES )
+        {
+            removed_pieces[ removed_count ] = piece;
+            removed_squares[ removed_count ] = bitboard_lsb ( removed );
+            BITCLR ( removed , removed_squares[ removed_count ] );
+            removed_count += 1;
+        }
+        while ( added && added_count < NNUE_MAX_CHANGED_FEATURES )
+        {
+            added_pieces[ added_count ] = piece;
+            added_squares[ added_count ] = bitboard_lsb ( added );
+            BITCLR ( added , added_squares[ added_count ] );
+            added_count += 1;
+        }
+        overflow |= removed || added;
+    }
+
+    for ( SIDE perspective = WHITE; perspective <= BLACK; ++perspective )
+    {
+        const PIECE king_piece = ( perspective == WHITE ) ? K : k;
+        if ( overflow || ( *prev_board ).pieces[ king_piece ] != ( *board ).pieces[ king_piece ] )
+        {
+            nnue_accumulator_refresh ( accumulator , board , perspective , nnue );
+            continue;
+        }
+
+        i16* values = ( *accumulator ).values[ perspective ];
+        memory_copy ( values
+                    , ( *prev ).values[ perspective ]
+                    , sizeof ( ( *prev ).values[ perspective ] )
+                    );
+        const SQUARE king = bitboard_lsb ( ( *board ).pieces[ king_piece ] );
+        for ( u32 i = 0; i < removed_count; ++i )
+        {
+            nnue_row_sub ( values
+                         , ( *nnue ).ft_weights + nnue_feature ( perspective , king , removed_pieces[ i ] , removed_squares[ i ] ) * NNUE_HALF_DIMENSIONS
+                         );
+        }
+        for ( u32 i = 0; i < added_count; ++i )
+        {
+            nnue_row_add ( values
+                         , ( *nnue ).ft_weights + nnue_feature ( perspective , king , added_pieces[ i ] , added_squares[ i ] ) * NNUE_HALF_DIMENSIONS
+                         );
+        }
+    }
+}
+
+i32
+nnue_evaluate
+(   const nnue_accumulator_t*   accumulator
+,   const SIDE                  side
+,   const nnue_t*               nnue
+)
+{
+    u8 input[ 2 * NNUE_HALF_DIMENSIONS ];
+    u8 hidden1[ NNUE_L1_LENGTH ];
+    u8 hidden2[ NNUE_L2_LENGTH ];
+
+    // Side to move's half first.
+    nnue_clip16 ( input
+                , ( *accumulator ).values[ side ]
+                , NNUE_HALF_DIMENSIONS
+                );
+    nnue_clip16 ( input + NNUE_HALF_DIMENSIONS
+                , ( *accumulator ).values[ !side ]
+                , NNUE_HALF_DIMENSIONS
+                );
+
+    nnue_affine_clip ( hidden1 , input
+                     , ( *nnue ).l1_weights , ( *nnue ).l1_biases
+                     , 2 * NNUE_HALF_DIMENSIONS , NNUE_L1_LENGTH
+                     );
+    nnue_affine_clip ( hidden2 , hidden1
+                     , ( *nnue ).l2_weights , ( *nnue ).l2_biases
+                     , NNUE_L1_LENGTH , NNUE_L2_LENGTH
+                     );
+
+    return ( ( *nnue ).out_bias + nnue_dot ( hidden2 , ( *nnue ).out_weights , NNUE_L2_LENGTH ) ) / NNUE_OUTPUT_SCALE;
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+/**
+ * @file nnue.h
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Efficiently updatable neural network (NNUE) board evaluation.
+ *
+ * The network uses HalfKP input features (king square x non-king piece x
+ * square, from each side's perspective) feeding a 2x256 int16 feature
+ * transformer, followed by two 32-wide int8 hidden layers and a single
+ * output neuron. The feature transformer output is kept in an accumulator
+ * which is updated incrementally from one board state to the next, and only
+ * refreshed from scratch when a king moves.
+ */
+#ifndef CHESS_NNUE_H
+#define CHESS_NNUE_H
+
+#include "chess/common.h"
+
+// Defines the network file header.
+#define NNUE_FILE_MAGIC   0x45554E4E    // "NNUE"
+#define NNUE_FILE_VERSION 1
+
+// Defines the network architecture.
+#define NNUE_PIECE_FEATURES     ( 10 * 64 + 1 )
+#define NNUE_INPUT_LENGTH       ( 64 * NNUE_PIECE_FEATURES )
+#define NNUE_HALF_DIMENSIONS    256
+#define NNUE_L1_LENGTH          32
+#define NNUE_L2_LENGTH          32
+
+// Defines the quantization parameters.
+#define NNUE_ACTIVATION_MAX     127
+#define NNUE_WEIGHT_SHIFT       6
+#define NNUE_OUTPUT_SCALE       16
+
+// Type definition for a quantized network.
+typedef struct
+{
+    // Feature transformer.
+    i16 ft_biases[ NNUE_HALF_DIMENSIONS ];
+    i16 ft_weights[ NNUE_INPUT_LENGTH * NNUE_HALF_DIMENSIONS ];
+
+    // Hidden layer 1.
+    i32 l1_biases[ NNUE_L1_LENGTH ];
+    i8  l1_weights[ NNUE_L1_LENGTH * 2 * NNUE_HALF_DIMENSIONS ];
+
+    // Hidden layer 2.
+    i32 l2_biases[ NNUE_L2_LENGTH ];
+    i8  l2_weights[ NNUE_L2_LENGTH * NNUE_L1_LENGTH ];
+
+    // Output layer.
+    i32 out_bias;
+    i8  out_weights[ NNUE_L2_LENGTH ];
+}
+nnue_t;
+
+// Type definition for a feature transformer accumulator (one half per side).
+typedef struct
+{
+    i16 values[ 2 ][ NNUE_HALF_DIMENSIONS ];
+}
+nnue_accumulator_t;
+
+/**
+ * @brief Loads a network from a binary file. The file consists of a u32
+ * magic number, a u32 version number, and then each array of nnue_t in
+ * declaration order (little-endian).
+ * @param filepath The network filepath.
+ * @param nnue Output buffer.
+ * @return true if network loaded successfully, false otherwise.
+ */
+bool
+nnue_load
+(   const char* filepath
+,   nnue_t*     nnue
+);
+
+/**
+ * @brief Recomputes one side's half of an accumulator from scratch.
+ * @param accumulator The accumulator to refresh.
+ * @param board A chess board state.
+ * @param perspective The side whose half should be refreshed.
+ * @param nnue The network.
+ */
+void
+nnue_accumulator_refresh
+(   nnue_accumulator_t* accumulator
+,   const board_t*      board
+,   const SIDE          perspective
+,   const nnue_t*       nnue
+);
+
+/**
+ * @brief Computes the accumulator for a board state which is one move ahead
+ * of the board state of a known accumulator. Only the changed features are
+ * applied; a side's half is refreshed instead if its king moved.
+ * @param accumulator Output buffer.
+ * @param prev The accumulator for prev_board.
+ * @param prev_board The board state before the move.
+ * @param board The board state after the move.
+ * @param nnue The network.
+ */
+void
+nnue_accumulator_update
+(   nnue_accumulator_t*         accumulator
+,   const nnue_accumulator_t*   prev
+,   const board_t*              prev_board
+,   const board_t*              board
+,   const nnue_t*               nnue
+);
+
+/**
+ * @brief Network evaluation function.
+ * @param accumulator The accumulator for the board state to evaluate.
+ * @param side The side to move.
+ * @param nnue The network.
+ * @return A score corresponding to the board state, relative to side.
+ */
+i32
+nnue_evaluate
+(   const nnue_accumulator_t*   accumulator
+,   const SIDE                  side
+,   const nnue_t*               nnue
+);
+
+#endif  // CHESS_NNUE_H
\ No newline at end of file
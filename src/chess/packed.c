@@ -0,0 +1,456 @@
+/**
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @file packed.c
+ * @brief Implementation of the packed header.
+ * (see packed.h for additional details)
+ */
+#include "chess/packed.h"
+
+#include "chess/board.h"
+#include "chess/fen.h"
+#include "chess/string.h"
+
+#include "core/logger.h"
+#include "core/memory.h"
+
+#include "math/math.h"
+
+// Defines the number of rounds of the shuffle permutation.
+#define DATASET_SHUFFLE_ROUNDS 4
+
+/**
+ * @brief Mixes the bits of a 64-bit integer (the splitmix64 finalizer).
+ * @param x A 64-bit integer.
+ * @return The mixed integer.
+ */
+INLINE
+u64
+dataset_mix
+(   u64 x
+)
+{
+    x = ( x ^ ( x >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+    x = ( x ^ ( x >> 27 ) ) * 0x94D049BB133111EBULL;
+    return x ^ ( x >> 31 );
+}
+
+/**
+ * @brief Keyed pseudo-random permutation of [ 0 , 2^bits ) (a balanced Feistel
+ * network; bits is even).
+ * @param x The index to permute.
+ * @param seed The permutation key.
+ * @param bits Size of the domain (log2).
+ * @return The permuted index.
+ */
+INLINE
+u64
+dataset_permute
+(   const u64 x
+,   const u64 seed
+,   const u32 bits
+)
+{
+    const u32 half = bits / 2;
+    const u64 mask = ( U64_1 << half ) - 1;
+    u64 l = x >> half;
+    u64 r = x & mask;
+    for ( u32 i = 0; i < DATASET_SHUFFLE_ROUNDS; ++i )
+    {
+        const u64 f = dataset_mix ( r ^ dataset_mix ( seed + i ) ) & mask;
+        const u64 t = r;
+        r = l ^ f;
+        l = t;
+    }
+    return ( l << half ) | r;
+}
+
+bool
+board_pack
+(   board_packed_t* packed
+,   const board_t*  board
+)
+{
+    memory_clear ( packed , sizeof ( board_packed_t ) );
+    ( *packed ).occupancy = ( *board ).occupancies[ 2 ];
+    if ( bitboard_count ( ( *packed ).occupancy ) > 32 )
+    {
+        return false;
+    }
+    bitboard_t occupancy = ( *packed ).occupancy;
+    u32 i = 0;
+    while ( occupancy )
+    {
+        const SQUARE square = bitboard_lsb ( occupancy );
+        PIECE piece = P;
+        while ( !bit ( ( *board ).pieces[ piece ] , square ) )
+        {
+            piece += 1;
+        }
+        ( *packed ).pieces[ i >> 1 ] |= piece << ( ( i & 1 ) * 4 );
+        i += 1;
+        BITCLR ( occupancy , square );
+    }
+    ( *packed ).side = ( *board ).side;
+    ( *packed ).castle = ( *board ).castle;
+    ( *packed ).enpassant = ( *board ).enpassant;
+    ( *packed ).result = BOARD_PACKED_RESULT_NONE;
+    ( *packed ).score = BOARD_PACKED_SCORE_NONE;
+    return true;
+}
+
+bool
+board_unpack
+(   board_t*                board
+,   const board_packed_t*   packed
+)
+{
+    if (    ( *packed ).side > BLACK
+         || ( *packed ).enpassant > NO_SQ
+         || bitboard_count ( ( *packed ).occupancy ) > 32
+       )
+    {
+        return false;
+    }
+
+    memory_clear ( ( *board ).pieces , sizeof ( ( *board ).pieces ) );
+    bitboard_t occupancy = ( *packed ).occupancy;
+    u32 i = 0;
+    while ( occupancy )
+    {
+        const SQUARE square = bitboard_lsb ( occupancy );
+        const PIECE piece = ( ( *packed ).pieces[ i >> 1 ] >> ( ( i & 1 ) * 4 ) ) & 0xF;
+        if ( piece > k )
+        {
+            return false;
+        }
+        BITSET ( ( *board ).pieces[ piece ] , square );
+        i += 1;
+        BITCLR ( occupancy , square );
+    }
+    if ( !( *board ).pieces[ K ] || !( *board ).pieces[ k ] )
+    {
+        return false;
+    }
+
+    ( *board ).occupancies[ WHITE ] = 0;
+    ( *board ).occupancies[ BLACK ] = 0;
+    for ( PIECE piece = P; piece <= K; ++piece )
+    {
+        ( *board ).occupancies[ WHITE ] |= ( *board ).pieces[ piece ];
+        ( *board ).occupancies[ BLACK ] |= ( *board ).pieces[ piece + p ];
+    }
+    ( *board ).occupancies[ 2 ] = ( *packed ).occupancy;
+    ( *board ).side = ( *packed ).side;
+    ( *board ).castle = ( *packed ).castle;
+    ( *board ).enpassant = ( *packed ).enpassant;
+    ( *board ).capture = EMPTY_SQ;
+    board_attacks_refresh ( board );
+    return true;
+}
+
+/**
+ * @brief Tests if a string begins with a prefix.
+ * @param s The string.
+ * @param prefix The prefix.
+ * @return true if s begins with prefix, false otherwise.
+ */
+INLINE
+bool
+board_packed_prefix
+(   const char* s
+,   const char* prefix
+)
+{
+    for ( ; *prefix; ++s, ++prefix )
+    {
+        if ( *s != *prefix )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Reads a signed decimal integer.
+ * @param s The position to read from (advanced past the integer).
+ * @param value Output buffer.
+ * @return true if an integer was read, false otherwise.
+ */
+INLINE
+bool
+board_packed_parse_i64
+(   const char**    s
+,   i64*            value
+)
+{
+    const bool negative = **s == '-';
+    const char* digits = *s + ( **s == '-' || **s == '+' );
+    if ( !digit ( *digits ) )
+    {
+        return false;
+    }
+    i64 x = 0;
+    for ( ; digit ( *digits ); ++digits )
+    {
+        x = 10 * x + to_digit ( *digits );
+    }
+    *s = digits;
+    *value = ( negative ) ? -x : x;
+    return true;
+}
+
+bool
+board_packed_parse
+(   const char*     s
+,   board_packed_t* packed
+)
+{
+    // Copy the four FEN fields.
+    char fen[ FEN_STRING_MAX_LENGTH ];
+    u32 length = 0;
+    u32 fields = 0;
+    while ( whitespace ( *s ) )
+    {
+        s += 1;
+    }
+    while ( *s && fields < 4 && length < FEN_STRING_MAX_LENGTH - 8 )
+    {
+        if ( whitespace ( *s ) )
+        {
+            fields += 1;
+            while ( whitespace ( *s ) )
+            {
+                s += 1;
+            }
+            if ( fields < 4 )
+            {
+                fen[ length++ ] = ' ';
+            }
+            continue;
+        }
+        fen[ length++ ] = *s;
+        s += 1;
+    }
+    fields += ( fields == 3 && length && !*s );
+    if ( fields < 4 )
+    {
+        return false;
+    }
+    fen[ length ] = 0;
+
+    board_t board;
+    if ( !fen_parse ( fen , &board ) || !board_pack ( packed , &board ) )
+    {
+        return false;
+    }
+
+    // Labels.
+    i64 fullmove = 1;
+    u32 counters = 0;
+    while ( *s )
+    {
+        i64 value;
+        const char* next = s;
+        if ( whitespace ( *s ) || *s == ';' || *s == '"' )
+        {
+            s += 1;
+        }
+        else if ( board_packed_prefix ( s , "1/2-1/2" ) )
+        {
+            ( *packed ).result = 1;
+            s += 7;
+        }
+        else if ( board_packed_prefix ( s , "1-0" ) || board_packed_prefix ( s , "0-1" ) )
+        {
+            ( *packed ).result = ( *s == '1' ) ? 2 : 0;
+            s += 3;
+        }
+        else if ( *s == '[' )
+        {
+            // Bracketed score in [ 0 , 1 ].
+            char score[ 8 ];
+            u32 i = 0;
+            s += 1;
+            while ( *s && *s != ']' && i < sizeof ( score ) - 1 )
+            {
+                score[ i++ ] = *s;
+                s += 1;
+            }
+            score[ i ] = 0;
+            f64 x;
+            if ( string_to_f64 ( score , &x ) )
+            {
+                ( *packed ).result = ( x > 0.75 ) ? 2 : ( x < 0.25 ) ? 0 : 1;
+            }
+        }
+        else if ( board_packed_prefix ( s , "ce " ) || board_packed_prefix ( s , "fmvn " ) )
+        {
+            const bool score = *s == 'c';
+            while ( !whitespace ( *s ) )
+            {
+                s += 1;
+            }
+            while ( whitespace ( *s ) )
+            {
+                s += 1;
+            }
+            if ( board_packed_parse_i64 ( &s , &value ) )
+            {
+                if ( score )
+                {
+                    value = ( board.side == WHITE ) ? value : -value;
+                    ( *packed ).score = clamp ( value , -32767 , 32767 );
+                }
+                else
+                {
+                    fullmove = value;
+                }
+            }
+        }
+        else if ( counters < 2 && board_packed_parse_i64 ( &next , &value ) && ( !*next || whitespace ( *next ) ) )
+        {
+            // FEN move counters (the halfmove clock, then the fullmove number).
+            counters += 1;
+            fullmove = ( counters == 2 ) ? value : fullmove;
+            s = next;
+        }
+        else
+        {
+            // Skip any other token (e.g. an EPD opcode or operand).
+            while ( *s && !whitespace ( *s ) && *s != ';' && *s != '"' )
+            {
+                s += 1;
+            }
+        }
+    }
+    ( *packed ).ply = clamp ( 2 * ( fullmove - 1 ) + board.side , 0 , 65535 );
+    return true;
+}
+
+char*
+string_board_packed
+(   char*                   dst
+,   const board_packed_t*   packed
+)
+{
+    board_t board;
+    if ( !board_unpack ( &board , packed ) )
+    {
+        return 0;
+    }
+    fen_from_board ( dst , &board );
+    u64 length = string_length ( dst );
+    length += string_format ( dst + length , " fmvn %u;" , ( *packed ).ply / 2 + 1 );
+    if ( ( *packed ).score != BOARD_PACKED_SCORE_NONE )
+    {
+        length += string_format ( dst + length
+                                , " ce %i;"
+                                , ( board.side == WHITE ) ? ( *packed ).score : -( *packed ).score
+                                );
+    }
+    if ( ( *packed ).result <= 2 )
+    {
+        length += string_format ( dst + length
+                                , " c9 \"%s\";"
+                                , ( ( *packed ).result == 2 ) ? "1-0"
+                                : ( ( *packed ).result == 1 ) ? "1/2-1/2"
+                                :                               "0-1"
+                                );
+    }
+    return dst;
+}
+
+bool
+dataset_open
+(   const char* filepath
+,   dataset_t*  dataset
+)
+{
+    memory_clear ( dataset , sizeof ( dataset_t ) );
+    if ( !platform_file_map ( filepath , &( *dataset ).mapping ) )
+    {
+        return false;
+    }
+    if ( ( *dataset ).mapping.size % sizeof ( board_packed_t ) )
+    {
+        LOGERROR ( "dataset_open: '%s' is not a dataset of packed position records." , filepath );
+        platform_file_unmap ( &( *dataset ).mapping );
+        return false;
+    }
+    ( *dataset ).records = ( *dataset ).mapping.memory;
+    ( *dataset ).record_count = ( *dataset ).mapping.size / sizeof ( board_packed_t );
+    return true;
+}
+
+void
+dataset_close
+(   dataset_t* dataset
+)
+{
+    platform_file_unmap ( &( *dataset ).mapping );
+    ( *dataset ).records = 0;
+    ( *dataset ).record_count = 0;
+}
+
+void
+dataset_iterator_init
+(   dataset_iterator_t* iterator
+,   const dataset_t*    dataset
+,   const u64           seed
+,   const u64           shard
+,   const u64           shard_count
+)
+{
+    const u64 count = ( *dataset ).record_count;
+    ( *iterator ).dataset = dataset;
+    ( *iterator ).seed = seed;
+    if ( !seed )
+    {
+        // File order: each shard is a contiguous range.
+        ( *iterator ).begin = count / shard_count * shard + min ( shard , count % shard_count );
+        ( *iterator ).end = ( *iterator ).begin + count / shard_count + ( shard < count % shard_count );
+        ( *iterator ).stride = 1;
+        ( *iterator ).bits = 0;
+    }
+    else
+    {
+        // Shuffled: each shard takes every shard_count-th index of the
+        // permutation, which is defined on the smallest even power of two
+        // covering the dataset.
+        ( *iterator ).begin = shard;
+        ( *iterator ).end = count;
+        ( *iterator ).stride = shard_count;
+        ( *iterator ).bits = 2;
+        while ( ( *iterator ).bits < 64 && ( U64_1 << ( *iterator ).bits ) < count )
+        {
+            ( *iterator ).bits += 2;
+        }
+    }
+    ( *iterator ).index = ( *iterator ).begin;
+}
+
+const board_packed_t*
+dataset_next
+(   dataset_iterator_t* iterator
+)
+{
+    if ( ( *iterator ).index >= ( *iterator ).end )
+    {
+        return 0;
+    }
+    u64 index = ( *iterator ).index;
+    ( *iterator ).index += ( *iterator ).stride;
+    if ( ( *iterator ).seed )
+    {
+        // Cycle-walk the permutation of the power of two domain until it
+        // lands inside the dataset; this restricts it to a permutation of the
+        // dataset indices.
+        do
+        {
+            index = dataset_permute ( index , ( *iterator ).seed , ( *iterator ).bits );
+        }
+        while ( index >= ( *iterator ).end );
+    }
+    return &( *( *iterator ).dataset ).records[ index ];
+}
\ No newline at end of file
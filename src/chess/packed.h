@@ -0,0 +1,202 @@
+/**
+ * @file packed.h
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Packed position records and memory-mapped datasets of them.
+ *
+ * A board_packed_t stores a position with its training labels in a fixed 32
+ * bytes: the occupancy bitboard, then a 4-bit piece code (see PIECE) for
+ * each occupied square in ascending square order, then the side to move,
+ * castling rights, en passant square, game result, score and game ply. A
+ * dataset is a file of such records with no header, so it is memory-mapped
+ * and record i is read at offset 32 * i, with no parsing.
+ *
+ * dataset_iterator_t walks one shard of a dataset either in file order (each
+ * shard a contiguous range) or in a seeded pseudo-random order (each shard
+ * every n-th index of a keyed permutation of all records). The permutation
+ * is computed per index, so shuffling takes no memory and no preprocessing
+ * regardless of the number of records, and the shards of one seed are
+ * disjoint and together cover the dataset exactly once.
+ * (see also, fen.h).
+ */
+#ifndef CHESS_PACKED_H
+#define CHESS_PACKED_H
+
+#include "chess/common.h"
+
+#include "core/string.h"
+
+#include "platform/platform.h"
+
+// Defines the file extension of a dataset of packed position records.
+#define DATASET_FILE_EXTENSION ".pack"
+
+// Defines the result and score of an unlabelled record.
+#define BOARD_PACKED_RESULT_NONE    0xFF
+#define BOARD_PACKED_SCORE_NONE     ( ( i16 ) 0x8000 )
+
+// Defines the maximum length of a packed position record in string format
+// (see string_board_packed).
+#define BOARD_PACKED_STRING_MAX_LENGTH ( FEN_STRING_MAX_LENGTH + 64 )
+
+// Type definition for a packed position record.
+typedef struct
+{
+    bitboard_t  occupancy;
+    u8          pieces[ 16 ];   // One PIECE per occupied square, low nibble first.
+    u8          side;
+    u8          castle;
+    u8          enpassant;
+    u8          result;         // White's result: 0 (loss), 1 (draw), 2 (win).
+    i16         score;          // Centipawns, from white's perspective.
+    u16         ply;            // Number of moves played since the start of the game.
+}
+board_packed_t;
+
+STATIC_ASSERT ( sizeof ( board_packed_t ) == 32 , "Expected board_packed_t to be 32 bytes." );
+
+// Type definition for a memory-mapped dataset.
+typedef struct
+{
+    platform_file_mapping_t mapping;
+    const board_packed_t*   records;
+    u64                     record_count;
+}
+dataset_t;
+
+// Type definition for an iterator over one shard of a dataset.
+typedef struct
+{
+    const dataset_t*    dataset;
+    u64                 seed;
+    u64                 index;          // Next position within the shard.
+    u64                 begin;          // First position of the shard (file order).
+    u64                 end;            // One past the last position of the shard.
+    u64                 stride;         // Distance between positions of the shard.
+    u32                 bits;           // Permutation domain size (log2).
+}
+dataset_iterator_t;
+
+/**
+ * @brief Tests if a filepath names a dataset (by its file extension).
+ * @param filepath The filepath.
+ * @return true if filepath ends with DATASET_FILE_EXTENSION, false otherwise.
+ */
+INLINE
+bool
+dataset_filepath
+(   const char* filepath
+)
+{
+    const u64 length = string_length ( filepath );
+    const u64 extension = sizeof ( DATASET_FILE_EXTENSION ) - 1;
+    return length > extension
+        && string_equal ( filepath + length - extension , DATASET_FILE_EXTENSION )
+        ;
+}
+
+/**
+ * @brief Packs the position of a board state. The result and score are set
+ * to unlabelled, and the ply to 0.
+ * @param packed Output buffer.
+ * @param board A chess board state.
+ * @return true if packed, false if board has more than 32 pieces.
+ */
+bool
+board_pack
+(   board_packed_t* packed
+,   const board_t*  board
+);
+
+/**
+ * @brief Unpacks the position of a packed record into a full board state
+ * (including its attack maps).
+ * @param board Output buffer.
+ * @param packed A packed position record.
+ * @return true if unpacked, false if the record is malformed.
+ */
+bool
+board_unpack
+(   board_t*                board
+,   const board_packed_t*   packed
+);
+
+/**
+ * @brief Parses a labelled FEN or EPD line into a packed record: four FEN
+ * fields, then optionally the move counters (or the EPD fmvn opcode), a
+ * result ("1-0", "0-1" or "1/2-1/2", optionally quoted as in the c9 opcode,
+ * or a bracketed score such as [1.0], [0.5], [0.0]) and a score (the EPD ce
+ * opcode, relative to the side to move).
+ * @param s The line to parse.
+ * @param packed Output buffer.
+ * @return false if the position is invalid, true otherwise.
+ */
+bool
+board_packed_parse
+(   const char*     s
+,   board_packed_t* packed
+);
+
+/**
+ * @brief Stringify packed record as an EPD line (with the fmvn, ce and c9
+ * opcodes for the move number, score and result, where present), which
+ * board_packed_parse reads back.
+ * @param dst Output buffer. Should have adequate space for
+ * BOARD_PACKED_STRING_MAX_LENGTH bytes.
+ * @param packed A packed position record.
+ * @return dst, or 0 if the record is malformed.
+ */
+char*
+string_board_packed
+(   char*                   dst
+,   const board_packed_t*   packed
+);
+
+/**
+ * @brief Memory-maps a dataset file.
+ * @param filepath The dataset filepath.
+ * @param dataset Output buffer.
+ * @return true if dataset opened successfully, false otherwise.
+ */
+bool
+dataset_open
+(   const char* filepath
+,   dataset_t*  dataset
+);
+
+/**
+ * @brief Unmaps a dataset file.
+ * @param dataset The dataset.
+ */
+void
+dataset_close
+(   dataset_t* dataset
+);
+
+/**
+ * @brief Initializes an iterator over one shard of a dataset.
+ * @param iterator Output buffer.
+ * @param dataset The dataset.
+ * @param seed Shuffle seed; 0 iterates in file order.
+ * @param shard The shard index (less than shard_count).
+ * @param shard_count The number of shards.
+ */
+void
+dataset_iterator_init
+(   dataset_iterator_t* iterator
+,   const dataset_t*    dataset
+,   const u64           seed
+,   const u64           shard
+,   const u64           shard_count
+);
+
+/**
+ * @brief Reads the next record of an iterator's shard.
+ * @param iterator The iterator.
+ * @return The record, or 0 at the end of the shard.
+ */
+const board_packed_t*
+dataset_next
+(   dataset_iterator_t* iterator
+);
+
+#endif  // CHESS_PACKED_H
\ No newline at end of file
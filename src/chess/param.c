@@ -0,0 +1,193 @@
+/**
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @file param.c
+ * @brief Implementation of the param header.
+ * (see param.h for additional details)
+ */
+#include "chess/param.h"
+
+#include "core/logger.h"
+#include "core/memory.h"
+#include "core/string.h"
+
+#include "platform/filesystem.h"
+
+// Search parameter registry (indexed by SEARCH_PARAM).
+static const search_param_t search_params[ SEARCH_PARAM_COUNT ] =
+{   [ SEARCH_PARAM_LMR_FULL_DEPTH_MOVES ] = { "lmr_full_depth_moves" , 4     , 1 , 64    , 1    }
+,   [ SEARCH_PARAM_LMR_REDUCTION_LIMIT ]  = { "lmr_reduction_limit"  , 3     , 2 , 16    , 1    }
+,   [ SEARCH_PARAM_LMR_REDUCTION ]        = { "lmr_reduction"        , 1     , 1 , 4     , 1    }
+,   [ SEARCH_PARAM_CHECK_EXTENSION ]      = { "check_extension"      , 1     , 0 , 1     , 1    }
+,   [ SEARCH_PARAM_ASPIRATION_WINDOW ]    = { "aspiration_window"    , 0     , 0 , 1000  , 15   }
+,   [ SEARCH_PARAM_PV_BONUS ]             = { "pv_bonus"             , 20000 , 0 , 30000 , 1000 }
+,   [ SEARCH_PARAM_CAPTURE_BONUS ]        = { "capture_bonus"        , 10000 , 0 , 30000 , 500  }
+,   [ SEARCH_PARAM_KILLER_BONUS_1 ]       = { "killer_bonus_1"       , 9000  , 0 , 30000 , 500  }
+,   [ SEARCH_PARAM_KILLER_BONUS_2 ]       = { "killer_bonus_2"       , 8000  , 0 , 30000 , 500  }
+};
+
+const search_param_t*
+search_param
+(   const SEARCH_PARAM param
+)
+{
+    return &search_params[ param ];
+}
+
+SEARCH_PARAM
+search_param_find
+(   const char* name
+)
+{
+    SEARCH_PARAM param = 0;
+    while ( param < SEARCH_PARAM_COUNT && !string_equal ( search_params[ param ].name , name ) )
+    {
+        param += 1;
+    }
+    return param;
+}
+
+void
+search_params_default
+(   search_params_t* params
+)
+{
+    for ( SEARCH_PARAM param = 0; param < SEARCH_PARAM_COUNT; ++param )
+    {
+        ( *params ).values[ param ] = search_params[ param ].value;
+    }
+}
+
+bool
+search_params_set
+(   search_params_t*    params
+,   const char*         name
+,   const i64           value
+)
+{
+    const SEARCH_PARAM param = search_param_find ( name );
+    if ( param == SEARCH_PARAM_COUNT )
+    {
+        LOGERROR ( "search_params_set: Unknown search parameter '%s'." , name );
+        return false;
+    }
+    if ( value < search_params[ param ].min || value > search_params[ param ].max )
+    {
+        LOGERROR ( "search_params_set: Value %lli of search parameter '%s' is out of range [%i, %i]."
+                 , value , name , search_params[ param ].min , search_params[ param ].max
+                 );
+        return false;
+    }
+    ( *params ).values[ param ] = value;
+    return true;
+}
+
+bool
+search_params_parse
+(   search_params_t*    params
+,   const char*         s
+)
+{
+    char name[ SEARCH_PARAM_NAME_MAX_LENGTH ];
+    u32 length = 0;
+    while ( whitespace ( *s ) )
+    {
+        s += 1;
+    }
+    while ( *s && *s != '=' && !whitespace ( *s ) && length < SEARCH_PARAM_NAME_MAX_LENGTH - 1 )
+    {
+        name[ length++ ] = *s++;
+    }
+    name[ length ] = 0;
+    while ( whitespace ( *s ) )
+    {
+        s += 1;
+    }
+    if ( *s != '=' )
+    {
+        LOGERROR ( "search_params_parse: Expected 'name=value', got '%s'." , name );
+        return false;
+    }
+    s += 1;
+    while ( whitespace ( *s ) )
+    {
+        s += 1;
+    }
+
+    // Value (signed).
+    const bool negative = *s == '-';
+    s += negative;
+    char value[ 24 ];
+    length = 0;
+    while ( *s && !whitespace ( *s ) && length < sizeof ( value ) - 1 )
+    {
+        value[ length++ ] = *s++;
+    }
+    value[ length ] = 0;
+    while ( whitespace ( *s ) )
+    {
+        s += 1;
+    }
+    u64 magnitude;
+    if ( *s || !string_to_u64 ( value , &magnitude ) || magnitude > 0x7FFFFFFF )
+    {
+        LOGERROR ( "search_params_parse: Invalid value for search parameter '%s'." , name );
+        return false;
+    }
+    return search_params_set ( params , name , ( negative ) ? -( i64 ) magnitude : ( i64 ) magnitude );
+}
+
+bool
+search_params_load
+(   search_params_t*    params
+,   const char*         filepath
+)
+{
+    file_handle_t file;
+    if ( !file_open ( filepath , FILE_MODE_READ , false , &file ) )
+    {
+        LOGERROR ( "search_params_load: Unable to open configuration file '%s'." , filepath );
+        return false;
+    }
+    bool success = true;
+    char* line;
+    while ( success && file_read_line ( &file , &line ) )
+    {
+        // Strip the comment, if any.
+        for ( char* s = line; *s; ++s )
+        {
+            if ( *s == '#' )
+            {
+                *s = 0;
+                break;
+            }
+        }
+        string_trim ( line );
+        success = !*line || search_params_parse ( params , line );
+        string_free ( line );
+    }
+    file_close ( &file );
+    return success;
+}
+
+bool
+search_params_save
+(   const search_params_t*  params
+,   const char*             filepath
+)
+{
+    file_handle_t file;
+    if ( !file_open ( filepath , FILE_MODE_WRITE , false , &file ) )
+    {
+        LOGERROR ( "search_params_save: Unable to open configuration file '%s' for writing." , filepath );
+        return false;
+    }
+    bool success = true;
+    char line[ SEARCH_PARAM_NAME_MAX_LENGTH + 16 ];
+    for ( SEARCH_PARAM param = 0; param < SEARCH_PARAM_COUNT && success; ++param )
+    {
+        string_format ( line , "%s=%i" , search_params[ param ].name , ( *params ).values[ param ] );
+        success = file_write_line ( &file , line );
+    }
+    file_close ( &file );
+    return success;
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+/**
+ * @file param.h
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Tunable search parameters.
+ *
+ * Each search parameter is registered with a name, a default value, a range
+ * and a tuning step (the size of a perturbation which should make a
+ * measurable difference in strength). A search_params_t holds one value per
+ * parameter; the search reads them at run time (see move_search_t), so two
+ * searches in one process may play with different values.
+ *
+ * Values are set by name, either one at a time as "name=value" strings (e.g.
+ * from the command line), or from a configuration file holding one
+ * "name=value" line per parameter ('#' begins a comment). Parameters a
+ * configuration file does not name keep their values.
+ */
+#ifndef CHESS_PARAM_H
+#define CHESS_PARAM_H
+
+#include "chess/common.h"
+
+// Defines the maximum length of a parameter name.
+#define SEARCH_PARAM_NAME_MAX_LENGTH 32
+
+// Type definition for a search parameter.
+typedef enum
+{
+    SEARCH_PARAM_LMR_FULL_DEPTH_MOVES   // Moves searched at full depth before late move reductions apply.
+,   SEARCH_PARAM_LMR_REDUCTION_LIMIT    // Minimum remaining depth for late move reductions.
+,   SEARCH_PARAM_LMR_REDUCTION          // Plies removed by a late move reduction.
+,   SEARCH_PARAM_CHECK_EXTENSION        // Plies added when the side to move is in check.
+,   SEARCH_PARAM_ASPIRATION_WINDOW      // Half-width of the aspiration window around the previous iteration's score (0 to disable).
+,   SEARCH_PARAM_PV_BONUS               // Move ordering score of the principal variation move.
+,   SEARCH_PARAM_CAPTURE_BONUS          // Move ordering score of a capture (plus its MVV-LVA score).
+,   SEARCH_PARAM_KILLER_BONUS_1         // Move ordering score of the first killer move.
+,   SEARCH_PARAM_KILLER_BONUS_2         // Move ordering score of the second killer move.
+,   SEARCH_PARAM_COUNT
+}
+SEARCH_PARAM;
+
+// Type definition for the registry entry of a search parameter.
+typedef struct
+{
+    const char* name;
+    i32         value;          // Default.
+    i32         min;
+    i32         max;
+    i32         step;
+}
+search_param_t;
+
+// Type definition for a set of search parameter values.
+typedef struct
+{
+    i32 values[ SEARCH_PARAM_COUNT ];
+}
+search_params_t;
+
+/**
+ * @brief Looks up the registry entry of a search parameter.
+ * @param param A search parameter.
+ * @return The registry entry.
+ */
+const search_param_t*
+search_param
+(   const SEARCH_PARAM param
+);
+
+/**
+ * @brief Looks up a search parameter by name.
+ * @param name The parameter name.
+ * @return The parameter, or SEARCH_PARAM_COUNT if none has that name.
+ */
+SEARCH_PARAM
+search_param_find
+(   const char* name
+);
+
+/**
+ * @brief Sets every search parameter to its default value.
+ * @param params Output buffer.
+ */
+void
+search_params_default
+(   search_params_t* params
+);
+
+/**
+ * @brief Sets a search parameter by name.
+ * @param params The parameter values.
+ * @param name The parameter name.
+ * @param value The value.
+ * @return false if no parameter has that name or value is out of range, true
+ * otherwise.
+ */
+bool
+search_params_set
+(   search_params_t*    params
+,   const char*         name
+,   const i64           value
+);
+
+/**
+ * @brief Sets a search parameter from a "name=value" string.
+ * @param params The parameter values.
+ * @param s The string to parse.
+ * @return false if s is invalid (see search_params_set), true otherwise.
+ */
+bool
+search_params_parse
+(   search_params_t*    params
+,   const char*         s
+);
+
+/**
+ * @brief Sets search parameters from a configuration file.
+ * @param params The parameter values.
+ * @param filepath The configuration filepath.
+ * @return false if the file could not be read or holds an invalid line, true
+ * otherwise.
+ */
+bool
+search_params_load
+(   search_params_t*    params
+,   const char*         filepath
+);
+
+/**
+ * @brief Writes search parameters to a configuration file.
+ * @param params The parameter values.
+ * @param filepath The configuration filepath.
+ * @return true on success, false otherwise.
+ */
+bool
+search_params_save
+(   const search_params_t*  params
+,   const char*             filepath
+);
+
+#endif  // CHESS_PARAM_H
\ No newline at end of file
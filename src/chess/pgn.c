@@ -0,0 +1,754 @@
+/**
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @file pgn.c
+ * @brief Implementation of the pgn header.
+ * (see pgn.h for additional details)
+ */
+#include "chess/pgn.h"
+
+#include "chess/board.h"
+#include "chess/fen.h"
+#include "chess/move.h"
+#include "chess/string.h"
+
+#include "core/logger.h"
+#include "core/memory.h"
+
+#include "math/math.h"
+
+/**
+ * @brief Tests if text begins with a prefix.
+ * @param s The text.
+ * @param end The end of the text.
+ * @param prefix The prefix.
+ * @return true if s begins with prefix, false otherwise.
+ */
+INLINE
+bool
+pgn_prefix
+(   const char* s
+,   const char* end
+,   const char* prefix
+)
+{
+    for ( ; *prefix; ++s, ++prefix )
+    {
+        if ( s == end || *s != *prefix )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Finds the next occurrence of a character.
+ * @param s The position to search from.
+ * @param end The end of the text.
+ * @param c The character.
+ * @return The position of c, or end.
+ */
+INLINE
+const char*
+pgn_find
+(   const char* s
+,   const char* end
+,   const char  c
+)
+{
+    while ( s < end && *s != c )
+    {
+        s += 1;
+    }
+    return s;
+}
+
+// Defines a map for all characters: character -> ends a symbol token? Y/N
+// (a lookup keeps the innermost loop of the tokenizer to one load per byte).
+static const bool pgn_delimiters[ 256 ] = { [ ' ' ] = true , [ '\n' ] = true , [ '\t' ] = true
+                                          , [ '\v' ] = true , [ '\f' ] = true , [ '\r' ] = true
+                                          , [ '{' ] = true , [ '}' ] = true
+                                          , [ '(' ] = true , [ ')' ] = true
+                                          , [ '[' ] = true , [ ']' ] = true
+                                          , [ ';' ] = true , [ '$' ] = true
+                                          };
+
+/**
+ * @brief Tests if a character ends a symbol token.
+ * @param c The character.
+ * @return true if c is whitespace or a delimiter, false otherwise.
+ */
+INLINE
+bool
+pgn_delimiter
+(   const char c
+)
+{
+    return pgn_delimiters[ ( u8 ) c ];
+}
+
+/**
+ * @brief Appends a word to the current line of movetext, first flushing the
+ * line if the word does not fit.
+ * @param writer The writer.
+ * @param word The word.
+ * @return true on success, false otherwise.
+ */
+bool
+pgn_write_word
+(   pgn_writer_t*   writer
+,   const char*     word
+);
+
+const char*
+pgn_string_result
+(   const PGN_RESULT result
+)
+{
+    switch ( result )
+    {
+        case PGN_RESULT_WHITE: return "1-0";
+        case PGN_RESULT_BLACK: return "0-1";
+        case PGN_RESULT_DRAW:  return "1/2-1/2";
+        default:               return "*";
+    }
+}
+
+PGN_RESULT
+pgn_parse_result
+(   const char* s
+,   const u32   length
+)
+{
+    const char* end = s + length;
+    if ( length == 3 && pgn_prefix ( s , end , "1-0" ) )     return PGN_RESULT_WHITE;
+    if ( length == 3 && pgn_prefix ( s , end , "0-1" ) )     return PGN_RESULT_BLACK;
+    if ( length == 7 && pgn_prefix ( s , end , "1/2-1/2" ) ) return PGN_RESULT_DRAW;
+    return PGN_RESULT_UNKNOWN;
+}
+
+const char*
+pgn_find_game
+(   const char* s
+,   const char* end
+)
+{
+    for ( s = pgn_find ( s , end , '\n' ); s < end; s = pgn_find ( s + 1 , end , '\n' ) )
+    {
+        if ( pgn_prefix ( s , end , PGN_GAME_BOUNDARY ) )
+        {
+            return s + 1;
+        }
+    }
+    return end;
+}
+
+void
+pgn_lexer_init
+(   pgn_lexer_t*    lexer
+,   const char*     begin
+,   const char*     end
+)
+{
+    ( *lexer ).s = begin;
+    ( *lexer ).end = end;
+    ( *lexer ).boundary = true;
+}
+
+bool
+pgn_lexer_next
+(   pgn_lexer_t*    lexer
+,   pgn_token_t*    token
+)
+{
+    const char* s = ( *lexer ).s;
+    const char* const end = ( *lexer ).end;
+    for (;;)
+    {
+        // Skip whitespace.
+        while ( s < end && whitespace ( *s ) )
+        {
+            s += 1;
+        }
+        if ( s == end )
+        {
+            ( *lexer ).s = s;
+            return false;
+        }
+
+        ( *token ).value = 0;
+        ( *token ).value_length = 0;
+        const char* text = s;
+
+        switch ( *s )
+        {
+            // Tag pair: [Name "value"]
+            case '[':
+            {
+                s += 1;
+                while ( s < end && whitespace ( *s ) )
+                {
+                    s += 1;
+                }
+                text = s;
+                while ( s < end && !whitespace ( *s ) && *s != '"' && *s != ']' )
+                {
+                    s += 1;
+                }
+                ( *token ).type = PGN_TOKEN_TAG;
+                ( *token ).text = text;
+                ( *token ).length = s - text;
+                while ( s < end && *s != '"' && *s != ']' )
+                {
+                    s += 1;
+                }
+                if ( s < end && *s == '"' )
+                {
+                    s += 1;
+                    ( *token ).value = s;
+                    while ( s < end && *s != '"' )
+                    {
+                        s += 1 + ( *s == '\\' && s + 1 < end );
+                    }
+                    ( *token ).value_length = s - ( *token ).value;
+                }
+                while ( s < end && *s != ']' && *s != '\n' )
+                {
+                    s += 1;
+                }
+                s += ( s < end && *s == ']' );
+                ( *lexer ).s = s;
+                return true;
+            }
+
+            // Brace comment.
+            case '{':
+            {
+                const char* close = pgn_find ( s + 1 , end , '}' );
+                ( *token ).type = PGN_TOKEN_COMMENT;
+                ( *token ).text = s + 1;
+                ( *token ).length = close - s - 1;
+                ( *lexer ).s = close + ( close < end );
+                return true;
+            }
+
+            // Rest of line comment.
+            case ';':
+            {
+                const char* eol = pgn_find ( s + 1 , end , '\n' );
+                ( *token ).type = PGN_TOKEN_COMMENT;
+                ( *token ).text = s + 1;
+                ( *token ).length = eol - s - 1;
+                ( *lexer ).s = eol;
+                return true;
+            }
+
+            // Escape line.
+            case '%':
+            {
+                s = pgn_find ( s , end , '\n' );
+                continue;
+            }
+
+            case '(':
+            {
+                ( *token ).type = PGN_TOKEN_VARIATION_BEGIN;
+                ( *token ).text = s;
+                ( *token ).length = 1;
+                ( *lexer ).s = s + 1;
+                return true;
+            }
+
+            case ')':
+            {
+                ( *token ).type = PGN_TOKEN_VARIATION_END;
+                ( *token ).text = s;
+                ( *token ).length = 1;
+                ( *lexer ).s = s + 1;
+                return true;
+            }
+
+            // Numeric annotation glyph.
+            case '$':
+            {
+                s += 1;
+                while ( s < end && digit ( *s ) )
+                {
+                    s += 1;
+                }
+                ( *token ).type = PGN_TOKEN_NAG;
+                ( *token ).text = text;
+                ( *token ).length = s - text;
+                ( *lexer ).s = s;
+                return true;
+            }
+
+            // Stray delimiters.
+            case ']':
+            case '}':
+            {
+                s += 1;
+                continue;
+            }
+
+            default:
+            {
+                break;
+            }
+        }
+
+        // Symbol.
+        while ( s < end && !pgn_delimiter ( *s ) )
+        {
+            s += 1;
+        }
+        const u32 length = s - text;
+
+        // Game termination marker.
+        if (    ( length == 1 && *text == '*' )
+             || pgn_parse_result ( text , length ) != PGN_RESULT_UNKNOWN
+           )
+        {
+            ( *token ).type = PGN_TOKEN_RESULT;
+            ( *token ).text = text;
+            ( *token ).length = length;
+            ( *lexer ).s = s;
+            ( *lexer ).boundary = true;
+            return true;
+        }
+
+        // Strip a move number (e.g. "12.", "12...", "12.e4" or "12...e5").
+        const char* san = text;
+        while ( san < s && digit ( *san ) )
+        {
+            san += 1;
+        }
+        if ( san < s && *san == '.' )
+        {
+            while ( san < s && *san == '.' )
+            {
+                san += 1;
+            }
+        }
+        else
+        {
+            san = text;
+        }
+        if ( san == s )
+        {
+            continue;
+        }
+
+        ( *token ).type = PGN_TOKEN_MOVE;
+        ( *token ).text = san;
+        ( *token ).length = s - san;
+        ( *lexer ).s = s;
+        ( *lexer ).boundary = false;
+        return true;
+    }
+}
+
+bool
+pgn_game_begin
+(   pgn_lexer_t*        lexer
+,   const attacks_t*    attacks
+,   pgn_game_t*         game
+)
+{
+    ( *game ).tag_count = 0;
+    ( *game ).ply = 0;
+    ( *game ).result = PGN_RESULT_UNKNOWN;
+    ( *game ).error = false;
+    ( *game ).end = false;
+
+    // Skip to the next tag section, or to the movetext of a game without one.
+    pgn_token_t token;
+    pgn_lexer_t mark;
+    for (;;)
+    {
+        mark = *lexer;
+        if ( !pgn_lexer_next ( lexer , &token ) )
+        {
+            return false;
+        }
+        if ( token.type == PGN_TOKEN_TAG )
+        {
+            break;
+        }
+        if ( token.type == PGN_TOKEN_MOVE && mark.boundary )
+        {
+            *lexer = mark;
+            break;
+        }
+    }
+
+    // Read the tag section.
+    while ( token.type == PGN_TOKEN_TAG )
+    {
+        if ( ( *game ).tag_count < PGN_MAX_TAGS )
+        {
+            ( *game ).tags[ ( *game ).tag_count ] = token;
+            ( *game ).tag_count += 1;
+        }
+        mark = *lexer;
+        if ( !pgn_lexer_next ( lexer , &token ) )
+        {
+            break;
+        }
+        if ( token.type != PGN_TOKEN_TAG )
+        {
+            *lexer = mark;
+        }
+    }
+    ( *lexer ).boundary = false;
+
+    // Starting position.
+    const pgn_token_t* fen = pgn_game_tag ( game , "FEN" );
+    if ( fen && ( *fen ).value_length < FEN_STRING_MAX_LENGTH - 1 )
+    {
+        char s[ FEN_STRING_MAX_LENGTH ];
+        memory_copy ( s , ( *fen ).value , ( *fen ).value_length );
+        s[ ( *fen ).value_length ] = 0;
+        ( *game ).error = !fen_parse ( s , &( *game ).board );
+    }
+    else
+    {
+        ( *game ).error = fen || !fen_parse ( FEN_START , &( *game ).board );
+    }
+
+    // The result tag holds the result until the movetext confirms it.
+    const pgn_token_t* result = pgn_game_tag ( game , "Result" );
+    if ( result )
+    {
+        ( *game ).result = pgn_parse_result ( ( *result ).value , ( *result ).value_length );
+    }
+    return true;
+}
+
+bool
+pgn_game_next
+(   pgn_lexer_t*        lexer
+,   const attacks_t*    attacks
+,   pgn_game_t*         game
+,   move_t*             move
+)
+{
+    if ( ( *game ).error || ( *game ).end )
+    {
+        return false;
+    }
+
+    pgn_token_t token;
+    pgn_lexer_t mark;
+    u32 nesting = 0;
+    for (;;)
+    {
+        mark = *lexer;
+        if ( !pgn_lexer_next ( lexer , &token ) )
+        {
+            ( *game ).end = true;
+            return false;
+        }
+        switch ( token.type )
+        {
+            case PGN_TOKEN_VARIATION_BEGIN:
+            {
+                nesting += 1;
+                continue;
+            }
+            case PGN_TOKEN_VARIATION_END:
+            {
+                nesting -= ( nesting > 0 );
+                continue;
+            }
+            case PGN_TOKEN_RESULT:
+            {
+                ( *game ).result = pgn_parse_result ( token.text , token.length );
+                ( *game ).end = true;
+                return false;
+            }
+            case PGN_TOKEN_TAG:
+            {
+                // The next game begins (this one has no termination marker).
+                *lexer = mark;
+                ( *lexer ).boundary = true;
+                ( *game ).end = true;
+                return false;
+            }
+            case PGN_TOKEN_MOVE:
+            {
+                if ( !nesting )
+                {
+                    break;
+                }
+                continue;
+            }
+            default:
+            {
+                continue;
+            }
+        }
+
+        // Parse the move in standard algebraic notation.
+        char san[ MOVE_SAN_STRING_MAX_LENGTH + 4 ];
+        const u32 length = min ( token.length , sizeof ( san ) - 1 );
+        memory_copy ( san , token.text , length );
+        san[ length ] = 0;
+        moves_t moves;
+        moves_compute ( &moves , &( *game ).board , attacks );
+        if ( !move_parse_san ( san , &( *game ).board , &moves , attacks , move ) )
+        {
+            ( *game ).error = true;
+            return false;
+        }
+        board_move ( &( *game ).board , *move , attacks );
+        ( *game ).ply += 1;
+        return true;
+    }
+}
+
+void
+pgn_game_end
+(   pgn_lexer_t*    lexer
+,   pgn_game_t*     game
+)
+{
+    pgn_token_t token;
+    pgn_lexer_t mark;
+    while ( !( *game ).end )
+    {
+        mark = *lexer;
+        if ( !pgn_lexer_next ( lexer , &token ) )
+        {
+            break;
+        }
+        if ( token.type == PGN_TOKEN_RESULT )
+        {
+            ( *game ).result = pgn_parse_result ( token.text , token.length );
+            break;
+        }
+        if ( token.type == PGN_TOKEN_TAG )
+        {
+            *lexer = mark;
+            ( *lexer ).boundary = true;
+            break;
+        }
+    }
+    ( *game ).end = true;
+}
+
+const pgn_token_t*
+pgn_game_tag
+(   const pgn_game_t*   game
+,   const char*         name
+)
+{
+    for ( u32 i = 0; i < ( *game ).tag_count; ++i )
+    {
+        const pgn_token_t* tag = &( *game ).tags[ i ];
+        if (    pgn_prefix ( ( *tag ).text , ( *tag ).text + ( *tag ).length , name )
+             && !name[ ( *tag ).length ]
+           )
+        {
+            return tag;
+        }
+    }
+    return 0;
+}
+
+bool
+pgn_reader_open
+(   const char*     filepath
+,   const u64       capacity
+,   pgn_reader_t*   reader
+)
+{
+    memory_clear ( reader , sizeof ( pgn_reader_t ) );
+    if ( !file_open ( filepath , FILE_MODE_READ , true , &( *reader ).file ) )
+    {
+        return false;
+    }
+    ( *reader ).capacity = capacity;
+    ( *reader ).buffer = memory_allocate ( capacity , MEMORY_TAG_APPLICATION );
+    return true;
+}
+
+bool
+pgn_reader_next
+(   pgn_reader_t*   reader
+,   const char**    begin
+,   const char**    end
+)
+{
+    if ( ( *reader ).eof )
+    {
+        return false;
+    }
+
+    // Move the partial game left over from the previous chunk to the front of
+    // the buffer, then fill the rest.
+    char* const buffer = ( *reader ).buffer;
+    memory_move ( buffer , buffer + ( *reader ).size - ( *reader ).carry , ( *reader ).carry );
+    const u64 space = ( *reader ).capacity - ( *reader ).carry;
+    u64 read = 0;
+    file_read ( &( *reader ).file , space , buffer + ( *reader ).carry , &read );
+    ( *reader ).eof = read < space;
+    ( *reader ).size = ( *reader ).carry + read;
+    const char* const end_ = buffer + ( *reader ).size;
+
+    // Only hand out complete games; the trailing partial game is carried over
+    // to the next chunk.
+    const char* cut = end_;
+    if ( !( *reader ).eof )
+    {
+        cut = 0;
+        for ( const char* s = pgn_find_game ( buffer , end_ ); s != end_; s = pgn_find_game ( s , end_ ) )
+        {
+            cut = s;
+        }
+        if ( !cut || cut == buffer )
+        {
+            LOGWARN ( "pgn_reader_next: A single game exceeds the read buffer; it may be split." );
+            cut = end_;
+        }
+    }
+
+    *begin = buffer;
+    *end = cut;
+    ( *reader ).carry = end_ - cut;
+    return true;
+}
+
+void
+pgn_reader_close
+(   pgn_reader_t* reader
+)
+{
+    file_close ( &( *reader ).file );
+    memory_free ( ( *reader ).buffer , ( *reader ).capacity , MEMORY_TAG_APPLICATION );
+    ( *reader ).buffer = 0;
+}
+
+void
+pgn_write_begin
+(   pgn_writer_t*   writer
+,   file_handle_t*  file
+)
+{
+    memory_clear ( writer , sizeof ( pgn_writer_t ) );
+    ( *writer ).file = file;
+}
+
+bool
+pgn_write_tag
+(   pgn_writer_t*   writer
+,   const char*     name
+,   const char*     value
+)
+{
+    char line[ STACK_STRING_MAX_LENGTH ];
+    u64 length = string_format ( line , "[%s \"" , name );
+    for ( ; *value && length < STACK_STRING_MAX_LENGTH - 4; ++value )
+    {
+        if ( *value == '"' || *value == '\\' )
+        {
+            line[ length++ ] = '\\';
+        }
+        line[ length++ ] = *value;
+    }
+    line[ length++ ] = '"';
+    line[ length++ ] = ']';
+    line[ length ] = 0;
+    ( *writer ).tag_count += 1;
+    return file_write_line ( ( *writer ).file , line );
+}
+
+bool
+pgn_write_move
+(   pgn_writer_t*       writer
+,   const board_t*      board
+,   const attacks_t*    attacks
+,   const move_t        move
+)
+{
+    char word[ 16 + MOVE_SAN_STRING_BUFFER_LENGTH ];
+
+    // The movetext is separated from the tag section by a blank line; a game
+    // which begins with black to move is numbered "1...".
+    if ( !( *writer ).movetext )
+    {
+        if ( ( *writer ).tag_count && !file_write_line ( ( *writer ).file , "" ) )
+        {
+            return false;
+        }
+        ( *writer ).movetext = true;
+        ( *writer ).ply = ( ( *board ).side == BLACK );
+        if ( ( *board ).side == BLACK && !pgn_write_word ( writer , "1..." ) )
+        {
+            return false;
+        }
+    }
+
+    // Move number.
+    if ( !( ( *writer ).ply & 1 ) )
+    {
+        string_format ( word , "%u." , ( *writer ).ply / 2 + 1 );
+        if ( !pgn_write_word ( writer , word ) )
+        {
+            return false;
+        }
+    }
+
+    moves_t moves;
+    moves_compute ( &moves , board , attacks );
+    string_move_san ( word , board , &moves , attacks , move );
+    ( *writer ).ply += 1;
+    return pgn_write_word ( writer , word );
+}
+
+bool
+pgn_write_end
+(   pgn_writer_t*       writer
+,   const PGN_RESULT    result
+)
+{
+    if ( !( *writer ).movetext && ( *writer ).tag_count && !file_write_line ( ( *writer ).file , "" ) )
+    {
+        return false;
+    }
+    ( *writer ).movetext = true;
+    if ( !pgn_write_word ( writer , pgn_string_result ( result ) ) )
+    {
+        return false;
+    }
+    const bool success = file_write_line ( ( *writer ).file , ( *writer ).line )
+                      && file_write_line ( ( *writer ).file , "" )
+                      ;
+    ( *writer ).length = 0;
+    return success;
+}
+
+bool
+pgn_write_word
+(   pgn_writer_t*   writer
+,   const char*     word
+)
+{
+    const u64 length = string_length ( word );
+    if ( ( *writer ).length && ( *writer ).length + 1 + length > PGN_LINE_LENGTH )
+    {
+        if ( !file_write_line ( ( *writer ).file , ( *writer ).line ) )
+        {
+            return false;
+        }
+        ( *writer ).length = 0;
+    }
+    if ( ( *writer ).length )
+    {
+        ( *writer ).line[ ( *writer ).length++ ] = ' ';
+    }
+    memory_copy ( ( *writer ).line + ( *writer ).length , word , length );
+    ( *writer ).length += length;
+    ( *writer ).line[ ( *writer ).length ] = 0;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,333 @@
+/**
+ * @file pgn.h
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Portable Game Notation (PGN) reader and writer.
+ *
+ * The reader is layered so that a game database of any size is processed in
+ * bounded memory and without allocating per token or per game:
+ *
+ *  - pgn_reader_t streams a file in large chunks and hands out ranges which
+ *    hold only complete games (the trailing partial game of a chunk is
+ *    carried over to the next one). pgn_find_game locates game boundaries,
+ *    so a range can be split further across threads.
+ *  - pgn_lexer_t tokenizes a range in place: tag pairs, moves, comments,
+ *    variations, numeric annotation glyphs and game termination markers.
+ *    Tokens point into the range, and move numbers are skipped.
+ *  - pgn_game_t replays the main line of one game at a time: it reads the
+ *    tag section (including a custom starting position), then parses each
+ *    move in standard algebraic notation against the current board state,
+ *    skipping comments and variations.
+ *
+ * The writer formats one game at a time (tag section, numbered movetext
+ * wrapped to PGN_LINE_LENGTH columns, game termination marker), generating
+ * the standard algebraic notation of each move (see string_move_san).
+ */
+#ifndef CHESS_PGN_H
+#define CHESS_PGN_H
+
+#include "chess/common.h"
+
+#include "platform/filesystem.h"
+
+// Defines the maximum length of a line of movetext written by pgn_writer_t.
+#define PGN_LINE_LENGTH 79
+
+// Defines the maximum number of tag pairs kept per game (the rest are skipped).
+#define PGN_MAX_TAGS 32
+
+// Defines the tag which begins each game of a well-formed database.
+#define PGN_GAME_BOUNDARY "\n[Event "
+
+// Type definition for a token type.
+typedef enum
+{
+    PGN_TOKEN_TAG
+,   PGN_TOKEN_MOVE
+,   PGN_TOKEN_COMMENT
+,   PGN_TOKEN_VARIATION_BEGIN
+,   PGN_TOKEN_VARIATION_END
+,   PGN_TOKEN_NAG
+,   PGN_TOKEN_RESULT
+}
+PGN_TOKEN;
+
+// Type definition for a game result.
+typedef enum
+{
+    PGN_RESULT_UNKNOWN
+,   PGN_RESULT_WHITE
+,   PGN_RESULT_BLACK
+,   PGN_RESULT_DRAW
+}
+PGN_RESULT;
+
+// Type definition for a token. Its text is not terminated; it points into the
+// range being tokenized, which must outlive the token.
+typedef struct
+{
+    PGN_TOKEN   type;
+    const char* text;           // Tag name, move, comment body, glyph or marker.
+    u32         length;
+    const char* value;          // Tag value (still escaped); PGN_TOKEN_TAG only.
+    u32         value_length;
+}
+pgn_token_t;
+
+// Type definition for a tokenizer over a range of text.
+typedef struct
+{
+    const char* s;
+    const char* end;
+    bool        boundary;       // At a game boundary (the start of the range, or after a game termination marker)? Y/N
+}
+pgn_lexer_t;
+
+// Type definition for the state of a game being replayed.
+typedef struct
+{
+    pgn_token_t tags[ PGN_MAX_TAGS ];
+    u32         tag_count;
+
+    board_t     board;          // The position before the next move.
+    u32         ply;            // Number of moves replayed.
+    PGN_RESULT  result;
+    bool        error;          // Stopped at an illegal or unparsable move? Y/N
+    bool        end;            // Read the whole movetext? Y/N
+}
+pgn_game_t;
+
+// Type definition for a streaming reader.
+typedef struct
+{
+    file_handle_t   file;
+    char*           buffer;
+    u64             capacity;
+    u64             size;           // Bytes held by the buffer.
+    u64             carry;          // Bytes at the end of the buffer which hold a partial game.
+    bool            eof;
+}
+pgn_reader_t;
+
+// Type definition for a writer.
+typedef struct
+{
+    file_handle_t*  file;
+    char            line[ PGN_LINE_LENGTH + 1 ];
+    u32             length;
+    u32             tag_count;
+    u32             ply;
+    bool            movetext;
+}
+pgn_writer_t;
+
+/**
+ * @brief Stringify game result.
+ * @param result A game result.
+ * @return The game termination marker for result ("*" if unknown).
+ */
+const char*
+pgn_string_result
+(   const PGN_RESULT result
+);
+
+/**
+ * @brief Parses a game termination marker.
+ * @param s The text.
+ * @param length Length of the text.
+ * @return The game result (PGN_RESULT_UNKNOWN for "*" or any other text).
+ */
+PGN_RESULT
+pgn_parse_result
+(   const char* s
+,   const u32   length
+);
+
+/**
+ * @brief Finds the next game boundary at or after a position.
+ * @param s The position to search from.
+ * @param end The end of the text.
+ * @return The position of the boundary (one past the line break), or end.
+ */
+const char*
+pgn_find_game
+(   const char* s
+,   const char* end
+);
+
+/**
+ * @brief Initializes a tokenizer over a range of text.
+ * @param lexer Output buffer.
+ * @param begin The beginning of the text.
+ * @param end The end of the text.
+ */
+void
+pgn_lexer_init
+(   pgn_lexer_t*    lexer
+,   const char*     begin
+,   const char*     end
+);
+
+/**
+ * @brief Reads the next token.
+ * @param lexer The tokenizer.
+ * @param token Output buffer.
+ * @return true if a token was read, false at the end of the text.
+ */
+bool
+pgn_lexer_next
+(   pgn_lexer_t*    lexer
+,   pgn_token_t*    token
+);
+
+/**
+ * @brief Reads the tag section of the next game and sets up its starting
+ * position (from the FEN tag, if any). Skips whatever remains of the
+ * previous game.
+ * @param lexer The tokenizer.
+ * @param attacks The pregenerated attack tables.
+ * @param game Output buffer.
+ * @return true if a game was found, false at the end of the text.
+ */
+bool
+pgn_game_begin
+(   pgn_lexer_t*        lexer
+,   const attacks_t*    attacks
+,   pgn_game_t*         game
+);
+
+/**
+ * @brief Reads the next move of the main line of a game and performs it on
+ * ( *game ).board, skipping comments, variations and glyphs. The board state
+ * the move was played from is ( *game ).board before the call.
+ * @param lexer The tokenizer.
+ * @param attacks The pregenerated attack tables.
+ * @param game The game state.
+ * @param move Output buffer.
+ * @return true if a move was read, false at the end of the game or if the
+ * move is illegal or unparsable (then ( *game ).error is set).
+ */
+bool
+pgn_game_next
+(   pgn_lexer_t*        lexer
+,   const attacks_t*    attacks
+,   pgn_game_t*         game
+,   move_t*             move
+);
+
+/**
+ * @brief Skips the rest of the movetext of a game without replaying it,
+ * reading its game termination marker (see ( *game ).result).
+ * @param lexer The tokenizer.
+ * @param game The game state.
+ */
+void
+pgn_game_end
+(   pgn_lexer_t*    lexer
+,   pgn_game_t*     game
+);
+
+/**
+ * @brief Looks up a tag pair of a game by name.
+ * @param game The game state.
+ * @param name The tag name.
+ * @return The tag pair, or 0 if the game has no such tag.
+ */
+const pgn_token_t*
+pgn_game_tag
+(   const pgn_game_t*   game
+,   const char*         name
+);
+
+/**
+ * @brief Opens a game database for streaming.
+ * @param filepath The database filepath.
+ * @param capacity Size of the read buffer (bounds the size of a single game).
+ * @param reader Output buffer.
+ * @return true if database opened successfully, false otherwise.
+ */
+bool
+pgn_reader_open
+(   const char*     filepath
+,   const u64       capacity
+,   pgn_reader_t*   reader
+);
+
+/**
+ * @brief Reads the next chunk of a game database.
+ * @param reader The reader.
+ * @param begin Output buffer for the beginning of the complete games read.
+ * @param end Output buffer for the end of the complete games read.
+ * @return true if a chunk was read, false at the end of the database.
+ */
+bool
+pgn_reader_next
+(   pgn_reader_t*   reader
+,   const char**    begin
+,   const char**    end
+);
+
+/**
+ * @brief Closes a game database.
+ * @param reader The reader.
+ */
+void
+pgn_reader_close
+(   pgn_reader_t* reader
+);
+
+/**
+ * @brief Begins writing a game. The tag section is written first (see
+ * pgn_write_tag), then the movetext (see pgn_write_move).
+ * @param writer Output buffer.
+ * @param file The file to write to.
+ */
+void
+pgn_write_begin
+(   pgn_writer_t*   writer
+,   file_handle_t*  file
+);
+
+/**
+ * @brief Writes a tag pair.
+ * @param writer The writer.
+ * @param name The tag name.
+ * @param value The tag value (escaped by the writer).
+ * @return true on success, false otherwise.
+ */
+bool
+pgn_write_tag
+(   pgn_writer_t*   writer
+,   const char*     name
+,   const char*     value
+);
+
+/**
+ * @brief Writes a move in standard algebraic notation, preceded by its move
+ * number when needed. Requires pregenerated attack tables.
+ * @param writer The writer.
+ * @param board The board state the move is played from.
+ * @param attacks The pregenerated attack tables.
+ * @param move A legal move for board.
+ * @return true on success, false otherwise.
+ */
+bool
+pgn_write_move
+(   pgn_writer_t*       writer
+,   const board_t*      board
+,   const attacks_t*    attacks
+,   const move_t        move
+);
+
+/**
+ * @brief Ends a game: writes the game termination marker and a blank line.
+ * @param writer The writer.
+ * @param result The game result.
+ * @return true on success, false otherwise.
+ */
+bool
+pgn_write_end
+(   pgn_writer_t*       writer
+,   const PGN_RESULT    result
+);
+
+#endif  // CHESS_PGN_H
\ No newline at end of file
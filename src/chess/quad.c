@@ -0,0 +1,232 @@
+/**
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @file quad.c
+ * @brief Implementation of the quad header.
+ * (see quad.h for additional details)
+ */
+#include "chess/quad.h"
+
+#include "chess/board.h"
+#include "chess/castle.h"
+#include "chess/move.h"
+
+#include "core/memory.h"
+
+/**
+ * @brief Places a piece on an empty square of a compact board state.
+ * @param quad The compact board state to mutate.
+ * @param square The square.
+ * @param piece The piece.
+ */
+INLINE
+void
+board_quad_set
+(   board_quad_t*   quad
+,   const SQUARE    square
+,   const PIECE     piece
+)
+{
+    const u8 code = piece % 6 + 1;
+    ( *quad ).planes[ 0 ] |= ( bitboard_t )( piece >= p ) << square;
+    ( *quad ).planes[ 1 ] |= ( bitboard_t )( code & 1 ) << square;
+    ( *quad ).planes[ 2 ] |= ( bitboard_t )( ( code >> 1 ) & 1 ) << square;
+    ( *quad ).planes[ 3 ] |= ( bitboard_t )( ( code >> 2 ) & 1 ) << square;
+}
+
+/**
+ * @brief Empties a square of a compact board state.
+ * @param quad The compact board state to mutate.
+ * @param square The square.
+ */
+INLINE
+void
+board_quad_clear
+(   board_quad_t*   quad
+,   const SQUARE    square
+)
+{
+    const bitboard_t mask = ~( U64_1 << square );
+    ( *quad ).planes[ 0 ] &= mask;
+    ( *quad ).planes[ 1 ] &= mask;
+    ( *quad ).planes[ 2 ] &= mask;
+    ( *quad ).planes[ 3 ] &= mask;
+}
+
+/**
+ * @brief Reads the piece on an occupied square of a compact board state.
+ * @param quad A compact board state.
+ * @param square The square.
+ * @return The piece.
+ */
+INLINE
+PIECE
+board_quad_get
+(   const board_quad_t* quad
+,   const SQUARE        square
+)
+{
+    const u8 code = ( ( ( *quad ).planes[ 1 ] >> square ) & 1 )
+                  | ( ( ( ( *quad ).planes[ 2 ] >> square ) & 1 ) << 1 )
+                  | ( ( ( ( *quad ).planes[ 3 ] >> square ) & 1 ) << 2 )
+                  ;
+    return ( ( ( *quad ).planes[ 0 ] >> square ) & 1 ) * 6 + code - 1;
+}
+
+void
+board_quad_pack
+(   board_quad_t*   quad
+,   const board_t*  board
+)
+{
+    memory_clear ( quad , sizeof ( board_quad_t ) );
+    for ( PIECE piece = P; piece <= k; ++piece )
+    {
+        const u8 code = piece % 6 + 1;
+        const bitboard_t pieces = ( *board ).pieces[ piece ];
+        if ( piece >= p )
+        {
+            ( *quad ).planes[ 0 ] |= pieces;
+        }
+        if ( code & 1 )
+        {
+            ( *quad ).planes[ 1 ] |= pieces;
+        }
+        if ( code & 2 )
+        {
+            ( *quad ).planes[ 2 ] |= pieces;
+        }
+        if ( code & 4 )
+        {
+            ( *quad ).planes[ 3 ] |= pieces;
+        }
+    }
+    ( *quad ).side = ( *board ).side;
+    ( *quad ).enpassant = ( *board ).enpassant;
+    ( *quad ).castle = ( *board ).castle;
+    ( *quad ).capture = ( *board ).capture;
+}
+
+void
+board_quad_unpack
+(   board_t*            board
+,   const board_quad_t* quad
+)
+{
+    board_quad_expand ( board , quad );
+    ( *board ).capture = ( *quad ).capture;
+    board_attacks_refresh ( board );
+}
+
+void
+board_quad_move
+(   board_quad_t*   quad
+,   const move_t    move
+)
+{
+    const SIDE side = ( *quad ).side;
+    const SQUARE src = move_decode_src ( move );
+    const SQUARE dst = move_decode_dst ( move );
+    const PIECE piece = move_decode_piece ( move );
+    const PIECE promotion = move_decode_promotion ( move );
+    const i32 forward = ( side == WHITE ) ? -8 : 8;
+
+    // Parse capture.
+    if ( move_decode_enpassant ( move ) )
+    {
+        ( *quad ).capture = ( side == WHITE ) ? p : P;
+        board_quad_clear ( quad , dst - forward );
+    }
+    else if ( move_decode_capture ( move ) )
+    {
+        ( *quad ).capture = board_quad_get ( quad , dst );
+        board_quad_clear ( quad , dst );
+    }
+
+    // Move the piece (or its promotion).
+    board_quad_clear ( quad , src );
+    board_quad_set ( quad , dst , ( promotion ) ? promotion : piece );
+
+    // Parse castling.
+    if ( move_decode_castle ( move ) )
+    {
+        const PIECE rook = ( side == WHITE ) ? R : r;
+        const SQUARE king = ( side == WHITE ) ? E1 : E8;
+        const SQUARE from = ( dst == king + 2 ) ? king + 3 : king - 4;
+        const SQUARE to = ( dst == king + 2 ) ? king + 1 : king - 1;
+        board_quad_clear ( quad , from );
+        board_quad_set ( quad , to , rook );
+    }
+
+    // Update en passant square and castling rights.
+    ( *quad ).enpassant = ( move_decode_double_push ( move ) ) ? dst - forward : NO_SQ;
+    ( *quad ).castle &= castling_rights[ src ];
+    ( *quad ).castle &= castling_rights[ dst ];
+
+    // Toggle side.
+    ( *quad ).side = !side;
+}
+
+bool
+board_quad_check
+(   const board_quad_t* quad
+,   const SIDE          side
+)
+{
+    const PIECE other = ( side == WHITE ) ? p : P;
+    const bitboard_t king = board_quad_pieces ( quad , ( side == WHITE ) ? K : k );
+    const bitboard_t occupancy = board_quad_occupancy ( quad );
+    const bitboard_t queens = board_quad_pieces ( quad , other + Q );
+    return ( bitboard_pawn_attacks ( king , side ) & board_quad_pieces ( quad , other ) )
+        || ( bitboard_knight_attacks ( king ) & board_quad_pieces ( quad , other + N ) )
+        || ( bitboard_bishop_attacks ( king , occupancy ) & ( board_quad_pieces ( quad , other + B ) | queens ) )
+        || ( bitboard_rook_attacks ( king , occupancy ) & ( board_quad_pieces ( quad , other + R ) | queens ) )
+        || ( bitboard_king_attacks ( king ) & board_quad_pieces ( quad , other + K ) )
+        ;
+}
+
+void
+board_quad_expand
+(   board_t*            board
+,   const board_quad_t* quad
+)
+{
+    for ( PIECE piece = P; piece <= k; ++piece )
+    {
+        ( *board ).pieces[ piece ] = board_quad_pieces ( quad , piece );
+    }
+    ( *board ).occupancies[ 2 ] = board_quad_occupancy ( quad );
+    ( *board ).occupancies[ BLACK ] = ( *quad ).planes[ 0 ];
+    ( *board ).occupancies[ WHITE ] = ( *board ).occupancies[ 2 ] & ~( *quad ).planes[ 0 ];
+    ( *board ).side = ( *quad ).side;
+    ( *board ).enpassant = ( *quad ).enpassant;
+    ( *board ).castle = ( *quad ).castle;
+
+    // The move generator reads the squares attacked by the opponent only to
+    // test castling.
+    if ( ( *board ).castle & ( ( ( *board ).side == WHITE ) ? ( CASTLE_WK | CASTLE_WQ )
+                                                            : ( CASTLE_BK | CASTLE_BQ )
+                                                            ))
+    {
+        const SIDE other = !( *board ).side;
+        const PIECE offset = ( other == WHITE ) ? P : p;
+        const bitboard_t queens = ( *board ).pieces[ offset + Q ];
+        ( *board ).attacked[ other ] = bitboard_pawn_attacks ( ( *board ).pieces[ offset ] , other )
+                                     | bitboard_knight_attacks ( ( *board ).pieces[ offset + N ] )
+                                     | bitboard_bishop_attacks ( ( *board ).pieces[ offset + B ] | queens , ( *board ).occupancies[ 2 ] )
+                                     | bitboard_rook_attacks ( ( *board ).pieces[ offset + R ] | queens , ( *board ).occupancies[ 2 ] )
+                                     | bitboard_king_attacks ( ( *board ).pieces[ offset + K ] )
+                                     ;
+    }
+}
+
+u32
+moves_generate_quad
+(   move_t*             moves
+,   const board_quad_t* quad
+,   const attacks_t*    attacks
+)
+{
+    board_t board;
+    board_quad_expand ( &board , quad );
+    return moves_generate ( moves , &board , attacks );
+}
\ No newline at end of file
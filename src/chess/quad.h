@@ -0,0 +1,150 @@
+/**
+ * @file quad.h
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Compact board state representation (quad-bitboard).
+ *
+ * A board_quad_t encodes the pieces of a board in four bitboards: one with the
+ * squares of the black pieces, and three bit planes which together hold the
+ * piece type (plus one, so that an empty square reads zero) of every square.
+ * With the side to move, en passant square, castling rights and last capture
+ * in one byte each, the whole state takes 40 bytes against the several
+ * hundred of board_t, so it is cheap to copy and to hash.
+ *
+ * The piece bitboards of board_t are recovered with a few bitwise operations
+ * per piece (see board_quad_pieces); board_quad_unpack expands a compact state
+ * into a full board_t, and moves_generate_quad runs the move generator on a
+ * compact state through a partial expansion (see board_quad_expand). board_quad_move and
+ * board_quad_check make moves and test for check on the compact state
+ * directly, for make/copy-heavy workloads such as perft.
+ * (see also, board.h, move.h).
+ */
+#ifndef CHESS_QUAD_H
+#define CHESS_QUAD_H
+
+#include "chess/common.h"
+
+#include "chess/bitboard.h"
+
+// Type definition for a compact board state.
+typedef struct
+{
+    bitboard_t  planes[ 4 ];
+
+    u8          side;
+    u8          enpassant;
+    u8          castle;
+    u8          capture;
+}
+board_quad_t;
+
+/**
+ * @brief Computes the bitboard of one piece from a compact board state.
+ * @param quad A compact board state.
+ * @param piece The piece.
+ * @return The squares occupied by piece.
+ */
+INLINE
+bitboard_t
+board_quad_pieces
+(   const board_quad_t* quad
+,   const PIECE         piece
+)
+{
+    const u8 code = piece % 6 + 1;
+    return ( ( code & 1 ) ? ( *quad ).planes[ 1 ] : ~( *quad ).planes[ 1 ] )
+         & ( ( code & 2 ) ? ( *quad ).planes[ 2 ] : ~( *quad ).planes[ 2 ] )
+         & ( ( code & 4 ) ? ( *quad ).planes[ 3 ] : ~( *quad ).planes[ 3 ] )
+         & ( ( piece >= p ) ? ( *quad ).planes[ 0 ] : ~( *quad ).planes[ 0 ] )
+         ;
+}
+
+/**
+ * @brief Computes the occupancy of a compact board state.
+ * @param quad A compact board state.
+ * @return The squares occupied by any piece.
+ */
+INLINE
+bitboard_t
+board_quad_occupancy
+(   const board_quad_t* quad
+)
+{
+    return ( *quad ).planes[ 1 ] | ( *quad ).planes[ 2 ] | ( *quad ).planes[ 3 ];
+}
+
+/**
+ * @brief Packs a board state into a compact board state.
+ * @param quad Output buffer.
+ * @param board A chess board state.
+ */
+void
+board_quad_pack
+(   board_quad_t*   quad
+,   const board_t*  board
+);
+
+/**
+ * @brief Expands a compact board state into a full board state (including its
+ * attack maps).
+ * @param board Output buffer.
+ * @param quad A compact board state.
+ */
+void
+board_quad_unpack
+(   board_t*            board
+,   const board_quad_t* quad
+);
+
+/**
+ * @brief Partially expands a compact board state: fills in only what the move
+ * generator and board_move_legal read (the piece bitboards, occupancies, side
+ * to move, en passant square and castling rights, plus the squares attacked by
+ * the opponent if the side to move may castle).
+ * @param board Output buffer.
+ * @param quad A compact board state.
+ */
+void
+board_quad_expand
+(   board_t*            board
+,   const board_quad_t* quad
+);
+
+/**
+ * @brief Updates a compact board state by performing a move.
+ * @param quad The compact board state to mutate.
+ * @param move The move to make.
+ */
+void
+board_quad_move
+(   board_quad_t*   quad
+,   const move_t    move
+);
+
+/**
+ * @brief Computes if a given side is in check, on a compact board state.
+ * @param quad A compact board state.
+ * @param side The side to test.
+ * @return true if side's king is in check, false otherwise.
+ */
+bool
+board_quad_check
+(   const board_quad_t* quad
+,   const SIDE          side
+);
+
+/**
+ * @brief Generates the move options for a compact board state (see
+ * moves_generate). Requires pregenerated attack tables.
+ * @param moves Output buffer (room for at least MOVES_BUFFER_LENGTH moves).
+ * @param quad A compact board state.
+ * @param attacks The pregenerated attack tables.
+ * @return The number of moves generated.
+ */
+u32
+moves_generate_quad
+(   move_t*             moves
+,   const board_quad_t* quad
+,   const attacks_t*    attacks
+);
+
+#endif  // CHESS_QUAD_H
\ No newline at end of file
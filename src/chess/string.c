@@ -6,7 +6,9 @@
  */
 #include "chess/string.h"
 
+#include "chess/board.h"
 #include "chess/fen.h"
+#include "chess/move.h"
 
 char*
 string_move
@@ -29,6 +31,107 @@ string_move
     return dst;
 }
 
+char*
+string_move_san
+(   char*               dst
+,   const board_t*      board
+,   const moves_t*      moves
+,   const attacks_t*    attacks
+,   const move_t        move
+)
+{
+    const SQUARE src = move_decode_src ( move );
+    const SQUARE dst_ = move_decode_dst ( move );
+    const PIECE piece = move_decode_piece ( move );
+    const PIECE promotion = move_decode_promotion ( move );
+    const bool pawn = piece == P || piece == p;
+    u64 len = 0;
+
+    if ( move_decode_castle ( move ) )
+    {
+        len = string_format ( dst , "%s" , ( dst_ & 7 ) == 6 ? "O-O" : "O-O-O" );
+    }
+    else
+    {
+        // Moving piece.
+        if ( !pawn )
+        {
+            dst[ len++ ] = to_uppercase ( piecechr ( piece ) );
+
+            // Disambiguate among the other legal moves of the same piece type
+            // to the same square: by file if that suffices, else by rank,
+            // else by both.
+            bool ambiguous = false;
+            bool file = false;
+            bool rank = false;
+            for ( u32 i = 0; i < ( *moves ).count; ++i )
+            {
+                const move_t other = ( *moves ).moves[ i ];
+                const SQUARE other_src = move_decode_src ( other );
+                if (   move_decode_piece ( other ) != piece
+                    || move_decode_dst ( other ) != dst_
+                    || other_src == src
+                    || !board_move_legal ( board , other , attacks )
+                   )
+                {
+                    continue;
+                }
+                ambiguous = true;
+                file = file || ( other_src & 7 ) == ( src & 7 );
+                rank = rank || ( other_src >> 3 ) == ( src >> 3 );
+            }
+            if ( ambiguous && ( !file || rank ) )
+            {
+                dst[ len++ ] = 'a' + ( src & 7 );
+            }
+            if ( ambiguous && file )
+            {
+                dst[ len++ ] = '8' - ( src >> 3 );
+            }
+        }
+
+        // Capture (a pawn capture is qualified by its source file).
+        if ( move_decode_capture ( move ) || move_decode_enpassant ( move ) )
+        {
+            if ( pawn )
+            {
+                dst[ len++ ] = 'a' + ( src & 7 );
+            }
+            dst[ len++ ] = 'x';
+        }
+
+        // Destination square.
+        dst[ len++ ] = 'a' + ( dst_ & 7 );
+        dst[ len++ ] = '8' - ( dst_ >> 3 );
+
+        // Promotion.
+        if ( promotion )
+        {
+            dst[ len++ ] = '=';
+            dst[ len++ ] = to_uppercase ( piecechr ( promotion ) );
+        }
+    }
+
+    // Check or checkmate.
+    board_t board_;
+    memory_copy ( &board_ , board , sizeof ( board_t ) );
+    board_move ( &board_ , move , attacks );
+    if ( board_check ( &board_ , attacks , board_.side ) )
+    {
+        moves_t replies;
+        moves_compute ( &replies , &board_ , attacks );
+        bool mate = true;
+        for ( u32 i = 0; mate && i < replies.count; ++i )
+        {
+            mate = !board_move_legal ( &board_ , replies.moves[ i ] , attacks );
+        }
+        dst[ len++ ] = ( mate ) ? '#' : '+';
+    }
+
+    dst[ len ] = 0; // Append terminator.
+    return dst;
+}
+
 char*
 string_moves
 (   char*           dst
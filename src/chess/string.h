@@ -17,6 +17,14 @@
 // Defines the number of characters needed to represent a move in string format.
 #define MOVE_STRING_LENGTH ( 2 * SQUARE_STRING_LENGTH + 1 )
 
+// Defines the maximum length of a move string in standard algebraic notation
+// (excluding check and annotation suffixes), e.g. "Qh4xe1=Q".
+#define MOVE_SAN_STRING_MAX_LENGTH 8
+
+// Defines the number of bytes needed to hold a generated move string in
+// standard algebraic notation (with a check suffix and a terminator).
+#define MOVE_SAN_STRING_BUFFER_LENGTH ( MOVE_SAN_STRING_MAX_LENGTH + 2 )
+
 // Defines a string representation of each square coordinate on a chess board.
 static const char* square_coordinate_tags[] = { "A8" , "B8" , "C8" , "D8" , "E8" , "F8" , "G8" , "H8"
                                               , "A7" , "B7" , "C7" , "D7" , "E7" , "F7" , "G7" , "H7"
@@ -153,6 +161,29 @@ string_move
 ,   const move_t    move
 );
 
+/**
+ * @brief Stringify move in standard algebraic notation (e.g. "Nbd7", "exd5",
+ * "e8=Q+", "O-O"). The source square is qualified only as much as needed to
+ * tell the move apart from the other legal moves of the same piece type to
+ * the same square, and a '+' or '#' suffix marks check or checkmate.
+ * Requires pregenerated attack tables and a list of valid moves.
+ * @param dst Output buffer. Should have adequate space for
+ * MOVE_SAN_STRING_BUFFER_LENGTH bytes.
+ * @param board The board state the move is played from.
+ * @param moves A pregenerated list of all valid moves for board.
+ * @param attacks The pregenerated attack tables.
+ * @param move A legal move for board.
+ * @return dst.
+ */
+char*
+string_move_san
+(   char*               dst
+,   const board_t*      board
+,   const moves_t*      moves
+,   const attacks_t*    attacks
+,   const move_t        move
+);
+
 /**
  * @brief Stringify moves.
  * @param dst Output buffer.
@@ -0,0 +1,574 @@
+/**
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @file bench.c
+ * @brief Implementation of the bench header.
+ * (see bench.h for additional details)
+ */
+#include "chess/test/bench.h"
+
+#include "chess/batch.h"
+#include "chess/best.h"
+#include "chess/board.h"
+#include "chess/fen.h"
+#include "chess/quad.h"
+
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/memory.h"
+
+#include "math/math.h"
+#include "math/random.h"
+
+#include "platform/platform.h"
+
+// Defines the number of sampled positions.
+#define BENCH_POSITIONS 1024
+
+// Defines the maximum length of a random playout.
+#define BENCH_PLAYOUT_MAX_PLY 160
+
+// Test positions of the fixed-node search benchmark.
+static const char* bench_fens[] =
+{   FEN_START
+,   FEN_TRICKY
+,   FEN_KILLER
+,   FEN_CMK
+,   "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"
+,   "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"
+,   "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"
+,   "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10"
+,   "r3k2r/2pb1ppp/2pp1q2/p7/1nP1B3/1P2P3/P2N1PPP/R2QK2R w KQkq a6 0 14"
+,   "4rrk1/2p1b1p1/p1p3q1/4p3/2P2n1p/1P1NR2P/PB3PP1/3R1QK1 b - - 2 24"
+,   "r3qbrk/6p1/2b2pPp/p3pP1Q/PpPpP2P/3P1B2/2PB3K/R5R1 w - - 16 42"
+,   "6k1/1R3p2/6p1/2Bp3p/3P2q1/P7/1P2rQ1K/5R2 b - - 4 44"
+,   "8/8/1p2k1p1/3p3p/1p1P1P1P/1P2PK2/8/8 w - - 3 54"
+,   "7r/2p3k1/1p1p1qp1/1P1Bp3/p1P2r1P/P7/4R3/Q4RK1 w - - 0 36"
+,   "r1bq1rk1/pp2b1pp/n1pp1n2/3P1p2/2P1p3/2N1P2N/PP2BPPP/R1BQ1RK1 b - - 2 10"
+,   "3r3k/2r4p/1p1b3q/p4P2/P2Pp3/1B2P3/3BQ1RP/6K1 w - - 3 87"
+};
+
+// Defines the number of test positions of the fixed-node search benchmark.
+#define BENCH_NODES_POSITIONS ( sizeof ( bench_fens ) / sizeof ( bench_fens[ 0 ] ) )
+
+// Type definition for the state of the fixed-node search benchmark, shared by
+// its threads. The result of each search is stored by position, so that the
+// signature does not depend on which thread searched it.
+typedef struct
+{
+    const attacks_t*        attacks;
+    const nnue_t*           nnue;
+    const search_params_t*  params;
+    u64                     node_limit;
+    u32                     next;       // Next position to search (atomic).
+
+    // Result of each search.
+    move_t                  moves[ BENCH_NODES_POSITIONS ];
+    i32                     scores[ BENCH_NODES_POSITIONS ];
+    u32                     depths[ BENCH_NODES_POSITIONS ];
+    u64                     completed[ BENCH_NODES_POSITIONS ];
+    u64                     nodes[ BENCH_NODES_POSITIONS ];
+}
+bench_nodes_t;
+
+// Type definition for a thread of the fixed-node search benchmark.
+typedef struct
+{
+    bench_nodes_t*          bench;
+    move_search_t*          search;
+    u64                     completed;  // Nodes of the last completed iteration.
+}
+bench_worker_t;
+
+/**
+ * @brief Samples positions from random playouts.
+ * @param attacks The pregenerated attack tables.
+ * @param prev Output buffer for the position preceding each sample.
+ * @param next Output buffer for the sampled positions.
+ */
+void
+bench_sample
+(   const attacks_t*    attacks
+,   board_t*            prev
+,   board_t*            next
+);
+
+/**
+ * @brief Fixed-node search benchmark thread entry point. Searches positions
+ * until every position has been claimed.
+ * @param args A bench_worker_t.
+ * @return 0.
+ */
+u32
+bench_nodes_worker
+(   void* args
+);
+
+/**
+ * @brief Search observer callback of the fixed-node search benchmark (see
+ * PFN_move_search_observer). Records the node count of the completed
+ * iteration.
+ * @param result The search result so far.
+ * @param args A bench_worker_t.
+ */
+void
+bench_nodes_iteration
+(   const move_search_result_t* result
+,   void*                       args
+);
+
+/**
+ * @brief Folds a value into a hash.
+ * @param hash The hash.
+ * @param value The value.
+ * @return The updated hash.
+ */
+INLINE
+u64
+bench_hash
+(   u64         hash
+,   const u64   value
+)
+{
+    hash = ( hash ^ value ) * 0x100000001B3ULL;
+    return hash ^ ( hash >> 29 );
+}
+
+void
+bench_evaluate
+(   const attacks_t*    attacks
+,   const nnue_t*       nnue
+,   const u32           iterations
+)
+{
+    LOGINFO ( "bench_evaluate: Started evaluation benchmark." );
+
+    // Sample positions (and the positions preceding them) from random
+    // playouts.
+    board_t* prev = memory_allocate ( sizeof ( board_t ) * BENCH_POSITIONS
+                                    , MEMORY_TAG_APPLICATION
+                                    );
+    board_t* next = memory_allocate ( sizeof ( board_t ) * BENCH_POSITIONS
+                                    , MEMORY_TAG_APPLICATION
+                                    );
+    nnue_accumulator_t* accumulators = memory_allocate ( sizeof ( nnue_accumulator_t ) * BENCH_POSITIONS
+                                                       , MEMORY_TAG_APPLICATION
+                                                       );
+    nnue_accumulator_t accumulator;
+    bench_sample ( attacks , prev , next );
+    for ( u32 i = 0; i < BENCH_POSITIONS; ++i )
+    {
+        nnue_accumulator_refresh ( &accumulators[ i ] , &prev[ i ] , WHITE , nnue );
+        nnue_accumulator_refresh ( &accumulators[ i ] , &prev[ i ] , BLACK , nnue );
+    }
+
+    clock_t clock;
+    i64 checksum;
+
+    // Material and positional tables.
+    checksum = 0;
+    clock_start ( &clock );
+    for ( u32 i = 0; i < iterations; ++i )
+    {
+        checksum += score_board ( &next[ i % BENCH_POSITIONS ] );
+    }
+    clock_update ( &clock );
+    LOGINFO ( "bench_evaluate:\tscore_board:              %f ns/eval (checksum %lli)"
+            , clock.elapsed * 1e9 / iterations
+            , checksum
+            );
+
+    // Material and positional tables, whole sample scored at once.
+    board_batch_t batch;
+    i32* scores = memory_allocate ( sizeof ( i32 ) * BENCH_POSITIONS , MEMORY_TAG_APPLICATION );
+    board_batch_create ( BENCH_POSITIONS , &batch );
+    for ( u32 i = 0; i < BENCH_POSITIONS; ++i )
+    {
+        board_batch_push ( &batch , &next[ i ] );
+    }
+    const u32 batches = max ( iterations / BENCH_POSITIONS , 1U );
+    checksum = 0;
+    clock_start ( &clock );
+    for ( u32 i = 0; i < batches; ++i )
+    {
+        score_boards ( &batch , scores );
+        checksum += scores[ i % BENCH_POSITIONS ];
+    }
+    clock_update ( &clock );
+    LOGINFO ( "bench_evaluate:\tscore_boards:             %f ns/eval (checksum %lli)"
+            , clock.elapsed * 1e9 / ( batches * BENCH_POSITIONS )
+            , checksum
+            );
+    for ( u32 i = 0; i < BENCH_POSITIONS; ++i )
+    {
+        if ( scores[ i ] != score_board ( &next[ i ] ) )
+        {
+            LOGERROR ( "bench_evaluate: score_boards disagrees with score_board on position %u (%i != %i)."
+                     , i , scores[ i ] , score_board ( &next[ i ] )
+                     );
+            break;
+        }
+    }
+    board_batch_destroy ( &batch );
+    memory_free ( scores , sizeof ( i32 ) * BENCH_POSITIONS , MEMORY_TAG_APPLICATION );
+
+    // Network, accumulator recomputed from scratch.
+    checksum = 0;
+    clock_start ( &clock );
+    for ( u32 i = 0; i < iterations; ++i )
+    {
+        const board_t* board_ = &next[ i % BENCH_POSITIONS ];
+        nnue_accumulator_refresh ( &accumulator , board_ , WHITE , nnue );
+        nnue_accumulator_refresh ( &accumulator , board_ , BLACK , nnue );
+        checksum += nnue_evaluate ( &accumulator , ( *board_ ).side , nnue );
+    }
+    clock_update ( &clock );
+    LOGINFO ( "bench_evaluate:\tnnue (refresh):           %f ns/eval (checksum %lli)"
+            , clock.elapsed * 1e9 / iterations
+            , checksum
+            );
+
+    // Network, accumulator updated incrementally from the previous position.
+    checksum = 0;
+    clock_start ( &clock );
+    for ( u32 i = 0; i < iterations; ++i )
+    {
+        const u32 j = i % BENCH_POSITIONS;
+        nnue_accumulator_update ( &accumulator , &accumulators[ j ] , &prev[ j ] , &next[ j ] , nnue );
+        checksum += nnue_evaluate ( &accumulator , next[ j ].side , nnue );
+    }
+    clock_update ( &clock );
+    LOGINFO ( "bench_evaluate:\tnnue (incremental):       %f ns/eval (checksum %lli)"
+            , clock.elapsed * 1e9 / iterations
+            , checksum
+            );
+    nnue_accumulator_t refreshed;
+    bool agree = true;
+    for ( u32 i = 0; i < BENCH_POSITIONS && agree; ++i )
+    {
+        nnue_accumulator_update ( &accumulator , &accumulators[ i ] , &prev[ i ] , &next[ i ] , nnue );
+        nnue_accumulator_refresh ( &refreshed , &next[ i ] , WHITE , nnue );
+        nnue_accumulator_refresh ( &refreshed , &next[ i ] , BLACK , nnue );
+        for ( SIDE side = WHITE; side <= BLACK && agree; ++side )
+        {
+            for ( u32 j = 0; j < NNUE_HALF_DIMENSIONS; ++j )
+            {
+                if ( accumulator.values[ side ][ j ] != refreshed.values[ side ][ j ] )
+                {
+                    LOGERROR ( "bench_evaluate: nnue_accumulator_update disagrees with nnue_accumulator_refresh on position %u (%s perspective, feature %u: %i != %i)."
+                             , i , ( side == WHITE ) ? "white" : "black" , j
+                             , accumulator.values[ side ][ j ] , refreshed.values[ side ][ j ]
+                             );
+                    agree = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    memory_free ( accumulators , sizeof ( nnue_accumulator_t ) * BENCH_POSITIONS , MEMORY_TAG_APPLICATION );
+    memory_free ( next , sizeof ( board_t ) * BENCH_POSITIONS , MEMORY_TAG_APPLICATION );
+    memory_free ( prev , sizeof ( board_t ) * BENCH_POSITIONS , MEMORY_TAG_APPLICATION );
+}
+
+void
+bench_movegen
+(   const attacks_t*    attacks
+,   const u32           iterations
+)
+{
+    LOGINFO ( "bench_movegen: Started move generation benchmark." );
+
+    board_t* prev = memory_allocate ( sizeof ( board_t ) * BENCH_POSITIONS
+                                    , MEMORY_TAG_APPLICATION
+                                    );
+    board_t* next = memory_allocate ( sizeof ( board_t ) * BENCH_POSITIONS
+                                    , MEMORY_TAG_APPLICATION
+                                    );
+    moves_t* moves = memory_allocate ( sizeof ( moves_t ) * BENCH_POSITIONS
+                                     , MEMORY_TAG_APPLICATION
+                                     );
+    bench_sample ( attacks , prev , next );
+
+    clock_t clock;
+    u64 count;
+    u64 checksum;
+
+    // Move generation.
+    checksum = 0;
+    clock_start ( &clock );
+    for ( u32 i = 0; i < iterations; ++i )
+    {
+        const u32 j = i % BENCH_POSITIONS;
+        checksum += ( *moves_compute ( &moves[ j ] , &next[ j ] , attacks ) ).count;
+    }
+    clock_update ( &clock );
+    LOGINFO ( "bench_movegen:\tmoves_compute:            %f ns/position (checksum %llu)"
+            , clock.elapsed * 1e9 / iterations
+            , checksum
+            );
+
+    // Make move and legality test, for each generated move.
+    board_t board;
+    count = 0;
+    checksum = 0;
+    clock_start ( &clock );
+    for ( u32 i = 0; i < iterations; ++i )
+    {
+        const u32 j = i % BENCH_POSITIONS;
+        for ( u32 k = 0; k < moves[ j ].count; ++k )
+        {
+            memory_copy ( &board , &next[ j ] , sizeof ( board_t ) );
+            board_move ( &board , moves[ j ].moves[ k ] , attacks );
+            checksum += !board_check ( &board , attacks , !board.side );
+        }
+        count += moves[ j ].count;
+    }
+    clock_update ( &clock );
+    LOGINFO ( "bench_movegen:\tboard_move + board_check: %f ns/move (checksum %llu)"
+            , clock.elapsed * 1e9 / count
+            , checksum
+            );
+
+    // Same, on the compact board state.
+    board_quad_t* quads = memory_allocate ( sizeof ( board_quad_t ) * BENCH_POSITIONS
+                                          , MEMORY_TAG_APPLICATION
+                                          );
+    for ( u32 i = 0; i < BENCH_POSITIONS; ++i )
+    {
+        board_quad_pack ( &quads[ i ] , &next[ i ] );
+    }
+    board_quad_t quad;
+    count = 0;
+    checksum = 0;
+    clock_start ( &clock );
+    for ( u32 i = 0; i < iterations; ++i )
+    {
+        const u32 j = i % BENCH_POSITIONS;
+        for ( u32 k = 0; k < moves[ j ].count; ++k )
+        {
+            quad = quads[ j ];
+            board_quad_move ( &quad , moves[ j ].moves[ k ] );
+            checksum += !board_quad_check ( &quad , !quad.side );
+        }
+        count += moves[ j ].count;
+    }
+    clock_update ( &clock );
+    LOGINFO ( "bench_movegen:\tboard_quad_move + check:  %f ns/move (checksum %llu)"
+            , clock.elapsed * 1e9 / count
+            , checksum
+            );
+    memory_free ( quads , sizeof ( board_quad_t ) * BENCH_POSITIONS , MEMORY_TAG_APPLICATION );
+
+    memory_free ( moves , sizeof ( moves_t ) * BENCH_POSITIONS , MEMORY_TAG_APPLICATION );
+    memory_free ( next , sizeof ( board_t ) * BENCH_POSITIONS , MEMORY_TAG_APPLICATION );
+    memory_free ( prev , sizeof ( board_t ) * BENCH_POSITIONS , MEMORY_TAG_APPLICATION );
+}
+
+void
+bench_search
+(   const attacks_t*    attacks
+,   const u32           depth
+,   move_search_t*      args
+)
+{
+    LOGINFO ( "bench_search: Started search benchmark." );
+
+    static const char* fens[] = { FEN_START , FEN_TRICKY , FEN_KILLER , FEN_CMK };
+
+    board_t board;
+    clock_t clock;
+    u64 nodes = 0;
+    f64 elapsed = 0;
+    for ( u32 i = 0; i < sizeof ( fens ) / sizeof ( fens[ 0 ] ); ++i )
+    {
+        memory_clear ( &board , sizeof ( board_t ) );
+        fen_parse ( fens[ i ] , &board );
+        clock_start ( &clock );
+        board_best_move ( &board , attacks , depth , args );
+        clock_update ( &clock );
+        nodes += ( *args ).result.nodes;
+        elapsed += clock.elapsed;
+        LOGINFO ( "bench_search:\t%s: %llu nodes, %f seconds"
+                , fens[ i ]
+                , ( *args ).result.nodes
+                , clock.elapsed
+                );
+    }
+    LOGINFO ( "bench_search:\ttotal: %llu nodes, %f seconds (%f nodes/second)"
+            , nodes
+            , elapsed
+            , nodes / elapsed
+            );
+}
+
+u64
+bench_nodes_memory_requirement
+(   const u32 thread_count
+)
+{
+    return sizeof ( bench_nodes_t )
+         + thread_count * ( sizeof ( bench_worker_t ) + sizeof ( move_search_t ) )
+         ;
+}
+
+bool
+bench_nodes
+(   const attacks_t*        attacks
+,   const nnue_t*           nnue
+,   const search_params_t*  params
+,   const u64               node_limit
+,   const u32               thread_count
+,   bench_result_t*         result
+)
+{
+    const u32 count = clamp ( thread_count , 1U , ( u32 ) BENCH_MAX_THREADS );
+    bench_nodes_t* bench = memory_allocate ( sizeof ( bench_nodes_t ) , MEMORY_TAG_APPLICATION );
+    ( *bench ).attacks = attacks;
+    ( *bench ).nnue = nnue;
+    ( *bench ).params = params;
+    ( *bench ).node_limit = node_limit;
+    bench_worker_t* workers = memory_allocate ( count * sizeof ( bench_worker_t ) , MEMORY_TAG_APPLICATION );
+    for ( u32 i = 0; i < count; ++i )
+    {
+        workers[ i ].bench = bench;
+        workers[ i ].search = memory_allocate ( sizeof ( move_search_t ) , MEMORY_TAG_APPLICATION );
+    }
+
+    // Search.
+    clock_t clock;
+    clock_start ( &clock );
+    platform_thread_t threads[ BENCH_MAX_THREADS ];
+    u32 started = 0;
+    for ( u32 i = 0; i < count; ++i )
+    {
+        if ( !platform_thread_create ( bench_nodes_worker , &workers[ i ] , &threads[ i ] ) )
+        {
+            threads[ i ].handle = 0;
+            continue;
+        }
+        started += 1;
+    }
+    for ( u32 i = 0; i < count; ++i )
+    {
+        if ( threads[ i ].handle )
+        {
+            platform_thread_join ( &threads[ i ] );
+        }
+    }
+    clock_update ( &clock );
+
+    // Sum up.
+    memory_clear ( result , sizeof ( bench_result_t ) );
+    ( *result ).positions = BENCH_NODES_POSITIONS;
+    ( *result ).elapsed = clock.elapsed;
+    ( *result ).signature = 0xCBF29CE484222325ULL;
+    for ( u32 i = 0; i < BENCH_NODES_POSITIONS; ++i )
+    {
+        ( *result ).nodes += ( *bench ).nodes[ i ];
+        ( *result ).signature = bench_hash ( ( *result ).signature , ( *bench ).moves[ i ] );
+        ( *result ).signature = bench_hash ( ( *result ).signature , ( u32 )( *bench ).scores[ i ] );
+        ( *result ).signature = bench_hash ( ( *result ).signature , ( *bench ).depths[ i ] );
+        ( *result ).signature = bench_hash ( ( *result ).signature , ( *bench ).completed[ i ] );
+    }
+
+    for ( u32 i = 0; i < count; ++i )
+    {
+        memory_free ( workers[ i ].search , sizeof ( move_search_t ) , MEMORY_TAG_APPLICATION );
+    }
+    memory_free ( workers , count * sizeof ( bench_worker_t ) , MEMORY_TAG_APPLICATION );
+    memory_free ( bench , sizeof ( bench_nodes_t ) , MEMORY_TAG_APPLICATION );
+    if ( !started )
+    {
+        LOGERROR ( "bench_nodes: Failed to start any threads." );
+        return false;
+    }
+    return true;
+}
+
+u32
+bench_nodes_worker
+(   void* args
+)
+{
+    bench_worker_t* worker = args;
+    bench_nodes_t* bench = ( *worker ).bench;
+    move_search_t* search = ( *worker ).search;
+    board_t board;
+    u32 i;
+    while ( ( i = __atomic_fetch_add ( &( *bench ).next , 1 , __ATOMIC_RELAXED ) ) < BENCH_NODES_POSITIONS )
+    {
+        memory_clear ( &board , sizeof ( board_t ) );
+        fen_parse ( bench_fens[ i ] , &board );
+        memory_clear ( search , sizeof ( move_search_t ) );
+        ( *search ).nnue = ( *bench ).nnue;
+        ( *search ).params = ( *bench ).params;
+        ( *search ).node_limit = ( *bench ).node_limit;
+        ( *search ).observer = bench_nodes_iteration;
+        ( *search ).observer_args = worker;
+        ( *worker ).completed = 0;
+        ( *bench ).moves[ i ] = board_best_move ( &board , ( *bench ).attacks , MOVE_SEARCH_MAX_PLY , search );
+        ( *bench ).scores[ i ] = ( *search ).result.score;
+        ( *bench ).depths[ i ] = ( *search ).result.depth;
+        ( *bench ).completed[ i ] = ( *worker ).completed;
+        ( *bench ).nodes[ i ] = ( *search ).result.nodes;
+    }
+    return 0;
+}
+
+void
+bench_nodes_iteration
+(   const move_search_result_t* result
+,   void*                       args
+)
+{
+    bench_worker_t* worker = args;
+    ( *worker ).completed = ( *result ).nodes;
+}
+
+void
+bench_sample
+(   const attacks_t*    attacks
+,   board_t*            prev
+,   board_t*            next
+)
+{
+    board_t board;
+    moves_t moves;
+    u32 ply = BENCH_PLAYOUT_MAX_PLY;
+    u32 count = 0;
+    while ( count < BENCH_POSITIONS )
+    {
+        if ( ply >= BENCH_PLAYOUT_MAX_PLY )
+        {
+            memory_clear ( &board , sizeof ( board_t ) );
+            fen_parse ( FEN_START , &board );
+            ply = 0;
+        }
+
+        // Play a random legal move.
+        moves_compute ( &moves , &board , attacks );
+        bool moved = false;
+        while ( moves.count && !moved )
+        {
+            const u32 i = random2 ( 0 , moves.count - 1 );
+            memory_copy ( &prev[ count ] , &board , sizeof ( board_t ) );
+            board_move ( &board , moves.moves[ i ] , attacks );
+            if ( board_check ( &board , attacks , !board.side ) )
+            {
+                memory_copy ( &board , &prev[ count ] , sizeof ( board_t ) );
+                moves.moves[ i ] = moves.moves[ moves.count - 1 ];
+                moves.count -= 1;
+                continue;
+            }
+            moved = true;
+        }
+        if ( !moved )
+        {
+            ply = BENCH_PLAYOUT_MAX_PLY;
+            continue;
+        }
+        memory_copy ( &next[ count ] , &board , sizeof ( board_t ) );
+        count += 1;
+        ply += 1;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+/**
+ * @file bench.h
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Interface for benchmarking board evaluation, move generation and
+ * search.
+ * (see also, best.h, move.h, nnue.h).
+ */
+#ifndef CHESS_BENCH_H
+#define CHESS_BENCH_H
+
+#include "chess/common.h"
+
+#include "chess/best.h"
+#include "chess/nnue.h"
+
+// Defines the default node budget per position of the fixed-node search
+// benchmark.
+#define BENCH_NODES 200000
+
+// Defines the maximum number of threads of the fixed-node search benchmark.
+#define BENCH_MAX_THREADS 64
+
+// Type definition for the result of the fixed-node search benchmark.
+typedef struct
+{
+    u32                 positions;
+    u64                 nodes;          // Total.
+    u64                 signature;      // Hash of the result of every search.
+    f64                 elapsed;        // Wall time, in seconds.
+}
+bench_result_t;
+
+/**
+ * @brief Runs the evaluation latency benchmark. Times score_board against
+ * score_boards (the whole sample as one batch) and the network (full
+ * accumulator refresh and incremental update) over a sample of positions
+ * taken from random playouts, and checks score_boards against score_board.
+ * Requires pregenerated attack tables.
+ * @param attacks The pregenerated attack tables.
+ * @param nnue The network (its weights do not affect timing).
+ * @param iterations Number of evaluations to time per method.
+ */
+void
+bench_evaluate
+(   const attacks_t*    attacks
+,   const nnue_t*       nnue
+,   const u32           iterations
+);
+
+/**
+ * @brief Runs the move generation benchmark. Times moves_compute, and
+ * board_move followed by the legality test on both the full and the compact
+ * board state (see quad.h), over a sample of positions taken from random
+ * playouts. Requires pregenerated attack tables.
+ * @param attacks The pregenerated attack tables.
+ * @param iterations Number of positions to time.
+ */
+void
+bench_movegen
+(   const attacks_t*    attacks
+,   const u32           iterations
+);
+
+/**
+ * @brief Runs the search benchmark. Times a fixed-depth search of a set of
+ * test positions. Requires pregenerated attack tables.
+ * @param attacks The pregenerated attack tables.
+ * @param depth The search depth.
+ * @param args Buffer to hold internal search function arguments.
+ */
+void
+bench_search
+(   const attacks_t*    attacks
+,   const u32           depth
+,   move_search_t*      args
+);
+
+/**
+ * @brief Computes the memory requirement of bench_nodes (see memory_startup).
+ * @param thread_count The number of threads.
+ * @return The number of bytes bench_nodes allocates.
+ */
+u64
+bench_nodes_memory_requirement
+(   const u32 thread_count
+);
+
+/**
+ * @brief Runs the fixed-node search benchmark. Searches each of a fixed set
+ * of test positions to node_limit nodes (see move_search_t), in parallel
+ * across threads, each from a cleared search state. The searches are limited
+ * by nodes alone, so the node count and the signature (a hash of the best
+ * move, score, depth and node count of the last completed iteration of every
+ * search, see move_search_result_t) depend on the engine alone: they are the same on every run and
+ * for any number of threads, and change with any change to the search or
+ * evaluation. Only the elapsed time varies. Requires pregenerated attack
+ * tables.
+ * @param attacks The pregenerated attack tables.
+ * @param nnue The network (optional).
+ * @param params The search parameters (optional).
+ * @param node_limit The node budget per position.
+ * @param thread_count The number of threads (at most BENCH_MAX_THREADS).
+ * @param result Output buffer.
+ * @return false if no thread could be started, true otherwise.
+ */
+bool
+bench_nodes
+(   const attacks_t*        attacks
+,   const nnue_t*           nnue
+,   const search_params_t*  params
+,   const u64               node_limit
+,   const u32               thread_count
+,   bench_result_t*         result
+);
+
+#endif  // CHESS_BENCH_H
\ No newline at end of file
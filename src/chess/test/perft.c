@@ -8,23 +8,76 @@
 
 #include "chess/board.h"
 #include "chess/string.h"
+#include "chess/zobrist.h"
 
 #include "core/clock.h"
 #include "core/logger.h"
 #include "core/memory.h"
 
+#include "math/math.h"
+
+#include "platform/platform.h"
+
+// Type definition for the state of a parallel perft worker thread.
+typedef struct
+{
+    // Input.
+    const board_t*      frontier;
+    u64                 frontier_count;
+    u32                 index;
+    u32                 thread_count;
+    u32                 depth;
+    const attacks_t*    attacks;
+    perft_table_t*      table;
+
+    // Output.
+    u64*                counts;
+}
+perft_worker_t;
+
 /**
- * @brief Primary implementation of perft (see perft).
+ * @brief Counts leaf nodes like perft_count, caching the count of each
+ * subtree deeper than 1 in a hash table.
  * @param board A chess board state.
- * @param depth The current recursion depth.
+ * @param depth The recursion depth.
  * @param attacks The pregenerated attack tables.
- * @return The current leaf node count.
+ * @param table The hash table.
+ * @return The leaf node count.
  */
 u64
-_perft
-(   board_t*            board
-,   u32                 depth
+perft_count_table
+(   const board_t*      board
+,   const u32           depth
 ,   const attacks_t*    attacks
+,   perft_table_t*      table
+);
+
+/**
+ * @brief Collects the board states of every legal line of moves of a given
+ * length.
+ * @param board A chess board state.
+ * @param ply The number of moves.
+ * @param attacks The pregenerated attack tables.
+ * @param frontier Output buffer for the board states, or 0 to only count them.
+ * @return The number of board states.
+ */
+u64
+perft_frontier
+(   const board_t*      board
+,   const u32           ply
+,   const attacks_t*    attacks
+,   board_t*            frontier
+);
+
+/**
+ * @brief Entry point for a parallel perft worker thread. Counts the leaf
+ * nodes below every thread_count-th frontier board state.
+ * @param args The worker state.
+ * @return 0.
+ */
+u32
+perft_worker
+(   void* args
 );
 
 void
@@ -50,6 +103,12 @@ perft
     u64 leaf_count = 0;
     for ( u32 i = 0; i < moves.count; ++i )
     {
+        // Filter the move if it puts the moving side into check.
+        if ( !board_move_legal ( board_ , moves.moves[ i ] , attacks ) )
+        {
+            continue;
+        }
+
         // Initialize a working board state.
         memory_copy ( &board , board_ , sizeof ( board_t ) );        
         
@@ -59,25 +118,19 @@ perft
                    , attacks
                    );
         
-        // Filter the move if it put the moving side into check.
-        if ( board_check ( &board , attacks , !board.side ) )
-        {
-            continue;
-        }
-        
         // Recurse.
-        const u64 result = _perft ( &board
-                                  , depth - 1
-                                  , attacks
-                                  );
+        const u64 result = perft_count ( &board
+                                       , depth - 1
+                                       , attacks
+                                       );
         leaf_count += result;
 
         // Statistics.
         char s_move[ MOVE_STRING_LENGTH + 1 ];
-        LOGINFO ( "perft:\tMOVE:  %s    LEAF NODES: %llu"
-                , string_move ( s_move , moves.moves[ i ] )
-                , result
-                );
+        LOGDEBUG ( "perft:\tMOVE:  %s    LEAF NODES: %llu"
+                 , string_move ( s_move , moves.moves[ i ] )
+                 , result
+                 );
     }
     
     
@@ -92,9 +145,9 @@ perft
 }
 
 u64
-_perft
-(   board_t*            board
-,   u32                 depth
+perft_count
+(   const board_t*      board
+,   const u32           depth
 ,   const attacks_t*    attacks
 )
 {
@@ -111,30 +164,312 @@ _perft
     u64 leaf_count = 0;
     for ( u32 i = 0; i < moves.count; ++i )
     {
-        // Preserve board state.
-        board_t board_prev;
-        memory_copy ( &board_prev , board , sizeof ( board_t ) );
+        // Filter the move if it puts the moving side into check.
+        if ( !board_move_legal ( board , moves.moves[ i ] , attacks ) )
+        {
+            continue;
+        }
 
-        // Perform a move.
-        board_move ( board
+        // Bulk count: a legal move at depth 1 is a leaf node.
+        if ( depth == 1 )
+        {
+            leaf_count += 1;
+            continue;
+        }
+
+        // Perform a move and recurse.
+        board_t board_next;
+        memory_copy ( &board_next , board , sizeof ( board_t ) );
+        board_move ( &board_next
                    , moves.moves[ i ]
                    , attacks
                    );
-                                
-        // Filter the move if it put the moving side into check.
-        if ( board_check ( board , attacks , !( *board ).side ) )
+        leaf_count += perft_count ( &board_next , depth - 1 , attacks );
+    }
+    
+    return leaf_count;
+}
+
+u64
+perft_count_quad
+(   const board_quad_t* quad
+,   const u32           depth
+,   const attacks_t*    attacks
+)
+{
+    // Base case.
+    if ( !depth )
+    {
+        return 1;
+    }
+
+    // Generate move options.
+    board_t board;
+    board_quad_expand ( &board , quad );
+    moves_t moves;
+    moves_compute ( &moves , &board , attacks );
+
+    u64 leaf_count = 0;
+    for ( u32 i = 0; i < moves.count; ++i )
+    {
+        // Filter the move if it puts the moving side into check.
+        if ( !board_move_legal ( &board , moves.moves[ i ] , attacks ) )
         {
-            // Restore board state.
-            memory_copy ( board , &board_prev , sizeof ( board_t ) );
             continue;
         }
-        
-        // Move succeeded. Recurse.
-        leaf_count += _perft ( board , depth - 1 , attacks );
-        
-        // Restore board state.
-        memory_copy ( board , &board_prev , sizeof ( board_t ) );
+
+        // Bulk count: a legal move at depth 1 is a leaf node.
+        if ( depth == 1 )
+        {
+            leaf_count += 1;
+            continue;
+        }
+
+        // Perform a move on a copy of the compact state and recurse.
+        board_quad_t quad_next = *quad;     // Small enough to copy inline.
+        board_quad_move ( &quad_next , moves.moves[ i ] );
+        leaf_count += perft_count_quad ( &quad_next , depth - 1 , attacks );
     }
-    
+
+    return leaf_count;
+}
+
+u64
+perft_parallel
+(   const board_t*      board
+,   const u32           depth
+,   const attacks_t*    attacks
+,   const u32           thread_count_
+,   perft_table_t*      table
+)
+{
+    const u32 thread_count = max ( 1ULL , min ( thread_count_ , PERFT_MAX_THREADS ) );
+    if ( depth <= PERFT_SPLIT_PLY )
+    {
+        return perft_count ( board , depth , attacks );
+    }
+
+    // Collect the subtrees at the split ply.
+    const u64 frontier_count = perft_frontier ( board , PERFT_SPLIT_PLY , attacks , 0 );
+    if ( !frontier_count )
+    {
+        return 0;
+    }
+    board_t* frontier = memory_allocate ( frontier_count * sizeof ( board_t ) , MEMORY_TAG_APPLICATION );
+    u64* counts = memory_allocate ( frontier_count * sizeof ( u64 ) , MEMORY_TAG_APPLICATION );
+    perft_frontier ( board , PERFT_SPLIT_PLY , attacks , frontier );
+
+    // Deal the subtrees out to the workers in turn, which keeps the work of
+    // each worker roughly even.
+    perft_worker_t workers[ PERFT_MAX_THREADS ];
+    platform_thread_t threads[ PERFT_MAX_THREADS ];
+    for ( u32 i = 0; i < thread_count; ++i )
+    {
+        workers[ i ].frontier = frontier;
+        workers[ i ].frontier_count = frontier_count;
+        workers[ i ].index = i;
+        workers[ i ].thread_count = thread_count;
+        workers[ i ].depth = depth - PERFT_SPLIT_PLY;
+        workers[ i ].attacks = attacks;
+        workers[ i ].table = table;
+        workers[ i ].counts = counts;
+    }
+    for ( u32 i = 1; i < thread_count; ++i )
+    {
+        if ( !platform_thread_create ( perft_worker , &workers[ i ] , &threads[ i ] ) )
+        {
+            // Fall back to running the slice on the calling thread.
+            perft_worker ( &workers[ i ] );
+            threads[ i ].handle = 0;
+        }
+    }
+    perft_worker ( &workers[ 0 ] );
+    for ( u32 i = 1; i < thread_count; ++i )
+    {
+        if ( threads[ i ].handle )
+        {
+            platform_thread_join ( &threads[ i ] );
+        }
+    }
+
+    // Sum in frontier order, independent of the thread count.
+    u64 leaf_count = 0;
+    for ( u64 i = 0; i < frontier_count; ++i )
+    {
+        leaf_count += counts[ i ];
+    }
+
+    memory_free ( counts , frontier_count * sizeof ( u64 ) , MEMORY_TAG_APPLICATION );
+    memory_free ( frontier , frontier_count * sizeof ( board_t ) , MEMORY_TAG_APPLICATION );
     return leaf_count;
+}
+
+bool
+perft_table_create
+(   const u64       size
+,   perft_table_t*  table
+)
+{
+    memory_clear ( table , sizeof ( perft_table_t ) );
+    if ( size < sizeof ( perft_entry_t ) )
+    {
+        return false;
+    }
+
+    // Round down to a power of two, so entries can be indexed by mask.
+    u64 entry_count = 1;
+    while ( entry_count * 2 * sizeof ( perft_entry_t ) <= size )
+    {
+        entry_count *= 2;
+    }
+
+    ( *table ).entries = memory_allocate ( entry_count * sizeof ( perft_entry_t ) , MEMORY_TAG_APPLICATION );
+    if ( !( *table ).entries )
+    {
+        return false;
+    }
+    ( *table ).entry_count = entry_count;
+    return true;
+}
+
+void
+perft_table_destroy
+(   perft_table_t* table
+)
+{
+    if ( ( *table ).entries )
+    {
+        memory_free ( ( *table ).entries
+                    , ( *table ).entry_count * sizeof ( perft_entry_t )
+                    , MEMORY_TAG_APPLICATION
+                    );
+    }
+    memory_clear ( table , sizeof ( perft_table_t ) );
+}
+
+void
+perft_table_clear
+(   perft_table_t* table
+)
+{
+    memory_clear ( ( *table ).entries , ( *table ).entry_count * sizeof ( perft_entry_t ) );
+}
+
+u64
+perft_count_table
+(   const board_t*      board
+,   const u32           depth
+,   const attacks_t*    attacks
+,   perft_table_t*      table
+)
+{
+    // Leaves at depth 1 are counted in bulk, which is cheaper than a probe.
+    if ( depth <= 1 )
+    {
+        return perft_count ( board , depth , attacks );
+    }
+
+    // Probe. The data holds the count in the upper bits and the depth in the
+    // low byte, so an empty entry never matches.
+    const u64 key = zobrist_key ( board );
+    perft_entry_t* entry = &( *table ).entries[ key & ( ( *table ).entry_count - 1 ) ];
+    const u64 data = ( *entry ).data;
+    if ( ( *entry ).check == ( key ^ data ) && ( data & 0xFF ) == depth )
+    {
+        return data >> 8;
+    }
+
+    // Generate move options.
+    moves_t moves;
+    moves_compute ( &moves , board , attacks );
+
+    u64 leaf_count = 0;
+    for ( u32 i = 0; i < moves.count; ++i )
+    {
+        // Filter the move if it puts the moving side into check.
+        if ( !board_move_legal ( board , moves.moves[ i ] , attacks ) )
+        {
+            continue;
+        }
+
+        // Perform a move and recurse.
+        board_t board_next;
+        memory_copy ( &board_next , board , sizeof ( board_t ) );
+        board_move ( &board_next
+                   , moves.moves[ i ]
+                   , attacks
+                   );
+        leaf_count += perft_count_table ( &board_next , depth - 1 , attacks , table );
+    }
+
+    // Store (always replace).
+    const u64 data_ = ( leaf_count << 8 ) | depth;
+    ( *entry ).check = key ^ data_;
+    ( *entry ).data = data_;
+
+    return leaf_count;
+}
+
+u64
+perft_frontier
+(   const board_t*      board
+,   const u32           ply
+,   const attacks_t*    attacks
+,   board_t*            frontier
+)
+{
+    if ( !ply )
+    {
+        if ( frontier )
+        {
+            memory_copy ( frontier , board , sizeof ( board_t ) );
+        }
+        return 1;
+    }
+
+    moves_t moves;
+    moves_compute ( &moves , board , attacks );
+
+    u64 count = 0;
+    for ( u32 i = 0; i < moves.count; ++i )
+    {
+        if ( !board_move_legal ( board , moves.moves[ i ] , attacks ) )
+        {
+            continue;
+        }
+        board_t board_next;
+        memory_copy ( &board_next , board , sizeof ( board_t ) );
+        board_move ( &board_next
+                   , moves.moves[ i ]
+                   , attacks
+                   );
+        count += perft_frontier ( &board_next
+                                , ply - 1
+                                , attacks
+                                , ( frontier ) ? frontier + count : 0
+                                );
+    }
+    return count;
+}
+
+u32
+perft_worker
+(   void* args
+)
+{
+    perft_worker_t* worker = args;
+    for ( u64 i = ( *worker ).index; i < ( *worker ).frontier_count; i += ( *worker ).thread_count )
+    {
+        ( *worker ).counts[ i ] = ( ( *worker ).table ) ? perft_count_table ( &( *worker ).frontier[ i ]
+                                                                            , ( *worker ).depth
+                                                                            , ( *worker ).attacks
+                                                                            , ( *worker ).table
+                                                                            )
+                                                        : perft_count ( &( *worker ).frontier[ i ]
+                                                                      , ( *worker ).depth
+                                                                      , ( *worker ).attacks
+                                                                      )
+                                                        ;
+    }
+    return 0;
 }
\ No newline at end of file
@@ -10,6 +10,120 @@
 #include "chess/common.h"
 
 #include "chess/move.h"
+#include "chess/quad.h"
+
+// Defines the ply at which the parallel perft splits the tree among threads.
+#define PERFT_SPLIT_PLY 2
+
+// Defines buffer sizes.
+#define PERFT_MAX_THREADS 64ULL
+
+// Type definition for a perft hash table entry. The key is stored XORed with
+// the data, so that an entry torn by concurrent writes fails to match.
+typedef struct
+{
+    u64 check;
+    u64 data;
+}
+perft_entry_t;
+
+// Type definition for a perft hash table. The table caches subtree leaf
+// counts, keyed by Zobrist key and depth, and may be shared between threads
+// without locking.
+typedef struct
+{
+    perft_entry_t*  entries;
+    u64             entry_count;
+}
+perft_table_t;
+
+/**
+ * @brief Counts the leaf nodes of the legal move tree rooted at a board state.
+ * Leaves are counted in bulk: at depth 1, legal moves are counted without
+ * being performed. Requires pregenerated attack tables.
+ * @param board A chess board state.
+ * @param depth The recursion depth.
+ * @param attacks The pregenerated attack tables.
+ * @return The leaf node count.
+ */
+u64
+perft_count
+(   const board_t*      board
+,   const u32           depth
+,   const attacks_t*    attacks
+);
+
+/**
+ * @brief Variant of perft_count on the compact board state (see quad.h).
+ * Moves are generated and tested for legality on a partial expansion of the
+ * compact state (see board_quad_expand), as perft_count does on the full
+ * state, but performed on a copy of the compact state; the two counts thus
+ * differ only in the cost of copying and making moves. Requires pregenerated
+ * attack tables.
+ * @param quad A compact board state.
+ * @param depth The recursion depth.
+ * @param attacks The pregenerated attack tables.
+ * @return The leaf node count.
+ */
+u64
+perft_count_quad
+(   const board_quad_t* quad
+,   const u32           depth
+,   const attacks_t*    attacks
+);
+
+/**
+ * @brief Counts the leaf nodes of the legal move tree rooted at a board state
+ * across several threads (see perft_count). The tree is split into the
+ * subtrees rooted at PERFT_SPLIT_PLY, which are dealt out to the threads in
+ * turn. The result does not depend on the number of threads. Requires
+ * pregenerated attack tables.
+ * @param board A chess board state.
+ * @param depth The recursion depth.
+ * @param attacks The pregenerated attack tables.
+ * @param thread_count The number of threads.
+ * @param table A hash table of subtree leaf counts, or 0 if none.
+ * @return The leaf node count.
+ */
+u64
+perft_parallel
+(   const board_t*      board
+,   const u32           depth
+,   const attacks_t*    attacks
+,   const u32           thread_count
+,   perft_table_t*      table
+);
+
+/**
+ * @brief Allocates a perft hash table.
+ * @param size The table size in bytes (rounded down to a power of two number
+ * of entries).
+ * @param table Output buffer.
+ * @return true if table allocated successfully, false otherwise.
+ */
+bool
+perft_table_create
+(   const u64       size
+,   perft_table_t*  table
+);
+
+/**
+ * @brief Frees a perft hash table.
+ * @param table The table.
+ */
+void
+perft_table_destroy
+(   perft_table_t* table
+);
+
+/**
+ * @brief Clears every entry of a perft hash table.
+ * @param table The table.
+ */
+void
+perft_table_clear
+(   perft_table_t* table
+);
 
 /**
  * @brief Runs the Perft driver. Requires pregenerated attack tables.
@@ -0,0 +1,32 @@
+/**
+ * @file zobrist.h
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Zobrist hashing of chess board states.
+ *
+ * The keys are compatible with the Polyglot opening book format, so the same
+ * key can be used both to look up book moves and to index hash tables.
+ */
+#ifndef CHESS_ZOBRIST_H
+#define CHESS_ZOBRIST_H
+
+#include "chess/common.h"
+
+// Defines the layout of the Polyglot random number table.
+#define ZOBRIST_PIECE_OFFS      0
+#define ZOBRIST_CASTLE_OFFS     768
+#define ZOBRIST_ENPASSANT_OFFS  772
+#define ZOBRIST_TURN_OFFS       780
+#define ZOBRIST_RANDOM_COUNT    781
+
+/**
+ * @brief Computes the Polyglot Zobrist key of a board state. The en passant
+ * square is only hashed if a pawn of the side to move can capture onto it.
+ * @param board A chess board state.
+ * @return The Zobrist key.
+ */
+u64
+zobrist_key
+(   const board_t* board
+);
+
+#endif  // CHESS_ZOBRIST_H
\ No newline at end of file
@@ -0,0 +1,581 @@
+/**
+ * @file main.c
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Entry point for the endgame bitbase generator program.
+ *
+ * Generates the win/draw/loss bitbases listed in chess/bitbase.c by
+ * retrograde analysis, and writes one file per endgame.
+ *
+ * Usage: bitbase [-d <directory>] [-t <threads>] [-n <max pieces>]
+ *
+ * Each table is solved by repeated passes over every position: a position is
+ * won if some move reaches a position lost for the opponent, lost if every
+ * move reaches a position won for the opponent, and drawn if every move is
+ * resolved and none of them wins. Captures and promotions lead into tables
+ * which were generated earlier (or into trivially drawn material). Positions
+ * which remain unresolved once a pass makes no progress are drawn. Each pass
+ * is split across all cores.
+ *
+ * Once KQK is generated, a search is run with the generated tables on a set
+ * of short forced mates, as a regression check that bitbase probing does not
+ * hide mates from the search (see negamax).
+ */
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/memory.h"
+#include "core/string.h"
+
+#include "math/math.h"
+
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include "chess/chess.h"
+#include "chess/bitbase.h"
+
+// Defines default generator parameters.
+#define BITBASE_DEFAULT_DIRECTORY   "."
+
+// Defines buffer sizes.
+#define BITBASE_MAX_THREADS         64ULL
+
+// Defines the search depth of the regression check.
+#define BITBASE_CHECK_DEPTH         6
+
+// Type definition for a regression check position: a forced mate which the
+// search must find with the bitbases loaded.
+typedef struct
+{
+    const char* fen;
+    const char* best;   // Expected best move (see string_move).
+    i32         mate;   // Expected moves to mate.
+}
+bitbase_check_t;
+
+// Regression check positions. The first is covered by the bitbases; the
+// second is not, but its mate lands in a covered ending.
+static const bitbase_check_t bitbase_checks[] =
+{   { "7k/8/6K1/8/8/8/8/1Q6 w - - 0 1" , "B1B8" , 1 }
+,   { "7k/p7/6K1/8/8/8/8/1Q6 w - - 0 1" , "B1B8" , 1 }
+};
+
+// Type definition for the state of a generator worker thread.
+typedef struct
+{
+    // Input.
+    u32                 endgame;
+    u64                 begin;
+    u64                 end;
+    bool                initialize;
+    const attacks_t*    attacks;
+    const bitbases_t*   bitbases;
+    const u8*           results;
+
+    // Output.
+    u8*                 next;
+    u64                 changed;
+    bool                missing;
+}
+bitbase_worker_t;
+
+// Type definition for the generator state.
+typedef struct
+{
+    attacks_t           attacks;
+    bitbases_t          bitbases;
+    u64                 sizes[ BITBASE_ENDGAME_COUNT ];
+
+    // Workers.
+    u32                 thread_count;
+    bitbase_worker_t    workers[ BITBASE_MAX_THREADS ];
+}
+generator_t;
+
+/**
+ * @brief Solves a single endgame and writes it to a file. The packed table is
+ * kept in the generator state for use by later endgames.
+ * @param endgame The endgame index.
+ * @param directory The output directory.
+ * @param generator The generator state.
+ * @return true on success, false otherwise.
+ */
+bool
+bitbase_generate
+(   const u32       endgame
+,   const char*     directory
+,   generator_t*    generator
+);
+
+/**
+ * @brief Searches each regression check position with the generated
+ * bitbases, and tests that the expected forced mate is found.
+ * @param generator The generator state.
+ * @return true if every check passed, false otherwise.
+ */
+bool
+bitbase_check
+(   generator_t* generator
+);
+
+/**
+ * @brief Runs a single generation pass across all threads.
+ * @param generator The generator state.
+ * @return The number of positions resolved during the pass.
+ */
+u64
+bitbase_pass
+(   generator_t* generator
+);
+
+/**
+ * @brief Worker thread entry point (see bitbase_pass).
+ * @param args A bitbase_worker_t.
+ * @return 0.
+ */
+u32
+bitbase_worker
+(   void* args
+);
+
+/**
+ * @brief Computes the result of a single position from the results of its
+ * successors.
+ * @param index The position index.
+ * @param worker The worker state.
+ * @return The result, or BITBASE_UNKNOWN if not yet resolved.
+ */
+BITBASE_RESULT
+bitbase_solve
+(   const u64           index
+,   bitbase_worker_t*   worker
+);
+
+/**
+ * @brief Looks up the result of a position reached by a move.
+ * @param board The board state after the move.
+ * @param worker The worker state.
+ * @return The result relative to the side to move.
+ */
+BITBASE_RESULT
+bitbase_successor
+(   const board_t*      board
+,   bitbase_worker_t*   worker
+);
+
+int
+main
+(   int     argc
+,   char**  argv
+)
+{
+    const char* directory = BITBASE_DEFAULT_DIRECTORY;
+    u64 thread_count = platform_processor_count ();
+    u64 max_pieces = BITBASE_MAX_PIECES;
+
+    // Parse command line.
+    for ( i32 i = 1; i < argc; ++i )
+    {
+        if ( string_equal ( argv[ i ] , "-d" ) && i + 1 < argc )
+        {
+            directory = argv[ ++i ];
+        }
+        else if ( string_equal ( argv[ i ] , "-t" ) && i + 1 < argc )
+        {
+            if ( !string_to_u64 ( argv[ ++i ] , &thread_count ) || !thread_count )
+            {
+                LOGERROR ( "Invalid thread count '%s'." , argv[ i ] );
+                return 1;
+            }
+        }
+        else if ( string_equal ( argv[ i ] , "-n" ) && i + 1 < argc )
+        {
+            if ( !string_to_u64 ( argv[ ++i ] , &max_pieces ) )
+            {
+                LOGERROR ( "Invalid piece count '%s'." , argv[ i ] );
+                return 1;
+            }
+        }
+        else
+        {
+            LOGERROR ( "Usage: %s [-d <directory>] [-t <threads>] [-n <max pieces>]"
+                     , argv[ 0 ]
+                     );
+            return 1;
+        }
+    }
+
+    // Size the memory subsystem for the largest table: two bytes per position
+    // while solving, plus every packed table.
+    u64 memory_requirement = sizeof ( generator_t ) + MEBIBYTES ( 4 );
+    u64 largest = 0;
+    for ( u32 i = 0; i < BITBASE_ENDGAME_COUNT; ++i )
+    {
+        largest = max ( largest , bitbase_size ( i ) );
+        memory_requirement += bitbase_size ( i ) / 4 + 1;
+    }
+    memory_requirement += 2 * largest + sizeof ( move_search_t );
+    if ( !memory_startup ( memory_requirement ) )
+    {
+        return 1;
+    }
+
+    generator_t* generator = memory_allocate ( sizeof ( generator_t ) , MEMORY_TAG_APPLICATION );
+    ( *generator ).thread_count = min ( thread_count , BITBASE_MAX_THREADS );
+    attacks_init ( &( *generator ).attacks );
+
+    for ( u32 i = 0; i < BITBASE_ENDGAME_COUNT; ++i )
+    {
+        if ( 2 + ( *bitbase_endgame ( i ) ).piece_count > max_pieces )
+        {
+            continue;
+        }
+        if ( !bitbase_generate ( i , directory , generator ) )
+        {
+            return 1;
+        }
+    }
+    if ( ( *generator ).bitbases.tables[ 0 ] && !bitbase_check ( generator ) )
+    {
+        return 1;
+    }
+
+    for ( u32 i = 0; i < BITBASE_ENDGAME_COUNT; ++i )
+    {
+        if ( ( *generator ).bitbases.tables[ i ] )
+        {
+            memory_free ( ( void* )( *generator ).bitbases.tables[ i ]
+                        , ( *generator ).sizes[ i ] / 4 + 1
+                        , MEMORY_TAG_APPLICATION
+                        );
+        }
+    }
+    memory_free ( generator , sizeof ( generator_t ) , MEMORY_TAG_APPLICATION );
+    memory_shutdown ();
+    return 0;
+}
+
+bool
+bitbase_generate
+(   const u32       endgame
+,   const char*     directory
+,   generator_t*    generator
+)
+{
+    const char* name = ( *bitbase_endgame ( endgame ) ).name;
+    const u64 size = bitbase_size ( endgame );
+
+    // Allocate the packed table first, so that the solver buffers are freed
+    // back into one contiguous block for the next endgame.
+    u8* table = memory_allocate ( size / 4 + 1 , MEMORY_TAG_APPLICATION );
+    u8* results = memory_allocate ( size , MEMORY_TAG_APPLICATION );
+    u8* next = memory_allocate ( size , MEMORY_TAG_APPLICATION );
+
+    // Split the table evenly across the worker threads.
+    for ( u32 i = 0; i < ( *generator ).thread_count; ++i )
+    {
+        bitbase_worker_t* worker = &( *generator ).workers[ i ];
+        ( *worker ).endgame = endgame;
+        ( *worker ).begin = size * i / ( *generator ).thread_count;
+        ( *worker ).end = size * ( i + 1 ) / ( *generator ).thread_count;
+        ( *worker ).initialize = true;
+        ( *worker ).attacks = &( *generator ).attacks;
+        ( *worker ).bitbases = &( *generator ).bitbases;
+        ( *worker ).results = results;
+        ( *worker ).next = next;
+        ( *worker ).missing = false;
+    }
+
+    // Solve.
+    clock_t clock;
+    clock_start ( &clock );
+    u32 passes = 0;
+    for ( u64 changed = bitbase_pass ( generator ); changed; changed = bitbase_pass ( generator ) )
+    {
+        if ( ( *generator ).workers[ 0 ].initialize )
+        {
+            for ( u32 i = 0; i < ( *generator ).thread_count; ++i )
+            {
+                ( *generator ).workers[ i ].initialize = false;
+            }
+        }
+        else
+        {
+            passes += 1;
+        }
+        for ( u32 i = 0; i < ( *generator ).thread_count; ++i )
+        {
+            if ( ( *generator ).workers[ i ].missing )
+            {
+                LOGERROR ( "bitbase_generate: %s depends on a bitbase which was not generated." , name );
+                return false;
+            }
+        }
+        memory_copy ( results , next , size );
+    }
+    clock_update ( &clock );
+
+    // Pack the results; unresolved positions are drawn.
+    u64 counts[ BITBASE_UNKNOWN + 1 ];
+    memory_clear ( counts , sizeof ( counts ) );
+    for ( u64 i = 0; i < size; ++i )
+    {
+        const BITBASE_RESULT result = ( results[ i ] == BITBASE_UNKNOWN ) ? BITBASE_DRAW
+                                                                          : results[ i ]
+                                                                          ;
+        counts[ result ] += 1;
+        table[ i >> 2 ] |= result << ( ( i & 3 ) << 1 );
+    }
+    memory_free ( results , size , MEMORY_TAG_APPLICATION );
+    memory_free ( next , size , MEMORY_TAG_APPLICATION );
+    ( *generator ).bitbases.tables[ endgame ] = table;
+    ( *generator ).sizes[ endgame ] = size;
+
+    LOGINFO ( "%s: %llu positions solved in %u passes (%f seconds). Win: %llu, draw: %llu, loss: %llu, illegal: %llu."
+            , name , size , passes , clock.elapsed
+            , counts[ BITBASE_WIN ] , counts[ BITBASE_DRAW ]
+            , counts[ BITBASE_LOSS ] , counts[ BITBASE_ILLEGAL ]
+            );
+
+    // Write the file.
+    char filepath[ STACK_STRING_MAX_LENGTH ];
+    string_format ( filepath , "%s/%s" BITBASE_FILE_EXTENSION , directory , name );
+    file_handle_t file;
+    if ( !file_open ( filepath , FILE_MODE_WRITE , true , &file ) )
+    {
+        LOGERROR ( "bitbase_generate: Unable to open file '%s' for writing." , filepath );
+        return false;
+    }
+    const u32 header[ 4 ] = { BITBASE_FILE_MAGIC , BITBASE_FILE_VERSION , endgame , 0 };
+    u64 written;
+    const bool success = file_write ( &file , sizeof ( header ) , header , &written )
+                      && file_write ( &file , ( size + 3 ) / 4 , table , &written )
+                      ;
+    file_close ( &file );
+    if ( !success )
+    {
+        LOGERROR ( "bitbase_generate: Failed to write file '%s'." , filepath );
+        return false;
+    }
+    LOGINFO ( "Wrote %s bitbase to '%s'." , name , filepath );
+    return true;
+}
+
+bool
+bitbase_check
+(   generator_t* generator
+)
+{
+    move_search_t* search = memory_allocate ( sizeof ( move_search_t ) , MEMORY_TAG_APPLICATION );
+    ( *search ).bitbases = &( *generator ).bitbases;
+
+    bool success = true;
+    for ( u32 i = 0; i < sizeof ( bitbase_checks ) / sizeof ( bitbase_checks[ 0 ] ); ++i )
+    {
+        const bitbase_check_t* check = &bitbase_checks[ i ];
+        board_t board;
+        memory_clear ( &board , sizeof ( board_t ) );
+        fen_parse ( ( *check ).fen , &board );
+        const move_t best = board_best_move ( &board
+                                            , &( *generator ).attacks
+                                            , BITBASE_CHECK_DEPTH
+                                            , search
+                                            );
+        char move[ MOVE_STRING_LENGTH + 1 ];
+        string_move ( move , best );
+        string_trim ( move );
+        if (    !string_equal ( move , ( *check ).best )
+             || !( *search ).result.forced_mate
+             || ( *search ).result.mate != ( *check ).mate
+           )
+        {
+            LOGERROR ( "bitbase_check: %s: expected %s (mate %i), got %s (score %i)."
+                     , ( *check ).fen , ( *check ).best , ( *check ).mate
+                     , move , ( *search ).result.score
+                     );
+            success = false;
+        }
+    }
+    if ( success )
+    {
+        LOGINFO ( "Regression check passed (%u positions)."
+                , ( u32 )( sizeof ( bitbase_checks ) / sizeof ( bitbase_checks[ 0 ] ) )
+                );
+    }
+
+    memory_free ( search , sizeof ( move_search_t ) , MEMORY_TAG_APPLICATION );
+    return success;
+}
+
+u64
+bitbase_pass
+(   generator_t* generator
+)
+{
+    platform_thread_t threads[ BITBASE_MAX_THREADS ];
+    for ( u32 i = 1; i < ( *generator ).thread_count; ++i )
+    {
+        if ( !platform_thread_create ( bitbase_worker , &( *generator ).workers[ i ] , &threads[ i ] ) )
+        {
+            // Fall back to running the slice on the calling thread.
+            bitbase_worker ( &( *generator ).workers[ i ] );
+            threads[ i ].handle = 0;
+        }
+    }
+    bitbase_worker ( &( *generator ).workers[ 0 ] );
+
+    u64 changed = ( *generator ).workers[ 0 ].changed;
+    for ( u32 i = 1; i < ( *generator ).thread_count; ++i )
+    {
+        if ( threads[ i ].handle )
+        {
+            platform_thread_join ( &threads[ i ] );
+        }
+        changed += ( *generator ).workers[ i ].changed;
+    }
+    return changed;
+}
+
+u32
+bitbase_worker
+(   void* args
+)
+{
+    bitbase_worker_t* worker = args;
+    ( *worker ).changed = 0;
+
+    // First pass: mark illegal positions, everything else is unresolved.
+    if ( ( *worker ).initialize )
+    {
+        board_t board;
+        for ( u64 i = ( *worker ).begin; i < ( *worker ).end; ++i )
+        {
+            const bool legal = bitbase_position ( ( *worker ).endgame , i , &board )
+                            && !board_check ( &board , ( *worker ).attacks , !board.side )
+                            ;
+            ( *worker ).next[ i ] = ( legal ) ? BITBASE_UNKNOWN : BITBASE_ILLEGAL;
+        }
+        ( *worker ).changed = ( *worker ).end - ( *worker ).begin;
+        return 0;
+    }
+
+    for ( u64 i = ( *worker ).begin; i < ( *worker ).end; ++i )
+    {
+        if ( ( *worker ).results[ i ] != BITBASE_UNKNOWN )
+        {
+            continue;
+        }
+        const BITBASE_RESULT result = bitbase_solve ( i , worker );
+        if ( result != BITBASE_UNKNOWN )
+        {
+            ( *worker ).next[ i ] = result;
+            ( *worker ).changed += 1;
+        }
+    }
+    return 0;
+}
+
+BITBASE_RESULT
+bitbase_solve
+(   const u64           index
+,   bitbase_worker_t*   worker
+)
+{
+    board_t board;
+    bitbase_position ( ( *worker ).endgame , index , &board );
+
+    moves_t moves;
+    moves_compute ( &moves , &board , ( *worker ).attacks );
+
+    u32 legal = 0;
+    bool draw = false;
+    bool resolved = true;
+    for ( u32 i = 0; i < moves.count; ++i )
+    {
+        board_t successor;
+        memory_copy ( &successor , &board , sizeof ( board_t ) );
+        board_move ( &successor , moves.moves[ i ] , ( *worker ).attacks );
+        if ( board_check ( &successor , ( *worker ).attacks , !successor.side ) )
+        {
+            continue;
+        }
+        legal += 1;
+
+        switch ( bitbase_successor ( &successor , worker ) )
+        {
+            case BITBASE_LOSS:
+            {
+                return BITBASE_WIN;
+            }
+
+            case BITBASE_DRAW:
+            {
+                draw = true;
+            }
+            break;
+
+            case BITBASE_WIN:
+            {}
+            break;
+
+            default:
+            {
+                resolved = false;
+            }
+            break;
+        }
+    }
+
+    // No legal moves.
+    if ( !legal )
+    {
+        return ( board_check ( &board , ( *worker ).attacks , board.side ) ) ? BITBASE_LOSS
+                                                                           : BITBASE_DRAW
+                                                                           ;
+    }
+
+    if ( !resolved )
+    {
+        return BITBASE_UNKNOWN;
+    }
+    return ( draw ) ? BITBASE_DRAW : BITBASE_LOSS;
+}
+
+BITBASE_RESULT
+bitbase_successor
+(   const board_t*      board
+,   bitbase_worker_t*   worker
+)
+{
+    bool flip;
+    const i32 endgame = bitbase_find ( board , &flip );
+
+    // Same table.
+    if ( endgame == ( i32 )( *worker ).endgame )
+    {
+        return ( *worker ).results[ bitbase_index ( endgame , board , flip ) ];
+    }
+
+    // Earlier table.
+    if ( endgame >= 0 && ( *( *worker ).bitbases ).tables[ endgame ] )
+    {
+        return bitbase_read ( ( *( *worker ).bitbases ).tables[ endgame ]
+                            , bitbase_index ( endgame , board , flip )
+                            );
+    }
+
+    // Insufficient material (at most one minor piece).
+    if (   !( ( *board ).pieces[ P ] | ( *board ).pieces[ p ]
+            | ( *board ).pieces[ R ] | ( *board ).pieces[ r ]
+            | ( *board ).pieces[ Q ] | ( *board ).pieces[ q ]
+            )
+        && bitboard_count (   ( *board ).pieces[ N ] | ( *board ).pieces[ n ]
+                            | ( *board ).pieces[ B ] | ( *board ).pieces[ b ]
+                            ) <= 1
+       )
+    {
+        return BITBASE_DRAW;
+    }
+
+    ( *worker ).missing = true;
+    return BITBASE_UNKNOWN;
+}
\ No newline at end of file
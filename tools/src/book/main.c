@@ -0,0 +1,776 @@
+/**
+ * @file main.c
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Entry point for the opening book builder program.
+ *
+ * Replays every game of a PGN corpus up to a maximum depth, aggregates
+ * position -> move statistics, and writes a Polyglot book (see chess/book.h).
+ *
+ * Usage: book <corpus> [-o <output>] [-t <threads>] [-d <max ply>]
+ *                      [-f <min frequency>] [-m <memory MiB>]
+ *
+ * The corpus is streamed in chunks (see chess/pgn.h), and each chunk is split
+ * at game boundaries across the worker threads. Each worker appends one record per
+ * (position, move) it replays to its own buffer. When the buffer fills, it is
+ * sorted and duplicate records are combined; if that does not free enough
+ * space, the sorted run is spilled to a temporary file. Once the corpus has
+ * been read, the in-memory runs and the spilled runs are combined by a k-way
+ * merge, so memory use is bounded regardless of the size of the corpus.
+ *
+ * Move weights follow the Polyglot convention: 2 per win and 1 per draw for
+ * the side which played the move. Moves played fewer times than the minimum
+ * frequency, and moves which never scored, are left out.
+ */
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/memory.h"
+#include "core/string.h"
+
+#include "math/math.h"
+
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include "chess/chess.h"
+
+// Defines default builder parameters.
+#define BOOK_DEFAULT_OUTPUT_FILEPATH    "book.bin"
+#define BOOK_DEFAULT_DEPTH              24
+#define BOOK_DEFAULT_MIN_FREQUENCY      3
+#define BOOK_DEFAULT_MEMORY             256
+
+// Defines buffer sizes.
+#define BOOK_READ_BUFFER_SIZE   ( MEBIBYTES ( 16 ) )
+#define BOOK_MERGE_BUFFER_SIZE  ( MEBIBYTES ( 16 ) )
+#define BOOK_MAX_THREADS        64ULL
+
+// Type definition for an aggregated (position, move) record.
+typedef struct
+{
+    u64 key;
+    u32 count;
+    u32 weight;
+    u16 move;
+}
+book_record_t;
+
+// Type definition for the state of a builder worker thread.
+typedef struct
+{
+    // Input.
+    u32                 index;
+    const char*         begin;
+    const char*         end;
+    const attacks_t*    attacks;
+    const char*         output;
+    u32                 depth;
+
+    // Records.
+    book_record_t*      records;
+    u64                 record_count;
+    u64                 record_capacity;
+    u32                 run_count;
+
+    // Output.
+    u64                 game_count;
+    u64                 error_count;
+    bool                failed;
+}
+book_worker_t;
+
+// Type definition for a merge source (an in-memory run or a spilled run).
+typedef struct
+{
+    file_handle_t       file;
+    bool                spilled;
+    book_record_t*      records;
+    u64                 record_count;
+    u64                 position;
+}
+book_source_t;
+
+// Type definition for the builder state.
+typedef struct
+{
+    attacks_t           attacks;
+
+    // Workers.
+    u32                 thread_count;
+    book_worker_t       workers[ BOOK_MAX_THREADS ];
+}
+builder_t;
+
+/**
+ * @brief Worker thread entry point. Replays the games of a slice of the
+ * corpus.
+ * @param args A book_worker_t.
+ * @return 0.
+ */
+u32
+book_worker
+(   void* args
+);
+
+/**
+ * @brief Sorts a worker's records and combines duplicates. Spills the records
+ * to a temporary file if that leaves less than half of the buffer free.
+ * @param worker The worker state.
+ * @param spill Spill regardless of the free space? Y/N
+ * @return true on success, false if the spill file could not be written.
+ */
+bool
+book_compact
+(   book_worker_t*  worker
+,   const bool      spill
+);
+
+/**
+ * @brief Sorts records by key, then by move.
+ * @param records The records to sort.
+ * @param count Number of records.
+ */
+void
+book_sort
+(   book_record_t*  records
+,   u64             count
+);
+
+/**
+ * @brief Merges all runs and writes the book file.
+ * @param filepath The output filepath.
+ * @param builder The builder state.
+ * @param min_frequency The frequency cutoff.
+ * @return true on success, false otherwise.
+ */
+bool
+book_write
+(   const char*         filepath
+,   builder_t*          builder
+,   const u64           min_frequency
+);
+
+/**
+ * @brief Formats the filepath of a spilled run.
+ * @param dst Output buffer.
+ * @param output The output filepath.
+ * @param worker The worker index.
+ * @param run The run index.
+ * @return dst.
+ */
+INLINE
+char*
+book_run_filepath
+(   char*       dst
+,   const char* output
+,   const u32   worker
+,   const u32   run
+)
+{
+    string_format ( dst , "%s.%u.%u.tmp" , output , worker , run );
+    return dst;
+}
+
+/**
+ * @brief Compares two records by key, then by move.
+ * @param a A record.
+ * @param b A record.
+ * @return true if a sorts before b, false otherwise.
+ */
+INLINE
+bool
+book_record_less
+(   const book_record_t* a
+,   const book_record_t* b
+)
+{
+    return ( *a ).key < ( *b ).key
+        || ( ( *a ).key == ( *b ).key && ( *a ).move < ( *b ).move )
+        ;
+}
+
+int
+main
+(   int     argc
+,   char**  argv
+)
+{
+    const char* input = 0;
+    const char* output = BOOK_DEFAULT_OUTPUT_FILEPATH;
+    u64 thread_count = platform_processor_count ();
+    u64 depth = BOOK_DEFAULT_DEPTH;
+    u64 min_frequency = BOOK_DEFAULT_MIN_FREQUENCY;
+    u64 memory = BOOK_DEFAULT_MEMORY;
+
+    // Parse command line.
+    for ( i32 i = 1; i < argc; ++i )
+    {
+        u64* value = 0;
+        if ( string_equal ( argv[ i ] , "-o" ) && i + 1 < argc )
+        {
+            output = argv[ ++i ];
+            continue;
+        }
+        else if ( string_equal ( argv[ i ] , "-t" ) ) value = &thread_count;
+        else if ( string_equal ( argv[ i ] , "-d" ) ) value = &depth;
+        else if ( string_equal ( argv[ i ] , "-f" ) ) value = &min_frequency;
+        else if ( string_equal ( argv[ i ] , "-m" ) ) value = &memory;
+        else if ( !input )
+        {
+            input = argv[ i ];
+            continue;
+        }
+
+        if ( !value || i + 1 >= argc || !string_to_u64 ( argv[ ++i ] , value ) || !*value )
+        {
+            LOGERROR ( "Usage: %s <corpus> [-o <output>] [-t <threads>] [-d <max ply>] [-f <min frequency>] [-m <memory MiB>]"
+                     , argv[ 0 ]
+                     );
+            return 1;
+        }
+    }
+    if ( !input )
+    {
+        LOGERROR ( "Usage: %s <corpus> [-o <output>] [-t <threads>] [-d <max ply>] [-f <min frequency>] [-m <memory MiB>]"
+                 , argv[ 0 ]
+                 );
+        return 1;
+    }
+
+    if ( !memory_startup ( sizeof ( builder_t )
+                         + MEBIBYTES ( memory )
+                         + BOOK_READ_BUFFER_SIZE
+                         + BOOK_MERGE_BUFFER_SIZE
+                         + MEBIBYTES ( 4 )
+                         ))
+    {
+        return 1;
+    }
+
+    builder_t* builder = memory_allocate ( sizeof ( builder_t ) , MEMORY_TAG_APPLICATION );
+    ( *builder ).thread_count = min ( thread_count , BOOK_MAX_THREADS );
+    attacks_init ( &( *builder ).attacks );
+
+    // Divide the record memory evenly across the worker threads.
+    const u64 capacity = MEBIBYTES ( memory ) / ( *builder ).thread_count / sizeof ( book_record_t );
+    if ( capacity < 4 * depth )
+    {
+        LOGERROR ( "Not enough memory for %u threads; increase the memory limit." , ( *builder ).thread_count );
+        return 1;
+    }
+    for ( u32 i = 0; i < ( *builder ).thread_count; ++i )
+    {
+        book_worker_t* worker = &( *builder ).workers[ i ];
+        ( *worker ).index = i;
+        ( *worker ).attacks = &( *builder ).attacks;
+        ( *worker ).output = output;
+        ( *worker ).depth = depth;
+        ( *worker ).record_capacity = capacity;
+        ( *worker ).records = memory_allocate ( capacity * sizeof ( book_record_t ) , MEMORY_TAG_APPLICATION );
+    }
+
+    pgn_reader_t reader;
+    if ( !pgn_reader_open ( input , BOOK_READ_BUFFER_SIZE , &reader ) )
+    {
+        LOGERROR ( "Unable to open corpus '%s'." , input );
+        return 1;
+    }
+
+    // Stream the corpus.
+    clock_t clock;
+    clock_start ( &clock );
+    const char* buffer;
+    const char* cut;
+    while ( pgn_reader_next ( &reader , &buffer , &cut ) )
+    {
+        // Split the complete games across the worker threads.
+        const char* begin = buffer;
+        for ( u32 i = 0; i < ( *builder ).thread_count; ++i )
+        {
+            ( *builder ).workers[ i ].begin = begin;
+            begin = ( i == ( *builder ).thread_count - 1 )
+                  ? cut
+                  : pgn_find_game ( max ( begin , buffer + ( cut - buffer ) * ( i + 1 ) / ( *builder ).thread_count ) , cut );
+            ( *builder ).workers[ i ].end = begin;
+        }
+
+        platform_thread_t threads[ BOOK_MAX_THREADS ];
+        for ( u32 i = 1; i < ( *builder ).thread_count; ++i )
+        {
+            if ( !platform_thread_create ( book_worker , &( *builder ).workers[ i ] , &threads[ i ] ) )
+            {
+                // Fall back to running the slice on the calling thread.
+                book_worker ( &( *builder ).workers[ i ] );
+                threads[ i ].handle = 0;
+            }
+        }
+        book_worker ( &( *builder ).workers[ 0 ] );
+        for ( u32 i = 1; i < ( *builder ).thread_count; ++i )
+        {
+            if ( threads[ i ].handle )
+            {
+                platform_thread_join ( &threads[ i ] );
+            }
+        }
+        for ( u32 i = 0; i < ( *builder ).thread_count; ++i )
+        {
+            if ( ( *builder ).workers[ i ].failed )
+            {
+                LOGERROR ( "Failed to write a temporary run file next to '%s'." , output );
+                return 1;
+            }
+        }
+    }
+    pgn_reader_close ( &reader );
+
+    u64 games = 0;
+    u64 errors = 0;
+    u32 runs = 0;
+    for ( u32 i = 0; i < ( *builder ).thread_count; ++i )
+    {
+        if ( !book_compact ( &( *builder ).workers[ i ] , false ) )
+        {
+            LOGERROR ( "Failed to write a temporary run file next to '%s'." , output );
+            return 1;
+        }
+        games += ( *builder ).workers[ i ].game_count;
+        errors += ( *builder ).workers[ i ].error_count;
+        runs += ( *builder ).workers[ i ].run_count;
+    }
+    clock_update ( &clock );
+    LOGINFO ( "Replayed %llu games in %f seconds (%llu with illegal or unparsable moves, %u spilled runs)."
+            , games , clock.elapsed , errors , runs
+            );
+
+    if ( !book_write ( output , builder , min_frequency ) )
+    {
+        return 1;
+    }
+
+    for ( u32 i = 0; i < ( *builder ).thread_count; ++i )
+    {
+        memory_free ( ( *builder ).workers[ i ].records
+                    , capacity * sizeof ( book_record_t )
+                    , MEMORY_TAG_APPLICATION
+                    );
+    }
+    memory_free ( builder , sizeof ( builder_t ) , MEMORY_TAG_APPLICATION );
+    memory_shutdown ();
+    return 0;
+}
+
+u32
+book_worker
+(   void* args
+)
+{
+    book_worker_t* worker = args;
+
+    pgn_lexer_t lexer;
+    pgn_lexer_init ( &lexer , ( *worker ).begin , ( *worker ).end );
+    pgn_game_t game;
+    move_t move;
+    while ( pgn_game_begin ( &lexer , ( *worker ).attacks , &game ) )
+    {
+        ( *worker ).game_count += 1;
+
+        // Games from a custom starting position are skipped.
+        if ( pgn_game_tag ( &game , "FEN" ) || pgn_game_tag ( &game , "SetUp" ) )
+        {
+            pgn_game_end ( &lexer , &game );
+            continue;
+        }
+
+        // Make room for the game before it begins, so that its records stay
+        // contiguous.
+        if (    ( *worker ).record_capacity - ( *worker ).record_count < ( *worker ).depth
+             && !book_compact ( worker , false )
+           )
+        {
+            ( *worker ).failed = true;
+            return 0;
+        }
+        const u64 game_begin = ( *worker ).record_count;
+
+        // Replay the game up to the maximum depth. On an illegal or
+        // unparsable move, stop recording the game, but keep the moves
+        // replayed so far.
+        while ( game.ply < ( *worker ).depth )
+        {
+            const u64 key = zobrist_key ( &game.board );
+            if ( !pgn_game_next ( &lexer , ( *worker ).attacks , &game , &move ) )
+            {
+                break;
+            }
+            book_record_t* record = &( *worker ).records[ ( *worker ).record_count ];
+            ( *record ).key = key;
+            ( *record ).move = book_move_encode ( move );
+            ( *record ).count = 1;
+            ( *record ).weight = 0;
+            ( *worker ).record_count += 1;
+        }
+        ( *worker ).error_count += game.error;
+        pgn_game_end ( &lexer , &game );
+
+        // Weight each move by the result for the side which played it.
+        for ( u64 i = game_begin; i < ( *worker ).record_count; ++i )
+        {
+            const bool white = !( ( i - game_begin ) & 1 );
+            ( *worker ).records[ i ].weight = ( game.result == PGN_RESULT_DRAW ) ? 1
+                                            : ( game.result == PGN_RESULT_WHITE && white ) ? 2
+                                            : ( game.result == PGN_RESULT_BLACK && !white ) ? 2
+                                            : 0
+                                            ;
+        }
+    }
+    return 0;
+}
+
+bool
+book_compact
+(   book_worker_t*  worker
+,   const bool      spill
+)
+{
+    book_record_t* records = ( *worker ).records;
+
+    // Sort, then combine duplicates in place.
+    book_sort ( records , ( *worker ).record_count );
+    u64 count = 0;
+    for ( u64 i = 0; i < ( *worker ).record_count; ++i )
+    {
+        if (    count
+             && records[ count - 1 ].key == records[ i ].key
+             && records[ count - 1 ].move == records[ i ].move
+           )
+        {
+            records[ count - 1 ].count += records[ i ].count;
+            records[ count - 1 ].weight += records[ i ].weight;
+        }
+        else
+        {
+            records[ count++ ] = records[ i ];
+        }
+    }
+    ( *worker ).record_count = count;
+    if ( !spill && count < ( *worker ).record_capacity / 2 )
+    {
+        return true;
+    }
+
+    // Spill the sorted run to a temporary file.
+    char filepath[ STACK_STRING_MAX_LENGTH ];
+    book_run_filepath ( filepath , ( *worker ).output , ( *worker ).index , ( *worker ).run_count );
+    file_handle_t file;
+    u64 written;
+    if (    !file_open ( filepath , FILE_MODE_WRITE , true , &file ) )
+    {
+        return false;
+    }
+    const bool success = file_write ( &file , count * sizeof ( book_record_t ) , records , &written );
+    file_close ( &file );
+    if ( !success )
+    {
+        return false;
+    }
+    ( *worker ).run_count += 1;
+    ( *worker ).record_count = 0;
+    return true;
+}
+
+void
+book_sort
+(   book_record_t*  records
+,   u64             count
+)
+{
+    // Quicksort, recursing into the smaller partition; insertion sort for
+    // small partitions.
+    while ( count > 16 )
+    {
+        // Median of three.
+        book_record_t* a = &records[ 0 ];
+        book_record_t* b = &records[ count / 2 ];
+        book_record_t* c = &records[ count - 1 ];
+        const book_record_t* m = ( book_record_less ( a , b ) )
+                               ? ( ( book_record_less ( b , c ) ) ? b : ( book_record_less ( a , c ) ) ? c : a )
+                               : ( ( book_record_less ( a , c ) ) ? a : ( book_record_less ( b , c ) ) ? c : b )
+                               ;
+        const book_record_t pivot = *m;
+
+        // Hoare partition.
+        i64 i = -1;
+        i64 j = count;
+        for ( ;; )
+        {
+            do { i += 1; } while ( book_record_less ( &records[ i ] , &pivot ) );
+            do { j -= 1; } while ( book_record_less ( &pivot , &records[ j ] ) );
+            if ( i >= j )
+            {
+                break;
+            }
+            const book_record_t swap = records[ i ];
+            records[ i ] = records[ j ];
+            records[ j ] = swap;
+        }
+
+        const u64 left = j + 1;
+        if ( left < count - left )
+        {
+            book_sort ( records , left );
+            records += left;
+            count -= left;
+        }
+        else
+        {
+            book_sort ( records + left , count - left );
+            count = left;
+        }
+    }
+    for ( u64 i = 1; i < count; ++i )
+    {
+        const book_record_t record = records[ i ];
+        u64 j = i;
+        for ( ; j && book_record_less ( &record , &records[ j - 1 ] ); --j )
+        {
+            records[ j ] = records[ j - 1 ];
+        }
+        records[ j ] = record;
+    }
+}
+
+/**
+ * @brief Reads the next record of a merge source, refilling its buffer from
+ * the run file if necessary.
+ * @param source The merge source.
+ * @param capacity The buffer capacity (spilled runs only).
+ * @return The next record, or 0 if the source is exhausted.
+ */
+const book_record_t*
+book_source_peek
+(   book_source_t*  source
+,   const u64       capacity
+)
+{
+    if ( ( *source ).position == ( *source ).record_count && ( *source ).spilled )
+    {
+        u64 read;
+        file_read ( &( *source ).file , capacity * sizeof ( book_record_t ) , ( *source ).records , &read );
+        ( *source ).record_count = read / sizeof ( book_record_t );
+        ( *source ).position = 0;
+    }
+    return ( ( *source ).position < ( *source ).record_count ) ? &( *source ).records[ ( *source ).position ]
+                                                               : 0
+                                                               ;
+}
+
+/**
+ * @brief Writes the book entries for one position. Weights are scaled down
+ * if needed to fit in 16 bits.
+ * @param file The output file.
+ * @param key The position key.
+ * @param records The aggregated records for the position.
+ * @param count Number of records.
+ * @param written Output buffer for the number of entries written.
+ * @return true on success, false otherwise.
+ */
+bool
+book_write_position
+(   file_handle_t*          file
+,   const u64               key
+,   const book_record_t*    records
+,   const u32               count
+,   u64*                    written
+)
+{
+    u32 weight_max = 0;
+    for ( u32 i = 0; i < count; ++i )
+    {
+        weight_max = max ( weight_max , records[ i ].weight );
+    }
+    *written = 0;
+    for ( u32 i = 0; i < count; ++i )
+    {
+        const u64 weight = ( weight_max > 0xFFFF ) ? ( u64 ) records[ i ].weight * 0xFFFF / weight_max
+                                                   : records[ i ].weight
+                                                   ;
+        if ( !weight )
+        {
+            continue;
+        }
+
+        // Big-endian entry: key, move, weight, learn.
+        u8 entry[ BOOK_ENTRY_SIZE ];
+        memory_clear ( entry , sizeof ( entry ) );
+        for ( u32 j = 0; j < 8; ++j )
+        {
+            entry[ j ] = key >> ( 56 - 8 * j );
+        }
+        entry[ 8 ] = records[ i ].move >> 8;
+        entry[ 9 ] = records[ i ].move;
+        entry[ 10 ] = weight >> 8;
+        entry[ 11 ] = weight;
+        u64 written_;
+        if ( !file_write ( file , sizeof ( entry ) , entry , &written_ ) )
+        {
+            return false;
+        }
+        *written += 1;
+    }
+    return true;
+}
+
+bool
+book_write
+(   const char*         filepath
+,   builder_t*          builder
+,   const u64           min_frequency
+)
+{
+    // Gather merge sources: each worker's spilled runs, then its in-memory
+    // run.
+    u32 source_count = 0;
+    u32 spilled_count = 0;
+    for ( u32 i = 0; i < ( *builder ).thread_count; ++i )
+    {
+        source_count += ( *builder ).workers[ i ].run_count + 1;
+        spilled_count += ( *builder ).workers[ i ].run_count;
+    }
+    book_source_t* sources = memory_allocate ( source_count * sizeof ( book_source_t ) , MEMORY_TAG_APPLICATION );
+    const u64 capacity = max ( 1ULL , ( BOOK_MERGE_BUFFER_SIZE - source_count * sizeof ( book_source_t ) )
+                                    / max ( 1U , spilled_count )
+                                    / sizeof ( book_record_t )
+                             );
+    book_record_t* buffers = ( spilled_count ) ? memory_allocate ( spilled_count * capacity * sizeof ( book_record_t ) , MEMORY_TAG_APPLICATION )
+                                               : 0
+                                               ;
+    // A source is only marked spilled once its run file is open (sources is
+    // zeroed on allocation), so the clean up below closes exactly the run
+    // files which were opened.
+    bool success = true;
+    char path[ STACK_STRING_MAX_LENGTH ];
+    u32 source = 0;
+    u32 spilled = 0;
+    for ( u32 i = 0; success && i < ( *builder ).thread_count; ++i )
+    {
+        const book_worker_t* worker = &( *builder ).workers[ i ];
+        for ( u32 j = 0; success && j < ( *worker ).run_count; ++j )
+        {
+            book_run_filepath ( path , ( *worker ).output , i , j );
+            if ( !file_open ( path , FILE_MODE_READ , true , &sources[ source ].file ) )
+            {
+                LOGERROR ( "book_write: Unable to open temporary run file '%s'." , path );
+                success = false;
+                break;
+            }
+            sources[ source ].spilled = true;
+            sources[ source ].records = buffers + spilled * capacity;
+            spilled += 1;
+            source += 1;
+        }
+        sources[ source ].records = ( *worker ).records;
+        sources[ source ].record_count = ( *worker ).record_count;
+        source += 1;
+    }
+
+    file_handle_t file;
+    if ( success && !file_open ( filepath , FILE_MODE_WRITE , true , &file ) )
+    {
+        LOGERROR ( "book_write: Unable to open file '%s' for writing." , filepath );
+        success = false;
+    }
+    const bool opened = success;
+
+    // K-way merge. Records for one position are gathered, then written.
+    book_record_t position[ MOVES_BUFFER_LENGTH ];
+    u32 position_count = 0;
+    u64 position_key = 0;
+    u64 entry_count = 0;
+    u64 position_total = 0;
+    while ( success )
+    {
+        const book_record_t* next = 0;
+        book_source_t* next_source = 0;
+        for ( u32 i = 0; i < source_count; ++i )
+        {
+            const book_record_t* record = book_source_peek ( &sources[ i ] , capacity );
+            if ( record && ( !next || book_record_less ( record , next ) ) )
+            {
+                next = record;
+                next_source = &sources[ i ];
+            }
+        }
+
+        // Flush the previous position.
+        if ( position_count && ( !next || ( *next ).key != position_key ) )
+        {
+            u32 kept = 0;
+            for ( u32 i = 0; i < position_count; ++i )
+            {
+                if ( position[ i ].count >= min_frequency )
+                {
+                    position[ kept++ ] = position[ i ];
+                }
+            }
+            u64 written;
+            if ( !book_write_position ( &file , position_key , position , kept , &written ) )
+            {
+                LOGERROR ( "book_write: Failed to write to file '%s'." , filepath );
+                success = false;
+                break;
+            }
+            entry_count += written;
+            position_total += ( written > 0 );
+            position_count = 0;
+        }
+        if ( !next )
+        {
+            break;
+        }
+
+        // Accumulate.
+        if (    position_count
+             && position[ position_count - 1 ].move == ( *next ).move
+           )
+        {
+            position[ position_count - 1 ].count += ( *next ).count;
+            position[ position_count - 1 ].weight += ( *next ).weight;
+        }
+        else if ( position_count < MOVES_BUFFER_LENGTH )
+        {
+            position[ position_count++ ] = *next;
+        }
+        position_key = ( *next ).key;
+        ( *next_source ).position += 1;
+    }
+    if ( opened )
+    {
+        file_close ( &file );
+    }
+
+    // Clean up the spilled runs.
+    for ( u32 i = 0; i < source_count; ++i )
+    {
+        if ( sources[ i ].spilled )
+        {
+            file_close ( &sources[ i ].file );
+        }
+    }
+    for ( u32 i = 0; i < ( *builder ).thread_count; ++i )
+    {
+        for ( u32 j = 0; j < ( *builder ).workers[ i ].run_count; ++j )
+        {
+            file_remove ( book_run_filepath ( path , ( *builder ).workers[ i ].output , i , j ) );
+        }
+    }
+    if ( buffers )
+    {
+        memory_free ( buffers , spilled_count * capacity * sizeof ( book_record_t ) , MEMORY_TAG_APPLICATION );
+    }
+    memory_free ( sources , source_count * sizeof ( book_source_t ) , MEMORY_TAG_APPLICATION );
+
+    if ( success )
+    {
+        LOGINFO ( "Wrote %llu entries for %llu positions to '%s'." , entry_count , position_total , filepath );
+    }
+    return success;
+}
\ No newline at end of file
@@ -0,0 +1,615 @@
+/**
+ * @file main.c
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Entry point for the EPD test suite runner.
+ *
+ * Searches every position of an EPD test suite (such as WAC or STS) and
+ * checks the move found against the best move (bm) and avoid move (am)
+ * operations of the position.
+ *
+ * Usage: epd <suite> [-o <report>] [-t <threads>] [-m <movetime ms>]
+ *                    [-n <nodes>] [-d <depth>] [-e <network>]
+ *
+ * Each position is searched with the given limits (one second per position
+ * if none are given). The suite is streamed in batches of EPD_BATCH_SIZE
+ * positions, and the positions of a batch are dealt out to the worker
+ * threads in turn, each running a search of its own, so throughput scales
+ * with the number of cores.
+ *
+ * A position is solved if the move found is one of its best moves and none of
+ * its avoid moves. Its time to solution is the time at which the search
+ * settled on that move: the end of the first iteration from which every
+ * iteration returned a correct move.
+ *
+ * The report is one tab-separated line per position, preceded by a header
+ * line:
+ *
+ *     id  result  move  seconds  nodes  solution seconds  solution nodes
+ *
+ * where result is one of pass or fail. It is written to the console, and to
+ * the report file if one is given. Then the solve rate, the mean time to
+ * solution and the total speed across all threads are logged.
+ */
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/memory.h"
+#include "core/string.h"
+
+#include "math/math.h"
+
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include "chess/chess.h"
+
+// Defines default search limits.
+#define EPD_DEFAULT_MOVETIME            1000
+
+// Defines buffer sizes.
+#define EPD_MAX_THREADS                 64ULL
+#define EPD_BATCH_SIZE                  1024
+#define EPD_MAX_MOVES                   8
+#define EPD_ID_MAX_LENGTH               64
+#define EPD_TOKEN_MAX_LENGTH            64
+
+// Type definition for a test position.
+typedef struct
+{
+    board_t     board;
+    char        id[ EPD_ID_MAX_LENGTH ];
+
+    // Best moves and avoid moves.
+    move_t      best[ EPD_MAX_MOVES ];
+    u32         best_count;
+    move_t      avoid[ EPD_MAX_MOVES ];
+    u32         avoid_count;
+
+    // Result.
+    move_t      move;
+    bool        solved;
+    u64         nodes;
+    f64         elapsed;
+    u64         solution_nodes;
+    f64         solution_elapsed;
+}
+epd_position_t;
+
+// Type definition for the search limits.
+typedef struct
+{
+    u32         depth;
+    u64         nodes;
+    f64         time;
+}
+epd_limits_t;
+
+// Type definition for the state of a search worker thread.
+typedef struct
+{
+    // Input.
+    u32                 index;
+    u32                 thread_count;
+    const attacks_t*    attacks;
+    const epd_limits_t* limits;
+    epd_position_t*     positions;
+    u32                 position_count;
+
+    // Search.
+    move_search_t*      search;
+    epd_position_t*     position;
+    bool                correct;
+}
+epd_worker_t;
+
+/**
+ * @brief Worker thread entry point. Searches every thread_count-th position
+ * of the batch.
+ * @param args An epd_worker_t.
+ * @return 0.
+ */
+u32
+epd_worker
+(   void* args
+);
+
+/**
+ * @brief Search observer callback (see PFN_move_search_observer). Tracks the
+ * time to solution of the position being searched.
+ * @param result The search result so far.
+ * @param args An epd_worker_t.
+ */
+void
+epd_iteration
+(   const move_search_result_t* result
+,   void*                       args
+);
+
+/**
+ * @brief Parses a line of an EPD file: the first four FEN fields, followed by
+ * operations (opcode, operands, semicolon). Reads the bm, am and id
+ * operations; the others are ignored. Requires pregenerated attack tables.
+ * @param line The line to parse.
+ * @param attacks The pregenerated attack tables.
+ * @param position Output buffer.
+ * @return false if line invalid or without best or avoid moves, true
+ * otherwise.
+ */
+bool
+epd_parse
+(   const char*         line
+,   const attacks_t*    attacks
+,   epd_position_t*     position
+);
+
+/**
+ * @brief Writes a line of the report.
+ * @param line The line to write.
+ * @param report Handle to the report file, or 0 if none.
+ */
+void
+epd_report
+(   const char*     line
+,   file_handle_t*  report
+);
+
+/**
+ * @brief Tests if a move solves a position.
+ * @param position The test position.
+ * @param move The move.
+ * @return true if move is a best move and not an avoid move, false otherwise.
+ */
+INLINE
+bool
+epd_correct
+(   const epd_position_t*   position
+,   const move_t            move
+)
+{
+    bool best = !( *position ).best_count;
+    for ( u32 i = 0; i < ( *position ).best_count; ++i )
+    {
+        best |= move_compact ( ( *position ).best[ i ] ) == move_compact ( move );
+    }
+    for ( u32 i = 0; i < ( *position ).avoid_count; ++i )
+    {
+        best &= move_compact ( ( *position ).avoid[ i ] ) != move_compact ( move );
+    }
+    return best;
+}
+
+int
+main
+(   int     argc
+,   char**  argv
+)
+{
+    const char* input = 0;
+    const char* filepath = 0;
+    const char* network = 0;
+    u64 thread_count = platform_processor_count ();
+    u64 movetime = 0;
+    u64 nodes = 0;
+    u64 depth = 0;
+
+    // Parse command line.
+    for ( i32 i = 1; i < argc; ++i )
+    {
+        u64* value = 0;
+        if ( string_equal ( argv[ i ] , "-o" ) && i + 1 < argc )
+        {
+            filepath = argv[ ++i ];
+            continue;
+        }
+        else if ( string_equal ( argv[ i ] , "-e" ) && i + 1 < argc )
+        {
+            network = argv[ ++i ];
+            continue;
+        }
+        else if ( string_equal ( argv[ i ] , "-t" ) ) value = &thread_count;
+        else if ( string_equal ( argv[ i ] , "-m" ) ) value = &movetime;
+        else if ( string_equal ( argv[ i ] , "-n" ) ) value = &nodes;
+        else if ( string_equal ( argv[ i ] , "-d" ) ) value = &depth;
+        else if ( !input )
+        {
+            input = argv[ i ];
+            continue;
+        }
+
+        if ( !value || i + 1 >= argc || !string_to_u64 ( argv[ ++i ] , value ) || !*value )
+        {
+            input = 0;
+            break;
+        }
+    }
+    if ( !input )
+    {
+        LOGERROR ( "Usage: %s <suite> [-o <report>] [-t <threads>] [-m <movetime ms>] [-n <nodes>] [-d <depth>] [-e <network>]"
+                 , argv[ 0 ]
+                 );
+        return 1;
+    }
+    if ( !movetime && !nodes && !depth )
+    {
+        movetime = EPD_DEFAULT_MOVETIME;
+    }
+    thread_count = min ( thread_count , EPD_MAX_THREADS );
+
+    epd_limits_t limits;
+    limits.depth = ( depth ) ? min ( depth , ( u64 ) MOVE_SEARCH_MAX_PLY ) : MOVE_SEARCH_MAX_PLY;
+    limits.nodes = nodes;
+    limits.time = movetime / 1000.0;
+
+    file_handle_t file;
+    if ( !file_open ( input , FILE_MODE_READ , false , &file ) )
+    {
+        LOGERROR ( "Failed to open test suite '%s'." , input );
+        return 1;
+    }
+    file_handle_t report_file;
+    file_handle_t* report = 0;
+    if ( filepath )
+    {
+        if ( !file_open ( filepath , FILE_MODE_WRITE , false , &report_file ) )
+        {
+            LOGERROR ( "Failed to open report file '%s'." , filepath );
+            return 1;
+        }
+        report = &report_file;
+    }
+
+    // Size the memory subsystem for the attack tables, the network, one
+    // search per thread and a batch of positions.
+    if ( !memory_startup ( sizeof ( attacks_t )
+                         + sizeof ( nnue_t )
+                         + thread_count * sizeof ( move_search_t )
+                         + EPD_BATCH_SIZE * sizeof ( epd_position_t )
+                         + MEBIBYTES ( 16 )
+                         ))
+    {
+        return 1;
+    }
+    attacks_t* attacks = memory_allocate ( sizeof ( attacks_t ) , MEMORY_TAG_APPLICATION );
+    attacks_init ( attacks );
+    nnue_t* nnue = 0;
+    if ( network )
+    {
+        nnue = memory_allocate ( sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+        if ( !nnue_load ( network , nnue ) )
+        {
+            LOGERROR ( "Failed to load evaluation network '%s'." , network );
+            return 1;
+        }
+    }
+    epd_position_t* positions = memory_allocate ( EPD_BATCH_SIZE * sizeof ( epd_position_t ) , MEMORY_TAG_APPLICATION );
+    epd_worker_t workers[ EPD_MAX_THREADS ];
+    for ( u32 i = 0; i < thread_count; ++i )
+    {
+        workers[ i ].index = i;
+        workers[ i ].thread_count = thread_count;
+        workers[ i ].attacks = attacks;
+        workers[ i ].limits = &limits;
+        workers[ i ].positions = positions;
+        workers[ i ].search = memory_allocate ( sizeof ( move_search_t ) , MEMORY_TAG_APPLICATION );
+        ( *workers[ i ].search ).nnue = nnue;
+        ( *workers[ i ].search ).observer = epd_iteration;
+        ( *workers[ i ].search ).observer_args = &workers[ i ];
+    }
+
+    epd_report ( "id\tresult\tmove\tseconds\tnodes\tsolution seconds\tsolution nodes" , report );
+
+    clock_t clock;
+    clock_start ( &clock );
+    u32 count = 0;
+    u32 solved = 0;
+    u32 errors = 0;
+    u64 total_nodes = 0;
+    f64 total_solution_elapsed = 0;
+    u32 line_count = 0;
+    bool eof = false;
+    while ( !eof )
+    {
+        // Read the next batch of positions.
+        u32 batch = 0;
+        char* line;
+        while ( batch < EPD_BATCH_SIZE )
+        {
+            if ( !file_read_line ( &file , &line ) )
+            {
+                eof = true;
+                break;
+            }
+            line_count += 1;
+            const char* s = line;
+            while ( *s && whitespace ( *s ) )
+            {
+                s += 1;
+            }
+            if ( *s && *s != '#' )
+            {
+                if ( epd_parse ( s , attacks , &positions[ batch ] ) )
+                {
+                    if ( !positions[ batch ].id[ 0 ] )
+                    {
+                        string_format ( positions[ batch ].id , "line %u" , line_count );
+                    }
+                    batch += 1;
+                }
+                else
+                {
+                    LOGWARN ( "Skipped line %u: invalid position, or no bm or am operation." , line_count );
+                    errors += 1;
+                }
+            }
+            string_free ( line );
+        }
+        if ( !batch )
+        {
+            continue;
+        }
+
+        // Search the batch.
+        platform_thread_t threads[ EPD_MAX_THREADS ];
+        for ( u32 i = 0; i < thread_count; ++i )
+        {
+            workers[ i ].position_count = batch;
+        }
+        for ( u32 i = 1; i < thread_count; ++i )
+        {
+            if ( !platform_thread_create ( epd_worker , &workers[ i ] , &threads[ i ] ) )
+            {
+                // Fall back to running the slice on the calling thread.
+                epd_worker ( &workers[ i ] );
+                threads[ i ].handle = 0;
+            }
+        }
+        epd_worker ( &workers[ 0 ] );
+        for ( u32 i = 1; i < thread_count; ++i )
+        {
+            if ( threads[ i ].handle )
+            {
+                platform_thread_join ( &threads[ i ] );
+            }
+        }
+
+        // Report the batch.
+        for ( u32 i = 0; i < batch; ++i )
+        {
+            const epd_position_t* position = &positions[ i ];
+            char move[ MOVE_STRING_LENGTH + 1 ];
+            char buf[ STACK_STRING_MAX_LENGTH ];
+            string_move ( move , ( *position ).move );
+            string_trim ( move );
+            string_format ( buf , "%s\t%s\t%s\t%f\t%llu\t%f\t%llu"
+                          , ( *position ).id
+                          , ( ( *position ).solved ) ? "pass" : "fail"
+                          , move
+                          , ( *position ).elapsed
+                          , ( *position ).nodes
+                          , ( *position ).solution_elapsed
+                          , ( *position ).solution_nodes
+                          );
+            epd_report ( buf , report );
+            count += 1;
+            total_nodes += ( *position ).nodes;
+            if ( ( *position ).solved )
+            {
+                solved += 1;
+                total_solution_elapsed += ( *position ).solution_elapsed;
+            }
+        }
+    }
+    clock_update ( &clock );
+
+    LOGINFO ( "Solved %u of %u positions (%.1f%%); mean time to solution %f seconds."
+            , solved , count , ( count ) ? 100.0 * solved / count : 0.0
+            , ( solved ) ? total_solution_elapsed / solved : 0.0
+            );
+    LOGINFO ( "Searched %llu nodes in %f seconds on %u threads (%llu nodes/second)."
+            , total_nodes , clock.elapsed , ( u32 ) thread_count
+            , ( clock.elapsed > 0 ) ? ( u64 )( total_nodes / clock.elapsed ) : 0
+            );
+    if ( errors )
+    {
+        LOGWARN ( "%u line(s) skipped." , errors );
+    }
+
+    for ( u32 i = 0; i < thread_count; ++i )
+    {
+        memory_free ( workers[ i ].search , sizeof ( move_search_t ) , MEMORY_TAG_APPLICATION );
+    }
+    memory_free ( positions , EPD_BATCH_SIZE * sizeof ( epd_position_t ) , MEMORY_TAG_APPLICATION );
+    if ( nnue )
+    {
+        memory_free ( nnue , sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+    }
+    memory_free ( attacks , sizeof ( attacks_t ) , MEMORY_TAG_APPLICATION );
+    memory_shutdown ();
+    file_close ( &file );
+    if ( report )
+    {
+        file_close ( report );
+    }
+    return 0;
+}
+
+u32
+epd_worker
+(   void* args
+)
+{
+    epd_worker_t* worker = args;
+    move_search_t* search = ( *worker ).search;
+
+    for ( u32 i = ( *worker ).index; i < ( *worker ).position_count; i += ( *worker ).thread_count )
+    {
+        epd_position_t* position = &( *worker ).positions[ i ];
+        ( *worker ).position = position;
+        ( *worker ).correct = false;
+        ( *position ).solution_nodes = 0;
+        ( *position ).solution_elapsed = 0;
+
+        ( *search ).stop = false;
+        ( *search ).time_limit = ( *( *worker ).limits ).time;
+        ( *search ).node_limit = ( *( *worker ).limits ).nodes;
+        ( *position ).move = board_best_move ( &( *position ).board
+                                             , ( *worker ).attacks
+                                             , ( *( *worker ).limits ).depth
+                                             , search
+                                             );
+        ( *position ).nodes = ( *search ).result.nodes;
+        ( *position ).elapsed = ( *search ).result.elapsed;
+        ( *position ).solved = epd_correct ( position , ( *position ).move );
+        if ( !( *position ).solved )
+        {
+            ( *position ).solution_nodes = 0;
+            ( *position ).solution_elapsed = 0;
+        }
+    }
+    return 0;
+}
+
+void
+epd_iteration
+(   const move_search_result_t* result
+,   void*                       args
+)
+{
+    epd_worker_t* worker = args;
+    epd_position_t* position = ( *worker ).position;
+
+    const bool correct = epd_correct ( position , ( *result ).best );
+    if ( correct && !( *worker ).correct )
+    {
+        ( *position ).solution_nodes = ( *result ).nodes;
+        ( *position ).solution_elapsed = ( *result ).elapsed;
+    }
+    ( *worker ).correct = correct;
+}
+
+bool
+epd_parse
+(   const char*         line
+,   const attacks_t*    attacks
+,   epd_position_t*     position
+)
+{
+    memory_clear ( position , sizeof ( epd_position_t ) );
+
+    // Parse the four FEN fields.
+    char fen[ FEN_STRING_MAX_LENGTH ];
+    const char* s = line;
+    for ( u32 field = 0; field < 4; ++field )
+    {
+        while ( *s && whitespace ( *s ) )
+        {
+            s += 1;
+        }
+        while ( *s && !whitespace ( *s ) )
+        {
+            s += 1;
+        }
+    }
+    if ( ( u64 )( s - line ) >= FEN_STRING_MAX_LENGTH )
+    {
+        return false;
+    }
+    memory_copy ( fen , line , s - line );
+    fen[ s - line ] = 0;    // Append terminator.
+    if ( !fen_parse ( fen , &( *position ).board ) )
+    {
+        return false;
+    }
+    moves_t moves;
+    moves_compute ( &moves , &( *position ).board , attacks );
+
+    // Parse the operations.
+    char opcode[ EPD_TOKEN_MAX_LENGTH ];
+    char operand[ EPD_TOKEN_MAX_LENGTH ];
+    while ( *s )
+    {
+        // Opcode.
+        while ( *s && ( whitespace ( *s ) || *s == ';' ) )
+        {
+            s += 1;
+        }
+        u32 len = 0;
+        while ( *s && !whitespace ( *s ) && *s != ';' )
+        {
+            if ( len < EPD_TOKEN_MAX_LENGTH - 1 )
+            {
+                opcode[ len++ ] = *s;
+            }
+            s += 1;
+        }
+        opcode[ len ] = 0;  // Append terminator.
+
+        // Operands (up to the semicolon; a quoted operand may contain one).
+        while ( *s && *s != ';' )
+        {
+            while ( *s && whitespace ( *s ) )
+            {
+                s += 1;
+            }
+            len = 0;
+            const bool quoted = ( *s == '"' );
+            if ( quoted )
+            {
+                s += 1;
+            }
+            while ( *s && ( ( quoted ) ? *s != '"' : ( !whitespace ( *s ) && *s != ';' ) ) )
+            {
+                if ( len < EPD_TOKEN_MAX_LENGTH - 1 )
+                {
+                    operand[ len++ ] = *s;
+                }
+                s += 1;
+            }
+            if ( quoted && *s )
+            {
+                s += 1;
+            }
+            operand[ len ] = 0; // Append terminator.
+            if ( !len && !quoted )
+            {
+                continue;
+            }
+
+            if ( string_equal ( opcode , "id" ) )
+            {
+                string_format ( ( *position ).id , "%s" , operand );
+            }
+            else if ( string_equal ( opcode , "bm" ) || string_equal ( opcode , "am" ) )
+            {
+                const bool best = string_equal ( opcode , "bm" );
+                move_t* list = ( best ) ? ( *position ).best : ( *position ).avoid;
+                u32* count = ( best ) ? &( *position ).best_count : &( *position ).avoid_count;
+                move_t move;
+                if (    *count >= EPD_MAX_MOVES
+                     || (    !move_parse_san ( operand , &( *position ).board , &moves , attacks , &move )
+                          && !move_parse ( operand , &moves , attacks , &move )
+                        )
+                   )
+                {
+                    return false;
+                }
+                list[ ( *count )++ ] = move;
+            }
+        }
+    }
+    return ( *position ).best_count || ( *position ).avoid_count;
+}
+
+void
+epd_report
+(   const char*     line
+,   file_handle_t*  report
+)
+{
+    char buf[ STACK_STRING_MAX_LENGTH ];
+    string_format ( buf , "%s\n" , line );
+    platform_console_write ( buf );
+    if ( report )
+    {
+        file_write_line ( report , line );
+    }
+}
\ No newline at end of file
@@ -0,0 +1,634 @@
+/**
+ * @file main.c
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Entry point for the magic number finder program.
+ *
+ * Searches for "black" magic numbers for the slider pieces, packs the slider
+ * attacks of every square into a single shared table, and writes a new
+ * chess/magic.h.
+ *
+ * Usage: magic [-o <output>] [-t <threads>] [-n <tries per square>]
+ *              [-s <seed>]
+ *
+ * A black magic indexes the table by ( ( occupancy | ~mask ) * magic ) >>
+ * shift, where mask is the relevant occupancy mask of the square. Since the
+ * bits outside the mask are all set, the indices of a good magic fall into a
+ * window much narrower than the 2^shift range of a plain magic. For each
+ * square, the search keeps the magic with the narrowest window, trying both
+ * the plain index width and one bit fewer. The squares are split across all
+ * cores.
+ *
+ * The windows are then placed into the shared table one at a time, largest
+ * first, each at the lowest offset where every entry it needs is either free
+ * or already holds the same attack. This lets windows overlap, and lets the
+ * smaller windows fill the gaps left in the larger ones.
+ */
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/memory.h"
+#include "core/string.h"
+
+#include "math/math.h"
+
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include "chess/chess.h"
+
+// Defines default search parameters.
+#define MAGIC_DEFAULT_OUTPUT_FILEPATH   "magic.h"
+#define MAGIC_DEFAULT_TRIES             1000000
+#define MAGIC_DEFAULT_SEED              0x9E3779B97F4A7C15ULL
+
+// Defines buffer sizes.
+#define MAGIC_MAX_THREADS               64ULL
+#define MAGIC_MAX_SUBSETS               4096
+#define MAGIC_JOB_COUNT                 128
+#define MAGIC_MAX_TABLE_LENGTH          ( 64 * 512 + 64 * 4096 )
+
+// Type definition for the search for a single slider piece on a single square.
+typedef struct
+{
+    // Input.
+    bool        rook;
+    SQUARE      square;
+
+    // Output.
+    bitboard_t  magic;
+    u8          shift;
+    u64         index_min;
+    u64         window;
+    i32         offset;
+
+    // Every relevant occupancy, as an index into the window and the attack
+    // found there.
+    u32         subset_count;
+    u32         indices[ MAGIC_MAX_SUBSETS ];
+    bitboard_t  attacks[ MAGIC_MAX_SUBSETS ];
+}
+magic_job_t;
+
+// Type definition for the state of a search worker thread.
+typedef struct
+{
+    // Input.
+    u32             index;
+    u32             thread_count;
+    u64             tries;
+    u64             seed;
+    magic_job_t*    jobs;
+
+    // Scratch space.
+    bitboard_t      subsets[ MAGIC_MAX_SUBSETS ];
+    u64             stamps[ MAGIC_MAX_SUBSETS ];
+    bitboard_t      values[ MAGIC_MAX_SUBSETS ];
+}
+magic_worker_t;
+
+// Type definition for the finder state.
+typedef struct
+{
+    magic_job_t     jobs[ MAGIC_JOB_COUNT ];
+    bitboard_t      table[ MAGIC_MAX_TABLE_LENGTH ];
+    u64             table_length;
+
+    // Workers.
+    u32             thread_count;
+    magic_worker_t  workers[ MAGIC_MAX_THREADS ];
+}
+finder_t;
+
+/**
+ * @brief Generates a 64-bit pseudorandom number (xorshift64*).
+ * @param state The generator state (nonzero). Updated in place.
+ * @return A pseudorandom number.
+ */
+INLINE
+u64
+magic_random
+(   u64* state
+)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * @brief Entry point for a search worker thread. Searches every
+ * thread_count-th job.
+ * @param args The worker state.
+ * @return 0.
+ */
+u32
+magic_worker
+(   void* args
+);
+
+/**
+ * @brief Searches for the magic with the narrowest index window for a single
+ * job.
+ * @param job The job.
+ * @param worker The worker state.
+ * @param seed The generator seed.
+ * @return true if a magic was found, false otherwise.
+ */
+bool
+magic_search
+(   magic_job_t*    job
+,   magic_worker_t* worker
+,   u64             seed
+);
+
+/**
+ * @brief Places the windows of every job into the shared table.
+ * @param finder The finder state.
+ */
+void
+magic_pack
+(   finder_t* finder
+);
+
+/**
+ * @brief Writes the magic numbers, shifts and offsets as a C header.
+ * @param filepath The output filepath.
+ * @param finder The finder state.
+ * @return true on success, false otherwise.
+ */
+bool
+magic_write
+(   const char*     filepath
+,   const finder_t* finder
+);
+
+/**
+ * @brief Writes an array of 64 integers as a C declaration, eight per line.
+ * @param file Handle to the output file.
+ * @param declaration The declaration, up to and excluding the initializer.
+ * @param values The values.
+ * @param width The minimum width of each value.
+ */
+void
+magic_write_grid
+(   file_handle_t*  file
+,   const char*     declaration
+,   const i64*      values
+,   const u32       width
+);
+
+/**
+ * @brief Writes an array of 64 magic numbers as a C declaration, one per
+ * line.
+ * @param file Handle to the output file.
+ * @param declaration The declaration, up to and excluding the initializer.
+ * @param finder The finder state.
+ * @param rook Write the rook magics? Y/N
+ */
+void
+magic_write_magics
+(   file_handle_t*  file
+,   const char*     declaration
+,   const finder_t* finder
+,   const bool      rook
+);
+
+int
+main
+(   int     argc
+,   char**  argv
+)
+{
+    const char* filepath = MAGIC_DEFAULT_OUTPUT_FILEPATH;
+    u64 thread_count = platform_processor_count ();
+    u64 tries = MAGIC_DEFAULT_TRIES;
+    u64 seed = MAGIC_DEFAULT_SEED;
+
+    // Parse command line.
+    for ( i32 i = 1; i < argc; ++i )
+    {
+        if ( string_equal ( argv[ i ] , "-o" ) && i + 1 < argc )
+        {
+            filepath = argv[ ++i ];
+        }
+        else if ( string_equal ( argv[ i ] , "-t" ) && i + 1 < argc )
+        {
+            if ( !string_to_u64 ( argv[ ++i ] , &thread_count ) || !thread_count )
+            {
+                LOGERROR ( "Invalid thread count '%s'." , argv[ i ] );
+                return 1;
+            }
+        }
+        else if ( string_equal ( argv[ i ] , "-n" ) && i + 1 < argc )
+        {
+            if ( !string_to_u64 ( argv[ ++i ] , &tries ) || !tries )
+            {
+                LOGERROR ( "Invalid try count '%s'." , argv[ i ] );
+                return 1;
+            }
+        }
+        else if ( string_equal ( argv[ i ] , "-s" ) && i + 1 < argc )
+        {
+            if ( !string_to_u64 ( argv[ ++i ] , &seed ) || !seed )
+            {
+                LOGERROR ( "Invalid seed '%s'." , argv[ i ] );
+                return 1;
+            }
+        }
+        else
+        {
+            LOGERROR ( "Usage: %s [-o <output>] [-t <threads>] [-n <tries per square>] [-s <seed>]"
+                     , argv[ 0 ]
+                     );
+            return 1;
+        }
+    }
+
+    if ( !memory_startup ( sizeof ( finder_t ) + MEBIBYTES ( 4 ) ) )
+    {
+        return 1;
+    }
+
+    finder_t* finder = memory_allocate ( sizeof ( finder_t ) , MEMORY_TAG_APPLICATION );
+    ( *finder ).thread_count = min ( thread_count , MAGIC_MAX_THREADS );
+    for ( u32 i = 0; i < MAGIC_JOB_COUNT; ++i )
+    {
+        ( *finder ).jobs[ i ].rook = i >= 64;
+        ( *finder ).jobs[ i ].square = i % 64;
+    }
+
+    clock_t clock;
+    clock_start ( &clock );
+    LOGINFO ( "Searching for magics (%llu tries per square, %u threads)..."
+            , tries , ( *finder ).thread_count
+            );
+
+    // Search.
+    platform_thread_t threads[ MAGIC_MAX_THREADS ];
+    for ( u32 i = 0; i < ( *finder ).thread_count; ++i )
+    {
+        magic_worker_t* worker = &( *finder ).workers[ i ];
+        ( *worker ).index = i;
+        ( *worker ).thread_count = ( *finder ).thread_count;
+        ( *worker ).tries = tries;
+        ( *worker ).seed = seed;
+        ( *worker ).jobs = ( *finder ).jobs;
+    }
+    for ( u32 i = 1; i < ( *finder ).thread_count; ++i )
+    {
+        if ( !platform_thread_create ( magic_worker , &( *finder ).workers[ i ] , &threads[ i ] ) )
+        {
+            // Fall back to running the slice on the calling thread.
+            magic_worker ( &( *finder ).workers[ i ] );
+            threads[ i ].handle = 0;
+        }
+    }
+    magic_worker ( &( *finder ).workers[ 0 ] );
+    for ( u32 i = 1; i < ( *finder ).thread_count; ++i )
+    {
+        if ( threads[ i ].handle )
+        {
+            platform_thread_join ( &threads[ i ] );
+        }
+    }
+    for ( u32 i = 0; i < MAGIC_JOB_COUNT; ++i )
+    {
+        if ( !( *finder ).jobs[ i ].magic )
+        {
+            LOGERROR ( "No %s magic found for square %u. Try more tries per square."
+                     , ( ( *finder ).jobs[ i ].rook ) ? "rook" : "bishop"
+                     , ( *finder ).jobs[ i ].square
+                     );
+            return 1;
+        }
+    }
+
+    u64 windows[ 2 ] = { 0 , 0 };
+    for ( u32 i = 0; i < MAGIC_JOB_COUNT; ++i )
+    {
+        windows[ ( *finder ).jobs[ i ].rook ] += ( *finder ).jobs[ i ].window;
+    }
+    LOGINFO ( "Found magics with windows totalling %llu entries for bishops and %llu for rooks."
+            , windows[ 0 ] , windows[ 1 ]
+            );
+
+    // Pack.
+    magic_pack ( finder );
+    clock_update ( &clock );
+    LOGINFO ( "Packed slider attacks into %llu entries (%llu KiB), from %u with plain magics. Took %f seconds."
+            , ( *finder ).table_length
+            , ( *finder ).table_length * sizeof ( bitboard_t ) / 1024
+            , MAGIC_MAX_TABLE_LENGTH
+            , clock.elapsed
+            );
+
+    if ( !magic_write ( filepath , finder ) )
+    {
+        return 1;
+    }
+    LOGINFO ( "Wrote '%s'." , filepath );
+
+    memory_free ( finder , sizeof ( finder_t ) , MEMORY_TAG_APPLICATION );
+    memory_shutdown ();
+    return 0;
+}
+
+u32
+magic_worker
+(   void* args
+)
+{
+    magic_worker_t* worker = args;
+    for ( u32 i = ( *worker ).index; i < MAGIC_JOB_COUNT; i += ( *worker ).thread_count )
+    {
+        // Seed each job separately, so the result does not depend on the
+        // thread count.
+        magic_search ( &( *worker ).jobs[ i ]
+                     , worker
+                     , ( *worker ).seed ^ ( ( i + 1 ) * 0xD1B54A32D192ED03ULL )
+                     );
+    }
+    return 0;
+}
+
+bool
+magic_search
+(   magic_job_t*    job
+,   magic_worker_t* worker
+,   u64             seed
+)
+{
+    const SQUARE square = ( *job ).square;
+    const bitboard_t mask = ( ( *job ).rook ) ? attack_mask_rook ( square )
+                                              : attack_mask_bishop ( square )
+                                              ;
+    const u8 count = bitboard_count ( mask );
+
+    // Enumerate every subset of the mask and its attack.
+    u32 subset_count = 0;
+    bitboard_t subset = 0;
+    do
+    {
+        ( *worker ).subsets[ subset_count ] = subset;
+        ( *job ).attacks[ subset_count ] = ( ( *job ).rook ) ? attack_mask_rook_with_block ( square , subset )
+                                                             : attack_mask_bishop_with_block ( square , subset )
+                                                             ;
+        subset_count += 1;
+        subset = ( subset - mask ) & mask;
+    }
+    while ( subset );
+    ( *job ).subset_count = subset_count;
+
+    memory_clear ( ( *worker ).stamps , sizeof ( ( *worker ).stamps ) );
+    u64 state = ( seed ) ? seed : MAGIC_DEFAULT_SEED;
+    u64 window_best = ( ( u64 ) -1 );
+    for ( u64 try = 0; try < ( *worker ).tries; ++try )
+    {
+        // Alternate between the plain index width and one bit fewer. Sparse
+        // numbers make better magics.
+        const u8 bits = count - ( try & 1 );
+        const u8 shift = 64 - bits;
+        const bitboard_t magic = magic_random ( &state )
+                               & magic_random ( &state )
+                               & magic_random ( &state )
+                               ;
+        const u64 stamp = try + 1;
+
+        // Test for destructive collisions, giving up as soon as the window is
+        // no narrower than the best so far.
+        u64 index_min = ( ( u64 ) -1 );
+        u64 index_max = 0;
+        bool valid = true;
+        for ( u32 i = 0; i < subset_count; ++i )
+        {
+            const u64 index = ( ( ( *worker ).subsets[ i ] | ~mask ) * magic ) >> shift;
+            if ( ( *worker ).stamps[ index ] == stamp )
+            {
+                if ( ( *worker ).values[ index ] != ( *job ).attacks[ i ] )
+                {
+                    valid = false;
+                    break;
+                }
+            }
+            else
+            {
+                ( *worker ).stamps[ index ] = stamp;
+                ( *worker ).values[ index ] = ( *job ).attacks[ i ];
+            }
+            index_min = min ( index_min , index );
+            index_max = max ( index_max , index );
+            if ( index_max - index_min + 1 >= window_best )
+            {
+                valid = false;
+                break;
+            }
+        }
+        if ( !valid )
+        {
+            continue;
+        }
+
+        window_best = index_max - index_min + 1;
+        ( *job ).magic = magic;
+        ( *job ).shift = shift;
+        ( *job ).index_min = index_min;
+        ( *job ).window = window_best;
+    }
+    if ( !( *job ).magic )
+    {
+        return false;
+    }
+
+    // Record the window index of every subset.
+    for ( u32 i = 0; i < subset_count; ++i )
+    {
+        ( *job ).indices[ i ] = ( ( ( ( *worker ).subsets[ i ] | ~mask ) * ( *job ).magic ) >> ( *job ).shift )
+                              - ( *job ).index_min
+                              ;
+    }
+    return true;
+}
+
+void
+magic_pack
+(   finder_t* finder
+)
+{
+    // Order the jobs by window, largest first.
+    u32 order[ MAGIC_JOB_COUNT ];
+    for ( u32 i = 0; i < MAGIC_JOB_COUNT; ++i )
+    {
+        order[ i ] = i;
+    }
+    for ( u32 i = 1; i < MAGIC_JOB_COUNT; ++i )
+    {
+        const u32 job = order[ i ];
+        u32 j = i;
+        while ( j && ( *finder ).jobs[ order[ j - 1 ] ].window < ( *finder ).jobs[ job ].window )
+        {
+            order[ j ] = order[ j - 1 ];
+            j -= 1;
+        }
+        order[ j ] = job;
+    }
+
+    // Place each window at the lowest offset where it does not conflict with
+    // the windows already placed. An empty entry is 0, which is never a slider
+    // attack.
+    ( *finder ).table_length = 0;
+    for ( u32 i = 0; i < MAGIC_JOB_COUNT; ++i )
+    {
+        magic_job_t* job = &( *finder ).jobs[ order[ i ] ];
+        u64 offset = 0;
+        for ( ;; ++offset )
+        {
+            bool fits = true;
+            for ( u32 j = 0; j < ( *job ).subset_count; ++j )
+            {
+                const bitboard_t entry = ( *finder ).table[ offset + ( *job ).indices[ j ] ];
+                if ( entry && entry != ( *job ).attacks[ j ] )
+                {
+                    fits = false;
+                    break;
+                }
+            }
+            if ( fits )
+            {
+                break;
+            }
+        }
+        for ( u32 j = 0; j < ( *job ).subset_count; ++j )
+        {
+            ( *finder ).table[ offset + ( *job ).indices[ j ] ] = ( *job ).attacks[ j ];
+        }
+        ( *job ).offset = ( i64 ) offset - ( i64 )( *job ).index_min;
+        ( *finder ).table_length = max ( ( *finder ).table_length , offset + ( *job ).window );
+    }
+}
+
+bool
+magic_write
+(   const char*     filepath
+,   const finder_t* finder
+)
+{
+    file_handle_t file;
+    if ( !file_open ( filepath , FILE_MODE_WRITE , false , &file ) )
+    {
+        LOGERROR ( "magic_write: Failed to open file '%s' for writing." , filepath );
+        return false;
+    }
+
+    char line[ STACK_STRING_MAX_LENGTH ];
+    file_write_line ( &file , "/**" );
+    file_write_line ( &file , " * @file magic.h" );
+    file_write_line ( &file , " * @author Matthew Weissel (null@mattweissel.info)" );
+    file_write_line ( &file , " * @brief Defines literals to assist with computing magic bitboards for" );
+    file_write_line ( &file , " * slider piece attacks." );
+    file_write_line ( &file , " *" );
+    file_write_line ( &file , " * Generated by the magic number finder (see tools/src/magic/main.c). The" );
+    file_write_line ( &file , " * attacks of both slider pieces on every square share a single table. The" );
+    file_write_line ( &file , " * attack for an occupancy is found at offset + ( ( ( occupancy | ~mask ) *" );
+    file_write_line ( &file , " * magic ) >> shift ), where mask is the relevant occupancy mask of the" );
+    file_write_line ( &file , " * square (\"black\" magics)." );
+    file_write_line ( &file , " */" );
+    file_write_line ( &file , "#ifndef CHESS_MAGIC_H" );
+    file_write_line ( &file , "#define CHESS_MAGIC_H" );
+    file_write_line ( &file , "" );
+    file_write_line ( &file , "#include \"chess/common/bitboard.h\"" );
+    file_write_line ( &file , "" );
+    file_write_line ( &file , "// Defines the length of the shared slider attack table." );
+    string_format ( line , "#define MAGIC_TABLE_LENGTH %llu" , ( *finder ).table_length );
+    file_write_line ( &file , line );
+    file_write_line ( &file , "" );
+
+    i64 bishops[ 64 ];
+    i64 rooks[ 64 ];
+    file_write_line ( &file , "// Defines the index shift for each board square for slider pieces." );
+    for ( u32 i = 0; i < 64; ++i )
+    {
+        bishops[ i ] = ( *finder ).jobs[ i ].shift;
+        rooks[ i ] = ( *finder ).jobs[ 64 + i ].shift;
+    }
+    magic_write_grid ( &file , "static const u8 bishop_attack_shifts[ 64 ] = " , bishops , 2 );
+    magic_write_grid ( &file , "static const u8 rook_attack_shifts[ 64 ] = " , rooks , 2 );
+    file_write_line ( &file , "" );
+
+    file_write_line ( &file , "// Defines the table offset for each board square for slider pieces." );
+    for ( u32 i = 0; i < 64; ++i )
+    {
+        bishops[ i ] = ( *finder ).jobs[ i ].offset;
+        rooks[ i ] = ( *finder ).jobs[ 64 + i ].offset;
+    }
+    magic_write_grid ( &file , "static const i32 bishop_attack_offsets[ 64 ] = " , bishops , 7 );
+    magic_write_grid ( &file , "static const i32 rook_attack_offsets[ 64 ] = " , rooks , 7 );
+    file_write_line ( &file , "" );
+
+    file_write_line ( &file , "// Defines magic bitboards for slider pieces." );
+    magic_write_magics ( &file , "static const bitboard_t bitboard_magic_bishops[ 64 ] = " , finder , false );
+    magic_write_magics ( &file , "static const bitboard_t bitboard_magic_rooks[ 64 ] = " , finder , true );
+    file_write_line ( &file , "" );
+
+    u64 written;
+    const char* end = "#endif  // CHESS_MAGIC_H";
+    const bool success = file_write ( &file , string_length ( end ) , end , &written );
+    file_close ( &file );
+    if ( !success )
+    {
+        LOGERROR ( "magic_write: Failed to write file '%s'." , filepath );
+    }
+    return success;
+}
+
+void
+magic_write_grid
+(   file_handle_t*  file
+,   const char*     declaration
+,   const i64*      values
+,   const u32       width
+)
+{
+    char line[ STACK_STRING_MAX_LENGTH ];
+    const u32 indent = string_length ( declaration );
+    for ( u32 i = 0; i < 8; ++i )
+    {
+        char* s = line;
+        s += ( !i ) ? string_format ( s , "%s{" , declaration )
+                    : string_format ( s , "%*s," , indent , "" )
+                    ;
+        for ( u32 j = 0; j < 8; ++j )
+        {
+            s += string_format ( s , ( j ) ? " , %*lli" : " %*lli" , width , values[ 8 * i + j ] );
+        }
+        file_write_line ( file , line );
+    }
+    string_format ( line , "%*s};" , indent , "" );
+    file_write_line ( file , line );
+}
+
+void
+magic_write_magics
+(   file_handle_t*  file
+,   const char*     declaration
+,   const finder_t* finder
+,   const bool      rook
+)
+{
+    char line[ STACK_STRING_MAX_LENGTH ];
+    const u32 indent = string_length ( declaration );
+    for ( u32 i = 0; i < 64; ++i )
+    {
+        const bitboard_t magic = ( *finder ).jobs[ ( ( rook ) ? 64 : 0 ) + i ].magic;
+        if ( !i )
+        {
+            string_format ( line , "%s{ 0x%llXULL" , declaration , magic );
+        }
+        else
+        {
+            string_format ( line , "%*s, 0x%llXULL" , indent , "" , magic );
+        }
+        file_write_line ( file , line );
+    }
+    string_format ( line , "%*s};" , indent , "" );
+    file_write_line ( file , line );
+}
\ No newline at end of file
@@ -0,0 +1,416 @@
+/**
+ * @file main.c
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Entry point for the engine match runner.
+ *
+ * Plays a match between two engine configurations, A and B, in parallel
+ * across worker threads, and estimates the Elo difference between them, with
+ * optional sequential probability ratio test (SPRT) early stopping.
+ *
+ * Usage: match [-g <game pairs>] [-t <threads>] [-o <openings>]
+ *              [-r <random plies>] [-s <seed>] [-sprt <elo0> <elo1>]
+ *              [-n <nodes>] [-m <movetime ms>] [-c <base s>+<increment s>]
+ *              [-d <depth>] [-e <network>] [-f <configuration>]
+ *              [-p <name>=<value>]
+ *
+ * The engine options (-n, -m, -c, -d, -e, -f and -p) apply to both engines,
+ * or, with an a or b suffix (e.g. -na 20000, -pb lmr_reduction=2), to engine
+ * A or engine B only. Each move is searched up to the given node count, move
+ * time or depth; under a clock (-c), each engine receives a share of its
+ * remaining time per move and loses on time if its clock runs out. With no
+ * limits, each move is searched to MATCH_DEFAULT_NODES nodes. The search
+ * parameters (see chess/param.h) start at their defaults, are read from a
+ * configuration file with -f, and are set one at a time with -p (which takes
+ * precedence over -f).
+ *
+ * The games are played in pairs from the openings of a FEN/EPD file or a
+ * packed dataset (see chess/packed.h), or, without one, from random legal
+ * moves (see chess/match.h for the pairing and adjudication rules).
+ *
+ * The Elo difference and its 95% confidence interval are estimated from the
+ * score of each game pair. With -sprt, the match tests H0: elo = elo0
+ * against H1: elo = elo1, with false positive and false negative rates of
+ * MATCH_SPRT_ALPHA and MATCH_SPRT_BETA, and stops once the log-likelihood
+ * ratio leaves its bounds.
+ */
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/memory.h"
+#include "core/string.h"
+
+#include "math/math.h"
+
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include "chess/chess.h"
+
+// Defines default match parameters.
+#define MATCH_DEFAULT_PAIRS             500
+#define MATCH_DEFAULT_NODES             10000
+#define MATCH_DEFAULT_RANDOM_PLIES      8
+#define MATCH_LOG_INTERVAL              10.0
+
+// Defines SPRT error rates.
+#define MATCH_SPRT_ALPHA                0.05
+#define MATCH_SPRT_BETA                 0.05
+
+// Defines the number of game pairs before the SPRT may stop a match (the
+// variance estimate of a handful of pairs is too unreliable).
+#define MATCH_SPRT_MIN_PAIRS            16
+
+// Type definition for the state of the match runner.
+typedef struct
+{
+    match_t*            match;
+    bool                sprt;
+    f64                 elo0;
+    f64                 elo1;
+    i32                 decision;
+    clock_t             clock;
+    f64                 log_time;
+}
+match_runner_t;
+
+/**
+ * @brief Match progress callback (see PFN_match_progress). Logs the progress
+ * of the match every MATCH_LOG_INTERVAL seconds, and stops it once the SPRT
+ * is decided.
+ * @param args A match_runner_t.
+ * @return false to stop the match, true otherwise.
+ */
+bool
+match_progress
+(   void* args
+);
+
+/**
+ * @brief Logs the progress of a match.
+ * @param match The match state.
+ * @param stats The match statistics.
+ * @param sprt SPRT enabled? Y/N
+ */
+void
+match_log
+(   const match_t*          match
+,   const match_stats_t*    stats
+,   const bool              sprt
+);
+
+int
+main
+(   int     argc
+,   char**  argv
+)
+{
+    const char* openings = 0;
+    const char* networks[ 2 ] = { 0 , 0 };
+    const char* configs[ 2 ] = { 0 , 0 };
+    u64 thread_count = platform_processor_count ();
+    u64 movetime[ 2 ] = { 0 , 0 };
+    u64 depth[ 2 ] = { 0 , 0 };
+
+    match_t state;
+    memory_clear ( &state , sizeof ( state ) );
+    match_t* match = &state;
+    ( *match ).pairs = MATCH_DEFAULT_PAIRS;
+    ( *match ).random_plies = MATCH_DEFAULT_RANDOM_PLIES;
+    ( *match ).seed = 1;
+    search_params_default ( &( *match ).engines[ 0 ].params );
+    search_params_default ( &( *match ).engines[ 1 ].params );
+
+    match_runner_t runner;
+    memory_clear ( &runner , sizeof ( runner ) );
+    runner.match = match;
+
+    // Parse command line.
+    bool valid = true;
+    for ( i32 i = 1; i < argc && valid; ++i )
+    {
+        const char* arg = argv[ i ];
+        u64* value = 0;
+        if ( string_equal ( arg , "-o" ) && i + 1 < argc )
+        {
+            openings = argv[ ++i ];
+            continue;
+        }
+        else if ( string_equal ( arg , "-sprt" ) && i + 2 < argc )
+        {
+            valid = string_to_f64 ( argv[ ++i ] , &runner.elo0 )
+                 && string_to_f64 ( argv[ ++i ] , &runner.elo1 )
+                 && runner.elo0 < runner.elo1
+                 ;
+            runner.sprt = true;
+            continue;
+        }
+        else if ( string_equal ( arg , "-g" ) ) value = &( *match ).pairs;
+        else if ( string_equal ( arg , "-t" ) ) value = &thread_count;
+        else if ( string_equal ( arg , "-r" ) ) value = &( *match ).random_plies;
+        else if ( string_equal ( arg , "-s" ) ) value = &( *match ).seed;
+        if ( value )
+        {
+            valid = i + 1 < argc && string_to_u64 ( argv[ ++i ] , value ) && *value;
+            continue;
+        }
+
+        // Engine options: -x (both engines), -xa (engine A) or -xb (engine B).
+        const u64 length = string_length ( arg );
+        const u32 first = ( length == 3 && arg[ 2 ] == 'b' ) ? 1 : 0;
+        const u32 last = ( length == 3 && arg[ 2 ] == 'a' ) ? 0 : 1;
+        valid = arg[ 0 ] == '-'
+             && ( length == 2 || ( length == 3 && ( arg[ 2 ] == 'a' || arg[ 2 ] == 'b' ) ) )
+             && i + 1 < argc
+             ;
+        if ( !valid )
+        {
+            break;
+        }
+        const char* s = argv[ ++i ];
+        for ( u32 j = first; j <= last && valid; ++j )
+        {
+            match_engine_t* engine = &( *match ).engines[ j ];
+            switch ( arg[ 1 ] )
+            {
+                case 'n': valid = string_to_u64 ( s , &( *engine ).nodes ) && ( *engine ).nodes ;break;
+                case 'm': valid = string_to_u64 ( s , &movetime[ j ] ) && movetime[ j ]          ;break;
+                case 'd': valid = string_to_u64 ( s , &depth[ j ] ) && depth[ j ]                ;break;
+                case 'e': networks[ j ] = s                                                     ;break;
+                case 'f': configs[ j ] = s                                                      ;break;
+                case 'p': valid = search_params_parse ( &( *engine ).params , s )               ;break;
+                case 'c':
+                {
+                    // Clock: <base>+<increment>, in seconds.
+                    char base[ 32 ];
+                    u32 k = 0;
+                    while ( s[ k ] && s[ k ] != '+' && k < sizeof ( base ) - 1 )
+                    {
+                        base[ k ] = s[ k ];
+                        k += 1;
+                    }
+                    base[ k ] = 0;
+                    ( *engine ).increment = 0;
+                    valid = string_to_f64 ( base , &( *engine ).base )
+                         && ( *engine ).base > 0
+                         && ( !s[ k ] || ( s[ k ] == '+' && string_to_f64 ( s + k + 1 , &( *engine ).increment ) ) )
+                         ;
+                }
+                break;
+                default: valid = false; break;
+            }
+        }
+    }
+    if ( !valid )
+    {
+        LOGERROR ( "Usage: %s [-g <game pairs>] [-t <threads>] [-o <openings>] [-r <random plies>] [-s <seed>] [-sprt <elo0> <elo1>] [-n <nodes>] [-m <movetime ms>] [-c <base s>+<increment s>] [-d <depth>] [-e <network>] [-f <configuration>] [-p <name>=<value>]"
+                 , argv[ 0 ]
+                 );
+        return 1;
+    }
+    ( *match ).thread_count = min ( thread_count , ( u64 ) MATCH_MAX_THREADS );
+    ( *match ).random_plies = min ( ( *match ).random_plies , GAME_MAX_PLY / 2ULL );
+    for ( u32 i = 0; i < 2; ++i )
+    {
+        match_engine_t* engine = &( *match ).engines[ i ];
+        ( *engine ).movetime = movetime[ i ] / 1000.0;
+        if ( !( *engine ).nodes && !movetime[ i ] && !depth[ i ] && !( *engine ).base )
+        {
+            ( *engine ).nodes = MATCH_DEFAULT_NODES;
+        }
+        ( *engine ).depth = ( depth[ i ] ) ? min ( depth[ i ] , ( u64 ) MOVE_SEARCH_MAX_PLY )
+                                           : MOVE_SEARCH_MAX_PLY
+                                           ;
+    }
+
+    // Size the memory subsystem for the attack tables, the networks, the
+    // openings and the match.
+    if ( !memory_startup ( sizeof ( attacks_t )
+                         + 2 * sizeof ( nnue_t )
+                         + ( ( openings ) ? match_openings_memory_requirement ( openings ) : 0 )
+                         + match_memory_requirement ( ( *match ).thread_count )
+                         + MEBIBYTES ( 16 )
+                         ))
+    {
+        return 1;
+    }
+    attacks_t* attacks = memory_allocate ( sizeof ( attacks_t ) , MEMORY_TAG_APPLICATION );
+    attacks_init ( attacks );
+    ( *match ).attacks = attacks;
+    nnue_t* nnue[ 2 ] = { 0 , 0 };
+    for ( u32 i = 0; i < 2; ++i )
+    {
+        if ( !networks[ i ] )
+        {
+            continue;
+        }
+        nnue[ i ] = memory_allocate ( sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+        if ( !nnue_load ( networks[ i ] , nnue[ i ] ) )
+        {
+            LOGERROR ( "Failed to load evaluation network '%s'." , networks[ i ] );
+            return 1;
+        }
+        ( *match ).engines[ i ].nnue = nnue[ i ];
+    }
+
+    // Read the configuration files, then set the parameters given one at a
+    // time on top of them.
+    for ( u32 i = 0; i < 2; ++i )
+    {
+        if ( !configs[ i ] )
+        {
+            continue;
+        }
+        search_params_t* params = &( *match ).engines[ i ].params;
+        if ( !search_params_load ( params , configs[ i ] ) )
+        {
+            return 1;
+        }
+        for ( i32 j = 1; j + 1 < argc; ++j )
+        {
+            if (    string_equal ( argv[ j ] , "-p" )
+                 || string_equal ( argv[ j ] , ( i ) ? "-pb" : "-pa" )
+               )
+            {
+                search_params_parse ( params , argv[ ++j ] );
+            }
+        }
+    }
+
+    // Load openings.
+    match_openings_t opening_set;
+    memory_clear ( &opening_set , sizeof ( opening_set ) );
+    if ( openings )
+    {
+        if ( !match_openings_open ( openings , &opening_set ) )
+        {
+            return 1;
+        }
+        if ( !opening_set.count )
+        {
+            LOGERROR ( "No valid openings in '%s'." , openings );
+            return 1;
+        }
+        ( *match ).openings = opening_set.records;
+        ( *match ).opening_count = opening_set.count;
+    }
+
+    // Play.
+    LOGINFO ( "Playing %llu game pairs on %u threads. . ." , ( *match ).pairs , ( *match ).thread_count );
+    ( *match ).progress = match_progress;
+    ( *match ).progress_args = &runner;
+    runner.log_time = MATCH_LOG_INTERVAL;
+    clock_start ( &runner.clock );
+    if ( !match_run ( match ) )
+    {
+        return 1;
+    }
+    clock_update ( &runner.clock );
+
+    // Summary.
+    // The games in progress when the SPRT stopped the match were still
+    // played out, so the final statistics may have moved back inside the
+    // bounds; the decision stands.
+    match_stats_t stats;
+    match_stats ( match , runner.elo0 , runner.elo1 , &stats );
+    match_log ( match , &stats , runner.sprt );
+    if ( runner.sprt )
+    {
+        if ( !runner.decision && stats.pairs >= MATCH_SPRT_MIN_PAIRS )
+        {
+            runner.decision = ( stats.llr >= log ( ( 1.0 - MATCH_SPRT_BETA ) / MATCH_SPRT_ALPHA ) ) ?  1
+                            : ( stats.llr <= log ( MATCH_SPRT_BETA / ( 1.0 - MATCH_SPRT_ALPHA ) ) ) ? -1
+                            : 0
+                            ;
+        }
+        LOGINFO ( "SPRT [%.1f, %.1f]: %s."
+                , runner.elo0 , runner.elo1
+                , ( runner.decision > 0 ) ? "H1 accepted" : ( runner.decision < 0 ) ? "H0 accepted" : "inconclusive"
+                );
+    }
+    LOGINFO ( "Played %llu games in %f seconds; searched %llu nodes (%llu nodes/second)."
+            , 2 * stats.pairs , runner.clock.elapsed , ( *match ).nodes
+            , ( runner.clock.elapsed > 0 ) ? ( u64 )( ( *match ).nodes / runner.clock.elapsed ) : 0
+            );
+    if ( ( *match ).forfeits )
+    {
+        LOGWARN ( "%llu game(s) lost on time." , ( *match ).forfeits );
+    }
+
+    if ( openings )
+    {
+        match_openings_close ( &opening_set );
+    }
+    for ( u32 i = 0; i < 2; ++i )
+    {
+        if ( nnue[ i ] )
+        {
+            memory_free ( nnue[ i ] , sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+        }
+    }
+    memory_free ( attacks , sizeof ( attacks_t ) , MEMORY_TAG_APPLICATION );
+    memory_shutdown ();
+    return 0;
+}
+
+bool
+match_progress
+(   void* args
+)
+{
+    match_runner_t* runner = args;
+    match_t* match = ( *runner ).match;
+    match_stats_t stats;
+    match_stats ( match , ( *runner ).elo0 , ( *runner ).elo1 , &stats );
+    clock_update ( &( *runner ).clock );
+    if ( ( *runner ).clock.elapsed >= ( *runner ).log_time )
+    {
+        match_log ( match , &stats , ( *runner ).sprt );
+        ( *runner ).log_time += MATCH_LOG_INTERVAL;
+    }
+    if ( ( *runner ).sprt && !( *runner ).decision && stats.pairs >= MATCH_SPRT_MIN_PAIRS )
+    {
+        if ( stats.llr >= log ( ( 1.0 - MATCH_SPRT_BETA ) / MATCH_SPRT_ALPHA ) )
+        {
+            ( *runner ).decision = 1;
+        }
+        else if ( stats.llr <= log ( MATCH_SPRT_BETA / ( 1.0 - MATCH_SPRT_ALPHA ) ) )
+        {
+            ( *runner ).decision = -1;
+        }
+    }
+    return !( *runner ).decision;
+}
+
+void
+match_log
+(   const match_t*          match
+,   const match_stats_t*    stats
+,   const bool              sprt
+)
+{
+    char buf[ STACK_STRING_MAX_LENGTH ];
+    u64 len = string_format ( buf , "Games %llu: +%llu =%llu -%llu (A vs B), score %.1f%%, Elo %.1f +/- %.1f"
+                            , 2 * ( *stats ).pairs
+                            , __atomic_load_n ( &( *match ).results[ 2 ] , __ATOMIC_RELAXED )
+                            , __atomic_load_n ( &( *match ).results[ 1 ] , __ATOMIC_RELAXED )
+                            , __atomic_load_n ( &( *match ).results[ 0 ] , __ATOMIC_RELAXED )
+                            , 100.0 * ( *stats ).score
+                            , ( *stats ).elo
+                            , ( *stats ).elo_error
+                            );
+    if ( sprt )
+    {
+        len += string_format ( buf + len , ", LLR %.2f (%.2f, %.2f)"
+                             , ( *stats ).llr
+                             , log ( MATCH_SPRT_BETA / ( 1.0 - MATCH_SPRT_ALPHA ) )
+                             , log ( ( 1.0 - MATCH_SPRT_BETA ) / MATCH_SPRT_ALPHA )
+                             );
+    }
+    string_format ( buf + len , ", pentanomial [%llu, %llu, %llu, %llu, %llu]."
+                  , __atomic_load_n ( &( *match ).pentanomial[ 0 ] , __ATOMIC_RELAXED )
+                  , __atomic_load_n ( &( *match ).pentanomial[ 1 ] , __ATOMIC_RELAXED )
+                  , __atomic_load_n ( &( *match ).pentanomial[ 2 ] , __ATOMIC_RELAXED )
+                  , __atomic_load_n ( &( *match ).pentanomial[ 3 ] , __ATOMIC_RELAXED )
+                  , __atomic_load_n ( &( *match ).pentanomial[ 4 ] , __ATOMIC_RELAXED )
+                  );
+    LOGINFO ( "%s" , buf );
+}
\ No newline at end of file
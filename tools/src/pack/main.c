@@ -0,0 +1,374 @@
+/**
+ * @file main.c
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Entry point for the dataset conversion program.
+ *
+ * Converts between labelled FEN/EPD text datasets and datasets of packed
+ * position records (see chess/packed.h), and shuffles and shards packed
+ * datasets.
+ *
+ * Usage: pack <input> -o <output> [-s <seed>] [-k <shard>] [-n <shards>]
+ *
+ * The direction of the conversion follows the file extensions: a file ending
+ * in DATASET_FILE_EXTENSION is a packed dataset, and any other file is text.
+ *
+ *  - text -> packed: each line holds a FEN or EPD position, optionally
+ *    followed by its move counters, result and score (see
+ *    board_packed_parse). Unreadable lines are skipped.
+ *  - packed -> text: each record is written as an EPD line (see
+ *    string_board_packed), which is checked to read back as the same record.
+ *  - packed -> packed: the records are copied.
+ *
+ * When reading a packed dataset, -s shuffles the records with the given seed,
+ * and -k and -n select shard k (1 to n) of n disjoint shards of the records.
+ */
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/memory.h"
+#include "core/string.h"
+
+#include "math/math.h"
+
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include "chess/chess.h"
+
+// Defines buffer sizes.
+#define PACK_READ_BUFFER_SIZE   ( MEBIBYTES ( 4 ) )
+#define PACK_WRITE_BATCH_SIZE   65536
+#define PACK_LINE_MAX_LENGTH    512ULL
+
+/**
+ * @brief Writes a batch of records.
+ * @param file The output file.
+ * @param records The records.
+ * @param count Number of records.
+ * @return true on success, false otherwise.
+ */
+INLINE
+bool
+pack_write
+(   file_handle_t*          file
+,   const board_packed_t*   records
+,   const u64               count
+)
+{
+    u64 written;
+    return file_write ( file , count * sizeof ( board_packed_t ) , records , &written )
+        && written == count * sizeof ( board_packed_t )
+        ;
+}
+
+/**
+ * @brief Compares two records.
+ * @param a A record.
+ * @param b A record.
+ * @return true if a and b hold the same position and labels, false otherwise.
+ */
+INLINE
+bool
+pack_record_equal
+(   const board_packed_t* a
+,   const board_packed_t* b
+)
+{
+    for ( u32 i = 0; i < sizeof ( ( *a ).pieces ); ++i )
+    {
+        if ( ( *a ).pieces[ i ] != ( *b ).pieces[ i ] )
+        {
+            return false;
+        }
+    }
+    return ( *a ).occupancy == ( *b ).occupancy
+        && ( *a ).side == ( *b ).side
+        && ( *a ).castle == ( *b ).castle
+        && ( *a ).enpassant == ( *b ).enpassant
+        && ( *a ).result == ( *b ).result
+        && ( *a ).score == ( *b ).score
+        && ( *a ).ply == ( *b ).ply
+        ;
+}
+
+/**
+ * @brief Converts a text dataset to a packed dataset.
+ * @param input The input file.
+ * @param output The output file.
+ * @param records Output buffer (room for PACK_WRITE_BATCH_SIZE records).
+ * @param count Output buffer for the number of records written.
+ * @return true on success, false otherwise.
+ */
+bool
+pack_text
+(   file_handle_t*  input
+,   file_handle_t*  output
+,   board_packed_t* records
+,   u64*            count
+);
+
+/**
+ * @brief Copies one shard of a packed dataset, either to a text dataset or to
+ * another packed dataset. Each line of text written is checked to parse back
+ * into the record it was written from.
+ * @param dataset The input dataset.
+ * @param output The output file.
+ * @param text Write text? Y/N
+ * @param seed Shuffle seed (0 for file order).
+ * @param shard The shard index.
+ * @param shard_count The number of shards.
+ * @param records Output buffer (room for PACK_WRITE_BATCH_SIZE records).
+ * @param count Output buffer for the number of records written.
+ * @return true on success, false otherwise.
+ */
+bool
+pack_dataset
+(   const dataset_t*    dataset
+,   file_handle_t*      output
+,   const bool          text
+,   const u64           seed
+,   const u64           shard
+,   const u64           shard_count
+,   board_packed_t*     records
+,   u64*                count
+);
+
+int
+main
+(   int     argc
+,   char**  argv
+)
+{
+    const char* input = 0;
+    const char* output = 0;
+    u64 seed = 0;
+    u64 shard = 1;
+    u64 shard_count = 1;
+
+    // Parse command line.
+    for ( i32 i = 1; i < argc; ++i )
+    {
+        u64* value = 0;
+        if ( string_equal ( argv[ i ] , "-o" ) && i + 1 < argc )
+        {
+            output = argv[ ++i ];
+            continue;
+        }
+        else if ( string_equal ( argv[ i ] , "-s" ) ) value = &seed;
+        else if ( string_equal ( argv[ i ] , "-k" ) ) value = &shard;
+        else if ( string_equal ( argv[ i ] , "-n" ) ) value = &shard_count;
+        else if ( !input )
+        {
+            input = argv[ i ];
+            continue;
+        }
+
+        if ( !value || i + 1 >= argc || !string_to_u64 ( argv[ ++i ] , value ) || !*value )
+        {
+            input = 0;
+            break;
+        }
+    }
+    if ( !input || !output || shard > shard_count )
+    {
+        LOGERROR ( "Usage: %s <input> -o <output> [-s <seed>] [-k <shard>] [-n <shards>]"
+                 , argv[ 0 ]
+                 );
+        return 1;
+    }
+    if ( !dataset_filepath ( input ) && !dataset_filepath ( output ) )
+    {
+        LOGERROR ( "Either the input or the output must be a packed dataset (*"DATASET_FILE_EXTENSION")." );
+        return 1;
+    }
+
+    if ( !memory_startup ( PACK_READ_BUFFER_SIZE
+                         + PACK_WRITE_BATCH_SIZE * sizeof ( board_packed_t )
+                         + MEBIBYTES ( 4 )
+                         ))
+    {
+        return 1;
+    }
+    board_packed_t* records = memory_allocate ( PACK_WRITE_BATCH_SIZE * sizeof ( board_packed_t )
+                                              , MEMORY_TAG_APPLICATION
+                                              );
+
+    file_handle_t out;
+    if ( !file_open ( output , FILE_MODE_WRITE , dataset_filepath ( output ) , &out ) )
+    {
+        LOGERROR ( "Unable to open '%s' for writing." , output );
+        return 1;
+    }
+
+    clock_t clock;
+    clock_start ( &clock );
+    u64 count = 0;
+    bool success;
+    if ( dataset_filepath ( input ) )
+    {
+        dataset_t dataset;
+        if ( !dataset_open ( input , &dataset ) )
+        {
+            LOGERROR ( "Unable to open dataset '%s'." , input );
+            return 1;
+        }
+        success = pack_dataset ( &dataset , &out , !dataset_filepath ( output )
+                               , seed , shard - 1 , shard_count
+                               , records , &count
+                               );
+        dataset_close ( &dataset );
+    }
+    else
+    {
+        file_handle_t in;
+        if ( !file_open ( input , FILE_MODE_READ , false , &in ) )
+        {
+            LOGERROR ( "Unable to open dataset '%s'." , input );
+            return 1;
+        }
+        success = pack_text ( &in , &out , records , &count );
+        file_close ( &in );
+    }
+    file_close ( &out );
+    clock_update ( &clock );
+
+    if ( !success )
+    {
+        LOGERROR ( "Failed to write '%s'." , output );
+        return 1;
+    }
+    LOGINFO ( "Wrote %llu positions to '%s' in %f seconds." , count , output , clock.elapsed );
+
+    memory_free ( records , PACK_WRITE_BATCH_SIZE * sizeof ( board_packed_t ) , MEMORY_TAG_APPLICATION );
+    memory_shutdown ();
+    return 0;
+}
+
+bool
+pack_text
+(   file_handle_t*  input
+,   file_handle_t*  output
+,   board_packed_t* records
+,   u64*            count
+)
+{
+    char* buffer = memory_allocate ( PACK_READ_BUFFER_SIZE , MEMORY_TAG_APPLICATION );
+    char line[ PACK_LINE_MAX_LENGTH ];
+    u64 line_length = 0;
+    u64 batch = 0;
+    u64 skipped = 0;
+    u64 read;
+    bool success = true;
+    do
+    {
+        file_read ( input , PACK_READ_BUFFER_SIZE , buffer , &read );
+        for ( u64 i = 0; i <= read && success; ++i )
+        {
+            // A line ends at a line break, or at the end of the file.
+            const bool eol = ( i == read ) ? read < PACK_READ_BUFFER_SIZE && line_length
+                                           : buffer[ i ] == '\n'
+                                           ;
+            if ( !eol )
+            {
+                if ( i < read && line_length < PACK_LINE_MAX_LENGTH - 1 )
+                {
+                    line[ line_length ] = buffer[ i ];
+                }
+                line_length += ( i < read );
+                continue;
+            }
+            line[ min ( line_length , PACK_LINE_MAX_LENGTH - 1 ) ] = 0;
+            line_length = 0;
+            if ( !line[ 0 ] || line[ 0 ] == '\r' )
+            {
+                continue;
+            }
+            if ( !board_packed_parse ( line , &records[ batch ] ) )
+            {
+                skipped += 1;
+                continue;
+            }
+            batch += 1;
+            if ( batch == PACK_WRITE_BATCH_SIZE )
+            {
+                success = pack_write ( output , records , batch );
+                *count += batch;
+                batch = 0;
+            }
+        }
+    }
+    while ( read == PACK_READ_BUFFER_SIZE && success );
+    success = success && pack_write ( output , records , batch );
+    *count += batch;
+
+    memory_free ( buffer , PACK_READ_BUFFER_SIZE , MEMORY_TAG_APPLICATION );
+    if ( skipped )
+    {
+        LOGWARN ( "pack_text: Skipped %llu invalid lines." , skipped );
+    }
+    return success;
+}
+
+bool
+pack_dataset
+(   const dataset_t*    dataset
+,   file_handle_t*      output
+,   const bool          text
+,   const u64           seed
+,   const u64           shard
+,   const u64           shard_count
+,   board_packed_t*     records
+,   u64*                count
+)
+{
+    dataset_iterator_t iterator;
+    dataset_iterator_init ( &iterator , dataset , seed , shard , shard_count );
+
+    char line[ BOARD_PACKED_STRING_MAX_LENGTH ];
+    board_packed_t check;
+    u64 batch = 0;
+    u64 skipped = 0;
+    const board_packed_t* record;
+    while ( ( record = dataset_next ( &iterator ) ) )
+    {
+        if ( text )
+        {
+            if ( !string_board_packed ( line , record ) )
+            {
+                skipped += 1;
+                continue;
+            }
+            if ( !board_packed_parse ( line , &check ) || !pack_record_equal ( &check , record ) )
+            {
+                LOGERROR ( "pack_dataset: Record does not survive a round trip through text: '%s'." , line );
+                return false;
+            }
+            if ( !file_write_line ( output , line ) )
+            {
+                return false;
+            }
+            *count += 1;
+            continue;
+        }
+        records[ batch++ ] = *record;
+        if ( batch == PACK_WRITE_BATCH_SIZE )
+        {
+            if ( !pack_write ( output , records , batch ) )
+            {
+                return false;
+            }
+            *count += batch;
+            batch = 0;
+        }
+    }
+    if ( batch && !pack_write ( output , records , batch ) )
+    {
+        return false;
+    }
+    *count += batch;
+
+    if ( skipped )
+    {
+        LOGWARN ( "pack_dataset: Skipped %llu malformed records." , skipped );
+    }
+    return true;
+}
\ No newline at end of file
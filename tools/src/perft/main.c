@@ -0,0 +1,395 @@
+/**
+ * @file main.c
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Entry point for the perft suite program.
+ *
+ * Counts the leaf nodes of the legal move tree for each of a set of standard
+ * test positions, checks the counts against known values, and reports the
+ * speed of the move generator in nodes per second.
+ *
+ * Usage: perft [-d <depth>] [-p <position>] [-o <report>] [-t <threads>]
+ *              [-H <hash MiB>] [-c] [-q]
+ *
+ * With more than one thread, or with a hash table, the count is split across
+ * threads and subtree counts are cached (see perft_parallel); -c then checks
+ * every count against a serial count as well. With -q, the count runs serially
+ * and uncached on the compact board representation instead (see perft_count_quad), to
+ * compare copy and make speed against the full board state.
+ *
+ * The report is one tab-separated line per position, preceded by a header
+ * line:
+ *
+ *     position  depth  nodes  expected  result  seconds  nps  threads  hash  board
+ *
+ * where result is one of pass, fail, none (no known count at that depth),
+ * unchecked or changed (a count which no independent reference confirms
+ * matches or differs from the count recorded; see perft_positions), hash is
+ * the hash table size in MiB, and board is full or quad. It is written to standard output, and to the report file if one is
+ * given, so that move generator speed can be compared between builds; log
+ * messages go to standard error. The program exits with status 1 if any
+ * count is wrong.
+ */
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/memory.h"
+#include "core/string.h"
+
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include "chess/chess.h"
+#include "chess/test/perft.h"
+
+// Defines the deepest known node count per position.
+#define PERFT_MAX_DEPTH 6
+
+// Type definition for the suite options.
+typedef struct
+{
+    u32                 thread_count;
+    u64                 hash;
+    bool                check;
+    bool                quad;
+    const attacks_t*    attacks;
+    perft_table_t*      table;
+    file_handle_t*      out;
+    file_handle_t*      report;
+}
+perft_options_t;
+
+// Type definition for a test position.
+typedef struct
+{
+    const char* name;
+    const char* fen;
+    u32         depth;
+    u64         nodes[ PERFT_MAX_DEPTH ];
+    bool        unchecked;  // nodes only records a previous count of this program.
+}
+perft_position_t;
+
+// Test positions, with the default depth for each and the known node counts
+// indexed by depth - 1 (0 if unknown). The counts for killer and cmk were
+// generated by this program and have no independent reference, so they are
+// reported as unchecked (or changed) rather than pass (or fail); all others
+// are the published values.
+static const perft_position_t perft_positions[] =
+{   { "start"    , FEN_START
+    , 5 , { 20 , 400 , 8902 , 197281 , 4865609 , 119060324 }
+    }
+,   { "kiwipete" , FEN_TRICKY
+    , 4 , { 48 , 2039 , 97862 , 4085603 , 193690690 , 0 }
+    }
+,   { "pos3"     , "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"
+    , 5 , { 14 , 191 , 2812 , 43238 , 674624 , 11030083 }
+    }
+,   { "pos4"     , "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"
+    , 4 , { 6 , 264 , 9467 , 422333 , 15833292 , 0 }
+    }
+,   { "pos5"     , "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"
+    , 4 , { 44 , 1486 , 62379 , 2103487 , 89941194 , 0 }
+    }
+,   { "pos6"     , "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10"
+    , 4 , { 46 , 2079 , 89890 , 3894594 , 164075551 , 0 }
+    }
+,   { "killer"   , FEN_KILLER
+    , 4 , { 42 , 1088 , 39518 , 1032012 , 36112837 , 0 } , true
+    }
+,   { "cmk"      , FEN_CMK
+    , 4 , { 43 , 1289 , 54240 , 1679340 , 69838845 , 0 } , true
+    }
+};
+
+// Defines the number of test positions.
+#define PERFT_POSITION_COUNT \
+    ( sizeof ( perft_positions ) / sizeof ( perft_positions[ 0 ] ) )
+
+/**
+ * @brief Writes a line of the report.
+ * @param line The line to write.
+ * @param options The suite options.
+ */
+void
+perft_report
+(   const char*             line
+,   const perft_options_t*  options
+);
+
+/**
+ * @brief Runs the test for a single position and writes its report line.
+ * @param position The test position.
+ * @param depth The recursion depth.
+ * @param options The suite options.
+ * @return false if the node count is wrong, true otherwise.
+ */
+bool
+perft_run
+(   const perft_position_t* position
+,   const u32               depth
+,   const perft_options_t*  options
+);
+
+int
+main
+(   int     argc
+,   char**  argv
+)
+{
+    // Standard output carries the report only.
+    logger_redirect_console ( true );
+
+    u64 depth = 0;
+    const char* name = 0;
+    const char* filepath = 0;
+    u64 thread_count = 1;
+    u64 hash = 0;
+    bool check = false;
+    bool quad = false;
+
+    // Parse command line.
+    for ( i32 i = 1; i < argc; ++i )
+    {
+        if ( string_equal ( argv[ i ] , "-d" ) && i + 1 < argc )
+        {
+            if ( !string_to_u64 ( argv[ ++i ] , &depth ) || !depth )
+            {
+                LOGERROR ( "Invalid depth '%s'." , argv[ i ] );
+                return 1;
+            }
+        }
+        else if ( string_equal ( argv[ i ] , "-p" ) && i + 1 < argc )
+        {
+            name = argv[ ++i ];
+        }
+        else if ( string_equal ( argv[ i ] , "-o" ) && i + 1 < argc )
+        {
+            filepath = argv[ ++i ];
+        }
+        else if ( string_equal ( argv[ i ] , "-t" ) && i + 1 < argc )
+        {
+            if ( !string_to_u64 ( argv[ ++i ] , &thread_count ) || !thread_count )
+            {
+                LOGERROR ( "Invalid thread count '%s'." , argv[ i ] );
+                return 1;
+            }
+        }
+        else if ( string_equal ( argv[ i ] , "-H" ) && i + 1 < argc )
+        {
+            if ( !string_to_u64 ( argv[ ++i ] , &hash ) )
+            {
+                LOGERROR ( "Invalid hash table size '%s'." , argv[ i ] );
+                return 1;
+            }
+        }
+        else if ( string_equal ( argv[ i ] , "-c" ) )
+        {
+            check = true;
+        }
+        else if ( string_equal ( argv[ i ] , "-q" ) )
+        {
+            quad = true;
+        }
+        else
+        {
+            LOGERROR ( "Usage: %s [-d <depth>] [-p <position>] [-o <report>] [-t <threads>] [-H <hash MiB>] [-c] [-q]"
+                     , argv[ 0 ]
+                     );
+            return 1;
+        }
+    }
+
+    // The compact board count is serial and uncached.
+    if ( quad )
+    {
+        thread_count = 1;
+        hash = 0;
+    }
+
+    file_handle_t out;
+    if ( !file_open_stdio ( FILE_MODE_WRITE , &out ) )
+    {
+        LOGERROR ( "Failed to open standard output." );
+        return 1;
+    }
+    file_handle_t file;
+    file_handle_t* report = 0;
+    if ( filepath )
+    {
+        if ( !file_open ( filepath , FILE_MODE_WRITE , false , &file ) )
+        {
+            LOGERROR ( "Failed to open report file '%s'." , filepath );
+            return 1;
+        }
+        report = &file;
+    }
+
+    // Size the memory subsystem for the attack tables, the hash table and the
+    // split point board states.
+    if ( !memory_startup ( sizeof ( attacks_t ) + MEBIBYTES ( hash ) + MEBIBYTES ( 16 ) ) )
+    {
+        return 1;
+    }
+    attacks_t* attacks = memory_allocate ( sizeof ( attacks_t ) , MEMORY_TAG_APPLICATION );
+    attacks_init ( attacks );
+
+    perft_table_t table;
+    memory_clear ( &table , sizeof ( perft_table_t ) );
+    if ( hash && !perft_table_create ( MEBIBYTES ( hash ) , &table ) )
+    {
+        LOGERROR ( "Failed to allocate a %llu MiB hash table." , hash );
+        return 1;
+    }
+
+    perft_options_t options;
+    options.thread_count = min ( thread_count , PERFT_MAX_THREADS );
+    options.hash = hash;
+    options.check = check;
+    options.quad = quad;
+    options.attacks = attacks;
+    options.table = ( hash ) ? &table : 0;
+    options.out = &out;
+    options.report = report;
+
+    perft_report ( "position\tdepth\tnodes\texpected\tresult\tseconds\tnps\tthreads\thash\tboard" , &options );
+
+    u32 failures = 0;
+    u32 count = 0;
+    for ( u32 i = 0; i < PERFT_POSITION_COUNT; ++i )
+    {
+        if ( name && !string_equal ( name , perft_positions[ i ].name ) )
+        {
+            continue;
+        }
+        if ( !perft_run ( &perft_positions[ i ]
+                        , ( depth ) ? depth : perft_positions[ i ].depth
+                        , &options
+                        ))
+        {
+            failures += 1;
+        }
+        count += 1;
+    }
+
+    perft_table_destroy ( &table );
+    memory_free ( attacks , sizeof ( attacks_t ) , MEMORY_TAG_APPLICATION );
+    memory_shutdown ();
+    if ( report )
+    {
+        file_close ( report );
+    }
+
+    if ( !count )
+    {
+        LOGERROR ( "Unknown position '%s'." , name );
+        return 1;
+    }
+    if ( failures )
+    {
+        LOGERROR ( "perft: %u of %u positions failed." , failures , count );
+        return 1;
+    }
+    return 0;
+}
+
+void
+perft_report
+(   const char*             line
+,   const perft_options_t*  options
+)
+{
+    file_write_line ( ( *options ).out , line );
+    if ( ( *options ).report )
+    {
+        file_write_line ( ( *options ).report , line );
+    }
+}
+
+bool
+perft_run
+(   const perft_position_t* position
+,   const u32               depth
+,   const perft_options_t*  options
+)
+{
+    board_t board;
+    if ( !fen_parse ( ( *position ).fen , &board ) )
+    {
+        return false;
+    }
+
+    // Start each position from an empty hash table, so its speed does not
+    // depend on the positions before it.
+    if ( ( *options ).table )
+    {
+        perft_table_clear ( ( *options ).table );
+    }
+
+    board_quad_t quad;
+    board_quad_pack ( &quad , &board );
+
+    clock_t clock;
+    clock_start ( &clock );
+    const u64 nodes = ( ( *options ).quad )
+                    ? perft_count_quad ( &quad , depth , ( *options ).attacks )
+                    : ( ( *options ).thread_count > 1 || ( *options ).table )
+                    ? perft_parallel ( &board , depth , ( *options ).attacks
+                                     , ( *options ).thread_count , ( *options ).table
+                                     )
+                    : perft_count ( &board , depth , ( *options ).attacks )
+                    ;
+    clock_update ( &clock );
+
+    // Check the result against a serial count.
+    bool match = true;
+    if ( ( *options ).check )
+    {
+        const u64 serial = perft_count ( &board , depth , ( *options ).attacks );
+        if ( serial != nodes )
+        {
+            LOGERROR ( "perft: %s depth %u: %llu nodes, but %llu counted serially."
+                     , ( *position ).name , depth , nodes , serial
+                     );
+            match = false;
+        }
+    }
+
+    const u64 expected = ( depth <= PERFT_MAX_DEPTH ) ? ( *position ).nodes[ depth - 1 ]
+                                                      : 0
+                                                      ;
+    const char* result;
+    if ( !match )
+    {
+        result = "fail";
+    }
+    else if ( !expected )
+    {
+        result = "none";
+    }
+    else if ( ( *position ).unchecked )
+    {
+        // Only a change since the count was recorded is detected.
+        result = ( nodes == expected ) ? "unchecked" : "changed";
+        if ( nodes != expected )
+        {
+            LOGWARN ( "perft: %s depth %u: %llu nodes, but %llu counted previously (unchecked)."
+                    , ( *position ).name , depth , nodes , expected
+                    );
+        }
+    }
+    else
+    {
+        match = nodes == expected;
+        result = ( match ) ? "pass" : "fail";
+    }
+
+    char line[ STACK_STRING_MAX_LENGTH ];
+    string_format ( line , "%s\t%u\t%llu\t%llu\t%s\t%f\t%llu\t%u\t%llu\t%s"
+                  , ( *position ).name , depth , nodes , expected , result , clock.elapsed
+                  , ( clock.elapsed > 0 ) ? ( u64 )( nodes / clock.elapsed ) : 0
+                  , ( *options ).thread_count , ( *options ).hash
+                  , ( ( *options ).quad ) ? "quad" : "full"
+                  );
+    perft_report ( line , options );
+
+    return match;
+}
\ No newline at end of file
@@ -0,0 +1,475 @@
+/**
+ * @file main.c
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Entry point for the self-play training data generator.
+ *
+ * Plays games of the engine against itself and writes the positions of each
+ * game, labelled with the search score and the game result, to a packed
+ * dataset (see chess/packed.h) for evaluation training.
+ *
+ * Usage: selfplay -o <output> [-t <threads>] [-g <games>] [-n <nodes>]
+ *                             [-r <random plies>] [-s <seed>] [-e <network>]
+ *
+ * Each worker thread owns a search and plays whole games, one at a time, at a
+ * fixed node budget per move. A game opens with a number of uniformly random
+ * legal moves, drawn from a generator seeded by the game index, so the games
+ * are reproducible whatever the number of threads. It ends by checkmate,
+ * stalemate, the fifty-move rule, threefold repetition, or adjudication (see
+ * chess/game.h).
+ *
+ * Only quiet positions are kept: not in check, with a best move that is
+ * neither a capture nor a promotion, and not scored as a forced mate. The
+ * random opening moves are not kept.
+ *
+ * The search threads never wait on the output file. Each worker hands its
+ * finished games to a queue of its own (single producer, single consumer),
+ * and the calling thread drains every queue to the file in the background. A
+ * game which does not fit in its queue is dropped (and counted) rather than
+ * stalling the search.
+ */
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/memory.h"
+#include "core/string.h"
+
+#include "math/math.h"
+
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include "chess/chess.h"
+
+// Defines default generator parameters.
+#define SELFPLAY_DEFAULT_GAMES          1000
+#define SELFPLAY_DEFAULT_NODES          5000
+#define SELFPLAY_DEFAULT_RANDOM_PLIES   8
+#define SELFPLAY_LOG_INTERVAL           10.0
+
+// Defines buffer sizes.
+#define SELFPLAY_MAX_THREADS            64ULL
+#define SELFPLAY_QUEUE_CAPACITY         65536   // Records per worker (a power of two).
+
+// Type definition for the generator parameters.
+typedef struct
+{
+    u64         games;
+    u64         nodes;
+    u64         random_plies;
+    u64         seed;
+}
+selfplay_options_t;
+
+// Type definition for the state of a generator worker thread.
+typedef struct
+{
+    // Input.
+    const attacks_t*            attacks;
+    const selfplay_options_t*   options;
+    u64*                        next_game;      // Shared by all workers.
+
+    // Search.
+    move_search_t*              search;
+    game_t                      game;
+    board_packed_t              records[ GAME_MAX_PLY ];
+
+    // Output queue. head is only written by the worker and tail only by the
+    // writer; both count records since the start and wrap around the queue.
+    board_packed_t*             queue;
+    u64                         head;
+    u64                         tail;
+
+    // Statistics (written by the worker).
+    u64                         games;
+    u64                         positions;
+    u64                         dropped;
+    u64                         nodes;
+    u64                         results[ 3 ];
+    bool                        done;
+}
+selfplay_worker_t;
+
+/**
+ * @brief Worker thread entry point. Plays games until the requested number of
+ * games have been claimed.
+ * @param args A selfplay_worker_t.
+ * @return 0.
+ */
+u32
+selfplay_worker
+(   void* args
+);
+
+/**
+ * @brief Plays a single game and queues its positions.
+ * @param worker The worker.
+ * @param index The game index (seeds the random opening).
+ */
+void
+selfplay_game
+(   selfplay_worker_t*  worker
+,   const u64           index
+);
+
+/**
+ * @brief Writes the records waiting in a worker's queue. Called by the writer
+ * only.
+ * @param worker The worker.
+ * @param file The output file.
+ * @param error Output buffer, set if a write failed.
+ * @return The number of records written.
+ */
+u64
+selfplay_drain
+(   selfplay_worker_t*  worker
+,   file_handle_t*      file
+,   bool*               error
+);
+
+int
+main
+(   int     argc
+,   char**  argv
+)
+{
+    const char* output = 0;
+    const char* network = 0;
+    u64 thread_count = platform_processor_count ();
+    selfplay_options_t options;
+    options.games = SELFPLAY_DEFAULT_GAMES;
+    options.nodes = SELFPLAY_DEFAULT_NODES;
+    options.random_plies = SELFPLAY_DEFAULT_RANDOM_PLIES;
+    options.seed = 1;
+
+    // Parse command line.
+    for ( i32 i = 1; i < argc; ++i )
+    {
+        u64* value = 0;
+        if ( string_equal ( argv[ i ] , "-o" ) && i + 1 < argc )
+        {
+            output = argv[ ++i ];
+            continue;
+        }
+        else if ( string_equal ( argv[ i ] , "-e" ) && i + 1 < argc )
+        {
+            network = argv[ ++i ];
+            continue;
+        }
+        else if ( string_equal ( argv[ i ] , "-t" ) ) value = &thread_count;
+        else if ( string_equal ( argv[ i ] , "-g" ) ) value = &options.games;
+        else if ( string_equal ( argv[ i ] , "-n" ) ) value = &options.nodes;
+        else if ( string_equal ( argv[ i ] , "-r" ) ) value = &options.random_plies;
+        else if ( string_equal ( argv[ i ] , "-s" ) ) value = &options.seed;
+
+        if ( !value || i + 1 >= argc || !string_to_u64 ( argv[ ++i ] , value ) || !*value )
+        {
+            output = 0;
+            break;
+        }
+    }
+    if ( !output )
+    {
+        LOGERROR ( "Usage: %s -o <output> [-t <threads>] [-g <games>] [-n <nodes>] [-r <random plies>] [-s <seed>] [-e <network>]"
+                 , argv[ 0 ]
+                 );
+        return 1;
+    }
+    if ( !dataset_filepath ( output ) )
+    {
+        LOGERROR ( "The output must be a packed dataset (*"DATASET_FILE_EXTENSION")." );
+        return 1;
+    }
+    thread_count = min ( thread_count , SELFPLAY_MAX_THREADS );
+    options.random_plies = min ( options.random_plies , GAME_MAX_PLY / 2ULL );
+
+    // Size the memory subsystem for the attack tables, the network, and one
+    // worker (search and queue) per thread.
+    if ( !memory_startup ( sizeof ( attacks_t )
+                         + sizeof ( nnue_t )
+                         + thread_count * ( sizeof ( selfplay_worker_t )
+                                          + sizeof ( move_search_t )
+                                          + SELFPLAY_QUEUE_CAPACITY * sizeof ( board_packed_t )
+                                          )
+                         + MEBIBYTES ( 16 )
+                         ))
+    {
+        return 1;
+    }
+    attacks_t* attacks = memory_allocate ( sizeof ( attacks_t ) , MEMORY_TAG_APPLICATION );
+    attacks_init ( attacks );
+    nnue_t* nnue = 0;
+    if ( network )
+    {
+        nnue = memory_allocate ( sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+        if ( !nnue_load ( network , nnue ) )
+        {
+            LOGERROR ( "Failed to load evaluation network '%s'." , network );
+            return 1;
+        }
+    }
+
+    file_handle_t file;
+    if ( !file_open ( output , FILE_MODE_WRITE , true , &file ) )
+    {
+        LOGERROR ( "Failed to open output file '%s'." , output );
+        return 1;
+    }
+
+    u64 next_game = 0;
+    selfplay_worker_t* workers = memory_allocate ( thread_count * sizeof ( selfplay_worker_t ) , MEMORY_TAG_APPLICATION );
+    for ( u32 i = 0; i < thread_count; ++i )
+    {
+        workers[ i ].attacks = attacks;
+        workers[ i ].options = &options;
+        workers[ i ].next_game = &next_game;
+        workers[ i ].search = memory_allocate ( sizeof ( move_search_t ) , MEMORY_TAG_APPLICATION );
+        ( *workers[ i ].search ).nnue = nnue;
+        workers[ i ].queue = memory_allocate ( SELFPLAY_QUEUE_CAPACITY * sizeof ( board_packed_t ) , MEMORY_TAG_APPLICATION );
+    }
+
+    // Start the workers. The calling thread is the writer, so every worker
+    // gets a thread of its own; the games are claimed one at a time, so a
+    // worker which fails to start only reduces the throughput.
+    clock_t clock;
+    clock_start ( &clock );
+    platform_thread_t threads[ SELFPLAY_MAX_THREADS ];
+    u32 started = 0;
+    for ( u32 i = 0; i < thread_count; ++i )
+    {
+        if ( !platform_thread_create ( selfplay_worker , &workers[ i ] , &threads[ i ] ) )
+        {
+            threads[ i ].handle = 0;
+            workers[ i ].done = true;
+            continue;
+        }
+        started += 1;
+    }
+    if ( !started )
+    {
+        LOGERROR ( "Failed to start any worker threads." );
+        return 1;
+    }
+    if ( started < thread_count )
+    {
+        LOGWARN ( "Started %u of %u worker threads." , started , ( u32 ) thread_count );
+    }
+    LOGINFO ( "Playing %llu games at %llu nodes per move on %u threads. . ." , options.games , options.nodes , started );
+
+    // Drain the queues until every worker is done. A worker queues its last
+    // game before it is marked done, so once every worker has been seen done,
+    // one more pass drains the queues for good.
+    u64 written = 0;
+    bool error = false;
+    f64 log_time = SELFPLAY_LOG_INTERVAL;
+    for (;;)
+    {
+        bool done = true;
+        for ( u32 i = 0; i < thread_count; ++i )
+        {
+            done &= __atomic_load_n ( &workers[ i ].done , __ATOMIC_ACQUIRE );
+        }
+        u64 drained = 0;
+        for ( u32 i = 0; i < thread_count; ++i )
+        {
+            drained += selfplay_drain ( &workers[ i ] , &file , &error );
+        }
+        written += drained;
+        if ( error )
+        {
+            // Stop handing out games.
+            __atomic_store_n ( &next_game , options.games , __ATOMIC_RELAXED );
+        }
+        if ( done )
+        {
+            break;
+        }
+
+        clock_update ( &clock );
+        if ( clock.elapsed >= log_time )
+        {
+            u64 games = 0;
+            for ( u32 i = 0; i < thread_count; ++i )
+            {
+                games += __atomic_load_n ( &workers[ i ].games , __ATOMIC_RELAXED );
+            }
+            LOGINFO ( "Played %llu of %llu games; wrote %llu positions (%llu positions/second)."
+                    , games , options.games , written , ( u64 )( written / clock.elapsed )
+                    );
+            log_time += SELFPLAY_LOG_INTERVAL;
+        }
+        if ( !drained )
+        {
+            platform_sleep ( 1 );
+        }
+    }
+    for ( u32 i = 0; i < thread_count; ++i )
+    {
+        if ( threads[ i ].handle )
+        {
+            platform_thread_join ( &threads[ i ] );
+        }
+    }
+    clock_update ( &clock );
+    file_close ( &file );
+
+    // Summary.
+    u64 games = 0;
+    u64 dropped = 0;
+    u64 nodes = 0;
+    u64 results[ 3 ] = { 0 , 0 , 0 };
+    for ( u32 i = 0; i < thread_count; ++i )
+    {
+        games += workers[ i ].games;
+        dropped += workers[ i ].dropped;
+        nodes += workers[ i ].nodes;
+        for ( u32 j = 0; j < 3; ++j )
+        {
+            results[ j ] += workers[ i ].results[ j ];
+        }
+    }
+    if ( error )
+    {
+        LOGERROR ( "Failed to write output file '%s'." , output );
+    }
+    LOGINFO ( "Played %llu games (+%llu =%llu -%llu for white); wrote %llu positions to '%s' in %f seconds."
+            , games , results[ 2 ] , results[ 1 ] , results[ 0 ] , written , output , clock.elapsed
+            );
+    LOGINFO ( "Searched %llu nodes (%llu nodes/second)."
+            , nodes , ( clock.elapsed > 0 ) ? ( u64 )( nodes / clock.elapsed ) : 0
+            );
+    if ( dropped )
+    {
+        LOGWARN ( "Dropped %llu positions: the output file could not keep up." , dropped );
+    }
+
+    for ( u32 i = 0; i < thread_count; ++i )
+    {
+        memory_free ( workers[ i ].queue , SELFPLAY_QUEUE_CAPACITY * sizeof ( board_packed_t ) , MEMORY_TAG_APPLICATION );
+        memory_free ( workers[ i ].search , sizeof ( move_search_t ) , MEMORY_TAG_APPLICATION );
+    }
+    memory_free ( workers , thread_count * sizeof ( selfplay_worker_t ) , MEMORY_TAG_APPLICATION );
+    if ( nnue )
+    {
+        memory_free ( nnue , sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+    }
+    memory_free ( attacks , sizeof ( attacks_t ) , MEMORY_TAG_APPLICATION );
+    memory_shutdown ();
+    return error;
+}
+
+u32
+selfplay_worker
+(   void* args
+)
+{
+    selfplay_worker_t* worker = args;
+    const u64 games = ( *( *worker ).options ).games;
+    u64 index;
+    while ( ( index = __atomic_fetch_add ( ( *worker ).next_game , 1 , __ATOMIC_RELAXED ) ) < games )
+    {
+        selfplay_game ( worker , index );
+        __atomic_store_n ( &( *worker ).games , ( *worker ).games + 1 , __ATOMIC_RELAXED );
+    }
+    __atomic_store_n ( &( *worker ).done , true , __ATOMIC_RELEASE );
+    return 0;
+}
+
+void
+selfplay_game
+(   selfplay_worker_t*  worker
+,   const u64           index
+)
+{
+    const attacks_t* attacks = ( *worker ).attacks;
+    const selfplay_options_t* options = ( *worker ).options;
+    move_search_t* search = ( *worker ).search;
+    game_t* game = &( *worker ).game;
+    const board_t* board = &( *game ).board;
+    board_t opening;
+    game_opening_random ( &opening , attacks , ( *options ).seed , index , ( *options ).random_plies );
+    game_start ( game , &opening , ( *options ).random_plies );
+
+    // Play.
+    u32 count = 0;
+    u8 result;
+    while ( !game_over ( game , attacks , &result ) )
+    {
+        ( *search ).stop = false;
+        ( *search ).time_limit = 0;
+        ( *search ).node_limit = ( *options ).nodes;
+        const move_t move = board_best_move ( board , attacks , MOVE_SEARCH_MAX_PLY , search );
+        const i32 score = ( ( *board ).side == WHITE ) ? ( *search ).result.score : -( *search ).result.score;
+        ( *worker ).nodes += ( *search ).result.nodes;
+
+        // Keep quiet positions.
+        if (    !board_check ( board , attacks , ( *board ).side )
+             && !move_decode_capture ( move )
+             && !move_decode_promotion ( move )
+             && !( *search ).result.forced_mate
+             && board_pack ( &( *worker ).records[ count ] , board )
+           )
+        {
+            ( *worker ).records[ count ].score = clamp ( score , -32767 , 32767 );
+            ( *worker ).records[ count ].ply = ( *game ).ply;
+            count += 1;
+        }
+
+        if ( game_adjudicate ( game , score , &result ) )
+        {
+            break;
+        }
+        game_move ( game , move , attacks );
+    }
+    ( *worker ).results[ result ] += 1;
+
+    // Label the positions with the result and queue them.
+    for ( u32 i = 0; i < count; ++i )
+    {
+        ( *worker ).records[ i ].result = result;
+    }
+    const u64 head = ( *worker ).head;
+    const u64 tail = __atomic_load_n ( &( *worker ).tail , __ATOMIC_ACQUIRE );
+    if ( SELFPLAY_QUEUE_CAPACITY - ( head - tail ) < count )
+    {
+        ( *worker ).dropped += count;
+        return;
+    }
+    for ( u32 i = 0; i < count; ++i )
+    {
+        ( *worker ).queue[ ( head + i ) & ( SELFPLAY_QUEUE_CAPACITY - 1 ) ] = ( *worker ).records[ i ];
+    }
+    ( *worker ).positions += count;
+    __atomic_store_n ( &( *worker ).head , head + count , __ATOMIC_RELEASE );
+}
+
+u64
+selfplay_drain
+(   selfplay_worker_t*  worker
+,   file_handle_t*      file
+,   bool*               error
+)
+{
+    const u64 head = __atomic_load_n ( &( *worker ).head , __ATOMIC_ACQUIRE );
+    const u64 tail = ( *worker ).tail;
+    if ( head == tail )
+    {
+        return 0;
+    }
+
+    // The records wrap around the end of the queue at most once.
+    const u64 begin = tail & ( SELFPLAY_QUEUE_CAPACITY - 1 );
+    const u64 first = min ( head - tail , SELFPLAY_QUEUE_CAPACITY - begin );
+    u64 written;
+    if (    !file_write ( file , first * sizeof ( board_packed_t ) , &( *worker ).queue[ begin ] , &written )
+         || written != first * sizeof ( board_packed_t )
+         || ( head - tail > first
+              && ( !file_write ( file , ( head - tail - first ) * sizeof ( board_packed_t ) , ( *worker ).queue , &written )
+                   || written != ( head - tail - first ) * sizeof ( board_packed_t )
+                 ))
+       )
+    {
+        *error = true;
+    }
+
+    __atomic_store_n ( &( *worker ).tail , head , __ATOMIC_RELEASE );
+    return head - tail;
+}
\ No newline at end of file
@@ -0,0 +1,403 @@
+/**
+ * @file main.c
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Entry point for the SPSA search parameter tuner.
+ *
+ * Tunes the search parameters (see chess/param.h) by simultaneous
+ * perturbation stochastic approximation (SPSA): each iteration perturbs every
+ * tuned parameter at once, up and down by a random sign, plays a short match
+ * between the two resulting configurations (see chess/match.h), and moves the
+ * parameters towards the configuration which scored better.
+ *
+ * Usage: spsa -o <output> [-i <iterations>] [-g <game pairs>] [-t <threads>]
+ *                         [-f <configuration>] [-p <parameter>] [-b <openings>]
+ *                         [-r <random plies>] [-s <seed>] [-n <nodes>]
+ *                         [-m <movetime ms>] [-c <base s>+<increment s>]
+ *                         [-d <depth>] [-e <network>]
+ *
+ * The parameters start from their defaults, or from a configuration file
+ * (-f). Every parameter is tuned, or, with one or more -p options, only the
+ * named ones; the others keep their starting values. The tuned values are
+ * written to the output configuration file after every iteration, so a run
+ * may be stopped at any time.
+ *
+ * By default, the games are played under a short clock (SPSA_DEFAULT_BASE
+ * seconds plus SPSA_DEFAULT_INCREMENT per move), so that the tuner optimises
+ * strength per unit of time, and a parameter which buys strength with more
+ * nodes pays for them; a node count (-n), move time (-m), depth (-d) or clock
+ * (-c) replaces it. The openings are read from a FEN/EPD file or a packed
+ * dataset (-b) and used in turn across iterations, or, without one, are made
+ * of random legal moves.
+ *
+ * The gains follow the usual schedule, in terms of the iteration k of N and
+ * the tuning step c of each parameter (see search_param_t):
+ *
+ *     c_k = c * N^SPSA_GAMMA / k^SPSA_GAMMA
+ *     a_k = SPSA_R_END * c^2 * ( A + N )^SPSA_ALPHA / ( A + k )^SPSA_ALPHA
+ *
+ * with A = SPSA_A_RATIO * N, so that the perturbation ends at c, and the
+ * last steps move a parameter by about SPSA_R_END * c per game won. Each
+ * iteration then updates
+ *
+ *     theta += a_k * ( wins - losses ) / ( c_k * delta )
+ *
+ * where delta = +/-1 is the sign of the perturbation and the result is that
+ * of the configuration perturbed up, theta + c_k * delta.
+ */
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/memory.h"
+#include "core/string.h"
+
+#include "math/math.h"
+
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include "chess/chess.h"
+
+// Defines default tuning parameters.
+#define SPSA_DEFAULT_ITERATIONS         1000
+#define SPSA_DEFAULT_PAIRS              8
+#define SPSA_DEFAULT_RANDOM_PLIES       8
+#define SPSA_DEFAULT_BASE               1.0
+#define SPSA_DEFAULT_INCREMENT          0.01
+
+// Defines the SPSA gain schedule.
+#define SPSA_ALPHA                      0.602
+#define SPSA_GAMMA                      0.101
+#define SPSA_A_RATIO                    0.1
+#define SPSA_R_END                      0.002
+
+/**
+ * @brief Generates a pseudo-random number (splitmix64).
+ * @param state The generator state.
+ * @return A pseudo-random number.
+ */
+INLINE
+u64
+spsa_random
+(   u64* state
+)
+{
+    u64 x = ( *state += 0x9E3779B97F4A7C15ULL );
+    x = ( x ^ ( x >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+    x = ( x ^ ( x >> 27 ) ) * 0x94D049BB133111EBULL;
+    return x ^ ( x >> 31 );
+}
+
+/**
+ * @brief Raises a positive number to a power.
+ * @param x The base (positive).
+ * @param y The exponent.
+ * @return x^y.
+ */
+INLINE
+f64
+spsa_pow
+(   const f64 x
+,   const f64 y
+)
+{
+    return exp ( y * log ( x ) );
+}
+
+/**
+ * @brief Rounds a parameter value to the nearest integer within the range
+ * of the parameter.
+ * @param param The parameter.
+ * @param x The value.
+ * @return The rounded value.
+ */
+INLINE
+i32
+spsa_round
+(   const SEARCH_PARAM  param
+,   const f64           x
+)
+{
+    const f64 y = clamp ( x , ( f64 )( *search_param ( param ) ).min , ( f64 )( *search_param ( param ) ).max );
+    return ( y >= 0 ) ? ( i32 )( y + 0.5 ) : -( i32 )( 0.5 - y );
+}
+
+int
+main
+(   int     argc
+,   char**  argv
+)
+{
+    const char* output = 0;
+    const char* config = 0;
+    const char* openings = 0;
+    const char* network = 0;
+    u64 iterations = SPSA_DEFAULT_ITERATIONS;
+    u64 thread_count = platform_processor_count ();
+    u64 seed = 1;
+    u64 movetime = 0;
+    u64 depth = 0;
+    bool tuned[ SEARCH_PARAM_COUNT ];
+    bool tune_all = true;
+    memory_clear ( tuned , sizeof ( tuned ) );
+
+    match_t state;
+    memory_clear ( &state , sizeof ( state ) );
+    match_t* match = &state;
+    match_engine_t* engine = &( *match ).engines[ 0 ];
+    ( *match ).pairs = SPSA_DEFAULT_PAIRS;
+    ( *match ).random_plies = SPSA_DEFAULT_RANDOM_PLIES;
+
+    // Parse command line.
+    bool valid = true;
+    for ( i32 i = 1; i < argc && valid; ++i )
+    {
+        const char* arg = argv[ i ];
+        u64* value = 0;
+        if ( string_equal ( arg , "-o" ) && i + 1 < argc )
+        {
+            output = argv[ ++i ];
+            continue;
+        }
+        else if ( string_equal ( arg , "-f" ) && i + 1 < argc )
+        {
+            config = argv[ ++i ];
+            continue;
+        }
+        else if ( string_equal ( arg , "-b" ) && i + 1 < argc )
+        {
+            openings = argv[ ++i ];
+            continue;
+        }
+        else if ( string_equal ( arg , "-e" ) && i + 1 < argc )
+        {
+            network = argv[ ++i ];
+            continue;
+        }
+        else if ( string_equal ( arg , "-p" ) && i + 1 < argc )
+        {
+            const SEARCH_PARAM param = search_param_find ( argv[ ++i ] );
+            if ( param == SEARCH_PARAM_COUNT )
+            {
+                LOGERROR ( "Unknown search parameter '%s'." , argv[ i ] );
+                valid = false;
+                break;
+            }
+            tuned[ param ] = true;
+            tune_all = false;
+            continue;
+        }
+        else if ( string_equal ( arg , "-c" ) && i + 1 < argc )
+        {
+            // Clock: <base>+<increment>, in seconds.
+            const char* s = argv[ ++i ];
+            char base[ 32 ];
+            u32 k = 0;
+            while ( s[ k ] && s[ k ] != '+' && k < sizeof ( base ) - 1 )
+            {
+                base[ k ] = s[ k ];
+                k += 1;
+            }
+            base[ k ] = 0;
+            ( *engine ).increment = 0;
+            valid = string_to_f64 ( base , &( *engine ).base )
+                 && ( *engine ).base > 0
+                 && ( !s[ k ] || ( s[ k ] == '+' && string_to_f64 ( s + k + 1 , &( *engine ).increment ) ) )
+                 ;
+            continue;
+        }
+        else if ( string_equal ( arg , "-i" ) ) value = &iterations;
+        else if ( string_equal ( arg , "-g" ) ) value = &( *match ).pairs;
+        else if ( string_equal ( arg , "-t" ) ) value = &thread_count;
+        else if ( string_equal ( arg , "-r" ) ) value = &( *match ).random_plies;
+        else if ( string_equal ( arg , "-s" ) ) value = &seed;
+        else if ( string_equal ( arg , "-n" ) ) value = &( *engine ).nodes;
+        else if ( string_equal ( arg , "-m" ) ) value = &movetime;
+        else if ( string_equal ( arg , "-d" ) ) value = &depth;
+        valid = value && i + 1 < argc && string_to_u64 ( argv[ ++i ] , value ) && *value;
+    }
+    if ( !valid || !output )
+    {
+        LOGERROR ( "Usage: %s -o <output> [-i <iterations>] [-g <game pairs>] [-t <threads>] [-f <configuration>] [-p <parameter>] [-b <openings>] [-r <random plies>] [-s <seed>] [-n <nodes>] [-m <movetime ms>] [-c <base s>+<increment s>] [-d <depth>] [-e <network>]"
+                 , argv[ 0 ]
+                 );
+        return 1;
+    }
+    if ( tune_all )
+    {
+        for ( SEARCH_PARAM param = 0; param < SEARCH_PARAM_COUNT; ++param )
+        {
+            tuned[ param ] = true;
+        }
+    }
+    ( *match ).thread_count = min ( thread_count , ( u64 ) MATCH_MAX_THREADS );
+    ( *match ).random_plies = min ( ( *match ).random_plies , GAME_MAX_PLY / 2ULL );
+    ( *engine ).movetime = movetime / 1000.0;
+    ( *engine ).depth = ( depth ) ? min ( depth , ( u64 ) MOVE_SEARCH_MAX_PLY ) : MOVE_SEARCH_MAX_PLY;
+    if ( !( *engine ).nodes && !movetime && !depth && !( *engine ).base )
+    {
+        ( *engine ).base = SPSA_DEFAULT_BASE;
+        ( *engine ).increment = SPSA_DEFAULT_INCREMENT;
+    }
+
+    // Size the memory subsystem for the attack tables, the network, the
+    // openings and the match.
+    if ( !memory_startup ( sizeof ( attacks_t )
+                         + sizeof ( nnue_t )
+                         + ( ( openings ) ? match_openings_memory_requirement ( openings ) : 0 )
+                         + match_memory_requirement ( ( *match ).thread_count )
+                         + MEBIBYTES ( 16 )
+                         ))
+    {
+        return 1;
+    }
+    attacks_t* attacks = memory_allocate ( sizeof ( attacks_t ) , MEMORY_TAG_APPLICATION );
+    attacks_init ( attacks );
+    ( *match ).attacks = attacks;
+    nnue_t* nnue = 0;
+    if ( network )
+    {
+        nnue = memory_allocate ( sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+        if ( !nnue_load ( network , nnue ) )
+        {
+            LOGERROR ( "Failed to load evaluation network '%s'." , network );
+            return 1;
+        }
+        ( *engine ).nnue = nnue;
+    }
+    search_params_t start;
+    search_params_default ( &start );
+    if ( config && !search_params_load ( &start , config ) )
+    {
+        return 1;
+    }
+    match_openings_t opening_set;
+    memory_clear ( &opening_set , sizeof ( opening_set ) );
+    if ( openings )
+    {
+        if ( !match_openings_open ( openings , &opening_set ) )
+        {
+            return 1;
+        }
+        if ( !opening_set.count )
+        {
+            LOGERROR ( "No valid openings in '%s'." , openings );
+            return 1;
+        }
+    }
+
+    // Both engines share everything but the parameters.
+    memory_copy ( &( *match ).engines[ 1 ] , engine , sizeof ( match_engine_t ) );
+
+    // Gain schedule constants.
+    const f64 n = iterations;
+    const f64 a_offset = SPSA_A_RATIO * n;
+    f64 theta[ SEARCH_PARAM_COUNT ];
+    for ( SEARCH_PARAM param = 0; param < SEARCH_PARAM_COUNT; ++param )
+    {
+        theta[ param ] = start.values[ param ];
+    }
+
+    LOGINFO ( "Tuning for %llu iterations of %llu game pairs on %u threads. . ."
+            , iterations , ( *match ).pairs , ( *match ).thread_count
+            );
+    clock_t clock;
+    clock_start ( &clock );
+    u64 random = seed;
+    u64 games[ 3 ] = { 0 , 0 , 0 };
+    for ( u64 k = 1; k <= iterations; ++k )
+    {
+        // Perturb.
+        const f64 c_scale = spsa_pow ( n , SPSA_GAMMA ) / spsa_pow ( k , SPSA_GAMMA );
+        const f64 a_scale = spsa_pow ( a_offset + n , SPSA_ALPHA ) / spsa_pow ( a_offset + k , SPSA_ALPHA );
+        f64 delta[ SEARCH_PARAM_COUNT ];
+        for ( SEARCH_PARAM param = 0; param < SEARCH_PARAM_COUNT; ++param )
+        {
+            delta[ param ] = ( spsa_random ( &random ) & 1 ) ? 1.0 : -1.0;
+            const f64 c_k = ( tuned[ param ] ) ? ( *search_param ( param ) ).step * c_scale : 0;
+            ( *match ).engines[ 0 ].params.values[ param ] = spsa_round ( param , theta[ param ] + c_k * delta[ param ] );
+            ( *match ).engines[ 1 ].params.values[ param ] = spsa_round ( param , theta[ param ] - c_k * delta[ param ] );
+        }
+
+        // Play. The openings are used in turn across iterations.
+        ( *match ).seed = seed + k * ( *match ).pairs;
+        if ( opening_set.count )
+        {
+            const u64 offset = ( ( k - 1 ) * ( *match ).pairs ) % opening_set.count;
+            ( *match ).openings = opening_set.records + offset;
+            ( *match ).opening_count = opening_set.count - offset;
+        }
+        if ( !match_run ( match ) )
+        {
+            return 1;
+        }
+        const i64 result = ( i64 )( *match ).results[ 2 ] - ( i64 )( *match ).results[ 0 ];
+        for ( u32 i = 0; i < 3; ++i )
+        {
+            games[ i ] += ( *match ).results[ i ];
+        }
+
+        // Update.
+        search_params_t params;
+        memory_copy ( &params , &start , sizeof ( params ) );
+        for ( SEARCH_PARAM param = 0; param < SEARCH_PARAM_COUNT; ++param )
+        {
+            if ( tuned[ param ] )
+            {
+                const f64 c = ( *search_param ( param ) ).step;
+                const f64 c_k = c * c_scale;
+                const f64 a_k = SPSA_R_END * c * c * a_scale;
+                theta[ param ] = clamp ( theta[ param ] + a_k * result / ( c_k * delta[ param ] )
+                                       , ( f64 )( *search_param ( param ) ).min
+                                       , ( f64 )( *search_param ( param ) ).max
+                                       );
+                params.values[ param ] = spsa_round ( param , theta[ param ] );
+            }
+        }
+        if ( !search_params_save ( &params , output ) )
+        {
+            return 1;
+        }
+
+        // Log.
+        clock_update ( &clock );
+        char buf[ STACK_STRING_MAX_LENGTH ];
+        u64 len = string_format ( buf , "Iteration %llu/%llu (%.1fs): %+lli (+%llu =%llu -%llu);"
+                                , k , iterations , clock.elapsed , result
+                                , ( *match ).results[ 2 ] , ( *match ).results[ 1 ] , ( *match ).results[ 0 ]
+                                );
+        for ( SEARCH_PARAM param = 0; param < SEARCH_PARAM_COUNT; ++param )
+        {
+            if ( tuned[ param ] && len + SEARCH_PARAM_NAME_MAX_LENGTH + 32 < sizeof ( buf ) )
+            {
+                len += string_format ( buf + len , " %s=%.1f" , ( *search_param ( param ) ).name , theta[ param ] );
+            }
+        }
+        LOGINFO ( "%s" , buf );
+    }
+
+    // Summary.
+    LOGINFO ( "Played %llu games (+%llu =%llu -%llu for the upward perturbations) in %f seconds. Tuned parameters (%s):"
+            , games[ 0 ] + games[ 1 ] + games[ 2 ] , games[ 2 ] , games[ 1 ] , games[ 0 ]
+            , clock.elapsed , output
+            );
+    for ( SEARCH_PARAM param = 0; param < SEARCH_PARAM_COUNT; ++param )
+    {
+        if ( tuned[ param ] )
+        {
+            LOGINFO ( "    %s = %i (from %i)"
+                    , ( *search_param ( param ) ).name , spsa_round ( param , theta[ param ] ) , start.values[ param ]
+                    );
+        }
+    }
+
+    if ( openings )
+    {
+        match_openings_close ( &opening_set );
+    }
+    if ( nnue )
+    {
+        memory_free ( nnue , sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+    }
+    memory_free ( attacks , sizeof ( attacks_t ) , MEMORY_TAG_APPLICATION );
+    memory_shutdown ();
+    return 0;
+}
\ No newline at end of file
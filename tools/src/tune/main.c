@@ -0,0 +1,908 @@
+/**
+ * @file main.c
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Entry point for the evaluation tuner program.
+ *
+ * Minimizes the mean squared error between game results and a sigmoid of the
+ * static evaluation (Texel's tuning method) over a labelled FEN/EPD dataset,
+ * then writes the tuned material and positional tables out in the format of
+ * chess/score.h.
+ *
+ * Usage: tune <dataset> [-o <output>] [-t <threads>] [-e <epochs>]
+ *                       [-r <learning rate>]
+ *
+ * Each dataset line holds a FEN (or EPD) position and a result from white's
+ * perspective, given either as "1-0", "0-1" or "1/2-1/2" (optionally quoted,
+ * as in the EPD c9 opcode) or as a bracketed score such as [1.0], [0.5],
+ * [0.0]; lines are parsed by board_packed_parse, and unlabelled lines are
+ * skipped. A packed dataset (see chess/packed.h) is read directly instead, by
+ * its file extension; its unlabelled records are skipped.
+ */
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/memory.h"
+#include "core/string.h"
+
+#include "math/math.h"
+
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include "chess/chess.h"
+#include "chess/score.h"
+
+// Defines default tuner parameters.
+#define TUNE_DEFAULT_OUTPUT_FILEPATH    "score.h"
+#define TUNE_DEFAULT_EPOCHS             1000
+#define TUNE_DEFAULT_LEARNING_RATE      1.0
+#define TUNE_LOG_INTERVAL               50
+
+// Defines buffer sizes.
+#define TUNE_READ_BUFFER_SIZE   ( MEBIBYTES ( 4 ) )
+#define TUNE_LINE_MAX_LENGTH    512ULL
+#define TUNE_MAX_THREADS        64ULL
+
+// Defines the layout of the tuned parameter vector: material scores (pawn
+// through queen; the king's cancels out), then one positional table each for
+// the pawn, knight, bishop, rook and king (the queen has none).
+#define TUNE_MATERIAL_OFFS      0
+#define TUNE_POSITIONAL_OFFS    5
+#define TUNE_PARAM_COUNT        ( TUNE_POSITIONAL_OFFS + 5 * 64 )
+
+// Positional table index for each piece kind (-1 if none).
+static const i32 tune_positional_table[ 6 ] = { 0 , 1 , 2 , 3 , -1 , 4 };
+
+// Defines the compact position encoding. Each position is stored as a u8
+// result (0 = black win, 1 = draw, 2 = white win), a u8 feature count, then
+// one u16 feature per non-king piece: bits 0-2 hold the piece kind, bits 3-8
+// the table square (mirrored for black), and bit 15 is set for black.
+#define TUNE_FEATURE_BLACK  0x8000
+#define TUNE_POSITION_SIZE(count) ( 2 + 2 * (count) )
+
+// Type definition for the state of a tuner worker thread.
+typedef struct
+{
+    // Input.
+    const u8*   begin;
+    const u8*   end;
+    const f64*  params;
+    f64         k;
+    bool        gradient;
+
+    // Output.
+    f64         error;
+    f64         grad[ TUNE_PARAM_COUNT ];
+}
+tune_worker_t;
+
+// Type definition for the tuner state.
+typedef struct
+{
+    // Dataset.
+    u8*             positions;
+    u64             positions_size;
+    u64             positions_capacity;
+    u64             position_count;
+
+    // Parameters.
+    f64             params[ TUNE_PARAM_COUNT ];
+    f64             k;
+
+    // Workers.
+    u32             thread_count;
+    tune_worker_t   workers[ TUNE_MAX_THREADS ];
+}
+tune_t;
+
+/**
+ * @brief Loads a dataset into the compact position array.
+ * @param filepath The dataset filepath.
+ * @param tune The tuner state.
+ * @return true on success, false otherwise.
+ */
+bool
+tune_load
+(   const char* filepath
+,   tune_t*     tune
+);
+
+/**
+ * @brief Loads a packed dataset into the compact position array.
+ * @param filepath The dataset filepath.
+ * @param tune The tuner state.
+ * @return true on success, false otherwise.
+ */
+bool
+tune_load_packed
+(   const char* filepath
+,   tune_t*     tune
+);
+
+/**
+ * @brief Parses a single dataset line and appends it to the compact position
+ * array.
+ * @param line The line to parse (null-terminated).
+ * @param tune The tuner state.
+ * @return true if a position was appended, false otherwise.
+ */
+bool
+tune_parse_line
+(   const char* line
+,   tune_t*     tune
+);
+
+/**
+ * @brief Encodes a position and appends it to the compact position array.
+ * @param board The position.
+ * @param result The result (see TUNE_POSITION_SIZE).
+ * @param tune The tuner state.
+ * @return true if the position was appended, false otherwise.
+ */
+bool
+tune_encode
+(   const board_t*  board
+,   const u8        result
+,   tune_t*         tune
+);
+
+/**
+ * @brief Computes the error (and optionally the error gradient) of the
+ * current parameters across all threads.
+ * @param tune The tuner state.
+ * @param k Sigmoid scaling constant.
+ * @param gradient Output buffer for the gradient (may be 0).
+ * @return The mean squared error.
+ */
+f64
+tune_error
+(   tune_t*     tune
+,   const f64   k
+,   f64*        gradient
+);
+
+/**
+ * @brief Worker thread entry point (see tune_error).
+ * @param args A tune_worker_t.
+ * @return 0.
+ */
+u32
+tune_worker
+(   void* args
+);
+
+/**
+ * @brief Fits the sigmoid scaling constant to the initial parameters.
+ * @param tune The tuner state.
+ */
+void
+tune_fit_k
+(   tune_t* tune
+);
+
+/**
+ * @brief Writes the tuned tables to a file in the format of chess/score.h.
+ * @param filepath The output filepath.
+ * @param tune The tuner state.
+ * @return true on success, false otherwise.
+ */
+bool
+tune_write
+(   const char*     filepath
+,   const tune_t*   tune
+);
+
+int
+main
+(   int     argc
+,   char**  argv
+)
+{
+    const char* input = 0;
+    const char* output = TUNE_DEFAULT_OUTPUT_FILEPATH;
+    u64 thread_count = platform_processor_count ();
+    u64 epochs = TUNE_DEFAULT_EPOCHS;
+    f64 rate = TUNE_DEFAULT_LEARNING_RATE;
+
+    // Parse command line.
+    for ( i32 i = 1; i < argc; ++i )
+    {
+        if ( string_equal ( argv[ i ] , "-o" ) && i + 1 < argc )
+        {
+            output = argv[ ++i ];
+        }
+        else if ( string_equal ( argv[ i ] , "-t" ) && i + 1 < argc )
+        {
+            if ( !string_to_u64 ( argv[ ++i ] , &thread_count ) || !thread_count )
+            {
+                LOGERROR ( "Invalid thread count '%s'." , argv[ i ] );
+                return 1;
+            }
+        }
+        else if ( string_equal ( argv[ i ] , "-e" ) && i + 1 < argc )
+        {
+            if ( !string_to_u64 ( argv[ ++i ] , &epochs ) )
+            {
+                LOGERROR ( "Invalid epoch count '%s'." , argv[ i ] );
+                return 1;
+            }
+        }
+        else if ( string_equal ( argv[ i ] , "-r" ) && i + 1 < argc )
+        {
+            if ( !string_to_f64 ( argv[ ++i ] , &rate ) )
+            {
+                LOGERROR ( "Invalid learning rate '%s'." , argv[ i ] );
+                return 1;
+            }
+        }
+        else if ( !input )
+        {
+            input = argv[ i ];
+        }
+        else
+        {
+            LOGERROR ( "Unrecognized argument '%s'." , argv[ i ] );
+            return 1;
+        }
+    }
+    if ( !input )
+    {
+        LOGERROR ( "Usage: %s <dataset> [-o <output>] [-t <threads>] [-e <epochs>] [-r <learning rate>]"
+                 , argv[ 0 ]
+                 );
+        return 1;
+    }
+
+    // Size the memory subsystem for the dataset. A compact position never
+    // takes more than twice as many bytes as the text line it was read from,
+    // nor more than three times as many as the packed record.
+    file_handle_t file;
+    u64 size;
+    if ( !file_open ( input , FILE_MODE_READ , true , &file ) || !file_size ( &file , &size ) )
+    {
+        LOGERROR ( "Unable to open dataset '%s'." , input );
+        return 1;
+    }
+    file_close ( &file );
+    size *= dataset_filepath ( input ) ? 3 : 2;
+    if ( !memory_startup ( size + sizeof ( tune_t ) + TUNE_READ_BUFFER_SIZE + MEBIBYTES ( 64 ) ) )
+    {
+        return 1;
+    }
+
+    tune_t* tune = memory_allocate ( sizeof ( tune_t ) , MEMORY_TAG_APPLICATION );
+    ( *tune ).thread_count = min ( thread_count , TUNE_MAX_THREADS );
+    ( *tune ).positions_capacity = size + TUNE_POSITION_SIZE ( 32 );
+    ( *tune ).positions = memory_allocate ( ( *tune ).positions_capacity , MEMORY_TAG_APPLICATION );
+
+    // Initial parameters.
+    for ( PIECE piece = P; piece <= Q; ++piece )
+    {
+        ( *tune ).params[ TUNE_MATERIAL_OFFS + piece ] = material_scores[ piece ];
+    }
+    for ( SQUARE square = 0; square < 64; ++square )
+    {
+        ( *tune ).params[ TUNE_POSITIONAL_OFFS + 0 * 64 + square ] = pawn_positional_scores[ square ];
+        ( *tune ).params[ TUNE_POSITIONAL_OFFS + 1 * 64 + square ] = knight_positional_scores[ square ];
+        ( *tune ).params[ TUNE_POSITIONAL_OFFS + 2 * 64 + square ] = bishop_positional_scores[ square ];
+        ( *tune ).params[ TUNE_POSITIONAL_OFFS + 3 * 64 + square ] = rook_positional_scores[ square ];
+        ( *tune ).params[ TUNE_POSITIONAL_OFFS + 4 * 64 + square ] = king_positional_scores[ square ];
+    }
+
+    // Load dataset.
+    clock_t clock;
+    clock_start ( &clock );
+    if ( !( dataset_filepath ( input ) ? tune_load_packed ( input , tune )
+                                       : tune_load ( input , tune )
+          ))
+    {
+        return 1;
+    }
+    clock_update ( &clock );
+    LOGINFO ( "Loaded %llu positions (%llu bytes) in %f seconds."
+            , ( *tune ).position_count
+            , ( *tune ).positions_size
+            , clock.elapsed
+            );
+    if ( !( *tune ).position_count )
+    {
+        LOGERROR ( "Dataset '%s' contains no labelled positions." , input );
+        return 1;
+    }
+
+    // Split the dataset evenly across the worker threads.
+    const u8* position = ( *tune ).positions;
+    const u8* const end = ( *tune ).positions + ( *tune ).positions_size;
+    for ( u32 i = 0; i < ( *tune ).thread_count; ++i )
+    {
+        const u64 count = ( *tune ).position_count / ( *tune ).thread_count
+                        + ( i < ( *tune ).position_count % ( *tune ).thread_count )
+                        ;
+        ( *tune ).workers[ i ].begin = position;
+        for ( u64 j = 0; j < count; ++j )
+        {
+            position += TUNE_POSITION_SIZE ( position[ 1 ] );
+        }
+        ( *tune ).workers[ i ].end = ( i == ( *tune ).thread_count - 1 ) ? end : position;
+        ( *tune ).workers[ i ].params = ( *tune ).params;
+    }
+
+    tune_fit_k ( tune );
+
+    // Minimize the error with Adam.
+    f64 gradient[ TUNE_PARAM_COUNT ];
+    f64 m[ TUNE_PARAM_COUNT ];
+    f64 v[ TUNE_PARAM_COUNT ];
+    memory_clear ( m , sizeof ( m ) );
+    memory_clear ( v , sizeof ( v ) );
+    const f64 beta1 = 0.9;
+    const f64 beta2 = 0.999;
+    f64 beta1_t = 1.0;
+    f64 beta2_t = 1.0;
+    clock_start ( &clock );
+    for ( u64 epoch = 1; epoch <= epochs; ++epoch )
+    {
+        const f64 error = tune_error ( tune , ( *tune ).k , gradient );
+        beta1_t *= beta1;
+        beta2_t *= beta2;
+        for ( u32 i = 0; i < TUNE_PARAM_COUNT; ++i )
+        {
+            m[ i ] = beta1 * m[ i ] + ( 1.0 - beta1 ) * gradient[ i ];
+            v[ i ] = beta2 * v[ i ] + ( 1.0 - beta2 ) * gradient[ i ] * gradient[ i ];
+            ( *tune ).params[ i ] -= rate * ( m[ i ] / ( 1.0 - beta1_t ) )
+                                   / ( sqrt ( v[ i ] / ( 1.0 - beta2_t ) ) + 1e-8 )
+                                   ;
+        }
+        if ( epoch % TUNE_LOG_INTERVAL == 0 || epoch == epochs )
+        {
+            clock_update ( &clock );
+            LOGINFO ( "Epoch %llu / %llu: error %.8f (%f seconds)."
+                    , epoch , epochs , error , clock.elapsed
+                    );
+        }
+    }
+    LOGINFO ( "Final error: %.8f." , tune_error ( tune , ( *tune ).k , 0 ) );
+
+    if ( !tune_write ( output , tune ) )
+    {
+        return 1;
+    }
+    LOGINFO ( "Wrote tuned tables to '%s'." , output );
+
+    memory_free ( ( *tune ).positions , ( *tune ).positions_capacity , MEMORY_TAG_APPLICATION );
+    memory_free ( tune , sizeof ( tune_t ) , MEMORY_TAG_APPLICATION );
+    memory_shutdown ();
+    return 0;
+}
+
+bool
+tune_load
+(   const char* filepath
+,   tune_t*     tune
+)
+{
+    file_handle_t file;
+    if ( !file_open ( filepath , FILE_MODE_READ , true , &file ) )
+    {
+        LOGERROR ( "tune_load: Unable to open dataset '%s'." , filepath );
+        return false;
+    }
+
+    // Stream the file in large chunks rather than line by line.
+    char* buffer = memory_allocate ( TUNE_READ_BUFFER_SIZE , MEMORY_TAG_APPLICATION );
+    char line[ TUNE_LINE_MAX_LENGTH ];
+    u64 line_length = 0;
+    u64 skipped = 0;
+    u64 read;
+    do
+    {
+        file_read ( &file , TUNE_READ_BUFFER_SIZE , buffer , &read );
+        for ( u64 i = 0; i <= read; ++i )
+        {
+            // A short read means EOF; flush the final unterminated line.
+            const bool eof = ( i == read );
+            if ( eof && read == TUNE_READ_BUFFER_SIZE )
+            {
+                break;
+            }
+            if ( eof || newline ( buffer[ i ] ) )
+            {
+                line[ min ( line_length , TUNE_LINE_MAX_LENGTH - 1 ) ] = 0;
+                if ( line_length && !tune_parse_line ( line , tune ) )
+                {
+                    skipped += 1;
+                }
+                line_length = 0;
+                continue;
+            }
+            if ( line_length < TUNE_LINE_MAX_LENGTH - 1 )
+            {
+                line[ line_length ] = buffer[ i ];
+            }
+            line_length += 1;
+        }
+    }
+    while ( read == TUNE_READ_BUFFER_SIZE );
+
+    memory_free ( buffer , TUNE_READ_BUFFER_SIZE , MEMORY_TAG_APPLICATION );
+    file_close ( &file );
+
+    if ( skipped )
+    {
+        LOGWARN ( "tune_load: Skipped %llu unlabelled or invalid lines." , skipped );
+    }
+    return true;
+}
+
+bool
+tune_load_packed
+(   const char* filepath
+,   tune_t*     tune
+)
+{
+    dataset_t dataset;
+    if ( !dataset_open ( filepath , &dataset ) )
+    {
+        LOGERROR ( "tune_load_packed: Unable to open dataset '%s'." , filepath );
+        return false;
+    }
+
+    u64 skipped = 0;
+    board_t board;
+    for ( u64 i = 0; i < dataset.record_count; ++i )
+    {
+        const board_packed_t* record = &dataset.records[ i ];
+        if (    ( *record ).result > 2
+             || !board_unpack ( &board , record )
+             || !tune_encode ( &board , ( *record ).result , tune )
+           )
+        {
+            skipped += 1;
+        }
+    }
+
+    dataset_close ( &dataset );
+
+    if ( skipped )
+    {
+        LOGWARN ( "tune_load_packed: Skipped %llu unlabelled or invalid records." , skipped );
+    }
+    return true;
+}
+
+bool
+tune_parse_line
+(   const char* line
+,   tune_t*     tune
+)
+{
+    // Parse as a packed record (see board_packed_parse); unlabelled lines are
+    // skipped.
+    board_packed_t packed;
+    board_t board;
+    if (    !board_packed_parse ( line , &packed )
+         || packed.result > 2
+         || !board_unpack ( &board , &packed )
+       )
+    {
+        return false;
+    }
+    return tune_encode ( &board , packed.result , tune );
+}
+
+bool
+tune_encode
+(   const board_t*  board
+,   const u8        result
+,   tune_t*         tune
+)
+{
+    u8* position = ( *tune ).positions + ( *tune ).positions_size;
+    u16* features = ( u16* )( position + 2 );
+    u8 count = 0;
+    for ( PIECE piece = P; piece <= k; ++piece )
+    {
+        if ( piece == K || piece == k )
+        {
+            continue;
+        }
+        const bool black = piece >= p;
+        bitboard_t bitboard = ( *board ).pieces[ piece ];
+        while ( bitboard && count < 32 )
+        {
+            const SQUARE square = bitboard_lsb ( bitboard );
+            const u16 feature = ( piece % 6 )
+                              | ( ( black ? mirror_position[ square ] : square ) << 3 )
+                              | ( black ? TUNE_FEATURE_BLACK : 0 )
+                              ;
+            memory_copy ( features + count , &feature , sizeof ( feature ) );
+            count += 1;
+            BITCLR ( bitboard , square );
+        }
+    }
+
+    // Kings always contribute a positional score.
+    const u16 white_king = K | ( bitboard_lsb ( ( *board ).pieces[ K ] ) << 3 );
+    const u16 black_king = K | ( mirror_position[ bitboard_lsb ( ( *board ).pieces[ k ] ) ] << 3 ) | TUNE_FEATURE_BLACK;
+    if ( !( *board ).pieces[ K ] || !( *board ).pieces[ k ] || count > 30 )
+    {
+        return false;
+    }
+    memory_copy ( features + count , &white_king , sizeof ( white_king ) );
+    memory_copy ( features + count + 1 , &black_king , sizeof ( black_king ) );
+    count += 2;
+
+    position[ 0 ] = result;
+    position[ 1 ] = count;
+    ( *tune ).positions_size += TUNE_POSITION_SIZE ( count );
+    ( *tune ).position_count += 1;
+    return true;
+}
+
+/**
+ * @brief Sigmoid mapping an evaluation to an expected score.
+ * @param score The evaluation (white relative).
+ * @param k Sigmoid scaling constant.
+ * @return Expected score in [ 0 , 1 ].
+ */
+INLINE
+f64
+tune_sigmoid
+(   const f64 score
+,   const f64 k
+)
+{
+    return 1.0 / ( 1.0 + exp ( -k * score * LN10 / 400.0 ) );
+}
+
+u32
+tune_worker
+(   void* args
+)
+{
+    tune_worker_t* worker = args;
+    const f64* params = ( *worker ).params;
+    const f64 k = ( *worker ).k;
+
+    ( *worker ).error = 0;
+    if ( ( *worker ).gradient )
+    {
+        memory_clear ( ( *worker ).grad , sizeof ( ( *worker ).grad ) );
+    }
+
+    const u8* position = ( *worker ).begin;
+    while ( position < ( *worker ).end )
+    {
+        const f64 result = position[ 0 ] * 0.5;
+        const u8 count = position[ 1 ];
+        const u8* features = position + 2;
+
+        // Evaluate.
+        f64 score = 0;
+        for ( u8 i = 0; i < count; ++i )
+        {
+            u16 feature;
+            memory_copy ( &feature , features + 2 * i , sizeof ( feature ) );
+            const u32 kind = feature & 0x7;
+            const u32 square = ( feature >> 3 ) & 0x3F;
+            const f64 sign = ( feature & TUNE_FEATURE_BLACK ) ? -1.0 : 1.0;
+            const i32 table = tune_positional_table[ kind ];
+            f64 value = ( kind < K ) ? params[ TUNE_MATERIAL_OFFS + kind ] : 0;
+            if ( table >= 0 )
+            {
+                value += params[ TUNE_POSITIONAL_OFFS + table * 64 + square ];
+            }
+            score += sign * value;
+        }
+
+        const f64 sigmoid = tune_sigmoid ( score , k );
+        const f64 delta = result - sigmoid;
+        ( *worker ).error += delta * delta;
+
+        // Accumulate the (unscaled) derivative of the error.
+        if ( ( *worker ).gradient )
+        {
+            const f64 g = -delta * sigmoid * ( 1.0 - sigmoid );
+            for ( u8 i = 0; i < count; ++i )
+            {
+                u16 feature;
+                memory_copy ( &feature , features + 2 * i , sizeof ( feature ) );
+                const u32 kind = feature & 0x7;
+                const u32 square = ( feature >> 3 ) & 0x3F;
+                const f64 signed_g = ( feature & TUNE_FEATURE_BLACK ) ? -g : g;
+                const i32 table = tune_positional_table[ kind ];
+                if ( kind < K )
+                {
+                    ( *worker ).grad[ TUNE_MATERIAL_OFFS + kind ] += signed_g;
+                }
+                if ( table >= 0 )
+                {
+                    ( *worker ).grad[ TUNE_POSITIONAL_OFFS + table * 64 + square ] += signed_g;
+                }
+            }
+        }
+
+        position += TUNE_POSITION_SIZE ( count );
+    }
+    return 0;
+}
+
+f64
+tune_error
+(   tune_t*     tune
+,   const f64   k
+,   f64*        gradient
+)
+{
+    platform_thread_t threads[ TUNE_MAX_THREADS ];
+    for ( u32 i = 0; i < ( *tune ).thread_count; ++i )
+    {
+        ( *tune ).workers[ i ].k = k;
+        ( *tune ).workers[ i ].gradient = gradient != 0;
+        if ( i && !platform_thread_create ( tune_worker , &( *tune ).workers[ i ] , &threads[ i ] ) )
+        {
+            // Fall back to running the slice on the calling thread.
+            tune_worker ( &( *tune ).workers[ i ] );
+            threads[ i ].handle = 0;
+        }
+    }
+    tune_worker ( &( *tune ).workers[ 0 ] );
+
+    f64 error = ( *tune ).workers[ 0 ].error;
+    for ( u32 i = 1; i < ( *tune ).thread_count; ++i )
+    {
+        if ( threads[ i ].handle )
+        {
+            platform_thread_join ( &threads[ i ] );
+        }
+        error += ( *tune ).workers[ i ].error;
+    }
+
+    const f64 n = ( *tune ).position_count;
+    if ( gradient )
+    {
+        // d/dp of mean ( r - sigmoid ( k * s ) )^2.
+        const f64 scale = 2.0 * k * LN10 / ( 400.0 * n );
+        for ( u32 j = 0; j < TUNE_PARAM_COUNT; ++j )
+        {
+            gradient[ j ] = 0;
+            for ( u32 i = 0; i < ( *tune ).thread_count; ++i )
+            {
+                gradient[ j ] += ( *tune ).workers[ i ].grad[ j ];
+            }
+            gradient[ j ] *= scale;
+        }
+    }
+    return error / n;
+}
+
+void
+tune_fit_k
+(   tune_t* tune
+)
+{
+    // Golden section search.
+    const f64 phi = 0.5 * ( sqrt ( 5.0 ) - 1.0 );
+    f64 a = 0.01;
+    f64 b = 4.0;
+    f64 c = b - phi * ( b - a );
+    f64 d = a + phi * ( b - a );
+    f64 fc = tune_error ( tune , c , 0 );
+    f64 fd = tune_error ( tune , d , 0 );
+    for ( u32 i = 0; i < 40; ++i )
+    {
+        if ( fc < fd )
+        {
+            b = d;
+            d = c;
+            fd = fc;
+            c = b - phi * ( b - a );
+            fc = tune_error ( tune , c , 0 );
+        }
+        else
+        {
+            a = c;
+            c = d;
+            fc = fd;
+            d = a + phi * ( b - a );
+            fd = tune_error ( tune , d , 0 );
+        }
+    }
+    ( *tune ).k = 0.5 * ( a + b );
+    LOGINFO ( "Fitted sigmoid scaling constant K = %f (error %.8f)."
+            , ( *tune ).k
+            , tune_error ( tune , ( *tune ).k , 0 )
+            );
+}
+
+/**
+ * @brief Writes a positional table.
+ * @param file Handle to the output file.
+ * @param name The table name.
+ * @param values The table values.
+ * @return true on success, false otherwise.
+ */
+bool
+tune_write_table
+(   file_handle_t*  file
+,   const char*     name
+,   const f64*      values
+)
+{
+    char line[ 256 ];
+    char prefix[ 128 ];
+    u64 offs;
+
+    const u64 indent = string_format ( prefix , "static const i32 %s[] = " , name );
+    for ( u32 r = 0; r < 8; ++r )
+    {
+        offs = 0;
+        if ( !r )
+        {
+            offs += string_format ( line , "%s{ " , prefix );
+        }
+        else
+        {
+            for ( u64 i = 0; i < indent; ++i )
+            {
+                line[ offs++ ] = ' ';
+            }
+            offs += string_format ( line + offs , ", " );
+        }
+        offs += string_format ( line + offs , "%2i" , ( i32 ) round ( values[ 8 * r ] ) );
+        for ( u32 f = 1; f < 8; ++f )
+        {
+            offs += string_format ( line + offs , " , %3i" , ( i32 ) round ( values[ 8 * r + f ] ) );
+        }
+        if ( !file_write_line ( file , line ) )
+        {
+            return false;
+        }
+    }
+    offs = 0;
+    for ( u64 i = 0; i < indent; ++i )
+    {
+        line[ offs++ ] = ' ';
+    }
+    string_format ( line + offs , "};" );
+    return file_write_line ( file , line );
+}
+
+bool
+tune_write
+(   const char*     filepath
+,   const tune_t*   tune
+)
+{
+    file_handle_t file;
+    if ( !file_open ( filepath , FILE_MODE_WRITE , false , &file ) )
+    {
+        LOGERROR ( "tune_write: Unable to open '%s' for writing." , filepath );
+        return false;
+    }
+
+    const f64* params = ( *tune ).params;
+    char line[ 256 ];
+    bool success = true;
+
+    success &= file_write_line ( &file , "/**\n"
+                                         " * @file score.h\n"
+                                         " * @author Matthew Weissel (null@mattweissel.info)\n"
+                                         " * @brief Evaluation tables used by the best move search.\n"
+                                         " * (see best.c; this file may be regenerated by the tune tool).\n"
+                                         " */\n"
+                                         "#ifndef CHESS_SCORE_H\n"
+                                         "#define CHESS_SCORE_H\n"
+                                         "\n"
+                                         "#include \"chess/common.h\"\n"
+                                         "\n"
+                                         "// Defines a material score for each piece."
+                               );
+
+    // Material.
+    static const char* names = "PNBRQK";
+    i32 material[ 6 ];
+    for ( PIECE piece = P; piece <= Q; ++piece )
+    {
+        material[ piece ] = round ( params[ TUNE_MATERIAL_OFFS + piece ] );
+    }
+    material[ K ] = material_scores[ K ];
+    for ( PIECE piece = P; piece <= K; ++piece )
+    {
+        string_format ( line , "%s[ %c ] = %i"
+                      , ( piece == P ) ? "static const i32 material_scores[] = { "
+                                       : "                                     , "
+                      , names[ piece ]
+                      , material[ piece ]
+                      );
+        success &= file_write_line ( &file , line );
+    }
+    for ( PIECE piece = P; piece <= K; ++piece )
+    {
+        string_format ( line , "                                     , [ %c ] = %i"
+                      , to_lowercase ( names[ piece ] )
+                      , -material[ piece ]
+                      );
+        success &= file_write_line ( &file , line );
+    }
+    success &= file_write_line ( &file , "                                     };\n"
+                                         "\n"
+                                         "// Defines a positional score table for each piece."
+                               );
+
+    // Positional.
+    success &= tune_write_table ( &file , "pawn_positional_scores" , params + TUNE_POSITIONAL_OFFS + 0 * 64 );
+    success &= tune_write_table ( &file , "knight_positional_scores" , params + TUNE_POSITIONAL_OFFS + 1 * 64 );
+    success &= tune_write_table ( &file , "bishop_positional_scores" , params + TUNE_POSITIONAL_OFFS + 2 * 64 );
+    success &= tune_write_table ( &file , "rook_positional_scores" , params + TUNE_POSITIONAL_OFFS + 3 * 64 );
+    success &= tune_write_table ( &file , "king_positional_scores" , params + TUNE_POSITIONAL_OFFS + 4 * 64 );
+
+    // Mirror table (unchanged).
+    success &= file_write_line ( &file , "\n"
+                                         "// Defines the mirror score table indices for calculating the opposite side's\n"
+                                         "// score."
+                               );
+    for ( u32 r = 0; r < 8; ++r )
+    {
+        u64 offs = string_format ( line , "%s"
+                                 , ( !r ) ? "static const SQUARE mirror_position[ 128 ] = { "
+                                          : "                                             , "
+                                 );
+        for ( u32 f = 0; f < 8; ++f )
+        {
+            offs += string_format ( line + offs , "%s%c%u" , ( f ) ? " , " : "" , 'A' + f , r + 1 );
+        }
+        success &= file_write_line ( &file , line );
+    }
+    success &= file_write_line ( &file , "                                             };" );
+
+    // Most-valuable victim versus least-valuable attacker, ranked by the
+    // tuned material scores (the king always ranks highest).
+    u32 rank[ 6 ];
+    for ( PIECE piece = P; piece <= K; ++piece )
+    {
+        rank[ piece ] = 0;
+        for ( PIECE other = P; other <= K; ++other )
+        {
+            if (   material[ other ] < material[ piece ]
+                || ( material[ other ] == material[ piece ] && other < piece )
+               )
+            {
+                rank[ piece ] += 1;
+            }
+        }
+    }
+    success &= file_write_line ( &file , "\n"
+                                         "// Defines most-valuable victim versus least-valuable attacker table."
+                               );
+    for ( u32 attacker = 0; attacker < 12; ++attacker )
+    {
+        if ( attacker == 6 )
+        {
+            success &= file_write_line ( &file , "" );
+        }
+        u64 offs = string_format ( line , "%s{ "
+                                 , ( !attacker ) ? "static const i32 mvv_lva[ 12 ][ 12 ] = { "
+                                                 : "                                       , "
+                                 );
+        for ( u32 victim = 0; victim < 12; ++victim )
+        {
+            offs += string_format ( line + offs , "%s%3u"
+                                  , ( !victim ) ? "" : ( victim == 6 ) ? " ,   " : " , "
+                                  , 100 * ( rank[ victim % 6 ] + 1 ) + 5 - rank[ attacker % 6 ]
+                                  );
+        }
+        string_format ( line + offs , " }" );
+        success &= file_write_line ( &file , line );
+    }
+    success &= file_write_line ( &file , "                                       };\n"
+                                         "\n"
+                                         "#endif  // CHESS_SCORE_H"
+                               );
+
+    file_close ( &file );
+    if ( !success )
+    {
+        LOGERROR ( "tune_write: Failed writing to '%s'." , filepath );
+    }
+    return success;
+}
\ No newline at end of file
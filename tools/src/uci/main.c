@@ -0,0 +1,781 @@
+/**
+ * @file main.c
+ * @author Matthew Weissel (null@mattweissel.info)
+ * @brief Entry point for the UCI protocol front end.
+ *
+ * A headless engine which speaks the Universal Chess Interface on standard
+ * input and output, for GUIs and automated play.
+ *
+ * Usage: cce-uci [bench [nodes <n>] [threads <n>]]
+ *
+ * Supported commands:
+ *
+ *     uci
+ *     isready
+ *     ucinewgame
+ *     setoption name <id> [value <x>]
+ *     position [startpos | fen <fen>] [moves <move> ...]
+ *     go [depth <n>] [nodes <n>] [movetime <ms>] [wtime <ms>] [btime <ms>]
+ *        [winc <ms>] [binc <ms>] [movestogo <n>] [infinite]
+ *     stop
+ *     quit
+ *     bench [nodes <n>] [threads <n>]
+ *
+ * The main thread only reads commands; each go runs board_best_move on a
+ * thread of its own. This way isready is answered while a search runs, and
+ * stop and quit interrupt it at once (see move_search_t); any other command
+ * waits for the search to end. An info
+ * line with the depth, score, node count, speed and principal variation is
+ * written after every completed iteration (see move_search_result_t), one
+ * with the progress every UCI_INFO_INTERVAL nodes, and a bestmove line once
+ * the search ends. Under go infinite, bestmove waits for stop.
+ *
+ * bench runs the fixed-node search benchmark (see bench_nodes), with
+ * BENCH_NODES nodes per position on one thread by default, and writes the
+ * total node count, the signature of the searches and the speed. The node
+ * count and the signature are the same on every run and for any number of
+ * threads, so they fingerprint the engine. Given on the command line, bench
+ * runs once, and the engine exits.
+ *
+ * Options:
+ *
+ *     EvalFile     Filepath of the evaluation network (empty for none).
+ *     BitbasePath  Directory of the endgame bitbases (empty for none).
+ *
+ * Every search parameter (see chess/param.h) is also an option of type spin,
+ * under its registry name and range.
+ */
+#include "core/clock.h"
+#include "core/logger.h"
+#include "core/memory.h"
+#include "core/string.h"
+
+#include "math/math.h"
+
+#include "platform/filesystem.h"
+#include "platform/platform.h"
+
+#include "chess/chess.h"
+#include "chess/test/bench.h"
+
+// Defines engine identification.
+#define UCI_ENGINE_NAME                 "cce"
+#define UCI_ENGINE_AUTHOR               "Matthew Weissel"
+
+// Defines default option values.
+#define UCI_DEFAULT_EVAL_FILE           "cce.nnue"
+#define UCI_DEFAULT_BITBASE_PATH        "."
+
+// Defines time management parameters (in milliseconds, except moves to go).
+#define UCI_DEFAULT_MOVES_TO_GO         30
+#define UCI_TIME_MARGIN                 50
+
+// Defines the number of nodes between two progress info lines.
+#define UCI_INFO_INTERVAL               1000000
+
+// Defines buffer sizes.
+#define UCI_TOKEN_MAX_LENGTH            256
+#define UCI_LINE_MAX_LENGTH             ( STACK_STRING_MAX_LENGTH )
+
+// Type definition for the front end state.
+typedef struct
+{
+    attacks_t           attacks;
+    file_handle_t       in;
+    file_handle_t       out;
+
+    // Current position.
+    board_t             board;
+
+    // Search.
+    move_search_t       search;
+    platform_thread_t   thread;
+    bool                searching;
+    bool                infinite;
+    u32                 depth;
+
+    // Options.
+    search_params_t     params;
+    nnue_t*             nnue;
+    bitbases_t          bitbases;
+}
+uci_t;
+
+/**
+ * @brief Search thread entry point. Runs the search, then writes the best
+ * move.
+ * @param args A uci_t.
+ * @return 0.
+ */
+u32
+uci_search
+(   void* args
+);
+
+/**
+ * @brief Search observer callback (see PFN_move_search_observer). Writes an
+ * info line.
+ * @param result The search result so far.
+ * @param args A uci_t.
+ */
+void
+uci_info
+(   const move_search_result_t* result
+,   void*                       args
+);
+
+/**
+ * @brief Executes a single command.
+ * @param uci The front end state.
+ * @param line The command line.
+ * @return false on quit, true otherwise.
+ */
+bool
+uci_command
+(   uci_t*      uci
+,   const char* line
+);
+
+/**
+ * @brief Executes a position command.
+ * @param uci The front end state.
+ * @param s The command arguments.
+ */
+void
+uci_position
+(   uci_t*      uci
+,   const char* s
+);
+
+/**
+ * @brief Executes a go command.
+ * @param uci The front end state.
+ * @param s The command arguments.
+ */
+void
+uci_go
+(   uci_t*      uci
+,   const char* s
+);
+
+/**
+ * @brief Executes a bench command.
+ * @param uci The front end state.
+ * @param s The command arguments.
+ */
+void
+uci_bench
+(   uci_t*      uci
+,   const char* s
+);
+
+/**
+ * @brief Executes a setoption command.
+ * @param uci The front end state.
+ * @param s The command arguments.
+ */
+void
+uci_setoption
+(   uci_t*      uci
+,   const char* s
+);
+
+/**
+ * @brief Waits for the running search, if any, to write its best move.
+ * @param uci The front end state.
+ * @param interrupt Interrupt the search? Y/N (a search under go infinite is
+ * always interrupted, as it would never end otherwise).
+ */
+void
+uci_stop
+(   uci_t*      uci
+,   const bool  interrupt
+);
+
+/**
+ * @brief Loads the evaluation network (replacing any loaded one).
+ * @param uci The front end state.
+ * @param filepath The network filepath (empty for none).
+ */
+void
+uci_load_nnue
+(   uci_t*      uci
+,   const char* filepath
+);
+
+/**
+ * @brief Loads the endgame bitbases (replacing any loaded ones).
+ * @param uci The front end state.
+ * @param directory The bitbase directory (empty for none).
+ */
+void
+uci_load_bitbases
+(   uci_t*      uci
+,   const char* directory
+);
+
+/**
+ * @brief Reads the next whitespace-delimited token of a string. Tokens longer
+ * than the buffer are truncated.
+ * @param s The string (advanced past the token).
+ * @param token Output buffer (UCI_TOKEN_MAX_LENGTH bytes).
+ * @return false if there are no more tokens, true otherwise.
+ */
+INLINE
+bool
+uci_token
+(   const char**    s
+,   char*           token
+)
+{
+    while ( **s && whitespace ( **s ) )
+    {
+        *s += 1;
+    }
+    u32 len = 0;
+    while ( **s && !whitespace ( **s ) )
+    {
+        if ( len < UCI_TOKEN_MAX_LENGTH - 1 )
+        {
+            token[ len++ ] = **s;
+        }
+        *s += 1;
+    }
+    token[ len ] = 0;   // Append terminator.
+    return len;
+}
+
+/**
+ * @brief Stringifies a move in UCI coordinate notation (e.g. "e7e8q").
+ * @param dst Output buffer (MOVE_STRING_LENGTH + 1 bytes).
+ * @param move The move (0 for the null move).
+ * @return dst.
+ */
+INLINE
+char*
+uci_move
+(   char*           dst
+,   const move_t    move
+)
+{
+    if ( !move )
+    {
+        string_format ( dst , "0000" );
+        return dst;
+    }
+    string_move ( dst , move );
+    if ( !move_decode_promotion ( move ) )
+    {
+        dst[ MOVE_STRING_LENGTH - 1 ] = 0;
+    }
+    for ( u32 i = 0; dst[ i ]; ++i )
+    {
+        dst[ i ] = to_lowercase ( dst[ i ] );
+    }
+    return dst;
+}
+
+/**
+ * @brief Writes a line to the output. Both the main thread and the search
+ * thread write, so the line and its newline are written in a single call,
+ * which the standard library does not interleave with another.
+ * @param uci The front end state.
+ * @param line The line to write.
+ */
+INLINE
+void
+uci_write
+(   uci_t*      uci
+,   const char* line
+)
+{
+    char buf[ UCI_LINE_MAX_LENGTH + 1 ];
+    const u64 len = min ( string_length ( line ) , ( u64 )( UCI_LINE_MAX_LENGTH - 1 ) );
+    memory_copy ( buf , line , len );
+    buf[ len ] = '\n';
+    u64 written;
+    file_write ( &( *uci ).out , len + 1 , buf , &written );
+}
+
+int
+main
+(   int     argc
+,   char**  argv
+)
+{
+    // Standard output carries the protocol only.
+    logger_redirect_console ( true );
+
+    if ( argc > 1 && !string_equal ( argv[ 1 ] , "bench" ) )
+    {
+        LOGERROR ( "Usage: %s [bench [nodes <n>] [threads <n>]]" , argv[ 0 ] );
+        return 1;
+    }
+
+    // Size the memory subsystem for the front end state, the network and the
+    // benchmark.
+    if ( !memory_startup ( sizeof ( uci_t )
+                         + sizeof ( nnue_t )
+                         + bench_nodes_memory_requirement ( BENCH_MAX_THREADS )
+                         + MEBIBYTES ( 16 )
+                         ))
+    {
+        return 1;
+    }
+    uci_t* uci = memory_allocate ( sizeof ( uci_t ) , MEMORY_TAG_APPLICATION );
+    if (    !file_open_stdio ( FILE_MODE_READ , &( *uci ).in )
+         || !file_open_stdio ( FILE_MODE_WRITE , &( *uci ).out )
+       )
+    {
+        return 1;
+    }
+    attacks_init ( &( *uci ).attacks );
+    fen_parse ( FEN_START , &( *uci ).board );
+    ( *uci ).search.observer = uci_info;
+    ( *uci ).search.observer_args = uci;
+    ( *uci ).search.observer_interval = UCI_INFO_INTERVAL;
+    search_params_default ( &( *uci ).params );
+    ( *uci ).search.params = &( *uci ).params;
+    if ( file_exists ( UCI_DEFAULT_EVAL_FILE ) )
+    {
+        uci_load_nnue ( uci , UCI_DEFAULT_EVAL_FILE );
+    }
+    uci_load_bitbases ( uci , UCI_DEFAULT_BITBASE_PATH );
+
+    // Benchmark from the command line.
+    if ( argc > 1 )
+    {
+        char args[ UCI_LINE_MAX_LENGTH ];
+        u64 len = 0;
+        args[ 0 ] = 0;
+        for ( i32 i = 2; i < argc && len + string_length ( argv[ i ] ) + 2 < sizeof ( args ); ++i )
+        {
+            len += string_format ( args + len , "%s " , argv[ i ] );
+        }
+        uci_bench ( uci , args );
+    }
+
+    // Read commands until quit or end of input.
+    char* line;
+    bool quit = argc > 1;
+    while ( !quit && file_read_line ( &( *uci ).in , &line ) )
+    {
+        quit = !uci_command ( uci , line );
+        string_free ( line );
+    }
+
+    uci_stop ( uci , true );
+    uci_load_nnue ( uci , "" );
+    uci_load_bitbases ( uci , "" );
+    memory_free ( uci , sizeof ( uci_t ) , MEMORY_TAG_APPLICATION );
+    memory_shutdown ();
+    return 0;
+}
+
+bool
+uci_command
+(   uci_t*      uci
+,   const char* line
+)
+{
+    char token[ UCI_TOKEN_MAX_LENGTH ];
+    const char* s = line;
+    if ( !uci_token ( &s , token ) )
+    {
+        return true;
+    }
+
+    if ( string_equal ( token , "uci" ) )
+    {
+        uci_write ( uci , "id name "UCI_ENGINE_NAME );
+        uci_write ( uci , "id author "UCI_ENGINE_AUTHOR );
+        uci_write ( uci , "option name EvalFile type string default "UCI_DEFAULT_EVAL_FILE );
+        uci_write ( uci , "option name BitbasePath type string default "UCI_DEFAULT_BITBASE_PATH );
+        for ( SEARCH_PARAM param = 0; param < SEARCH_PARAM_COUNT; ++param )
+        {
+            char buf[ UCI_TOKEN_MAX_LENGTH ];
+            string_format ( buf , "option name %s type spin default %i min %i max %i"
+                          , ( *search_param ( param ) ).name
+                          , ( *search_param ( param ) ).value
+                          , ( *search_param ( param ) ).min
+                          , ( *search_param ( param ) ).max
+                          );
+            uci_write ( uci , buf );
+        }
+        uci_write ( uci , "uciok" );
+    }
+    else if ( string_equal ( token , "isready" ) )
+    {
+        uci_write ( uci , "readyok" );
+    }
+    else if ( string_equal ( token , "ucinewgame" ) )
+    {
+        uci_stop ( uci , false );
+        fen_parse ( FEN_START , &( *uci ).board );
+    }
+    else if ( string_equal ( token , "setoption" ) )
+    {
+        uci_stop ( uci , false );
+        uci_setoption ( uci , s );
+    }
+    else if ( string_equal ( token , "position" ) )
+    {
+        uci_stop ( uci , false );
+        uci_position ( uci , s );
+    }
+    else if ( string_equal ( token , "go" ) )
+    {
+        uci_stop ( uci , false );
+        uci_go ( uci , s );
+    }
+    else if ( string_equal ( token , "bench" ) )
+    {
+        uci_stop ( uci , false );
+        uci_bench ( uci , s );
+    }
+    else if ( string_equal ( token , "stop" ) )
+    {
+        uci_stop ( uci , true );
+    }
+    else if ( string_equal ( token , "quit" ) )
+    {
+        return false;
+    }
+    return true;
+}
+
+void
+uci_position
+(   uci_t*      uci
+,   const char* s
+)
+{
+    char token[ UCI_TOKEN_MAX_LENGTH ];
+    char fen[ UCI_LINE_MAX_LENGTH ];
+    board_t board;
+
+    // Parse the position.
+    memory_clear ( &board , sizeof ( board_t ) );
+    if ( !uci_token ( &s , token ) )
+    {
+        return;
+    }
+    if ( string_equal ( token , "startpos" ) )
+    {
+        fen_parse ( FEN_START , &board );
+        uci_token ( &s , token );
+    }
+    else if ( string_equal ( token , "fen" ) )
+    {
+        u64 len = 0;
+        fen[ 0 ] = 0;
+        while ( uci_token ( &s , token ) && !string_equal ( token , "moves" ) )
+        {
+            if ( len + string_length ( token ) + 2 < UCI_LINE_MAX_LENGTH )
+            {
+                len += string_format ( fen + len , ( len ) ? " %s" : "%s" , token );
+            }
+        }
+        if ( !fen_parse ( fen , &board ) )
+        {
+            LOGERROR ( "uci_position: Invalid FEN '%s'." , fen );
+            return;
+        }
+    }
+    else
+    {
+        return;
+    }
+
+    // Replay the moves.
+    if ( string_equal ( token , "moves" ) )
+    {
+        moves_t moves;
+        move_t move;
+        while ( uci_token ( &s , token ) )
+        {
+            moves_compute ( &moves , &board , &( *uci ).attacks );
+            if ( !move_parse ( token , &moves , &( *uci ).attacks , &move ) )
+            {
+                LOGERROR ( "uci_position: Invalid move '%s'." , token );
+                break;
+            }
+            board_move ( &board , move , &( *uci ).attacks );
+        }
+    }
+    memory_copy ( &( *uci ).board , &board , sizeof ( board_t ) );
+}
+
+void
+uci_go
+(   uci_t*      uci
+,   const char* s
+)
+{
+    char token[ UCI_TOKEN_MAX_LENGTH ];
+    u64 depth = MOVE_SEARCH_MAX_PLY;
+    u64 nodes = 0;
+    u64 movetime = 0;
+    u64 time[ 2 ] = { 0 , 0 };
+    u64 inc[ 2 ] = { 0 , 0 };
+    u64 movestogo = UCI_DEFAULT_MOVES_TO_GO;
+    bool infinite = false;
+
+    // Parse the search limits.
+    while ( uci_token ( &s , token ) )
+    {
+        u64* value = 0;
+        if      ( string_equal ( token , "depth" ) )     value = &depth;
+        else if ( string_equal ( token , "nodes" ) )     value = &nodes;
+        else if ( string_equal ( token , "movetime" ) )  value = &movetime;
+        else if ( string_equal ( token , "wtime" ) )     value = &time[ WHITE ];
+        else if ( string_equal ( token , "btime" ) )     value = &time[ BLACK ];
+        else if ( string_equal ( token , "winc" ) )      value = &inc[ WHITE ];
+        else if ( string_equal ( token , "binc" ) )      value = &inc[ BLACK ];
+        else if ( string_equal ( token , "movestogo" ) ) value = &movestogo;
+        else if ( string_equal ( token , "infinite" ) )  infinite = true;
+        if ( value && uci_token ( &s , token ) )
+        {
+            string_to_u64 ( token , value );
+        }
+    }
+    depth = min ( max ( depth , 1ULL ) , ( u64 ) MOVE_SEARCH_MAX_PLY );
+
+    // Budget the time: a fixed move time, or an even share of the remaining
+    // clock time plus the increment, always leaving a safety margin.
+    const SIDE side = ( *uci ).board.side;
+    f64 limit = 0;
+    if ( movetime )
+    {
+        limit = movetime;
+    }
+    else if ( time[ side ] )
+    {
+        limit = time[ side ] / max ( movestogo , 1ULL ) + inc[ side ] / 2;
+        limit = min ( limit , ( f64 )( time[ side ] ) - UCI_TIME_MARGIN );
+    }
+    if ( ( movetime || time[ side ] ) && !infinite )
+    {
+        ( *uci ).search.time_limit = max ( limit , ( f64 ) 1 ) / 1000.0;
+    }
+    else
+    {
+        ( *uci ).search.time_limit = 0;
+    }
+
+    ( *uci ).search.node_limit = ( infinite ) ? 0 : nodes;
+
+    // Start the search.
+    ( *uci ).search.stop = false;
+    ( *uci ).depth = depth;
+    ( *uci ).infinite = infinite;
+    if ( !platform_thread_create ( uci_search , uci , &( *uci ).thread ) )
+    {
+        LOGERROR ( "uci_go: Failed to start the search thread." );
+        return;
+    }
+    ( *uci ).searching = true;
+}
+
+void
+uci_bench
+(   uci_t*      uci
+,   const char* s
+)
+{
+    char token[ UCI_TOKEN_MAX_LENGTH ];
+    u64 nodes = BENCH_NODES;
+    u64 threads = 1;
+    while ( uci_token ( &s , token ) )
+    {
+        u64* value = 0;
+        if      ( string_equal ( token , "nodes" ) )   value = &nodes;
+        else if ( string_equal ( token , "threads" ) ) value = &threads;
+        if ( value && uci_token ( &s , token ) )
+        {
+            string_to_u64 ( token , value );
+        }
+    }
+    nodes = max ( nodes , 1ULL );
+    threads = min ( max ( threads , 1ULL ) , ( u64 ) BENCH_MAX_THREADS );
+
+    bench_result_t result;
+    if ( !bench_nodes ( &( *uci ).attacks , ( *uci ).nnue , &( *uci ).params , nodes , threads , &result ) )
+    {
+        return;
+    }
+    char buf[ UCI_TOKEN_MAX_LENGTH ];
+    string_format ( buf , "Positions searched: %u (%llu nodes each, %llu threads)" , result.positions , nodes , threads );
+    uci_write ( uci , buf );
+    string_format ( buf , "Nodes searched: %llu" , result.nodes );
+    uci_write ( uci , buf );
+    string_format ( buf , "Signature: %016llx" , result.signature );
+    uci_write ( uci , buf );
+    string_format ( buf , "Nodes/second: %llu" , ( result.elapsed > 0 ) ? ( u64 )( result.nodes / result.elapsed ) : 0 );
+    uci_write ( uci , buf );
+}
+
+void
+uci_setoption
+(   uci_t*      uci
+,   const char* s
+)
+{
+    char token[ UCI_TOKEN_MAX_LENGTH ];
+    char name[ UCI_TOKEN_MAX_LENGTH ];
+    char value[ UCI_LINE_MAX_LENGTH ];
+
+    // Parse "name <id> [value <x>]". The value is the rest of the line, so
+    // that it may contain spaces.
+    if ( !uci_token ( &s , token ) || !string_equal ( token , "name" ) )
+    {
+        return;
+    }
+    uci_token ( &s , name );
+    value[ 0 ] = 0;
+    if ( uci_token ( &s , token ) && string_equal ( token , "value" ) )
+    {
+        string_format ( value , "%s" , s );
+        string_trim ( value );
+    }
+
+    if ( string_equal ( name , "EvalFile" ) )
+    {
+        uci_load_nnue ( uci , value );
+    }
+    else if ( string_equal ( name , "BitbasePath" ) )
+    {
+        uci_load_bitbases ( uci , value );
+    }
+    else if ( search_param_find ( name ) != SEARCH_PARAM_COUNT )
+    {
+        char param[ UCI_LINE_MAX_LENGTH ];
+        string_format ( param , "%s=%s" , name , value );
+        search_params_parse ( &( *uci ).params , param );
+    }
+    else
+    {
+        LOGERROR ( "uci_setoption: Unknown option '%s'." , name );
+    }
+}
+
+void
+uci_stop
+(   uci_t*      uci
+,   const bool  interrupt
+)
+{
+    if ( !( *uci ).searching )
+    {
+        return;
+    }
+    if ( interrupt || ( *uci ).infinite )
+    {
+        ( *uci ).search.stop = true;
+    }
+    platform_thread_join ( &( *uci ).thread );
+    ( *uci ).searching = false;
+}
+
+u32
+uci_search
+(   void* args
+)
+{
+    uci_t* uci = args;
+    char buf[ UCI_TOKEN_MAX_LENGTH ];
+    char move[ MOVE_STRING_LENGTH + 1 ];
+
+    const move_t best = board_best_move ( &( *uci ).board
+                                        , &( *uci ).attacks
+                                        , ( *uci ).depth
+                                        , &( *uci ).search
+                                        );
+
+    // Under go infinite, the best move may only be written after stop.
+    while ( ( *uci ).infinite && !( *uci ).search.stop )
+    {
+        platform_sleep ( 1 );
+    }
+
+    string_format ( buf , "bestmove %s" , uci_move ( move , best ) );
+    uci_write ( uci , buf );
+    return 0;
+}
+
+void
+uci_info
+(   const move_search_result_t* result
+,   void*                       args
+)
+{
+    uci_t* uci = args;
+    char buf[ UCI_LINE_MAX_LENGTH ];
+    char move[ MOVE_STRING_LENGTH + 1 ];
+    const u64 nps = ( ( *result ).elapsed > 0 ) ? ( u64 )( ( *result ).nodes / ( *result ).elapsed ) : 0;
+    const u64 time = ( *result ).elapsed * 1000;
+
+    // Between iterations, only the progress.
+    if ( !( *result ).iteration )
+    {
+        string_format ( buf , "info depth %u seldepth %u nodes %llu nps %llu time %llu"
+                      , ( *result ).depth + 1 , ( *result ).seldepth , ( *result ).nodes , nps , time
+                      );
+        uci_write ( uci , buf );
+        return;
+    }
+
+    // Score, in centipawns or in moves to mate.
+    u64 len = string_format ( buf , "info depth %u seldepth %u" , ( *result ).depth , ( *result ).seldepth );
+    if ( ( *result ).forced_mate )
+    {
+        len += string_format ( buf + len , " score mate %i" , ( *result ).mate );
+    }
+    else
+    {
+        len += string_format ( buf + len , " score cp %i" , ( *result ).score );
+    }
+    len += string_format ( buf + len , " nodes %llu nps %llu time %llu pv" , ( *result ).nodes , nps , time );
+
+    // Principal variation.
+    for ( u32 i = 0; i < ( *result ).pv_length && len + MOVE_STRING_LENGTH + 2 < UCI_LINE_MAX_LENGTH; ++i )
+    {
+        len += string_format ( buf + len , " %s" , uci_move ( move , ( *result ).pv[ i ] ) );
+    }
+    uci_write ( uci , buf );
+}
+
+void
+uci_load_nnue
+(   uci_t*      uci
+,   const char* filepath
+)
+{
+    if ( ( *uci ).nnue )
+    {
+        memory_free ( ( *uci ).nnue , sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+        ( *uci ).nnue = 0;
+    }
+    if ( *filepath )
+    {
+        ( *uci ).nnue = memory_allocate ( sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+        if ( !nnue_load ( filepath , ( *uci ).nnue ) )
+        {
+            LOGERROR ( "uci_load_nnue: Failed to load evaluation network '%s'. Using default evaluation." , filepath );
+            memory_free ( ( *uci ).nnue , sizeof ( nnue_t ) , MEMORY_TAG_APPLICATION );
+            ( *uci ).nnue = 0;
+        }
+    }
+    ( *uci ).search.nnue = ( *uci ).nnue;
+}
+
+void
+uci_load_bitbases
+(   uci_t*      uci
+,   const char* directory
+)
+{
+    bitbases_unload ( &( *uci ).bitbases );
+    const u32 count = ( *directory ) ? bitbases_load ( directory , &( *uci ).bitbases ) : 0;
+    ( *uci ).search.bitbases = ( count ) ? &( *uci ).bitbases : 0;
+}
\ No newline at end of file